@@ -0,0 +1,98 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include <vector>
+
+enum AnimationRotationMode {
+    ANIMATION_NLERP,    // normalized lerp, the usual choice between close keys
+    ANIMATION_SLERP
+};
+
+/* Keyframes of one channel for every joint of a clip. The keys of joint j
+ * are times[first[j] .. first[j] + count[j]) in increasing order, with the
+ * values at the same indices, so all the tracks of a channel share two
+ * flat arrays. */
+template <typename T>
+struct AnimationChannel {
+    std::vector<unsigned> first;
+    std::vector<unsigned> count;
+    std::vector<float> times;
+    std::vector<T> values;
+
+    void setKeys(unsigned joint, const float *keyTimes, const T *keyValues,
+            unsigned keyCount) {
+        first[joint] = (unsigned)times.size();
+        count[joint] = keyCount;
+        times.insert(times.end(), keyTimes, keyTimes + keyCount);
+        values.insert(values.end(), keyValues, keyValues + keyCount);
+    }
+};
+
+/* Local transforms of a skeleton, one entry per joint. */
+struct LocalPose {
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+
+    explicit LocalPose(unsigned jointCount = 0) {
+        resize(jointCount);
+    }
+
+    void resize(unsigned jointCount) {
+        translations.assign(jointCount, glm::vec3(0.0f));
+        rotations.assign(jointCount, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        scales.assign(jointCount, glm::vec3(1.0f));
+    }
+};
+
+/* The key each joint used last, per channel. Playing forward moves a
+ * cursor by a key or two per frame instead of searching the whole track,
+ * jumping backward falls back to a binary search. One cursor per playing
+ * instance of a clip. */
+struct AnimationCursor {
+    std::vector<unsigned> translation;
+    std::vector<unsigned> rotation;
+    std::vector<unsigned> scale;
+};
+
+class AnimationClip {
+
+public:
+    AnimationChannel<glm::vec3> translation;
+    AnimationChannel<glm::quat> rotation;
+    AnimationChannel<glm::vec3> scale;
+
+    AnimationClip(unsigned jointCount, float duration);
+
+    unsigned jointCount() const { return joints; }
+    float duration() const { return length; }
+
+    /* time modulo the duration, for looping playback */
+    float wrap(float time) const;
+
+    /* Writes the channels of joints [firstJoint, firstJoint + count) at
+     * time into pose. Times outside the keys clamp to the first or last
+     * key, joints without keys in a channel keep their pose value.
+     * Disjoint joint ranges can be sampled from different threads with
+     * the same cursor and pose. */
+    void sample(float time, AnimationCursor &cursor, LocalPose &pose,
+            unsigned firstJoint, unsigned count,
+            AnimationRotationMode mode = ANIMATION_NLERP) const;
+
+    void sample(float time, AnimationCursor &cursor, LocalPose &pose,
+            AnimationRotationMode mode = ANIMATION_NLERP) const {
+        sample(time, cursor, pose, 0, joints, mode);
+    }
+
+    /* Sizes cursor for this clip, sample() expects it */
+    void initCursor(AnimationCursor &cursor) const;
+
+private:
+    unsigned joints;
+    float length;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef GL_CAPTURE_H
+#define GL_CAPTURE_H
+
+/* Binary capture stream, read back by src/gl_replay.cpp:
+ *
+ *   header:  "GLCAPTR1", u32 number of entry points
+ *   record:  u16 entry index, then the arguments in declaration order
+ *            (scalars raw, pointers as kind + length + data padded to 8
+ *            bytes), then any returned value or generated names
+ *   markers: GL_CAPTURE_FRAME_MARKER after each frame,
+ *            GL_CAPTURE_END_MARKER at the end of the stream
+ */
+#define GL_CAPTURE_MAGIC        "GLCAPTR1"
+#define GL_CAPTURE_FRAME_MARKER 0xFFFE
+#define GL_CAPTURE_END_MARKER   0xFFFF
+
+#define GL_CAPTURE_PTR_NULL     0
+#define GL_CAPTURE_PTR_OFFSET   1   // offset into a bound buffer object
+#define GL_CAPTURE_PTR_DATA     2   // client memory, copied into the stream
+
+/* Records every call made through the glad entry points. Like GLTracer
+ * it swaps the glad_gl* pointers, so it costs nothing when not running.
+ * Must be started after gladLoadGLLoader(). */
+class GLCapture {
+
+public:
+    static bool begin(const char *path);
+    static void endFrame();
+    static void end();
+    static bool isCapturing();
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <iostream>
+#include <vector>
+
+struct GLCallStats {
+    const char *name;
+    unsigned long long calls;
+    double seconds;         // CPU time spent inside the driver entry point
+};
+
+/* Instrumented dispatch over the glad entry points. enable() swaps every
+ * loaded glad_gl* pointer for a counting/timing wrapper, disable() puts
+ * the driver pointers back, so a disabled tracer costs nothing. Must be
+ * called after gladLoadGLLoader(). */
+class GLTracer {
+
+public:
+    static void enable(bool logArgs = false);
+    static void disable();
+    static bool isEnabled();
+
+    /* closes the current frame: keeps its histogram, resets the counters */
+    static void endFrame();
+
+    /* last closed frame, sorted by time spent, slowest first */
+    static const std::vector<GLCallStats> &frameHistogram();
+    static void printFrameHistogram(std::ostream &out, int topN = 10);
+};
+
+#endif
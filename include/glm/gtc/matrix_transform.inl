@@ -5,45 +5,130 @@
 #include "../trigonometric.hpp"
 #include "../matrix.hpp"
 
-namespace glm
+namespace glm{
+namespace detail
 {
+	template <typename T, precision P, bool Aligned>
+	struct compute_translate
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<T, P> call(tmat4x4<T, P> const & m, tvec3<T, P> const & v)
+		{
+			tmat4x4<T, P> Result(m);
+			Result[3] = m[0] * v[0] + m[1] * v[1] + m[2] * v[2] + m[3];
+			return Result;
+		}
+	};
+
+	template <typename T, precision P, bool Aligned>
+	struct compute_rotate
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<T, P> call(tmat4x4<T, P> const & m, T angle, tvec3<T, P> const & v)
+		{
+			T const a = angle;
+			T const c = cos(a);
+			T const s = sin(a);
+
+			tvec3<T, P> axis(normalize(v));
+			tvec3<T, P> temp((T(1) - c) * axis);
+
+			tmat4x4<T, P> Rotate(uninitialize);
+			Rotate[0][0] = c + temp[0] * axis[0];
+			Rotate[0][1] = temp[0] * axis[1] + s * axis[2];
+			Rotate[0][2] = temp[0] * axis[2] - s * axis[1];
+
+			Rotate[1][0] = temp[1] * axis[0] - s * axis[2];
+			Rotate[1][1] = c + temp[1] * axis[1];
+			Rotate[1][2] = temp[1] * axis[2] + s * axis[0];
+
+			Rotate[2][0] = temp[2] * axis[0] + s * axis[1];
+			Rotate[2][1] = temp[2] * axis[1] - s * axis[0];
+			Rotate[2][2] = c + temp[2] * axis[2];
+
+			tmat4x4<T, P> Result(uninitialize);
+			Result[0] = m[0] * Rotate[0][0] + m[1] * Rotate[0][1] + m[2] * Rotate[0][2];
+			Result[1] = m[0] * Rotate[1][0] + m[1] * Rotate[1][1] + m[2] * Rotate[1][2];
+			Result[2] = m[0] * Rotate[2][0] + m[1] * Rotate[2][1] + m[2] * Rotate[2][2];
+			Result[3] = m[3];
+			return Result;
+		}
+	};
+
+	template <typename T, precision P, bool Aligned>
+	struct compute_scale
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<T, P> call(tmat4x4<T, P> const & m, tvec3<T, P> const & v)
+		{
+			tmat4x4<T, P> Result(uninitialize);
+			Result[0] = m[0] * v[0];
+			Result[1] = m[1] * v[1];
+			Result[2] = m[2] * v[2];
+			Result[3] = m[3];
+			return Result;
+		}
+	};
+
+	template <typename T, precision P, bool Aligned>
+	struct compute_lookAt
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<T, P> call(tvec3<T, P> const & eye, tvec3<T, P> const & center, tvec3<T, P> const & up, bool leftHanded)
+		{
+			tvec3<T, P> const f(normalize(center - eye));
+			tvec3<T, P> const s(leftHanded ? normalize(cross(up, f)) : normalize(cross(f, up)));
+			tvec3<T, P> const u(leftHanded ? cross(f, s) : cross(s, f));
+			tvec3<T, P> const b(leftHanded ? f : -f);
+
+			tmat4x4<T, P> Result(1);
+			Result[0][0] = s.x;
+			Result[1][0] = s.y;
+			Result[2][0] = s.z;
+			Result[0][1] = u.x;
+			Result[1][1] = u.y;
+			Result[2][1] = u.z;
+			Result[0][2] = b.x;
+			Result[1][2] = b.y;
+			Result[2][2] = b.z;
+			Result[3][0] = -dot(s, eye);
+			Result[3][1] = -dot(u, eye);
+			Result[3][2] = -dot(b, eye);
+			return Result;
+		}
+	};
+
+	template <typename T, precision P, bool Aligned>
+	struct compute_perspective
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<T, P> call(T fovy, T aspect, T zNear, T zFar, bool leftHanded)
+		{
+			T const tanHalfFovy = tan(fovy / static_cast<T>(2));
+
+			tmat4x4<T, P> Result(static_cast<T>(0));
+			Result[0][0] = static_cast<T>(1) / (aspect * tanHalfFovy);
+			Result[1][1] = static_cast<T>(1) / (tanHalfFovy);
+			Result[2][3] = leftHanded ? static_cast<T>(1) : - static_cast<T>(1);
+
+#			if GLM_DEPTH_CLIP_SPACE == GLM_DEPTH_ZERO_TO_ONE
+				Result[2][2] = leftHanded ? zFar / (zFar - zNear) : zFar / (zNear - zFar);
+				Result[3][2] = -(zFar * zNear) / (zFar - zNear);
+#			else
+				Result[2][2] = leftHanded ? (zFar + zNear) / (zFar - zNear) : - (zFar + zNear) / (zFar - zNear);
+				Result[3][2] = - (static_cast<T>(2) * zFar * zNear) / (zFar - zNear);
+#			endif
+
+			return Result;
+		}
+	};
+}//namespace detail
+
 	template <typename T, precision P>
 	GLM_FUNC_QUALIFIER tmat4x4<T, P> translate(tmat4x4<T, P> const & m, tvec3<T, P> const & v)
 	{
-		tmat4x4<T, P> Result(m);
-		Result[3] = m[0] * v[0] + m[1] * v[1] + m[2] * v[2] + m[3];
-		return Result;
+		return detail::compute_translate<T, P, detail::is_aligned<P>::value>::call(m, v);
 	}
 	
 	template <typename T, precision P>
 	GLM_FUNC_QUALIFIER tmat4x4<T, P> rotate(tmat4x4<T, P> const & m, T angle, tvec3<T, P> const & v)
 	{
-		T const a = angle;
-		T const c = cos(a);
-		T const s = sin(a);
-
-		tvec3<T, P> axis(normalize(v));
-		tvec3<T, P> temp((T(1) - c) * axis);
-
-		tmat4x4<T, P> Rotate(uninitialize);
-		Rotate[0][0] = c + temp[0] * axis[0];
-		Rotate[0][1] = temp[0] * axis[1] + s * axis[2];
-		Rotate[0][2] = temp[0] * axis[2] - s * axis[1];
-
-		Rotate[1][0] = temp[1] * axis[0] - s * axis[2];
-		Rotate[1][1] = c + temp[1] * axis[1];
-		Rotate[1][2] = temp[1] * axis[2] + s * axis[0];
-
-		Rotate[2][0] = temp[2] * axis[0] + s * axis[1];
-		Rotate[2][1] = temp[2] * axis[1] - s * axis[0];
-		Rotate[2][2] = c + temp[2] * axis[2];
-
-		tmat4x4<T, P> Result(uninitialize);
-		Result[0] = m[0] * Rotate[0][0] + m[1] * Rotate[0][1] + m[2] * Rotate[0][2];
-		Result[1] = m[0] * Rotate[1][0] + m[1] * Rotate[1][1] + m[2] * Rotate[1][2];
-		Result[2] = m[0] * Rotate[2][0] + m[1] * Rotate[2][1] + m[2] * Rotate[2][2];
-		Result[3] = m[3];
-		return Result;
+		return detail::compute_rotate<T, P, detail::is_aligned<P>::value>::call(m, angle, v);
 	}
 		
 	template <typename T, precision P>
@@ -78,12 +163,7 @@ namespace glm
 	template <typename T, precision P>
 	GLM_FUNC_QUALIFIER tmat4x4<T, P> scale(tmat4x4<T, P> const & m, tvec3<T, P> const & v)
 	{
-		tmat4x4<T, P> Result(uninitialize);
-		Result[0] = m[0] * v[0];
-		Result[1] = m[1] * v[1];
-		Result[2] = m[2] * v[2];
-		Result[3] = m[3];
-		return Result;
+		return detail::compute_scale<T, P, detail::is_aligned<P>::value>::call(m, v);
 	}
 
 	template <typename T, precision P>
@@ -259,22 +339,7 @@ namespace glm
 	{
 		assert(abs(aspect - std::numeric_limits<T>::epsilon()) > static_cast<T>(0));
 
-		T const tanHalfFovy = tan(fovy / static_cast<T>(2));
-
-		tmat4x4<T, defaultp> Result(static_cast<T>(0));
-		Result[0][0] = static_cast<T>(1) / (aspect * tanHalfFovy);
-		Result[1][1] = static_cast<T>(1) / (tanHalfFovy);
-		Result[2][3] = - static_cast<T>(1);
-
-#		if GLM_DEPTH_CLIP_SPACE == GLM_DEPTH_ZERO_TO_ONE
-			Result[2][2] = zFar / (zNear - zFar);
-			Result[3][2] = -(zFar * zNear) / (zFar - zNear);
-#		else
-			Result[2][2] = - (zFar + zNear) / (zFar - zNear);
-			Result[3][2] = - (static_cast<T>(2) * zFar * zNear) / (zFar - zNear);
-#		endif
-
-		return Result;
+		return detail::compute_perspective<T, defaultp, detail::is_aligned<defaultp>::value>::call(fovy, aspect, zNear, zFar, false);
 	}
 	
 	template <typename T>
@@ -282,22 +347,7 @@ namespace glm
 	{
 		assert(abs(aspect - std::numeric_limits<T>::epsilon()) > static_cast<T>(0));
 
-		T const tanHalfFovy = tan(fovy / static_cast<T>(2));
-		
-		tmat4x4<T, defaultp> Result(static_cast<T>(0));
-		Result[0][0] = static_cast<T>(1) / (aspect * tanHalfFovy);
-		Result[1][1] = static_cast<T>(1) / (tanHalfFovy);
-		Result[2][3] = static_cast<T>(1);
-
-#		if GLM_DEPTH_CLIP_SPACE == GLM_DEPTH_ZERO_TO_ONE
-			Result[2][2] = zFar / (zFar - zNear);
-			Result[3][2] = -(zFar * zNear) / (zFar - zNear);
-#		else
-			Result[2][2] = (zFar + zNear) / (zFar - zNear);
-			Result[3][2] = - (static_cast<T>(2) * zFar * zNear) / (zFar - zNear);
-#		endif
-
-		return Result;
+		return detail::compute_perspective<T, defaultp, detail::is_aligned<defaultp>::value>::call(fovy, aspect, zNear, zFar, true);
 	}
 
 	template <typename T>
@@ -525,24 +575,7 @@ namespace glm
 		tvec3<T, P> const & up
 	)
 	{
-		tvec3<T, P> const f(normalize(center - eye));
-		tvec3<T, P> const s(normalize(cross(f, up)));
-		tvec3<T, P> const u(cross(s, f));
-
-		tmat4x4<T, P> Result(1);
-		Result[0][0] = s.x;
-		Result[1][0] = s.y;
-		Result[2][0] = s.z;
-		Result[0][1] = u.x;
-		Result[1][1] = u.y;
-		Result[2][1] = u.z;
-		Result[0][2] =-f.x;
-		Result[1][2] =-f.y;
-		Result[2][2] =-f.z;
-		Result[3][0] =-dot(s, eye);
-		Result[3][1] =-dot(u, eye);
-		Result[3][2] = dot(f, eye);
-		return Result;
+		return detail::compute_lookAt<T, P, detail::is_aligned<P>::value>::call(eye, center, up, false);
 	}
 
 	template <typename T, precision P>
@@ -553,23 +586,10 @@ namespace glm
 		tvec3<T, P> const & up
 	)
 	{
-		tvec3<T, P> const f(normalize(center - eye));
-		tvec3<T, P> const s(normalize(cross(up, f)));
-		tvec3<T, P> const u(cross(f, s));
-
-		tmat4x4<T, P> Result(1);
-		Result[0][0] = s.x;
-		Result[1][0] = s.y;
-		Result[2][0] = s.z;
-		Result[0][1] = u.x;
-		Result[1][1] = u.y;
-		Result[2][1] = u.z;
-		Result[0][2] = f.x;
-		Result[1][2] = f.y;
-		Result[2][2] = f.z;
-		Result[3][0] = -dot(s, eye);
-		Result[3][1] = -dot(u, eye);
-		Result[3][2] = -dot(f, eye);
-		return Result;
+		return detail::compute_lookAt<T, P, detail::is_aligned<P>::value>::call(eye, center, up, true);
 	}
 }//namespace glm
+
+#if GLM_ARCH != GLM_ARCH_PURE && GLM_HAS_UNRESTRICTED_UNIONS
+#	include "matrix_transform_simd.inl"
+#endif
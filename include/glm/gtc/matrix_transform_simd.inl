@@ -0,0 +1,121 @@
+/// @ref gtc_matrix_transform
+/// @file glm/gtc/matrix_transform_simd.inl
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+#include "../simd/matrix.h"
+
+namespace glm{
+namespace detail
+{
+	// The specializations evaluate the same expressions as the generic code,
+	// in the same order and without FMA, so they round identically as long
+	// as the compiler doesn't contract the generic code into FMAs. GCC does
+	// by default once FMA is enabled (-mfma, -march=native): build with
+	// -ffp-contract=off where both paths must agree. math_bench checks it.
+
+	template <precision P>
+	struct compute_translate<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<float, P> call(tmat4x4<float, P> const & m, tvec3<float, P> const & v)
+		{
+			tmat4x4<float, P> Result(uninitialize);
+			glm_mat4_translate(
+				*reinterpret_cast<glm_vec4 const(*)[4]>(&m[0].data),
+				_mm_setr_ps(v.x, v.y, v.z, 0.0f),
+				*reinterpret_cast<glm_vec4(*)[4]>(&Result[0].data));
+			return Result;
+		}
+	};
+
+	template <precision P>
+	struct compute_rotate<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<float, P> call(tmat4x4<float, P> const & m, float angle, tvec3<float, P> const & v)
+		{
+			tvec3<float, P> const axis(normalize(v));
+
+			tmat4x4<float, P> Result(uninitialize);
+			glm_mat4_rotate(
+				*reinterpret_cast<glm_vec4 const(*)[4]>(&m[0].data),
+				cos(angle), sin(angle),
+				_mm_setr_ps(axis.x, axis.y, axis.z, 0.0f),
+				*reinterpret_cast<glm_vec4(*)[4]>(&Result[0].data));
+			return Result;
+		}
+	};
+
+	template <precision P>
+	struct compute_scale<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<float, P> call(tmat4x4<float, P> const & m, tvec3<float, P> const & v)
+		{
+			tmat4x4<float, P> Result(uninitialize);
+			glm_mat4_scale(
+				*reinterpret_cast<glm_vec4 const(*)[4]>(&m[0].data),
+				_mm_setr_ps(v.x, v.y, v.z, 0.0f),
+				*reinterpret_cast<glm_vec4(*)[4]>(&Result[0].data));
+			return Result;
+		}
+	};
+
+	template <precision P>
+	struct compute_lookAt<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<float, P> call(tvec3<float, P> const & eye, tvec3<float, P> const & center, tvec3<float, P> const & up, bool leftHanded)
+		{
+			__m128 const e = _mm_setr_ps(eye.x, eye.y, eye.z, 0.0f);
+			__m128 const c = _mm_setr_ps(center.x, center.y, center.z, 0.0f);
+			__m128 const w = _mm_setr_ps(up.x, up.y, up.z, 0.0f);
+
+			__m128 const f = normalizeExact(_mm_sub_ps(c, e));
+			__m128 const s = normalizeExact(leftHanded ? glm_vec4_cross(w, f) : glm_vec4_cross(f, w));
+			__m128 const u = leftHanded ? glm_vec4_cross(f, s) : glm_vec4_cross(s, f);
+			__m128 const b = leftHanded ? f : _mm_xor_ps(f, _mm_set1_ps(-0.0f));
+
+			tmat4x4<float, P> Result(uninitialize);
+			glm_mat4_lookAt(s, u, b, e, *reinterpret_cast<glm_vec4(*)[4]>(&Result[0].data));
+			return Result;
+		}
+
+		// v / length(v) with the scalar summation order: x * x + y * y + z * z
+		GLM_FUNC_QUALIFIER static __m128 normalizeExact(__m128 v)
+		{
+			__m128 const sq = _mm_mul_ps(v, v);
+			__m128 const dot = _mm_add_ss(_mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(sq, sq));
+			__m128 const isr = _mm_div_ss(_mm_set_ss(1.0f), _mm_sqrt_ss(dot));
+			return _mm_mul_ps(v, _mm_shuffle_ps(isr, isr, _MM_SHUFFLE(0, 0, 0, 0)));
+		}
+	};
+
+	template <precision P>
+	struct compute_perspective<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static tmat4x4<float, P> call(float fovy, float aspect, float zNear, float zFar, bool leftHanded)
+		{
+			float const tanHalfFovy = tan(fovy / 2.0f);
+
+			// The four divisions of the generic code in a single one
+#			if GLM_DEPTH_CLIP_SPACE == GLM_DEPTH_ZERO_TO_ONE
+				__m128 const num = _mm_setr_ps(1.0f, 1.0f, zFar, -(zFar * zNear));
+				__m128 const den = _mm_setr_ps(aspect * tanHalfFovy, tanHalfFovy, leftHanded ? zFar - zNear : zNear - zFar, zFar - zNear);
+#			else
+				__m128 const num = _mm_setr_ps(1.0f, 1.0f, leftHanded ? zFar + zNear : -(zFar + zNear), -(2.0f * zFar * zNear));
+				__m128 const den = _mm_setr_ps(aspect * tanHalfFovy, tanHalfFovy, zFar - zNear, zFar - zNear);
+#			endif
+			__m128 const div = _mm_div_ps(num, den);
+			__m128 const zero = _mm_setzero_ps();
+
+			tmat4x4<float, P> Result(uninitialize);
+			glm_vec4 (&r)[4] = *reinterpret_cast<glm_vec4(*)[4]>(&Result[0].data);
+			r[0] = _mm_move_ss(zero, div);
+			r[1] = _mm_and_ps(div, _mm_castsi128_ps(_mm_setr_epi32(0, -1, 0, 0)));
+			r[2] = _mm_movelh_ps(zero, _mm_unpacklo_ps(_mm_movehl_ps(div, div), _mm_set_ss(leftHanded ? 1.0f : -1.0f)));
+			r[3] = _mm_movehl_ps(_mm_unpackhi_ps(div, zero), zero);
+			return Result;
+		}
+	};
+}//namespace detail
+}//namespace glm
+
+#endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
@@ -0,0 +1,145 @@
+/// @ref gtx_affine
+/// @file glm/gtx/affine.hpp
+///
+/// @see core (dependence)
+///
+/// @defgroup gtx_affine GLM_GTX_affine
+/// @ingroup gtx
+///
+/// @brief Defines a compact 3 * 4 affine transform type and its operations.
+///
+/// An affine transform is a 4 * 4 matrix whose bottom row is always (0, 0, 0, 1).
+/// taffine stores only the top three rows, row-major, so the type takes 48
+/// bytes instead of 64 and aligned precisions keep each row in a SIMD register.
+/// Multiply, transform and inverse skip the arithmetic of the implicit row.
+/// With aligned precisions they use SSE, rounding exactly like the generic
+/// code as long as the compiler doesn't fuse multiply-adds (-ffp-contract).
+/// Use mat4_cast to expand it at upload time.
+///
+/// <glm/gtx/affine.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_affine extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_affine
+	/// @{
+
+	template <typename T, precision P = defaultp>
+	struct taffine
+	{
+		// -- Implementation detail --
+
+		typedef T value_type;
+		typedef tvec4<T, P> row_type;
+
+		// -- Data --
+
+		/// row[i] = (m[0][i], m[1][i], m[2][i], m[3][i]) of the equivalent 4 * 4 matrix:
+		/// the linear part in xyz and the translation in w.
+		row_type row[3];
+
+		// -- Implicit basic constructors --
+
+		GLM_FUNC_DECL taffine() GLM_DEFAULT_CTOR;
+		GLM_FUNC_DECL taffine(taffine<T, P> const & a) GLM_DEFAULT;
+		template <precision Q>
+		GLM_FUNC_DECL taffine(taffine<T, Q> const & a);
+
+		// -- Explicit basic constructors --
+
+		GLM_FUNC_DECL explicit taffine(ctor);
+		GLM_FUNC_DECL explicit taffine(T const & s);
+		GLM_FUNC_DECL taffine(row_type const & r0, row_type const & r1, row_type const & r2);
+		GLM_FUNC_DECL taffine(tmat3x3<T, P> const & linear, tvec3<T, P> const & translation);
+
+		// -- Conversion constructors --
+
+		/// Drops the bottom row of m, which is assumed to be (0, 0, 0, 1).
+		GLM_FUNC_DECL GLM_EXPLICIT taffine(tmat4x4<T, P> const & m);
+
+		// -- Unary arithmetic operators --
+
+		GLM_FUNC_DECL taffine<T, P> & operator=(taffine<T, P> const & a) GLM_DEFAULT;
+
+		GLM_FUNC_DECL taffine<T, P> & operator*=(taffine<T, P> const & a);
+	};
+
+	// -- Binary operators --
+
+	/// Composes two transforms, applying b first, like the product of the 4 * 4 matrices.
+	template <typename T, precision P>
+	GLM_FUNC_DECL taffine<T, P> operator*(taffine<T, P> const & a, taffine<T, P> const & b);
+
+	/// Transforms a homogeneous vector.
+	template <typename T, precision P>
+	GLM_FUNC_DECL tvec4<T, P> operator*(taffine<T, P> const & a, tvec4<T, P> const & v);
+
+	// -- Boolean operators --
+
+	template <typename T, precision P>
+	GLM_FUNC_DECL bool operator==(taffine<T, P> const & a, taffine<T, P> const & b);
+
+	template <typename T, precision P>
+	GLM_FUNC_DECL bool operator!=(taffine<T, P> const & a, taffine<T, P> const & b);
+
+	/// Transforms a point, the translation is applied.
+	///
+	/// @see gtx_affine
+	template <typename T, precision P>
+	GLM_FUNC_DECL tvec3<T, P> transformPoint(taffine<T, P> const & a, tvec3<T, P> const & p);
+
+	/// Transforms a direction, the translation is ignored.
+	///
+	/// @see gtx_affine
+	template <typename T, precision P>
+	GLM_FUNC_DECL tvec3<T, P> transformVector(taffine<T, P> const & a, tvec3<T, P> const & v);
+
+	/// Returns the inverse transform: the inverse of the linear part and the
+	/// translation moved back through it. The linear part must be invertible.
+	///
+	/// @see gtx_affine
+	template <typename T, precision P>
+	GLM_FUNC_DECL taffine<T, P> inverse(taffine<T, P> const & a);
+
+	/// Expands to the equivalent 4 * 4 matrix.
+	///
+	/// @see gtx_affine
+	template <typename T, precision P>
+	GLM_FUNC_DECL tmat4x4<T, P> mat4_cast(taffine<T, P> const & a);
+
+	/// Drops the bottom row of m, which is assumed to be (0, 0, 0, 1).
+	///
+	/// @see gtx_affine
+	template <typename T, precision P>
+	GLM_FUNC_DECL taffine<T, P> affine_cast(tmat4x4<T, P> const & m);
+
+	/// Single-precision floating-point affine transform.
+	///
+	/// @see gtx_affine
+	typedef taffine<float, defaultp>		affine;
+
+	/// Double-precision floating-point affine transform.
+	///
+	/// @see gtx_affine
+	typedef taffine<double, defaultp>		daffine;
+
+#	if GLM_HAS_ALIGNED_TYPE
+	/// Single-precision floating-point affine transform with 16 bytes aligned rows,
+	/// selects the SIMD code paths.
+	///
+	/// @see gtx_affine
+	typedef taffine<float, aligned_highp>	aligned_affine;
+#	endif
+
+	/// @}
+} //namespace glm
+
+#include "affine.inl"
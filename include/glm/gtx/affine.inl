@@ -0,0 +1,219 @@
+/// @ref gtx_affine
+/// @file glm/gtx/affine.inl
+
+namespace glm{
+namespace detail
+{
+	template <typename T, precision P, bool Aligned>
+	struct compute_affine_mul
+	{
+		GLM_FUNC_QUALIFIER static taffine<T, P> call(taffine<T, P> const & a, taffine<T, P> const & b)
+		{
+			taffine<T, P> Result(uninitialize);
+			for(length_t i = 0; i < 3; ++i)
+				Result.row[i] = (a.row[i].x * b.row[0] + a.row[i].y * b.row[1]) + (a.row[i].z * b.row[2] + tvec4<T, P>(static_cast<T>(0), static_cast<T>(0), static_cast<T>(0), a.row[i].w));
+			return Result;
+		}
+	};
+
+	template <typename T, precision P, bool Aligned>
+	struct compute_affine_transform
+	{
+		GLM_FUNC_QUALIFIER static tvec3<T, P> call(taffine<T, P> const & a, tvec3<T, P> const & v, T w)
+		{
+			return tvec3<T, P>(
+				a.row[0].x * v.x + a.row[0].y * v.y + a.row[0].z * v.z + a.row[0].w * w,
+				a.row[1].x * v.x + a.row[1].y * v.y + a.row[1].z * v.z + a.row[1].w * w,
+				a.row[2].x * v.x + a.row[2].y * v.y + a.row[2].z * v.z + a.row[2].w * w);
+		}
+	};
+
+	template <typename T, precision P, bool Aligned>
+	struct compute_affine_inverse
+	{
+		GLM_FUNC_QUALIFIER static taffine<T, P> call(taffine<T, P> const & a)
+		{
+			// Columns of the linear part
+			tvec3<T, P> const c0(a.row[0].x, a.row[1].x, a.row[2].x);
+			tvec3<T, P> const c1(a.row[0].y, a.row[1].y, a.row[2].y);
+			tvec3<T, P> const c2(a.row[0].z, a.row[1].z, a.row[2].z);
+			tvec3<T, P> const t(a.row[0].w, a.row[1].w, a.row[2].w);
+
+			// The rows of the inverse are the cross products of the columns over the determinant
+			tvec3<T, P> const r0(cross(c1, c2));
+			tvec3<T, P> const r1(cross(c2, c0));
+			tvec3<T, P> const r2(cross(c0, c1));
+			T const InvDet = static_cast<T>(1) / dot(c0, r0);
+
+			tvec3<T, P> const i0(r0 * InvDet);
+			tvec3<T, P> const i1(r1 * InvDet);
+			tvec3<T, P> const i2(r2 * InvDet);
+
+			return taffine<T, P>(
+				tvec4<T, P>(i0, -dot(i0, t)),
+				tvec4<T, P>(i1, -dot(i1, t)),
+				tvec4<T, P>(i2, -dot(i2, t)));
+		}
+	};
+}//namespace detail
+
+	// -- Implicit basic constructors --
+
+#	if !GLM_HAS_DEFAULTED_FUNCTIONS || !defined(GLM_FORCE_NO_CTOR_INIT)
+		template <typename T, precision P>
+		GLM_FUNC_QUALIFIER taffine<T, P>::taffine()
+		{
+#			ifndef GLM_FORCE_NO_CTOR_INIT
+				this->row[0] = row_type(static_cast<T>(1), static_cast<T>(0), static_cast<T>(0), static_cast<T>(0));
+				this->row[1] = row_type(static_cast<T>(0), static_cast<T>(1), static_cast<T>(0), static_cast<T>(0));
+				this->row[2] = row_type(static_cast<T>(0), static_cast<T>(0), static_cast<T>(1), static_cast<T>(0));
+#			endif
+		}
+#	endif
+
+#	if !GLM_HAS_DEFAULTED_FUNCTIONS
+		template <typename T, precision P>
+		GLM_FUNC_QUALIFIER taffine<T, P>::taffine(taffine<T, P> const & a)
+		{
+			this->row[0] = a.row[0];
+			this->row[1] = a.row[1];
+			this->row[2] = a.row[2];
+		}
+#	endif//!GLM_HAS_DEFAULTED_FUNCTIONS
+
+	template <typename T, precision P>
+	template <precision Q>
+	GLM_FUNC_QUALIFIER taffine<T, P>::taffine(taffine<T, Q> const & a)
+	{
+		this->row[0] = row_type(a.row[0]);
+		this->row[1] = row_type(a.row[1]);
+		this->row[2] = row_type(a.row[2]);
+	}
+
+	// -- Explicit basic constructors --
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P>::taffine(ctor)
+	{}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P>::taffine(T const & s)
+	{
+		T const Zero(0);
+		this->row[0] = row_type(s, Zero, Zero, Zero);
+		this->row[1] = row_type(Zero, s, Zero, Zero);
+		this->row[2] = row_type(Zero, Zero, s, Zero);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P>::taffine(row_type const & r0, row_type const & r1, row_type const & r2)
+	{
+		this->row[0] = r0;
+		this->row[1] = r1;
+		this->row[2] = r2;
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P>::taffine(tmat3x3<T, P> const & l, tvec3<T, P> const & t)
+	{
+		this->row[0] = row_type(l[0][0], l[1][0], l[2][0], t.x);
+		this->row[1] = row_type(l[0][1], l[1][1], l[2][1], t.y);
+		this->row[2] = row_type(l[0][2], l[1][2], l[2][2], t.z);
+	}
+
+	// -- Conversion constructors --
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P>::taffine(tmat4x4<T, P> const & m)
+	{
+		this->row[0] = row_type(m[0][0], m[1][0], m[2][0], m[3][0]);
+		this->row[1] = row_type(m[0][1], m[1][1], m[2][1], m[3][1]);
+		this->row[2] = row_type(m[0][2], m[1][2], m[2][2], m[3][2]);
+	}
+
+	// -- Unary arithmetic operators --
+
+#	if !GLM_HAS_DEFAULTED_FUNCTIONS
+		template <typename T, precision P>
+		GLM_FUNC_QUALIFIER taffine<T, P> & taffine<T, P>::operator=(taffine<T, P> const & a)
+		{
+			this->row[0] = a.row[0];
+			this->row[1] = a.row[1];
+			this->row[2] = a.row[2];
+			return *this;
+		}
+#	endif//!GLM_HAS_DEFAULTED_FUNCTIONS
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P> & taffine<T, P>::operator*=(taffine<T, P> const & a)
+	{
+		return (*this = *this * a);
+	}
+
+	// -- Binary operators --
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P> operator*(taffine<T, P> const & a, taffine<T, P> const & b)
+	{
+		return detail::compute_affine_mul<T, P, detail::is_aligned<P>::value>::call(a, b);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER tvec4<T, P> operator*(taffine<T, P> const & a, tvec4<T, P> const & v)
+	{
+		return tvec4<T, P>(detail::compute_affine_transform<T, P, detail::is_aligned<P>::value>::call(a, tvec3<T, P>(v), v.w), v.w);
+	}
+
+	// -- Boolean operators --
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER bool operator==(taffine<T, P> const & a, taffine<T, P> const & b)
+	{
+		return a.row[0] == b.row[0] && a.row[1] == b.row[1] && a.row[2] == b.row[2];
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER bool operator!=(taffine<T, P> const & a, taffine<T, P> const & b)
+	{
+		return !(a == b);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER tvec3<T, P> transformPoint(taffine<T, P> const & a, tvec3<T, P> const & p)
+	{
+		return detail::compute_affine_transform<T, P, detail::is_aligned<P>::value>::call(a, p, static_cast<T>(1));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER tvec3<T, P> transformVector(taffine<T, P> const & a, tvec3<T, P> const & v)
+	{
+		return detail::compute_affine_transform<T, P, detail::is_aligned<P>::value>::call(a, v, static_cast<T>(0));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P> inverse(taffine<T, P> const & a)
+	{
+		GLM_STATIC_ASSERT(std::numeric_limits<T>::is_iec559 || GLM_UNRESTRICTED_GENTYPE, "'inverse' only accept floating-point inputs");
+		return detail::compute_affine_inverse<T, P, detail::is_aligned<P>::value>::call(a);
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER tmat4x4<T, P> mat4_cast(taffine<T, P> const & a)
+	{
+		return tmat4x4<T, P>(
+			a.row[0].x, a.row[1].x, a.row[2].x, static_cast<T>(0),
+			a.row[0].y, a.row[1].y, a.row[2].y, static_cast<T>(0),
+			a.row[0].z, a.row[1].z, a.row[2].z, static_cast<T>(0),
+			a.row[0].w, a.row[1].w, a.row[2].w, static_cast<T>(1));
+	}
+
+	template <typename T, precision P>
+	GLM_FUNC_QUALIFIER taffine<T, P> affine_cast(tmat4x4<T, P> const & m)
+	{
+		return taffine<T, P>(m);
+	}
+}//namespace glm
+
+#if GLM_ARCH != GLM_ARCH_PURE && GLM_HAS_UNRESTRICTED_UNIONS
+#	include "affine_simd.inl"
+#endif
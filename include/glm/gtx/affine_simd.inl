@@ -0,0 +1,103 @@
+/// @ref gtx_affine
+/// @file glm/gtx/affine_simd.inl
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+#include "../simd/geometric.h"
+
+namespace glm{
+namespace detail
+{
+	// Same operation order as the generic code, the results are identical
+	// unless the compiler contracts either side into FMAs, which GCC does by
+	// default once FMA is enabled (-mfma, -march=native). Build with
+	// -ffp-contract=off where aligned and packed results must match.
+
+	template <precision P>
+	struct compute_affine_mul<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static taffine<float, P> call(taffine<float, P> const & a, taffine<float, P> const & b)
+		{
+			__m128 const w = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+			taffine<float, P> Result(uninitialize);
+			for(length_t i = 0; i < 3; ++i)
+			{
+				__m128 const r = a.row[i].data;
+				__m128 const m0 = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0)), b.row[0].data);
+				__m128 const m1 = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1)), b.row[1].data);
+				__m128 const m2 = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2)), b.row[2].data);
+				Result.row[i].data = _mm_add_ps(_mm_add_ps(m0, m1), _mm_add_ps(m2, _mm_and_ps(r, w)));
+			}
+			return Result;
+		}
+	};
+
+	template <precision P>
+	struct compute_affine_transform<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static tvec3<float, P> call(taffine<float, P> const & a, tvec3<float, P> const & v, float w)
+		{
+			// Transpose the rows into the columns of the 4 * 4 matrix
+			__m128 c0 = a.row[0].data;
+			__m128 c1 = a.row[1].data;
+			__m128 c2 = a.row[2].data;
+			__m128 c3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+			__m128 const a0 = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v.x)), _mm_mul_ps(c1, _mm_set1_ps(v.y)));
+			__m128 const a1 = _mm_add_ps(a0, _mm_mul_ps(c2, _mm_set1_ps(v.z)));
+			__m128 const a2 = _mm_add_ps(a1, _mm_mul_ps(c3, _mm_set1_ps(w)));
+
+			GLM_ALIGN(16) float Result[4];
+			_mm_store_ps(Result, a2);
+			return tvec3<float, P>(Result[0], Result[1], Result[2]);
+		}
+	};
+
+	template <precision P>
+	struct compute_affine_inverse<float, P, true>
+	{
+		GLM_FUNC_QUALIFIER static taffine<float, P> call(taffine<float, P> const & a)
+		{
+			__m128 c0 = a.row[0].data;
+			__m128 c1 = a.row[1].data;
+			__m128 c2 = a.row[2].data;
+			__m128 t = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+
+			__m128 const r0 = glm_vec4_cross(c1, c2);
+			__m128 const r1 = glm_vec4_cross(c2, c0);
+			__m128 const r2 = glm_vec4_cross(c0, c1);
+
+			// dot(c0, r0) summed as x + y + z like the scalar code
+			__m128 const d = _mm_mul_ps(c0, r0);
+			__m128 const Det = _mm_add_ss(_mm_add_ss(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(d, d));
+			__m128 const Rcp = _mm_div_ss(_mm_set_ss(1.0f), Det);
+			__m128 const InvDet = _mm_shuffle_ps(Rcp, Rcp, _MM_SHUFFLE(0, 0, 0, 0));
+
+			__m128 i0 = _mm_mul_ps(r0, InvDet);
+			__m128 i1 = _mm_mul_ps(r1, InvDet);
+			__m128 i2 = _mm_mul_ps(r2, InvDet);
+			__m128 i3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(i0, i1, i2, i3);
+
+			// -dot(row, t) for the three rows at once, then back to rows
+			__m128 const tx = _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0));
+			__m128 const ty = _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1));
+			__m128 const tz = _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2));
+			__m128 const dt = _mm_add_ps(_mm_add_ps(_mm_mul_ps(i0, tx), _mm_mul_ps(i1, ty)), _mm_mul_ps(i2, tz));
+			i3 = _mm_xor_ps(dt, _mm_set1_ps(-0.0f));
+			_MM_TRANSPOSE4_PS(i0, i1, i2, i3);
+
+			taffine<float, P> Result(uninitialize);
+			Result.row[0].data = i0;
+			Result.row[1].data = i1;
+			Result.row[2].data = i2;
+			return Result;
+		}
+	};
+}//namespace detail
+}//namespace glm
+
+#endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
@@ -0,0 +1,66 @@
+/// @ref gtx_inverse_batch
+/// @file glm/gtx/inverse_batch.hpp
+///
+/// @see core (dependence)
+/// @see gtc_matrix_inverse (dependence)
+///
+/// @defgroup gtx_inverse_batch GLM_GTX_inverse_batch
+/// @ingroup gtx
+///
+/// @brief Inverts arrays of matrices and builds normal matrices, one matrix
+/// per lane: 16 at a time with AVX-512, 8 with AVX2, 4 with SSE2.
+///
+/// Columns are loaded and transposed with 4 * 4 shuffles into structure of
+/// arrays registers, element (c, r) of every matrix of a block in one
+/// register, so the cofactor expansion itself runs without shuffles. Other
+/// targets loop over glm::inverse, affineInverse and inverseTranspose.
+///
+/// The affine and normal matrix functions check each block for rotations
+/// with a uniform scale s, columns orthogonal and of equal length within
+/// 1e-5 relative, whose inverse is the transpose over s^2. Blocks where
+/// every matrix passes take that path, others the cofactor expansion.
+///
+/// Results match the scalar functions to a few ulp, not bit for bit: the
+/// expansion groups the products differently from glm::inverse. Any count is
+/// accepted, arrays don't need any alignment and out may alias in.
+///
+/// <glm/gtx/inverse_batch.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/matrix_inverse.hpp"
+#include <cstddef>
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_inverse_batch extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_inverse_batch
+	/// @{
+
+	/// out[i] = inverse(in[i]) for count general 4 * 4 matrices.
+	GLM_FUNC_DECL void inverseBatch(mat4 const * in, mat4 * out, std::size_t count);
+
+	/// out[i] = inverse(in[i]) for count 3 * 3 matrices.
+	GLM_FUNC_DECL void inverseBatch(mat3 const * in, mat3 * out, std::size_t count);
+
+	/// out[i] = affineInverse(in[i]) for count matrices whose last row is (0, 0, 0, 1).
+	GLM_FUNC_DECL void affineInverseBatch(mat4 const * in, mat4 * out, std::size_t count);
+
+	/// out[i] = inverseTranspose(mat3(world[i])), the matrix transforming
+	/// normals of objects placed by world[i], for count matrices.
+	GLM_FUNC_DECL void normalMatrixBatch(mat4 const * world, mat3 * out, std::size_t count);
+
+	/// Same as the mat3 version with columns padded to 4 floats, the std140
+	/// and std430 layout of a GLSL mat3, ready for a uniform or storage buffer.
+	/// The padding floats are written as 0.
+	GLM_FUNC_DECL void normalMatrixBatch(mat4 const * world, mat3x4 * out, std::size_t count);
+
+	/// @}
+}//namespace glm
+
+#include "inverse_batch.inl"
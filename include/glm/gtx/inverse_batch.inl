@@ -0,0 +1,291 @@
+/// @ref gtx_inverse_batch
+/// @file glm/gtx/inverse_batch.inl
+
+#include "../simd/lanes.h"
+
+namespace glm{
+namespace detail
+{
+#	if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		// Element (c, r) of batch_lanes::size matrices into e[c * Rows + r]
+		template <int Cols, int Rows, typename M>
+		GLM_FUNC_QUALIFIER void inverse_load(M const* in, batch_vec* e)
+		{
+			int const stride = static_cast<int>(sizeof(M) / sizeof(float));
+			int const column = static_cast<int>(sizeof(typename M::col_type) / sizeof(float));
+
+			float const* base = &in[0][0][0];
+			for(int c = 0; c < Cols; ++c)
+				batch_lanes::rows(base + c * column, stride, Rows, e + c * Rows);
+		}
+
+		// Inverse of inverse_load, a fourth row missing from e is written as 0
+		template <int Cols, int Rows, typename M>
+		GLM_FUNC_QUALIFIER void inverse_store(batch_vec const* e, M* out)
+		{
+			int const stride = static_cast<int>(sizeof(M) / sizeof(float));
+			int const column = static_cast<int>(sizeof(typename M::col_type) / sizeof(float));
+
+			float* base = &out[0][0][0];
+			for(int c = 0; c < Cols; ++c)
+			{
+				if(Rows == column)
+					batch_lanes::unrows(base + c * column, stride, column, e + c * Rows);
+				else
+				{
+					batch_vec const v[4] = {e[c * Rows], e[c * Rows + 1], e[c * Rows + 2], batch_lanes::set1(0.0f)};
+					batch_lanes::unrows(base + c * column, stride, column, v);
+				}
+			}
+		}
+
+		GLM_FUNC_QUALIFIER batch_vec inverse_dot3(batch_vec const* a, batch_vec const* b)
+		{
+			typedef batch_lanes L;
+			return L::add(L::add(L::mul(a[0], b[0]), L::mul(a[1], b[1])), L::mul(a[2], b[2]));
+		}
+
+		GLM_FUNC_QUALIFIER void inverse_cross3(batch_vec const* a, batch_vec const* b, batch_vec* r)
+		{
+			typedef batch_lanes L;
+			r[0] = L::sub(L::mul(a[1], b[2]), L::mul(a[2], b[1]));
+			r[1] = L::sub(L::mul(a[2], b[0]), L::mul(a[0], b[2]));
+			r[2] = L::sub(L::mul(a[0], b[1]), L::mul(a[1], b[0]));
+		}
+
+		// Rows of the inverse of the 3 * 3 block with columns a, b, c at m,
+		// m + Rows and m + 2 * Rows: (b x c, c x a, a x b) / det
+		template <int Rows>
+		GLM_FUNC_QUALIFIER void inverse_rows3(batch_vec const* m, batch_vec* rows)
+		{
+			typedef batch_lanes L;
+
+			inverse_cross3(m + Rows, m + 2 * Rows, rows);
+			inverse_cross3(m + 2 * Rows, m, rows + 3);
+			inverse_cross3(m, m + Rows, rows + 6);
+			batch_vec const inv = L::div(L::set1(1.0f), inverse_dot3(m, rows));
+			for(int k = 0; k < 9; ++k)
+				rows[k] = L::mul(rows[k], inv);
+		}
+
+		// Whether every matrix of the block is a rotation times a uniform scale,
+		// s2 receives the squared scale
+		template <int Rows>
+		GLM_FUNC_QUALIFIER bool inverse_uniform(batch_vec const* m, batch_vec & s2)
+		{
+			typedef batch_lanes L;
+
+			batch_vec const* a = m;
+			batch_vec const* b = m + Rows;
+			batch_vec const* c = m + 2 * Rows;
+			s2 = inverse_dot3(a, a);
+			batch_vec const tol = L::mul(s2, L::set1(1e-5f));
+			L::mask ok = L::le(L::abs(L::sub(inverse_dot3(b, b), s2)), tol);
+			ok = L::mand(ok, L::le(L::abs(L::sub(inverse_dot3(c, c), s2)), tol));
+			ok = L::mand(ok, L::le(L::abs(inverse_dot3(a, b)), tol));
+			ok = L::mand(ok, L::le(L::abs(inverse_dot3(b, c)), tol));
+			ok = L::mand(ok, L::le(L::abs(inverse_dot3(c, a)), tol));
+			return L::bits(ok) == (1 << L::size) - 1;
+		}
+
+		// Laplace expansion on the 2 * 2 minors of the first two and last two
+		// columns. The formula is the same for the transpose, so it applies to
+		// e[c * 4 + r] as is.
+		GLM_FUNC_QUALIFIER void inverse_block(mat4 const* in, mat4* out)
+		{
+			typedef batch_lanes L;
+
+			batch_vec a[16], b[16];
+			inverse_load<4, 4>(in, a);
+
+			batch_vec const s0 = L::sub(L::mul(a[0], a[5]), L::mul(a[4], a[1]));
+			batch_vec const s1 = L::sub(L::mul(a[0], a[6]), L::mul(a[4], a[2]));
+			batch_vec const s2 = L::sub(L::mul(a[0], a[7]), L::mul(a[4], a[3]));
+			batch_vec const s3 = L::sub(L::mul(a[1], a[6]), L::mul(a[5], a[2]));
+			batch_vec const s4 = L::sub(L::mul(a[1], a[7]), L::mul(a[5], a[3]));
+			batch_vec const s5 = L::sub(L::mul(a[2], a[7]), L::mul(a[6], a[3]));
+			batch_vec const c5 = L::sub(L::mul(a[10], a[15]), L::mul(a[14], a[11]));
+			batch_vec const c4 = L::sub(L::mul(a[9], a[15]), L::mul(a[13], a[11]));
+			batch_vec const c3 = L::sub(L::mul(a[9], a[14]), L::mul(a[13], a[10]));
+			batch_vec const c2 = L::sub(L::mul(a[8], a[15]), L::mul(a[12], a[11]));
+			batch_vec const c1 = L::sub(L::mul(a[8], a[14]), L::mul(a[12], a[10]));
+			batch_vec const c0 = L::sub(L::mul(a[8], a[13]), L::mul(a[12], a[9]));
+
+			batch_vec const det = L::add(
+				L::add(L::sub(L::mul(s0, c5), L::mul(s1, c4)), L::add(L::mul(s2, c3), L::mul(s3, c2))),
+				L::sub(L::mul(s5, c0), L::mul(s4, c1)));
+			batch_vec const inv = L::div(L::set1(1.0f), det);
+
+#			define GLM_INVERSE_TERM(x, p, y, q, z, r) \
+				L::mul(L::add(L::sub(L::mul(x, p), L::mul(y, q)), L::mul(z, r)), inv)
+			batch_vec const zero = L::set1(0.0f);
+			b[0] = GLM_INVERSE_TERM(a[5], c5, a[6], c4, a[7], c3);
+			b[1] = L::sub(zero, GLM_INVERSE_TERM(a[1], c5, a[2], c4, a[3], c3));
+			b[2] = GLM_INVERSE_TERM(a[13], s5, a[14], s4, a[15], s3);
+			b[3] = L::sub(zero, GLM_INVERSE_TERM(a[9], s5, a[10], s4, a[11], s3));
+			b[4] = L::sub(zero, GLM_INVERSE_TERM(a[4], c5, a[6], c2, a[7], c1));
+			b[5] = GLM_INVERSE_TERM(a[0], c5, a[2], c2, a[3], c1);
+			b[6] = L::sub(zero, GLM_INVERSE_TERM(a[12], s5, a[14], s2, a[15], s1));
+			b[7] = GLM_INVERSE_TERM(a[8], s5, a[10], s2, a[11], s1);
+			b[8] = GLM_INVERSE_TERM(a[4], c4, a[5], c2, a[7], c0);
+			b[9] = L::sub(zero, GLM_INVERSE_TERM(a[0], c4, a[1], c2, a[3], c0));
+			b[10] = GLM_INVERSE_TERM(a[12], s4, a[13], s2, a[15], s0);
+			b[11] = L::sub(zero, GLM_INVERSE_TERM(a[8], s4, a[9], s2, a[11], s0));
+			b[12] = L::sub(zero, GLM_INVERSE_TERM(a[4], c3, a[5], c1, a[6], c0));
+			b[13] = GLM_INVERSE_TERM(a[0], c3, a[1], c1, a[2], c0);
+			b[14] = L::sub(zero, GLM_INVERSE_TERM(a[12], s3, a[13], s1, a[14], s0));
+			b[15] = GLM_INVERSE_TERM(a[8], s3, a[9], s1, a[10], s0);
+#			undef GLM_INVERSE_TERM
+
+			inverse_store<4, 4>(b, out);
+		}
+
+		GLM_FUNC_QUALIFIER void inverse_block(mat3 const* in, mat3* out)
+		{
+			batch_vec m[9], rows[9], e[9];
+			inverse_load<3, 3>(in, m);
+			inverse_rows3<3>(m, rows);
+			for(int c = 0; c < 3; ++c)
+				for(int r = 0; r < 3; ++r)
+					e[c * 3 + r] = rows[r * 3 + c];
+			inverse_store<3, 3>(e, out);
+		}
+
+		GLM_FUNC_QUALIFIER void affine_inverse_block(mat4 const* in, mat4* out)
+		{
+			typedef batch_lanes L;
+
+			batch_vec m[16], e[16], s2;
+			inverse_load<4, 4>(in, m);
+
+			// inv[c * 4 + r] is element (c, r) of the 3 * 3 inverse
+			batch_vec inv[12];
+			if(inverse_uniform<4>(m, s2))
+			{
+				batch_vec const k = L::div(L::set1(1.0f), s2);
+				for(int c = 0; c < 3; ++c)
+					for(int r = 0; r < 3; ++r)
+						inv[c * 4 + r] = L::mul(m[r * 4 + c], k);
+			}
+			else
+			{
+				batch_vec rows[9];
+				inverse_rows3<4>(m, rows);
+				for(int c = 0; c < 3; ++c)
+					for(int r = 0; r < 3; ++r)
+						inv[c * 4 + r] = rows[r * 3 + c];
+			}
+
+			batch_vec const zero = L::set1(0.0f);
+			for(int c = 0; c < 3; ++c)
+			{
+				for(int r = 0; r < 3; ++r)
+					e[c * 4 + r] = inv[c * 4 + r];
+				e[c * 4 + 3] = zero;
+			}
+			for(int r = 0; r < 3; ++r)
+				e[12 + r] = L::sub(zero, L::add(L::add(L::mul(inv[r], m[12]), L::mul(inv[4 + r], m[13])), L::mul(inv[8 + r], m[14])));
+			e[15] = L::set1(1.0f);
+			inverse_store<4, 4>(e, out);
+		}
+
+		template <typename M>
+		GLM_FUNC_QUALIFIER void normal_matrix_block(mat4 const* in, M* out)
+		{
+			typedef batch_lanes L;
+
+			batch_vec m[12], e[9], s2;
+			inverse_load<3, 4>(in, m);
+
+			// The rows of the inverse are the columns of its transpose
+			if(inverse_uniform<4>(m, s2))
+			{
+				batch_vec const k = L::div(L::set1(1.0f), s2);
+				for(int c = 0; c < 3; ++c)
+					for(int r = 0; r < 3; ++r)
+						e[c * 3 + r] = L::mul(m[c * 4 + r], k);
+			}
+			else
+				inverse_rows3<4>(m, e);
+
+			inverse_store<3, 3>(e, out);
+		}
+
+		// The last partial block goes through copies padded with identity matrices
+		template <typename In, typename Out, typename Block>
+		GLM_FUNC_QUALIFIER void inverse_run(In const* in, Out* out, std::size_t count, Block block)
+		{
+			std::size_t const size = static_cast<std::size_t>(batch_lanes::size);
+
+			std::size_t i = 0;
+			for(; i + size <= count; i += size)
+				block(in + i, out + i);
+			if(i < count)
+			{
+				In pad[batch_lanes::size];
+				Out res[batch_lanes::size];
+				for(std::size_t j = 0; j < size; ++j)
+					pad[j] = i + j < count ? in[i + j] : In(1.0f);
+				block(pad, res);
+				for(std::size_t j = 0; i + j < count; ++j)
+					out[i + j] = res[j];
+			}
+		}
+#	endif
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER void inverseBatch(mat4 const * in, mat4 * out, std::size_t count)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			void (*block)(mat4 const*, mat4*) = detail::inverse_block;
+			detail::inverse_run(in, out, count, block);
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = inverse(in[i]);
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER void inverseBatch(mat3 const * in, mat3 * out, std::size_t count)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			void (*block)(mat3 const*, mat3*) = detail::inverse_block;
+			detail::inverse_run(in, out, count, block);
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = inverse(in[i]);
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER void affineInverseBatch(mat4 const * in, mat4 * out, std::size_t count)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			detail::inverse_run(in, out, count, detail::affine_inverse_block);
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = affineInverse(in[i]);
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER void normalMatrixBatch(mat4 const * world, mat3 * out, std::size_t count)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			detail::inverse_run(world, out, count, detail::normal_matrix_block<mat3>);
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = inverseTranspose(mat3(world[i]));
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER void normalMatrixBatch(mat4 const * world, mat3x4 * out, std::size_t count)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			detail::inverse_run(world, out, count, detail::normal_matrix_block<mat3x4>);
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				mat3 const n(inverseTranspose(mat3(world[i])));
+				out[i] = mat3x4(vec4(n[0], 0.0f), vec4(n[1], 0.0f), vec4(n[2], 0.0f));
+			}
+#		endif
+	}
+}//namespace glm
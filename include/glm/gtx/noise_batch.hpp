@@ -0,0 +1,89 @@
+/// @ref gtx_noise_batch
+/// @file glm/gtx/noise_batch.hpp
+///
+/// @see core (dependence)
+/// @see gtc_noise (dependence)
+///
+/// @defgroup gtx_noise_batch GLM_GTX_noise_batch
+/// @ingroup gtx
+///
+/// @brief Evaluates gtc_noise perlin and simplex noise over arrays of points
+/// and regular grids, 4, 8 or 16 points at a time with SSE2, AVX2 or AVX-512,
+/// with fBm and ridged octave sums.
+///
+/// The vector code performs the same operations as the scalar perlin and
+/// simplex functions in the same order and never fuses multiply-adds, so
+/// results are bit identical to the scalar functions built without FMA. When
+/// the compiler contracts either into FMAs, as GCC does by default with
+/// -mfma or -march=native, simplex and 2D perlin differ by a few ulp while
+/// 3D perlin hashes some cells to other gradients, off by up to about 0.7.
+/// Build with -ffp-contract=off where the two must agree.
+/// 4D noise and periodic perlin noise are not batched.
+///
+/// <glm/gtx/noise_batch.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/noise.hpp"
+#include <cstddef>
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_noise_batch extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_noise_batch
+	/// @{
+
+	/// Which gtc_noise function a grid evaluates
+	enum noise_basis
+	{
+		noise_perlin,	///< perlin(p), classic gradient noise
+		noise_simplex	///< simplex(p)
+	};
+
+	/// out[i] = perlin(p[i])
+	GLM_FUNC_DECL void perlinBatch(vec2 const * p, float * out, std::size_t count);
+	GLM_FUNC_DECL void perlinBatch(vec3 const * p, float * out, std::size_t count);
+
+	/// out[i] = simplex(p[i])
+	GLM_FUNC_DECL void simplexBatch(vec2 const * p, float * out, std::size_t count);
+	GLM_FUNC_DECL void simplexBatch(vec3 const * p, float * out, std::size_t count);
+
+	/// Noise over a width x height grid stored row by row:
+	/// out[y * width + x] = noise(origin + vec2(x, y) * step)
+	GLM_FUNC_DECL void noiseGrid(float * out, std::size_t width, std::size_t height,
+		vec2 const & origin, vec2 const & step, noise_basis basis);
+
+	/// Noise over a plane of 3D space:
+	/// out[y * width + x] = noise(origin + stepX * x + stepY * y)
+	GLM_FUNC_DECL void noiseGrid(float * out, std::size_t width, std::size_t height,
+		vec3 const & origin, vec3 const & stepX, vec3 const & stepY, noise_basis basis);
+
+	/// Fractal Brownian motion over the grid of noiseGrid:
+	/// the sum over o < octaves of gain^o * noise(p * lacunarity^o).
+	/// The sum isn't normalized, with gain 0.5 it stays within about twice
+	/// the range of a single octave.
+	GLM_FUNC_DECL void fbmGrid(float * out, std::size_t width, std::size_t height,
+		vec2 const & origin, vec2 const & step, noise_basis basis,
+		int octaves, float lacunarity = 2.0f, float gain = 0.5f);
+	GLM_FUNC_DECL void fbmGrid(float * out, std::size_t width, std::size_t height,
+		vec3 const & origin, vec3 const & stepX, vec3 const & stepY, noise_basis basis,
+		int octaves, float lacunarity = 2.0f, float gain = 0.5f);
+
+	/// Ridged multifractal variant of fbmGrid, each octave contributes
+	/// gain^o * (1 - abs(noise))^2 so the zero crossings become sharp ridges.
+	GLM_FUNC_DECL void ridgedGrid(float * out, std::size_t width, std::size_t height,
+		vec2 const & origin, vec2 const & step, noise_basis basis,
+		int octaves, float lacunarity = 2.0f, float gain = 0.5f);
+	GLM_FUNC_DECL void ridgedGrid(float * out, std::size_t width, std::size_t height,
+		vec3 const & origin, vec3 const & stepX, vec3 const & stepY, noise_basis basis,
+		int octaves, float lacunarity = 2.0f, float gain = 0.5f);
+
+	/// @}
+}//namespace glm
+
+#include "noise_batch.inl"
@@ -0,0 +1,597 @@
+/// @ref gtx_noise_batch
+/// @file glm/gtx/noise_batch.inl
+
+#include "../simd/lanes.h"
+
+namespace glm{
+namespace detail
+{
+#	if GLM_ARCH & GLM_ARCH_SSE2_BIT
+	// gtc_noise perlin and simplex on N lanes. Every statement is the vector
+	// form of the scalar one in gtc/noise.inl, same operations in the same
+	// order and no fused multiply-add, so each lane rounds like the scalar code.
+	template <int N>
+	struct simd_noise
+	{
+		typedef simd_lanes<N> L;
+		typedef typename L::vec V;
+
+		static V fract(V x){return L::sub(x, L::floor(x));}
+
+		static V mod289(V x){return L::sub(x, L::mul(L::floor(L::div(x, L::set1(289.0f))), L::set1(289.0f)));}
+
+		static V permute(V x){return mod289(L::mul(L::add(L::mul(x, L::set1(34.0f)), L::set1(1.0f)), x));}
+
+		static V taylorInvSqrt(V r){return L::sub(L::set1(static_cast<float>(1.79284291400159)), L::mul(L::set1(static_cast<float>(0.85373472095314)), r));}
+
+		static V fade(V t)
+		{
+			return L::mul(L::mul(L::mul(t, t), t), L::add(L::mul(t, L::sub(L::mul(t, L::set1(6.0f)), L::set1(15.0f))), L::set1(10.0f)));
+		}
+
+		static V mix(V x, V y, V a){return L::add(x, L::mul(a, L::sub(y, x)));}
+
+		// step(edge, x)
+		static V step(V edge, V x){return L::select(L::lt(x, edge), L::set1(0.0f), L::set1(1.0f));}
+
+		// One corner of 2D perlin: gradient from the hash i, normalized and dotted with the offset
+		static V perlinCorner(V i, V fx, V fy)
+		{
+			V gx = L::sub(L::mul(L::set1(2.0f), fract(L::div(i, L::set1(41.0f)))), L::set1(1.0f));
+			V gy = L::sub(L::abs(gx), L::set1(0.5f));
+			V const tx = L::floor(L::add(gx, L::set1(0.5f)));
+			gx = L::sub(gx, tx);
+
+			V const norm = taylorInvSqrt(L::add(L::mul(gx, gx), L::mul(gy, gy)));
+			gx = L::mul(gx, norm);
+			gy = L::mul(gy, norm);
+			return L::add(L::mul(gx, fx), L::mul(gy, fy));
+		}
+
+		static V perlin(V x, V y)
+		{
+			V const one = L::set1(1.0f);
+			V const fx0 = L::floor(x);
+			V const fy0 = L::floor(y);
+			V const ix0 = mod289(fx0);
+			V const iy0 = mod289(fy0);
+			V const ix1 = mod289(L::add(fx0, one));
+			V const iy1 = mod289(L::add(fy0, one));
+			V const rx0 = fract(x);
+			V const ry0 = fract(y);
+			V const rx1 = L::sub(rx0, one);
+			V const ry1 = L::sub(ry0, one);
+
+			V const px0 = permute(ix0);
+			V const px1 = permute(ix1);
+			V const n00 = perlinCorner(permute(L::add(px0, iy0)), rx0, ry0);
+			V const n10 = perlinCorner(permute(L::add(px1, iy0)), rx1, ry0);
+			V const n01 = perlinCorner(permute(L::add(px0, iy1)), rx0, ry1);
+			V const n11 = perlinCorner(permute(L::add(px1, iy1)), rx1, ry1);
+
+			V const fadeX = fade(rx0);
+			V const n_xy = mix(mix(n00, n10, fadeX), mix(n01, n11, fadeX), fade(ry0));
+			return L::mul(L::set1(2.3f), n_xy);
+		}
+
+		static V perlinCorner(V i, V fx, V fy, V fz)
+		{
+			V const zero = L::set1(0.0f);
+			V const half = L::set1(0.5f);
+			V gx = L::mul(i, L::set1(static_cast<float>(1.0 / 7.0)));
+			V gy = L::sub(fract(L::mul(L::floor(gx), L::set1(static_cast<float>(1.0 / 7.0)))), half);
+			gx = fract(gx);
+			V gz = L::sub(L::sub(half, L::abs(gx)), L::abs(gy));
+			V const sz = step(gz, zero);
+			gx = L::sub(gx, L::mul(sz, L::sub(step(zero, gx), half)));
+			gy = L::sub(gy, L::mul(sz, L::sub(step(zero, gy), half)));
+
+			V const norm = taylorInvSqrt(L::add(L::add(L::mul(gx, gx), L::mul(gy, gy)), L::mul(gz, gz)));
+			gx = L::mul(gx, norm);
+			gy = L::mul(gy, norm);
+			gz = L::mul(gz, norm);
+			return L::add(L::add(L::mul(gx, fx), L::mul(gy, fy)), L::mul(gz, fz));
+		}
+
+		static V perlin(V x, V y, V z)
+		{
+			V const one = L::set1(1.0f);
+			V const fx0 = L::floor(x);
+			V const fy0 = L::floor(y);
+			V const fz0 = L::floor(z);
+			V const ix0 = mod289(fx0);
+			V const iy0 = mod289(fy0);
+			V const iz0 = mod289(fz0);
+			V const ix1 = mod289(L::add(fx0, one));
+			V const iy1 = mod289(L::add(fy0, one));
+			V const iz1 = mod289(L::add(fz0, one));
+			V const rx0 = fract(x);
+			V const ry0 = fract(y);
+			V const rz0 = fract(z);
+			V const rx1 = L::sub(rx0, one);
+			V const ry1 = L::sub(ry0, one);
+			V const rz1 = L::sub(rz0, one);
+
+			V const px0 = permute(ix0);
+			V const px1 = permute(ix1);
+			V const ixy00 = permute(L::add(px0, iy0));
+			V const ixy10 = permute(L::add(px1, iy0));
+			V const ixy01 = permute(L::add(px0, iy1));
+			V const ixy11 = permute(L::add(px1, iy1));
+
+			V const n000 = perlinCorner(permute(L::add(ixy00, iz0)), rx0, ry0, rz0);
+			V const n100 = perlinCorner(permute(L::add(ixy10, iz0)), rx1, ry0, rz0);
+			V const n010 = perlinCorner(permute(L::add(ixy01, iz0)), rx0, ry1, rz0);
+			V const n110 = perlinCorner(permute(L::add(ixy11, iz0)), rx1, ry1, rz0);
+			V const n001 = perlinCorner(permute(L::add(ixy00, iz1)), rx0, ry0, rz1);
+			V const n101 = perlinCorner(permute(L::add(ixy10, iz1)), rx1, ry0, rz1);
+			V const n011 = perlinCorner(permute(L::add(ixy01, iz1)), rx0, ry1, rz1);
+			V const n111 = perlinCorner(permute(L::add(ixy11, iz1)), rx1, ry1, rz1);
+
+			V const fadeY = fade(ry0);
+			V const fadeZ = fade(rz0);
+			V const n_y0 = mix(mix(n000, n001, fadeZ), mix(n010, n011, fadeZ), fadeY);
+			V const n_y1 = mix(mix(n100, n101, fadeZ), mix(n110, n111, fadeZ), fadeY);
+			return L::mul(L::set1(2.2f), mix(n_y0, n_y1, fade(rx0)));
+		}
+
+		static V simplex(V vx, V vy)
+		{
+			V const zero = L::set1(0.0f);
+			V const one = L::set1(1.0f);
+			V const half = L::set1(0.5f);
+			V const C0 = L::set1(static_cast<float>(0.211324865405187));
+			V const C1 = L::set1(static_cast<float>(0.366025403784439));
+			V const C2 = L::set1(static_cast<float>(-0.577350269189626));
+
+			// First corner
+			V s = L::add(L::mul(vx, C1), L::mul(vy, C1));
+			V ix = L::floor(L::add(vx, s));
+			V iy = L::floor(L::add(vy, s));
+			s = L::add(L::mul(ix, C0), L::mul(iy, C0));
+			V const x0x = L::add(L::sub(vx, ix), s);
+			V const x0y = L::add(L::sub(vy, iy), s);
+
+			// Other corners
+			typename L::mask const upper = L::lt(x0y, x0x);
+			V const i1x = L::select(upper, one, zero);
+			V const i1y = L::select(upper, zero, one);
+			V const x1x = L::sub(L::add(x0x, C0), i1x);
+			V const x1y = L::sub(L::add(x0y, C0), i1y);
+			V const x2x = L::add(x0x, C2);
+			V const x2y = L::add(x0y, C2);
+
+			// Permutations
+			ix = mod289(ix);
+			iy = mod289(iy);
+			V const p0 = permute(L::add(L::add(permute(L::add(iy, zero)), ix), zero));
+			V const p1 = permute(L::add(L::add(permute(L::add(iy, i1y)), ix), i1x));
+			V const p2 = permute(L::add(L::add(permute(L::add(iy, one)), ix), one));
+
+			V m0 = L::max(L::sub(half, L::add(L::mul(x0x, x0x), L::mul(x0y, x0y))), zero);
+			V m1 = L::max(L::sub(half, L::add(L::mul(x1x, x1x), L::mul(x1y, x1y))), zero);
+			V m2 = L::max(L::sub(half, L::add(L::mul(x2x, x2x), L::mul(x2y, x2y))), zero);
+			m0 = L::mul(m0, m0); m0 = L::mul(m0, m0);
+			m1 = L::mul(m1, m1); m1 = L::mul(m1, m1);
+			m2 = L::mul(m2, m2); m2 = L::mul(m2, m2);
+
+			V const g0 = simplexCorner(p0, x0x, x0y, m0);
+			V const g1 = simplexCorner(p1, x1x, x1y, m1);
+			V const g2 = simplexCorner(p2, x2x, x2y, m2);
+			return L::mul(L::set1(130.0f), L::add(L::add(g0, g1), g2));
+		}
+
+		// m * g for one corner of 2D simplex, gradients from 41 points on a line mapped onto a diamond
+		static V simplexCorner(V p, V xx, V xy, V m)
+		{
+			V const half = L::set1(0.5f);
+			V const x = L::sub(L::mul(L::set1(2.0f), fract(L::mul(p, L::set1(static_cast<float>(0.024390243902439))))), L::set1(1.0f));
+			V const h = L::sub(L::abs(x), half);
+			V const ox = L::floor(L::add(x, half));
+			V const a0 = L::sub(x, ox);
+
+			m = L::mul(m, L::sub(L::set1(static_cast<float>(1.79284291400159)),
+				L::mul(L::set1(static_cast<float>(0.85373472095314)), L::add(L::mul(a0, a0), L::mul(h, h)))));
+			return L::mul(m, L::add(L::mul(a0, xx), L::mul(h, xy)));
+		}
+
+		// p . x and the falloff for one corner of 3D simplex, gradients from 7x7 points mapped onto an octahedron
+		static V simplexCorner(V p, V xx, V xy, V xz, V & m)
+		{
+			float const n_ = static_cast<float>(0.142857142857);
+			V const nsx = L::set1(n_ * 2.0f - 0.0f);
+			V const nsy = L::set1(n_ * 0.5f - 1.0f);
+			V const nsz = L::set1(n_ * 1.0f - 0.0f);
+			V const zero = L::set1(0.0f);
+			V const one = L::set1(1.0f);
+			V const two = L::set1(2.0f);
+
+			V const j = L::sub(p, L::mul(L::set1(49.0f), L::floor(L::mul(L::mul(p, nsz), nsz))));
+			V const x_ = L::floor(L::mul(j, nsz));
+			V const y_ = L::floor(L::sub(j, L::mul(L::set1(7.0f), x_)));
+			V const x = L::add(L::mul(x_, nsx), nsy);
+			V const y = L::add(L::mul(y_, nsx), nsy);
+			V gz = L::sub(L::sub(one, L::abs(x)), L::abs(y));
+
+			V const sx = L::add(L::mul(L::floor(x), two), one);
+			V const sy = L::add(L::mul(L::floor(y), two), one);
+			V const sh = L::select(L::lt(zero, gz), L::set1(-0.0f), L::set1(-1.0f));
+			V gx = L::add(x, L::mul(sx, sh));
+			V gy = L::add(y, L::mul(sy, sh));
+
+			V const norm = taylorInvSqrt(L::add(L::add(L::mul(gx, gx), L::mul(gy, gy)), L::mul(gz, gz)));
+			gx = L::mul(gx, norm);
+			gy = L::mul(gy, norm);
+			gz = L::mul(gz, norm);
+
+			m = L::max(L::sub(L::set1(0.6f), L::add(L::add(L::mul(xx, xx), L::mul(xy, xy)), L::mul(xz, xz))), zero);
+			m = L::mul(m, m);
+			return L::add(L::add(L::mul(gx, xx), L::mul(gy, xy)), L::mul(gz, xz));
+		}
+
+		static V simplex(V vx, V vy, V vz)
+		{
+			V const zero = L::set1(0.0f);
+			V const one = L::set1(1.0f);
+			V const Cx = L::set1(static_cast<float>(1.0 / 6.0));
+			V const Cy = L::set1(static_cast<float>(1.0 / 3.0));
+
+			// First corner
+			V s = L::add(L::add(L::mul(vx, Cy), L::mul(vy, Cy)), L::mul(vz, Cy));
+			V ix = L::floor(L::add(vx, s));
+			V iy = L::floor(L::add(vy, s));
+			V iz = L::floor(L::add(vz, s));
+			s = L::add(L::add(L::mul(ix, Cx), L::mul(iy, Cx)), L::mul(iz, Cx));
+			V const x0x = L::add(L::sub(vx, ix), s);
+			V const x0y = L::add(L::sub(vy, iy), s);
+			V const x0z = L::add(L::sub(vz, iz), s);
+
+			// Other corners
+			V const gx = step(x0y, x0x);
+			V const gy = step(x0z, x0y);
+			V const gz = step(x0x, x0z);
+			V const lx = L::sub(one, gx);
+			V const ly = L::sub(one, gy);
+			V const lz = L::sub(one, gz);
+			V const i1x = L::min(gx, lz);
+			V const i1y = L::min(gy, lx);
+			V const i1z = L::min(gz, ly);
+			V const i2x = L::max(gx, lz);
+			V const i2y = L::max(gy, lx);
+			V const i2z = L::max(gz, ly);
+
+			V const x1x = L::add(L::sub(x0x, i1x), Cx);
+			V const x1y = L::add(L::sub(x0y, i1y), Cx);
+			V const x1z = L::add(L::sub(x0z, i1z), Cx);
+			V const x2x = L::add(L::sub(x0x, i2x), Cy);
+			V const x2y = L::add(L::sub(x0y, i2y), Cy);
+			V const x2z = L::add(L::sub(x0z, i2z), Cy);
+			V const x3x = L::sub(x0x, L::set1(0.5f));
+			V const x3y = L::sub(x0y, L::set1(0.5f));
+			V const x3z = L::sub(x0z, L::set1(0.5f));
+
+			// Permutations
+			ix = mod289(ix);
+			iy = mod289(iy);
+			iz = mod289(iz);
+			V const p0 = permute(L::add(L::add(permute(L::add(L::add(permute(L::add(iz, zero)), iy), zero)), ix), zero));
+			V const p1 = permute(L::add(L::add(permute(L::add(L::add(permute(L::add(iz, i1z)), iy), i1y)), ix), i1x));
+			V const p2 = permute(L::add(L::add(permute(L::add(L::add(permute(L::add(iz, i2z)), iy), i2y)), ix), i2x));
+			V const p3 = permute(L::add(L::add(permute(L::add(L::add(permute(L::add(iz, one)), iy), one)), ix), one));
+
+			V m0, m1, m2, m3;
+			V const d0 = simplexCorner(p0, x0x, x0y, x0z, m0);
+			V const d1 = simplexCorner(p1, x1x, x1y, x1z, m1);
+			V const d2 = simplexCorner(p2, x2x, x2y, x2z, m2);
+			V const d3 = simplexCorner(p3, x3x, x3y, x3z, m3);
+
+			V const t0 = L::mul(L::mul(m0, m0), d0);
+			V const t1 = L::mul(L::mul(m1, m1), d1);
+			V const t2 = L::mul(L::mul(m2, m2), d2);
+			V const t3 = L::mul(L::mul(m3, m3), d3);
+			return L::mul(L::set1(42.0f), L::add(L::add(t0, t1), L::add(t2, t3)));
+		}
+	};
+
+#	if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+		typedef simd_lanes<16> noise_lanes;
+#	elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+		typedef simd_lanes<8> noise_lanes;
+#	else
+		typedef simd_lanes<4> noise_lanes;
+#	endif
+	typedef noise_lanes::vec noise_vec;
+#	endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+	// The scalar functions are the GLM_ARCH_PURE fallback
+	struct noise_op_perlin
+	{
+		static float scalar(vec2 const & p){return perlin(p);}
+		static float scalar(vec3 const & p){return perlin(p);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			static noise_vec call(noise_vec x, noise_vec y){return simd_noise<noise_lanes::size>::perlin(x, y);}
+			static noise_vec call(noise_vec x, noise_vec y, noise_vec z){return simd_noise<noise_lanes::size>::perlin(x, y, z);}
+#		endif
+	};
+
+	struct noise_op_simplex
+	{
+		static float scalar(vec2 const & p){return simplex(p);}
+		static float scalar(vec3 const & p){return simplex(p);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			static noise_vec call(noise_vec x, noise_vec y){return simd_noise<noise_lanes::size>::simplex(x, y);}
+			static noise_vec call(noise_vec x, noise_vec y, noise_vec z){return simd_noise<noise_lanes::size>::simplex(x, y, z);}
+#		endif
+	};
+
+	// Octave sums, one octave with a unit amplitude and frequency is the plain noise
+	struct noise_octaves
+	{
+		int count;
+		float lacunarity;
+		float gain;
+		bool ridged;
+	};
+
+	template <typename Op, typename vecType>
+	GLM_FUNC_QUALIFIER float noise_fractal(vecType const & p, noise_octaves const & octaves)
+	{
+		float sum = 0.0f, amplitude = 1.0f, frequency = 1.0f;
+		for(int o = 0; o < octaves.count; ++o)
+		{
+			float n = Op::scalar(p * frequency);
+			if(octaves.ridged)
+			{
+				n = 1.0f - abs(n);
+				n = n * n;
+			}
+			sum += amplitude * n;
+			amplitude *= octaves.gain;
+			frequency *= octaves.lacunarity;
+		}
+		return sum;
+	}
+
+#	if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		template <typename Op>
+		GLM_FUNC_QUALIFIER noise_vec noise_fractal(noise_vec x, noise_vec y, noise_vec const * z, noise_octaves const & octaves)
+		{
+			typedef noise_lanes L;
+
+			noise_vec sum = L::set1(0.0f);
+			float amplitude = 1.0f, frequency = 1.0f;
+			for(int o = 0; o < octaves.count; ++o)
+			{
+				noise_vec const f = L::set1(frequency);
+				noise_vec n = z ? Op::call(L::mul(x, f), L::mul(y, f), L::mul(*z, f)) : Op::call(L::mul(x, f), L::mul(y, f));
+				if(octaves.ridged)
+				{
+					n = L::sub(L::set1(1.0f), L::abs(n));
+					n = L::mul(n, n);
+				}
+				sum = L::add(sum, L::mul(L::set1(amplitude), n));
+				amplitude *= octaves.gain;
+				frequency *= octaves.lacunarity;
+			}
+			return sum;
+		}
+
+		// Full registers are stored directly, the last partial one through a copy
+		GLM_FUNC_QUALIFIER void noise_store(float * out, std::size_t count, noise_vec v)
+		{
+			if(count >= static_cast<std::size_t>(noise_lanes::size))
+			{
+				noise_lanes::store(out, v);
+				return;
+			}
+			float r[noise_lanes::size];
+			noise_lanes::store(r, v);
+			for(std::size_t j = 0; j < count; ++j)
+				out[j] = r[j];
+		}
+
+		// x + lane index, exact below 2^24
+		GLM_FUNC_QUALIFIER noise_vec noise_column(std::size_t x)
+		{
+			float lanes[noise_lanes::size];
+			for(int j = 0; j < noise_lanes::size; ++j)
+				lanes[j] = static_cast<float>(x) + static_cast<float>(j);
+			return noise_lanes::load(lanes);
+		}
+#	endif
+
+	template <typename Op>
+	GLM_FUNC_QUALIFIER void noise_points(vec2 const * p, float * out, std::size_t count)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			typedef noise_lanes L;
+			noise_octaves const single = {1, 1.0f, 1.0f, false};
+
+			for(std::size_t i = 0; i < count; i += L::size)
+			{
+				std::size_t const n = count - i < static_cast<std::size_t>(L::size) ? count - i : static_cast<std::size_t>(L::size);
+				float x[L::size] = {0}, y[L::size] = {0};
+				for(std::size_t j = 0; j < n; ++j)
+				{
+					x[j] = p[i + j].x;
+					y[j] = p[i + j].y;
+				}
+				noise_store(out + i, n, noise_fractal<Op>(L::load(x), L::load(y), NULL, single));
+			}
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = Op::scalar(p[i]);
+#		endif
+	}
+
+	template <typename Op>
+	GLM_FUNC_QUALIFIER void noise_points(vec3 const * p, float * out, std::size_t count)
+	{
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			typedef noise_lanes L;
+			noise_octaves const single = {1, 1.0f, 1.0f, false};
+
+			for(std::size_t i = 0; i < count; i += L::size)
+			{
+				std::size_t const n = count - i < static_cast<std::size_t>(L::size) ? count - i : static_cast<std::size_t>(L::size);
+				float x[L::size] = {0}, y[L::size] = {0}, z[L::size] = {0};
+				for(std::size_t j = 0; j < n; ++j)
+				{
+					x[j] = p[i + j].x;
+					y[j] = p[i + j].y;
+					z[j] = p[i + j].z;
+				}
+				noise_vec const vz = L::load(z);
+				noise_store(out + i, n, noise_fractal<Op>(L::load(x), L::load(y), &vz, single));
+			}
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = Op::scalar(p[i]);
+#		endif
+	}
+
+	template <typename Op>
+	GLM_FUNC_QUALIFIER void noise_grid(float * out, std::size_t width, std::size_t height,
+		vec2 const & origin, vec2 const & step, noise_octaves const & octaves)
+	{
+		for(std::size_t y = 0; y < height; ++y)
+		{
+			float * row = out + y * width;
+#			if GLM_ARCH & GLM_ARCH_SSE2_BIT
+				typedef noise_lanes L;
+				noise_vec const py = L::set1(origin.y + static_cast<float>(y) * step.y);
+				for(std::size_t x = 0; x < width; x += L::size)
+				{
+					noise_vec const px = L::add(L::set1(origin.x), L::mul(noise_column(x), L::set1(step.x)));
+					noise_store(row + x, width - x, noise_fractal<Op>(px, py, NULL, octaves));
+				}
+#			else
+				for(std::size_t x = 0; x < width; ++x)
+					row[x] = noise_fractal<Op>(origin + vec2(x, y) * step, octaves);
+#			endif
+		}
+	}
+
+	template <typename Op>
+	GLM_FUNC_QUALIFIER void noise_grid(float * out, std::size_t width, std::size_t height,
+		vec3 const & origin, vec3 const & stepX, vec3 const & stepY, noise_octaves const & octaves)
+	{
+		for(std::size_t y = 0; y < height; ++y)
+		{
+			float * row = out + y * width;
+#			if GLM_ARCH & GLM_ARCH_SSE2_BIT
+				typedef noise_lanes L;
+				vec3 const offset = stepY * static_cast<float>(y);
+				for(std::size_t x = 0; x < width; x += L::size)
+				{
+					noise_vec const column = noise_column(x);
+					noise_vec const px = L::add(L::add(L::set1(origin.x), L::mul(L::set1(stepX.x), column)), L::set1(offset.x));
+					noise_vec const py = L::add(L::add(L::set1(origin.y), L::mul(L::set1(stepX.y), column)), L::set1(offset.y));
+					noise_vec const pz = L::add(L::add(L::set1(origin.z), L::mul(L::set1(stepX.z), column)), L::set1(offset.z));
+					noise_store(row + x, width - x, noise_fractal<Op>(px, py, &pz, octaves));
+				}
+#			else
+				for(std::size_t x = 0; x < width; ++x)
+					row[x] = noise_fractal<Op>(origin + stepX * static_cast<float>(x) + stepY * static_cast<float>(y), octaves);
+#			endif
+		}
+	}
+
+	template <typename Grid>
+	GLM_FUNC_QUALIFIER void noise_dispatch(noise_basis basis, Grid const & grid)
+	{
+		if(basis == noise_simplex)
+			grid.template run<noise_op_simplex>();
+		else
+			grid.template run<noise_op_perlin>();
+	}
+
+	struct noise_grid2
+	{
+		float * out;
+		std::size_t width, height;
+		vec2 origin, step;
+		noise_octaves octaves;
+
+		template <typename Op>
+		void run() const{noise_grid<Op>(out, width, height, origin, step, octaves);}
+	};
+
+	struct noise_grid3
+	{
+		float * out;
+		std::size_t width, height;
+		vec3 origin, stepX, stepY;
+		noise_octaves octaves;
+
+		template <typename Op>
+		void run() const{noise_grid<Op>(out, width, height, origin, stepX, stepY, octaves);}
+	};
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER void perlinBatch(vec2 const * p, float * out, std::size_t count)
+	{
+		detail::noise_points<detail::noise_op_perlin>(p, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void perlinBatch(vec3 const * p, float * out, std::size_t count)
+	{
+		detail::noise_points<detail::noise_op_perlin>(p, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void simplexBatch(vec2 const * p, float * out, std::size_t count)
+	{
+		detail::noise_points<detail::noise_op_simplex>(p, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void simplexBatch(vec3 const * p, float * out, std::size_t count)
+	{
+		detail::noise_points<detail::noise_op_simplex>(p, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void noiseGrid(float * out, std::size_t width, std::size_t height,
+		vec2 const & origin, vec2 const & step, noise_basis basis)
+	{
+		detail::noise_grid2 const grid = {out, width, height, origin, step, {1, 1.0f, 1.0f, false}};
+		detail::noise_dispatch(basis, grid);
+	}
+
+	GLM_FUNC_QUALIFIER void noiseGrid(float * out, std::size_t width, std::size_t height,
+		vec3 const & origin, vec3 const & stepX, vec3 const & stepY, noise_basis basis)
+	{
+		detail::noise_grid3 const grid = {out, width, height, origin, stepX, stepY, {1, 1.0f, 1.0f, false}};
+		detail::noise_dispatch(basis, grid);
+	}
+
+	GLM_FUNC_QUALIFIER void fbmGrid(float * out, std::size_t width, std::size_t height,
+		vec2 const & origin, vec2 const & step, noise_basis basis,
+		int octaves, float lacunarity, float gain)
+	{
+		detail::noise_grid2 const grid = {out, width, height, origin, step, {octaves, lacunarity, gain, false}};
+		detail::noise_dispatch(basis, grid);
+	}
+
+	GLM_FUNC_QUALIFIER void fbmGrid(float * out, std::size_t width, std::size_t height,
+		vec3 const & origin, vec3 const & stepX, vec3 const & stepY, noise_basis basis,
+		int octaves, float lacunarity, float gain)
+	{
+		detail::noise_grid3 const grid = {out, width, height, origin, stepX, stepY, {octaves, lacunarity, gain, false}};
+		detail::noise_dispatch(basis, grid);
+	}
+
+	GLM_FUNC_QUALIFIER void ridgedGrid(float * out, std::size_t width, std::size_t height,
+		vec2 const & origin, vec2 const & step, noise_basis basis,
+		int octaves, float lacunarity, float gain)
+	{
+		detail::noise_grid2 const grid = {out, width, height, origin, step, {octaves, lacunarity, gain, true}};
+		detail::noise_dispatch(basis, grid);
+	}
+
+	GLM_FUNC_QUALIFIER void ridgedGrid(float * out, std::size_t width, std::size_t height,
+		vec3 const & origin, vec3 const & stepX, vec3 const & stepY, noise_basis basis,
+		int octaves, float lacunarity, float gain)
+	{
+		detail::noise_grid3 const grid = {out, width, height, origin, stepX, stepY, {octaves, lacunarity, gain, true}};
+		detail::noise_dispatch(basis, grid);
+	}
+}//namespace glm
@@ -0,0 +1,63 @@
+/// @ref gtx_packing_batch
+/// @file glm/gtx/packing_batch.hpp
+///
+/// @see core (dependence)
+/// @see gtc_packing (dependence)
+///
+/// @defgroup gtx_packing_batch GLM_GTX_packing_batch
+/// @ingroup gtx
+///
+/// @brief Converts float arrays to and from half floats and packs them to
+/// snorm or unorm 8 and 16 bit integers, 16 values at a time with AVX-512,
+/// 8 with AVX2, 4 with SSE2 and NEON (AArch64).
+///
+/// Every result is bit identical to the gtc_packing function named in its
+/// description. Hardware half conversions round to nearest even where
+/// packHalf1x16 rounds half up, so floats are converted to halves with
+/// integer operations; F16C (or AVX-512) converts halves to floats, with
+/// signaling NaNs patched back to the payload unpackHalf1x16 keeps.
+///
+/// Vectors pack component by component: pass a vec4 array as 4 * count
+/// floats and get the u16vec4 array packHalf4x16 would give. Any count is
+/// accepted and arrays don't need any alignment.
+///
+/// <glm/gtx/packing_batch.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/packing.hpp"
+#include <cstddef>
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_packing_batch extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_packing_batch
+	/// @{
+
+	/// out[i] = packHalf1x16(in[i]) for count values.
+	GLM_FUNC_DECL void packHalf1x16Batch(float const * in, uint16 * out, std::size_t count);
+
+	/// out[i] = unpackHalf1x16(in[i]) for count values.
+	GLM_FUNC_DECL void unpackHalf1x16Batch(uint16 const * in, float * out, std::size_t count);
+
+	/// out[i] = packUnorm1x8(in[i]), round(clamp(in[i], 0, 1) * 255), for count values.
+	GLM_FUNC_DECL void packUnorm1x8Batch(float const * in, uint8 * out, std::size_t count);
+
+	/// out[i] = packSnorm1x8(in[i]), round(clamp(in[i], -1, 1) * 127), for count values.
+	GLM_FUNC_DECL void packSnorm1x8Batch(float const * in, uint8 * out, std::size_t count);
+
+	/// out[i] = packUnorm1x16(in[i]), round(clamp(in[i], 0, 1) * 65535), for count values.
+	GLM_FUNC_DECL void packUnorm1x16Batch(float const * in, uint16 * out, std::size_t count);
+
+	/// out[i] = packSnorm1x16(in[i]), round(clamp(in[i], -1, 1) * 32767), for count values.
+	GLM_FUNC_DECL void packSnorm1x16Batch(float const * in, uint16 * out, std::size_t count);
+
+	/// @}
+}//namespace glm
+
+#include "packing_batch.inl"
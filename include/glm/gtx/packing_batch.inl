@@ -0,0 +1,272 @@
+/// @ref gtx_packing_batch
+/// @file glm/gtx/packing_batch.inl
+
+#include "../simd/lanes.h"
+
+#if (GLM_ARCH & GLM_ARCH_NEON_BIT) && defined(__aarch64__)
+#	include <arm_neon.h>
+#endif
+
+namespace glm{
+namespace detail
+{
+	template <typename T, bool Signed>
+	struct packing_norm{};
+
+	template <>
+	struct packing_norm<uint8, false>
+	{
+		static uint8 scalar(float v){return packUnorm1x8(v);}
+		static float lo(){return 0.0f;}
+		static float scale(){return 255.0f;}
+	};
+
+	template <>
+	struct packing_norm<uint8, true>
+	{
+		static uint8 scalar(float v){return packSnorm1x8(v);}
+		static float lo(){return -1.0f;}
+		static float scale(){return 127.0f;}
+	};
+
+	template <>
+	struct packing_norm<uint16, false>
+	{
+		static uint16 scalar(float v){return packUnorm1x16(v);}
+		static float lo(){return 0.0f;}
+		static float scale(){return 65535.0f;}
+	};
+
+	template <>
+	struct packing_norm<uint16, true>
+	{
+		static uint16 scalar(float v){return packSnorm1x16(v);}
+		static float lo(){return -1.0f;}
+		static float scale(){return 32767.0f;}
+	};
+
+#	if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		static const int packing_lanes = batch_lanes::size;
+
+		// toFloat16 rounds half up on the dropped significand bits. Halves under
+		// 2^-14 are |v| * 2^24 rounded the same way, where adding 0.5 is exact.
+		GLM_FUNC_QUALIFIER batch_lanes::ivec packing_to_half(batch_vec v)
+		{
+			typedef batch_lanes L;
+			typedef L::ivec I;
+
+			I const u = L::iand(L::asint(v), L::iset1(0x7FFFFFFF));
+			I const sign = L::iand(L::shr(L::asint(v), 16), L::iset1(0x8000));
+			batch_vec const a = L::abs(v);
+
+			// The rounding carry may run into the exponent, as in toFloat16
+			I const normal = L::iadd(L::isub(L::shr(u, 13), L::iset1((127 - 15) << 10)), L::iand(L::shr(u, 12), L::iset1(1)));
+			I const denormal = L::trunc(L::add(L::mul(a, L::set1(16777216.0f)), L::set1(0.5f)));
+			// NaNs keep the top of the significand, with at least one bit set
+			I const m = L::iand(L::shr(u, 13), L::iset1(0x3FF));
+			I const nan = L::ior(L::ior(L::iset1(0x7C00), m), L::asint(L::select(L::ieq(m, L::iset1(0)), L::asfloat(L::iset1(1)), L::set1(0.0f))));
+
+			batch_vec h = L::select(L::lt(a, L::set1(6.103515625e-5f)), L::asfloat(denormal), L::asfloat(normal));
+			h = L::select(L::le(L::set1(65520.0f), a), L::asfloat(L::iset1(0x7C00)), h);
+			h = L::select(L::neq(v, v), L::asfloat(nan), h);
+			return L::ior(L::asint(h), sign);
+		}
+
+		GLM_FUNC_QUALIFIER batch_vec packing_from_half(uint16 const* p)
+		{
+			typedef batch_lanes L;
+			typedef L::ivec I;
+
+			I const h = L::iload16(p);
+			I const sign = L::shl(L::iand(h, L::iset1(0x8000)), 16);
+			I const em = L::iand(h, L::iset1(0x7FFF));
+			// Infinities and NaNs, the payload as is
+			I const special = L::ior(L::ior(L::shl(em, 13), L::iset1(0x7F800000)), sign);
+
+#			if defined(__F16C__) || ((GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT))
+				// The conversion quiets signaling NaNs, toFloat32 doesn't
+				batch_vec const f = L::loadhalf(p);
+				return L::select(L::neq(f, f), L::asfloat(special), f);
+#			else
+				batch_vec const e = L::tofloat(em);
+				I const normal = L::ior(L::iadd(L::shl(em, 13), L::iset1((127 - 15) << 23)), sign);
+				batch_vec const denormal = L::bxor(L::mul(e, L::set1(5.9604644775390625e-8f)), L::asfloat(sign));
+				batch_vec const f = L::select(L::lt(e, L::set1(1024.0f)), denormal, L::asfloat(normal));
+				return L::select(L::le(L::set1(31744.0f), e), L::asfloat(special), f);
+#			endif
+		}
+
+		// std::round rounds half away from zero: truncate, then step up where the
+		// dropped fraction is at least one half
+		template <typename T, bool Signed>
+		GLM_FUNC_QUALIFIER batch_lanes::ivec packing_to_norm(batch_vec v)
+		{
+			typedef batch_lanes L;
+			typedef packing_norm<T, Signed> N;
+
+			batch_vec const x = L::mul(L::min(L::max(v, L::set1(N::lo())), L::set1(1.0f)), L::set1(N::scale()));
+			batch_vec const a = L::abs(x);
+			L::ivec const t = L::trunc(a);
+			batch_vec r = L::select(L::le(L::set1(0.5f), L::sub(a, L::tofloat(t))), L::asfloat(L::iadd(t, L::iset1(1))), L::asfloat(t));
+			if(Signed)
+				r = L::select(L::lt(x, L::set1(0.0f)), L::asfloat(L::isub(L::iset1(0), L::asint(r))), r);
+			return L::asint(r);
+		}
+
+		GLM_FUNC_QUALIFIER void packing_store(uint8* p, batch_lanes::ivec v){batch_lanes::istore8(p, v);}
+		GLM_FUNC_QUALIFIER void packing_store(uint16* p, batch_lanes::ivec v){batch_lanes::istore16(p, v);}
+
+#	elif (GLM_ARCH & GLM_ARCH_NEON_BIT) && defined(__aarch64__)
+		// Two registers per call so 8 bit results fill a d register
+		static const int packing_lanes = 8;
+
+		// Same algorithm as the x86 kernels
+		GLM_FUNC_QUALIFIER uint16x4_t packing_to_half(float32x4_t v)
+		{
+			uint32x4_t const bits = vreinterpretq_u32_f32(v);
+			uint32x4_t const u = vandq_u32(bits, vdupq_n_u32(0x7FFFFFFF));
+			uint32x4_t const sign = vandq_u32(vshrq_n_u32(bits, 16), vdupq_n_u32(0x8000));
+			float32x4_t const a = vabsq_f32(v);
+
+			uint32x4_t const normal = vaddq_u32(vsubq_u32(vshrq_n_u32(u, 13), vdupq_n_u32((127 - 15) << 10)), vandq_u32(vshrq_n_u32(u, 12), vdupq_n_u32(1)));
+			uint32x4_t const denormal = vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(a, 16777216.0f), vdupq_n_f32(0.5f)));
+			uint32x4_t const m = vandq_u32(vshrq_n_u32(u, 13), vdupq_n_u32(0x3FF));
+			uint32x4_t const nan = vorrq_u32(vorrq_u32(vdupq_n_u32(0x7C00), m), vandq_u32(vceqq_u32(m, vdupq_n_u32(0)), vdupq_n_u32(1)));
+
+			uint32x4_t h = vbslq_u32(vcltq_f32(a, vdupq_n_f32(6.103515625e-5f)), denormal, normal);
+			h = vbslq_u32(vcgeq_f32(a, vdupq_n_f32(65520.0f)), vdupq_n_u32(0x7C00), h);
+			h = vbslq_u32(vceqq_f32(v, v), h, nan);
+			return vmovn_u32(vorrq_u32(h, sign));
+		}
+
+		GLM_FUNC_QUALIFIER float32x4_t packing_from_half(uint16x4_t h)
+		{
+			// The conversion quiets signaling NaNs, toFloat32 doesn't
+			uint32x4_t const w = vmovl_u16(h);
+			uint32x4_t const special = vorrq_u32(vorrq_u32(vshlq_n_u32(vandq_u32(w, vdupq_n_u32(0x7FFF)), 13), vdupq_n_u32(0x7F800000)), vshlq_n_u32(vandq_u32(w, vdupq_n_u32(0x8000)), 16));
+			float32x4_t const f = vcvt_f32_f16(vreinterpret_f16_u16(h));
+			return vbslq_f32(vceqq_f32(f, f), f, vreinterpretq_f32_u32(special));
+		}
+
+		// vcvtaq rounds half away from zero, as std::round
+		template <typename T, bool Signed>
+		GLM_FUNC_QUALIFIER uint32x4_t packing_to_norm(float32x4_t v)
+		{
+			typedef packing_norm<T, Signed> N;
+			float32x4_t const c = vminq_f32(vmaxq_f32(v, vdupq_n_f32(N::lo())), vdupq_n_f32(1.0f));
+			return vreinterpretq_u32_s32(vcvtaq_s32_f32(vmulq_n_f32(c, N::scale())));
+		}
+
+		GLM_FUNC_QUALIFIER void packing_store(uint8* p, uint32x4_t a, uint32x4_t b){vst1_u8(p, vmovn_u16(vcombine_u16(vmovn_u32(a), vmovn_u32(b))));}
+		GLM_FUNC_QUALIFIER void packing_store(uint16* p, uint32x4_t a, uint32x4_t b){vst1q_u16(p, vcombine_u16(vmovn_u32(a), vmovn_u32(b)));}
+
+#	else
+		static const int packing_lanes = 1;
+#	endif
+
+	// Kernels convert packing_lanes values per call
+	struct packing_half
+	{
+		typedef float input;
+		typedef uint16 output;
+
+		static void call(float const* in, uint16* out)
+		{
+#			if GLM_ARCH & GLM_ARCH_SSE2_BIT
+				batch_lanes::istore16(out, packing_to_half(batch_lanes::load(in)));
+#			elif (GLM_ARCH & GLM_ARCH_NEON_BIT) && defined(__aarch64__)
+				vst1q_u16(out, vcombine_u16(packing_to_half(vld1q_f32(in)), packing_to_half(vld1q_f32(in + 4))));
+#			else
+				out[0] = packHalf1x16(in[0]);
+#			endif
+		}
+	};
+
+	struct unpacking_half
+	{
+		typedef uint16 input;
+		typedef float output;
+
+		static void call(uint16 const* in, float* out)
+		{
+#			if GLM_ARCH & GLM_ARCH_SSE2_BIT
+				batch_lanes::store(out, packing_from_half(in));
+#			elif (GLM_ARCH & GLM_ARCH_NEON_BIT) && defined(__aarch64__)
+				uint16x8_t const h = vld1q_u16(in);
+				vst1q_f32(out, packing_from_half(vget_low_u16(h)));
+				vst1q_f32(out + 4, packing_from_half(vget_high_u16(h)));
+#			else
+				out[0] = unpackHalf1x16(in[0]);
+#			endif
+		}
+	};
+
+	template <typename T, bool Signed>
+	struct packing_to
+	{
+		typedef float input;
+		typedef T output;
+
+		static void call(float const* in, T* out)
+		{
+#			if GLM_ARCH & GLM_ARCH_SSE2_BIT
+				packing_store(out, packing_to_norm<T, Signed>(batch_lanes::load(in)));
+#			elif (GLM_ARCH & GLM_ARCH_NEON_BIT) && defined(__aarch64__)
+				packing_store(out, packing_to_norm<T, Signed>(vld1q_f32(in)), packing_to_norm<T, Signed>(vld1q_f32(in + 4)));
+#			else
+				out[0] = packing_norm<T, Signed>::scalar(in[0]);
+#			endif
+		}
+	};
+
+	// The tail goes through a zero padded copy so no lane reads or writes out of bounds
+	template <typename Kernel>
+	GLM_FUNC_QUALIFIER void packing_run(typename Kernel::input const* in, typename Kernel::output* out, std::size_t count)
+	{
+		std::size_t i = 0;
+		for(; i + packing_lanes <= count; i += packing_lanes)
+			Kernel::call(in + i, out + i);
+
+		if(i < count)
+		{
+			typename Kernel::input a[packing_lanes] = {0};
+			typename Kernel::output r[packing_lanes];
+			for(std::size_t j = 0; i + j < count; ++j)
+				a[j] = in[i + j];
+			Kernel::call(a, r);
+			for(std::size_t j = 0; i + j < count; ++j)
+				out[i + j] = r[j];
+		}
+	}
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER void packHalf1x16Batch(float const * in, uint16 * out, std::size_t count)
+	{
+		detail::packing_run<detail::packing_half>(in, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void unpackHalf1x16Batch(uint16 const * in, float * out, std::size_t count)
+	{
+		detail::packing_run<detail::unpacking_half>(in, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void packUnorm1x8Batch(float const * in, uint8 * out, std::size_t count)
+	{
+		detail::packing_run<detail::packing_to<uint8, false> >(in, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void packSnorm1x8Batch(float const * in, uint8 * out, std::size_t count)
+	{
+		detail::packing_run<detail::packing_to<uint8, true> >(in, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void packUnorm1x16Batch(float const * in, uint16 * out, std::size_t count)
+	{
+		detail::packing_run<detail::packing_to<uint16, false> >(in, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void packSnorm1x16Batch(float const * in, uint16 * out, std::size_t count)
+	{
+		detail::packing_run<detail::packing_to<uint16, true> >(in, out, count);
+	}
+}//namespace glm
@@ -0,0 +1,48 @@
+/// @ref gtx_quaternion_batch
+/// @file glm/gtx/quaternion_batch.hpp
+///
+/// @see core (dependence)
+/// @see gtc_quaternion (dependence)
+/// @see gtx_transcendental_batch (dependence)
+///
+/// @defgroup gtx_quaternion_batch GLM_GTX_quaternion_batch
+/// @ingroup gtx
+///
+/// @brief Interpolates arrays of quaternions, 4 or 8 at a time with SSE2 or AVX2.
+///
+/// The quaternions are transposed in registers so each lane handles one
+/// interpolation with its own factor. Arrays don't need any alignment and
+/// out may alias a or b.
+///
+/// <glm/gtx/quaternion_batch.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/quaternion.hpp"
+#include "transcendental_batch.hpp"
+#include <cstddef>
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_quaternion_batch extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_quaternion_batch
+	/// @{
+
+	/// out[i] = slerp(a[i], b[i], t[i]), taking the short path like gtc slerp.
+	/// The sin and acos are evaluated with the batch_precise polynomials,
+	/// results stay within 1e-6 of slerp.
+	GLM_FUNC_DECL void slerpBatch(quat const * a, quat const * b, float const * t, quat * out, std::size_t count);
+
+	/// out[i] = normalize(mix(a[i], b[i], t[i])) along the short path.
+	/// Cheaper than slerp and close to it for the small angles between keyframes.
+	GLM_FUNC_DECL void nlerpBatch(quat const * a, quat const * b, float const * t, quat * out, std::size_t count);
+
+	/// @}
+}//namespace glm
+
+#include "quaternion_batch.inl"
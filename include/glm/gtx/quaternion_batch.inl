@@ -0,0 +1,183 @@
+/// @ref gtx_quaternion_batch
+/// @file glm/gtx/quaternion_batch.inl
+
+namespace glm{
+namespace detail
+{
+#	if GLM_ARCH & GLM_ARCH_AVX2_BIT
+		typedef simd_lanes<8> quat_lanes;
+#	elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+		typedef simd_lanes<4> quat_lanes;
+#	endif
+
+#	if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		typedef quat_lanes::vec quat_vec;
+
+		// quat_lanes::size quaternions to x, y, z, w registers and back
+		GLM_FUNC_QUALIFIER void quat_batch_load(quat const* q, quat_vec & x, quat_vec & y, quat_vec & z, quat_vec & w)
+		{
+			float const* p = &q[0].x;
+#			if GLM_ARCH & GLM_ARCH_AVX2_BIT
+				x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 0)), _mm_loadu_ps(p + 16), 1);
+				y = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 20), 1);
+				z = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 24), 1);
+				w = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 12)), _mm_loadu_ps(p + 28), 1);
+				__m256 const t0 = _mm256_unpacklo_ps(x, y);
+				__m256 const t1 = _mm256_unpacklo_ps(z, w);
+				__m256 const t2 = _mm256_unpackhi_ps(x, y);
+				__m256 const t3 = _mm256_unpackhi_ps(z, w);
+				x = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+				y = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+				z = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				w = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+#			else
+				x = _mm_loadu_ps(p + 0);
+				y = _mm_loadu_ps(p + 4);
+				z = _mm_loadu_ps(p + 8);
+				w = _mm_loadu_ps(p + 12);
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+#			endif
+		}
+
+		GLM_FUNC_QUALIFIER void quat_batch_store(quat* q, quat_vec x, quat_vec y, quat_vec z, quat_vec w)
+		{
+			float* p = &q[0].x;
+#			if GLM_ARCH & GLM_ARCH_AVX2_BIT
+				__m256 const t0 = _mm256_unpacklo_ps(x, y);
+				__m256 const t1 = _mm256_unpacklo_ps(z, w);
+				__m256 const t2 = _mm256_unpackhi_ps(x, y);
+				__m256 const t3 = _mm256_unpackhi_ps(z, w);
+				__m256 const q0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 const q1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 const q2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 const q3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+				_mm_storeu_ps(p + 0, _mm256_castps256_ps128(q0));
+				_mm_storeu_ps(p + 4, _mm256_castps256_ps128(q1));
+				_mm_storeu_ps(p + 8, _mm256_castps256_ps128(q2));
+				_mm_storeu_ps(p + 12, _mm256_castps256_ps128(q3));
+				_mm_storeu_ps(p + 16, _mm256_extractf128_ps(q0, 1));
+				_mm_storeu_ps(p + 20, _mm256_extractf128_ps(q1, 1));
+				_mm_storeu_ps(p + 24, _mm256_extractf128_ps(q2, 1));
+				_mm_storeu_ps(p + 28, _mm256_extractf128_ps(q3, 1));
+#			else
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_storeu_ps(p + 0, x);
+				_mm_storeu_ps(p + 4, y);
+				_mm_storeu_ps(p + 8, z);
+				_mm_storeu_ps(p + 12, w);
+#			endif
+		}
+
+		template <bool Slerp>
+		GLM_FUNC_QUALIFIER void quat_batch_interpolate(quat const* a, quat const* b, float const* t, quat* out)
+		{
+			typedef quat_lanes L;
+
+			quat_vec ax, ay, az, aw, bx, by, bz, bw;
+			quat_batch_load(a, ax, ay, az, aw);
+			quat_batch_load(b, bx, by, bz, bw);
+			quat_vec const f = L::load(t);
+
+			// Short path: negate b where the dot product is negative
+			quat_vec d = L::madd(aw, bw, L::madd(az, bz, L::madd(ay, by, L::mul(ax, bx))));
+			quat_vec const flip = L::sign(d);
+			bx = L::bxor(bx, flip);
+			by = L::bxor(by, flip);
+			bz = L::bxor(bz, flip);
+			bw = L::bxor(bw, flip);
+			d = L::abs(d);
+
+			quat_vec wa, wb;
+			if(Slerp)
+			{
+				quat_vec const sinAngle = L::sqrt(L::max(L::sub(L::set1(1.0f), L::mul(d, d)), L::set1(0.0f)));
+				quat_vec const angle = simd_atan2<L::size, false>(sinAngle, d);
+				quat_vec sa, sb, c;
+				simd_sincos<L::size, false>(L::mul(L::sub(L::set1(1.0f), f), angle), sa, c);
+				simd_sincos<L::size, false>(L::mul(f, angle), sb, c);
+
+				// Linear weights when sin(angle) gets close to 0, like slerp
+				L::mask const linear = L::lt(L::set1(1.0f - epsilon<float>()), d);
+				quat_vec const rcp = L::div(L::set1(1.0f), L::select(linear, L::set1(1.0f), sinAngle));
+				wa = L::select(linear, L::sub(L::set1(1.0f), f), L::mul(sa, rcp));
+				wb = L::select(linear, f, L::mul(sb, rcp));
+			}
+			else
+			{
+				wa = L::sub(L::set1(1.0f), f);
+				wb = f;
+			}
+
+			quat_vec x = L::madd(bx, wb, L::mul(ax, wa));
+			quat_vec y = L::madd(by, wb, L::mul(ay, wa));
+			quat_vec z = L::madd(bz, wb, L::mul(az, wa));
+			quat_vec w = L::madd(bw, wb, L::mul(aw, wa));
+
+			if(!Slerp)
+			{
+				quat_vec const len = L::sqrt(L::madd(w, w, L::madd(z, z, L::madd(y, y, L::mul(x, x)))));
+				quat_vec const rcp = L::div(L::set1(1.0f), len);
+				x = L::mul(x, rcp);
+				y = L::mul(y, rcp);
+				z = L::mul(z, rcp);
+				w = L::mul(w, rcp);
+			}
+
+			quat_batch_store(out, x, y, z, w);
+		}
+
+		template <bool Slerp>
+		GLM_FUNC_QUALIFIER void quat_batch(quat const* a, quat const* b, float const* t, quat* out, std::size_t count)
+		{
+			std::size_t const Size = static_cast<std::size_t>(quat_lanes::size);
+
+			std::size_t i = 0;
+			for(; i + Size <= count; i += Size)
+				quat_batch_interpolate<Slerp>(a + i, b + i, t + i, out + i);
+
+			if(i < count)
+			{
+				std::size_t const n = count - i;
+				quat qa[quat_lanes::size], qb[quat_lanes::size], r[quat_lanes::size];
+				float f[quat_lanes::size] = {0};
+				for(std::size_t j = 0; j < n; ++j)
+				{
+					qa[j] = a[i + j];
+					qb[j] = b[i + j];
+					f[j] = t[i + j];
+				}
+				for(std::size_t j = n; j < Size; ++j)
+					qa[j] = qb[j] = quat(1.0f, 0.0f, 0.0f, 0.0f);
+				quat_batch_interpolate<Slerp>(qa, qb, f, r);
+				for(std::size_t j = 0; j < n; ++j)
+					out[i + j] = r[j];
+			}
+		}
+#	else
+		template <bool Slerp>
+		GLM_FUNC_QUALIFIER void quat_batch(quat const* a, quat const* b, float const* t, quat* out, std::size_t count)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				if(Slerp)
+					out[i] = slerp(a[i], b[i], t[i]);
+				else
+				{
+					quat const z = dot(a[i], b[i]) < 0.0f ? -b[i] : b[i];
+					out[i] = normalize(a[i] * (1.0f - t[i]) + z * t[i]);
+				}
+			}
+		}
+#	endif
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER void slerpBatch(quat const * a, quat const * b, float const * t, quat * out, std::size_t count)
+	{
+		detail::quat_batch<true>(a, b, t, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void nlerpBatch(quat const * a, quat const * b, float const * t, quat * out, std::size_t count)
+	{
+		detail::quat_batch<false>(a, b, t, out, count);
+	}
+}//namespace glm
@@ -0,0 +1,77 @@
+/// @ref gtx_random_batch
+/// @file glm/gtx/random_batch.hpp
+///
+/// @see core (dependence)
+/// @see gtc_random (dependence)
+/// @see gtx_transcendental_batch (dependence)
+///
+/// @defgroup gtx_random_batch GLM_GTX_random_batch
+/// @ingroup gtx
+///
+/// @brief Fills arrays with uniform, gaussian, disk and sphere samples from
+/// 16 xoshiro128+ generators advanced in lockstep, 4, 8 or 16 at a time with
+/// SSE2, AVX2 or AVX-512.
+///
+/// Unlike gtc_random, nothing is shared: each thread or job owns a
+/// batch_rng seeded with its own (seed, stream) pair, which makes parallel
+/// runs reproducible whatever the scheduling. Uniform samples are bit
+/// identical on every architecture, the others go through the batch_precise
+/// polynomials of gtx_transcendental_batch (std:: functions with
+/// GLM_FORCE_PURE) and match to a few ulp.
+///
+/// Generators advance by whole rounds of 16 samples: the values drawn
+/// depend on the sequence of calls and their counts, not on the hardware.
+///
+/// <glm/gtx/random_batch.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include "../gtc/random.hpp"
+#include "../gtc/constants.hpp"
+#include "transcendental_batch.hpp"
+#include <cstddef>
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_random_batch extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_random_batch
+	/// @{
+
+	/// State of 16 xoshiro128+ generators, word w of generator j in state[w][j].
+	/// 256 bytes, cheap to keep one per thread or per job.
+	struct batch_rng
+	{
+		static const int lanes = 16;
+
+		uint32 state[4][lanes];
+
+		/// Same as seedRand(*this, seed, stream)
+		GLM_FUNC_DECL explicit batch_rng(uint64 seed = 0, uint64 stream = 0);
+	};
+
+	/// Restarts the 16 generators from seed and stream number through
+	/// splitmix64. Streams of one seed are independent for practical purposes,
+	/// use the job or thread index as stream.
+	GLM_FUNC_DECL void seedRand(batch_rng & rng, uint64 seed, uint64 stream = 0);
+
+	/// out[i] uniform in [Min, Max), 24 random bits per sample
+	GLM_FUNC_DECL void linearRandBatch(batch_rng & rng, float * out, std::size_t count, float Min, float Max);
+
+	/// out[i] normally distributed, Box-Muller transform of two uniforms per pair of samples
+	GLM_FUNC_DECL void gaussRandBatch(batch_rng & rng, float * out, std::size_t count, float Mean, float Deviation);
+
+	/// out[i] uniform in the disk of the given radius, like diskRand but without rejection
+	GLM_FUNC_DECL void diskRandBatch(batch_rng & rng, vec2 * out, std::size_t count, float Radius);
+
+	/// out[i] uniform on the sphere of the given radius, like sphericalRand
+	GLM_FUNC_DECL void sphericalRandBatch(batch_rng & rng, vec3 * out, std::size_t count, float Radius);
+
+	/// @}
+}//namespace glm
+
+#include "random_batch.inl"
@@ -0,0 +1,267 @@
+/// @ref gtx_random_batch
+/// @file glm/gtx/random_batch.inl
+
+#include <cmath>
+
+namespace glm{
+namespace detail
+{
+	// splitmix64, expands a seed into generator states
+	GLM_FUNC_QUALIFIER uint64 rng_splitmix(uint64 & x)
+	{
+		uint64 z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// Distributions turn Uniforms values in [0, 1) into Outputs floats per sample.
+	// scalar is the GLM_ARCH_PURE fallback, call runs on full registers.
+	struct rng_linear
+	{
+		static const int uniforms = 1;
+		static const int outputs = 1;
+		float Min, Scale;
+
+		void scalar(float const* u, float* o) const
+		{
+			o[0] = Min + u[0] * Scale;
+		}
+
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			void call(batch_vec const* u, batch_vec* o) const
+			{
+				o[0] = batch_lanes::add(batch_lanes::set1(Min), batch_lanes::mul(u[0], batch_lanes::set1(Scale)));
+			}
+#		endif
+	};
+
+	// Box-Muller, 1 - u keeps the log argument in (0, 1]
+	struct rng_gauss
+	{
+		static const int uniforms = 2;
+		static const int outputs = 2;
+		float Mean, Deviation;
+
+		void scalar(float const* u, float* o) const
+		{
+			float const r = std::sqrt(-2.0f * std::log(1.0f - u[0])) * Deviation;
+			float const a = two_pi<float>() * u[1];
+			o[0] = Mean + r * std::cos(a);
+			o[1] = Mean + r * std::sin(a);
+		}
+
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			void call(batch_vec const* u, batch_vec* o) const
+			{
+				typedef batch_lanes L;
+				batch_vec s, c;
+				batch_vec const l = simd_log<L::size, false>(L::sub(L::set1(1.0f), u[0]));
+				batch_vec const r = L::mul(L::sqrt(L::mul(L::set1(-2.0f), l)), L::set1(Deviation));
+				simd_sincos<L::size, false>(L::mul(L::set1(two_pi<float>()), u[1]), s, c);
+				o[0] = L::add(L::set1(Mean), L::mul(r, c));
+				o[1] = L::add(L::set1(Mean), L::mul(r, s));
+			}
+#		endif
+	};
+
+	struct rng_disk
+	{
+		static const int uniforms = 2;
+		static const int outputs = 2;
+		float Radius;
+
+		void scalar(float const* u, float* o) const
+		{
+			float const r = Radius * std::sqrt(u[0]);
+			float const a = two_pi<float>() * u[1];
+			o[0] = r * std::cos(a);
+			o[1] = r * std::sin(a);
+		}
+
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			void call(batch_vec const* u, batch_vec* o) const
+			{
+				typedef batch_lanes L;
+				batch_vec s, c;
+				batch_vec const r = L::mul(L::set1(Radius), L::sqrt(u[0]));
+				simd_sincos<L::size, false>(L::mul(L::set1(two_pi<float>()), u[1]), s, c);
+				o[0] = L::mul(r, c);
+				o[1] = L::mul(r, s);
+			}
+#		endif
+	};
+
+	// Uniform z in [-1, 1) and longitude, Archimedes' hat-box theorem
+	struct rng_sphere
+	{
+		static const int uniforms = 2;
+		static const int outputs = 3;
+		float Radius;
+
+		void scalar(float const* u, float* o) const
+		{
+			float const z = 1.0f - 2.0f * u[0];
+			float const r = std::sqrt(1.0f - z * z) * Radius;
+			float const a = two_pi<float>() * u[1];
+			o[0] = r * std::cos(a);
+			o[1] = r * std::sin(a);
+			o[2] = z * Radius;
+		}
+
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			void call(batch_vec const* u, batch_vec* o) const
+			{
+				typedef batch_lanes L;
+				batch_vec s, c;
+				batch_vec const z = L::sub(L::set1(1.0f), L::mul(L::set1(2.0f), u[0]));
+				batch_vec const r = L::mul(L::sqrt(L::sub(L::set1(1.0f), L::mul(z, z))), L::set1(Radius));
+				simd_sincos<L::size, false>(L::mul(L::set1(two_pi<float>()), u[1]), s, c);
+				o[0] = L::mul(r, c);
+				o[1] = L::mul(r, s);
+				o[2] = L::mul(z, L::set1(Radius));
+			}
+#		endif
+	};
+
+	// Sample r * 16 + j comes from round r of generator j and fills
+	// out[(r * 16 + j) * Outputs ...], count is in floats. Each group of lanes
+	// keeps its generator state in registers for the whole call.
+	template <typename Dist>
+	GLM_FUNC_QUALIFIER void rng_fill(batch_rng & rng, Dist const & dist, float * out, std::size_t count)
+	{
+		std::size_t const samples = (count + Dist::outputs - 1) / Dist::outputs;
+		std::size_t const rounds = (samples + batch_rng::lanes - 1) / batch_rng::lanes;
+
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			typedef batch_lanes L;
+			typedef L::ivec ivec;
+
+			for(int j = 0; j < batch_rng::lanes; j += L::size)
+			{
+				ivec s0 = L::iload(rng.state[0] + j);
+				ivec s1 = L::iload(rng.state[1] + j);
+				ivec s2 = L::iload(rng.state[2] + j);
+				ivec s3 = L::iload(rng.state[3] + j);
+
+				for(std::size_t r = 0; r < rounds; ++r)
+				{
+					batch_vec u[Dist::uniforms], o[Dist::outputs];
+					for(int k = 0; k < Dist::uniforms; ++k)
+					{
+						ivec const x = L::iadd(s0, s3);
+						ivec const t = L::shl(s1, 9);
+						s2 = L::ixor(s2, s0);
+						s3 = L::ixor(s3, s1);
+						s1 = L::ixor(s1, s2);
+						s0 = L::ixor(s0, s3);
+						s2 = L::ixor(s2, t);
+						s3 = L::ior(L::shl(s3, 11), L::shr(s3, 21));
+						u[k] = L::mul(L::tofloat(L::shr(x, 8)), L::set1(1.0f / 16777216.0f));
+					}
+					dist.call(u, o);
+
+					std::size_t const first = (r * batch_rng::lanes + static_cast<std::size_t>(j)) * Dist::outputs;
+					if(Dist::outputs == 1 && first + L::size <= count)
+					{
+						L::store(out + first, o[0]);
+						continue;
+					}
+					float v[Dist::outputs][L::size];
+					for(int m = 0; m < Dist::outputs; ++m)
+						L::store(v[m], o[m]);
+					for(int l = 0; l < L::size; ++l)
+						for(int m = 0; m < Dist::outputs; ++m)
+						{
+							std::size_t const i = first + static_cast<std::size_t>(l * Dist::outputs + m);
+							if(i < count)
+								out[i] = v[m][l];
+						}
+				}
+
+				L::istore(rng.state[0] + j, s0);
+				L::istore(rng.state[1] + j, s1);
+				L::istore(rng.state[2] + j, s2);
+				L::istore(rng.state[3] + j, s3);
+			}
+#		else
+			for(int j = 0; j < batch_rng::lanes; ++j)
+			{
+				uint32 s0 = rng.state[0][j], s1 = rng.state[1][j], s2 = rng.state[2][j], s3 = rng.state[3][j];
+
+				for(std::size_t r = 0; r < rounds; ++r)
+				{
+					float u[Dist::uniforms], o[Dist::outputs];
+					for(int k = 0; k < Dist::uniforms; ++k)
+					{
+						uint32 const x = s0 + s3;
+						uint32 const t = s1 << 9;
+						s2 ^= s0;
+						s3 ^= s1;
+						s1 ^= s2;
+						s0 ^= s3;
+						s2 ^= t;
+						s3 = (s3 << 11) | (s3 >> 21);
+						u[k] = static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+					}
+					dist.scalar(u, o);
+
+					std::size_t const first = (r * batch_rng::lanes + static_cast<std::size_t>(j)) * Dist::outputs;
+					for(int m = 0; m < Dist::outputs; ++m)
+						if(first + static_cast<std::size_t>(m) < count)
+							out[first + static_cast<std::size_t>(m)] = o[m];
+				}
+
+				rng.state[0][j] = s0;
+				rng.state[1][j] = s1;
+				rng.state[2][j] = s2;
+				rng.state[3][j] = s3;
+			}
+#		endif
+	}
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER batch_rng::batch_rng(uint64 seed, uint64 stream)
+	{
+		seedRand(*this, seed, stream);
+	}
+
+	GLM_FUNC_QUALIFIER void seedRand(batch_rng & rng, uint64 seed, uint64 stream)
+	{
+		// Streams of one seed start the splitmix sequence at distinct points
+		uint64 x = detail::rng_splitmix(seed) ^ stream;
+		for(int j = 0; j < batch_rng::lanes; ++j)
+		{
+			uint64 const a = detail::rng_splitmix(x);
+			uint64 const b = detail::rng_splitmix(x);
+			rng.state[0][j] = static_cast<uint32>(a);
+			rng.state[1][j] = static_cast<uint32>(a >> 32);
+			rng.state[2][j] = static_cast<uint32>(b);
+			rng.state[3][j] = static_cast<uint32>(b >> 32) | (a == 0 && b == 0 ? 1u : 0u);
+		}
+	}
+
+	GLM_FUNC_QUALIFIER void linearRandBatch(batch_rng & rng, float * out, std::size_t count, float Min, float Max)
+	{
+		detail::rng_linear const dist = {Min, Max - Min};
+		detail::rng_fill(rng, dist, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void gaussRandBatch(batch_rng & rng, float * out, std::size_t count, float Mean, float Deviation)
+	{
+		detail::rng_gauss const dist = {Mean, Deviation};
+		detail::rng_fill(rng, dist, out, count);
+	}
+
+	GLM_FUNC_QUALIFIER void diskRandBatch(batch_rng & rng, vec2 * out, std::size_t count, float Radius)
+	{
+		detail::rng_disk const dist = {Radius};
+		detail::rng_fill(rng, dist, reinterpret_cast<float *>(out), count * 2);
+	}
+
+	GLM_FUNC_QUALIFIER void sphericalRandBatch(batch_rng & rng, vec3 * out, std::size_t count, float Radius)
+	{
+		detail::rng_sphere const dist = {Radius};
+		detail::rng_fill(rng, dist, reinterpret_cast<float *>(out), count * 3);
+	}
+}//namespace glm
@@ -0,0 +1,70 @@
+/// @ref gtx_transcendental_batch
+/// @file glm/gtx/transcendental_batch.hpp
+///
+/// @see core (dependence)
+///
+/// @defgroup gtx_transcendental_batch GLM_GTX_transcendental_batch
+/// @ingroup gtx
+///
+/// @brief Evaluates sin, cos, exp, log, pow and atan2 over float arrays with SIMD polynomials.
+///
+/// The kernel width follows GLM_ARCH at compile time: 16 lanes with AVX-512,
+/// 8 with AVX2, 4 with SSE2 and the standard library otherwise. Any count is
+/// accepted, arrays don't need any alignment and the output may alias the input.
+///
+/// Maximum errors measured against double precision libm:
+/// - batch_precise: sin/cos 1.5 ulp in [-pi, pi] and 1e-7 absolute up to |x| = 8192,
+///   exp 1.3 ulp, log 0.8 ulp, atan2 3.1 ulp, pow 32 ulp for |y * log(x)| < 18.
+/// - batch_fast: lower degree polynomials, sin/cos 1e-6 absolute, exp 6e-6 relative,
+///   log 2e-6 relative, pow 9e-6 relative, atan2 5e-7 absolute.
+///
+/// See glm/simd/transcendental.h for the special values handling.
+///
+/// <glm/gtx/transcendental_batch.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include <cstddef>
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_transcendental_batch extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_transcendental_batch
+	/// @{
+
+	enum batch_accuracy
+	{
+		batch_precise,
+		batch_fast
+	};
+
+	/// out[i] = sin(in[i]) for count values.
+	GLM_FUNC_DECL void sinBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy = batch_precise);
+
+	/// out[i] = cos(in[i]) for count values.
+	GLM_FUNC_DECL void cosBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy = batch_precise);
+
+	/// outSin[i] = sin(in[i]) and outCos[i] = cos(in[i]), sharing the range reduction.
+	GLM_FUNC_DECL void sincosBatch(float const * in, float * outSin, float * outCos, std::size_t count, batch_accuracy accuracy = batch_precise);
+
+	/// out[i] = exp(in[i]) for count values.
+	GLM_FUNC_DECL void expBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy = batch_precise);
+
+	/// out[i] = log(in[i]) for count values.
+	GLM_FUNC_DECL void logBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy = batch_precise);
+
+	/// out[i] = pow(x[i], y[i]) for count values, x must not be negative.
+	GLM_FUNC_DECL void powBatch(float const * x, float const * y, float * out, std::size_t count, batch_accuracy accuracy = batch_precise);
+
+	/// out[i] = atan2(y[i], x[i]) for count values.
+	GLM_FUNC_DECL void atan2Batch(float const * y, float const * x, float * out, std::size_t count, batch_accuracy accuracy = batch_precise);
+
+	/// @}
+}//namespace glm
+
+#include "transcendental_batch.inl"
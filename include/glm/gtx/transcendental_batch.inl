@@ -0,0 +1,223 @@
+/// @ref gtx_transcendental_batch
+/// @file glm/gtx/transcendental_batch.inl
+
+#include "../simd/transcendental.h"
+#include <cmath>
+
+namespace glm{
+namespace detail
+{
+	// The scalar function is the GLM_ARCH_PURE fallback, call runs on a full register
+	struct batch_sin
+	{
+		static float scalar(float x){return std::sin(x);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			template <bool Fast> static batch_vec call(batch_vec x){batch_vec s, c; simd_sincos<batch_lanes::size, Fast>(x, s, c); return s;}
+#		endif
+	};
+
+	struct batch_cos
+	{
+		static float scalar(float x){return std::cos(x);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			template <bool Fast> static batch_vec call(batch_vec x){batch_vec s, c; simd_sincos<batch_lanes::size, Fast>(x, s, c); return c;}
+#		endif
+	};
+
+	struct batch_exp
+	{
+		static float scalar(float x){return std::exp(x);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			template <bool Fast> static batch_vec call(batch_vec x){return simd_exp<batch_lanes::size, Fast>(x);}
+#		endif
+	};
+
+	struct batch_log
+	{
+		static float scalar(float x){return std::log(x);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			template <bool Fast> static batch_vec call(batch_vec x){return simd_log<batch_lanes::size, Fast>(x);}
+#		endif
+	};
+
+	struct batch_pow
+	{
+		static float scalar(float x, float y){return std::pow(x, y);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			template <bool Fast> static batch_vec call(batch_vec x, batch_vec y){return simd_pow<batch_lanes::size, Fast>(x, y);}
+#		endif
+	};
+
+	struct batch_atan2
+	{
+		static float scalar(float y, float x){return std::atan2(y, x);}
+#		if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			template <bool Fast> static batch_vec call(batch_vec y, batch_vec x){return simd_atan2<batch_lanes::size, Fast>(y, x);}
+#		endif
+	};
+
+#	if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		// The tail goes through a zero padded copy so no lane reads or writes out of bounds
+		template <typename Op, bool Fast>
+		GLM_FUNC_QUALIFIER void batch_unary(float const* in, float* out, std::size_t count)
+		{
+			typedef batch_lanes L;
+
+			std::size_t i = 0;
+			for(; i + L::size <= count; i += L::size)
+				L::store(out + i, Op::template call<Fast>(L::load(in + i)));
+
+			if(i < count)
+			{
+				std::size_t const n = count - i;
+				float a[L::size] = {0}, r[L::size];
+				for(std::size_t j = 0; j < n; ++j)
+					a[j] = in[i + j];
+				L::store(r, Op::template call<Fast>(L::load(a)));
+				for(std::size_t j = 0; j < n; ++j)
+					out[i + j] = r[j];
+			}
+		}
+
+		template <typename Op, bool Fast>
+		GLM_FUNC_QUALIFIER void batch_binary(float const* x, float const* y, float* out, std::size_t count)
+		{
+			typedef batch_lanes L;
+
+			std::size_t i = 0;
+			for(; i + L::size <= count; i += L::size)
+				L::store(out + i, Op::template call<Fast>(L::load(x + i), L::load(y + i)));
+
+			if(i < count)
+			{
+				std::size_t const n = count - i;
+				float a[L::size] = {0}, b[L::size] = {0}, r[L::size];
+				for(std::size_t j = 0; j < n; ++j)
+				{
+					a[j] = x[i + j];
+					b[j] = y[i + j];
+				}
+				L::store(r, Op::template call<Fast>(L::load(a), L::load(b)));
+				for(std::size_t j = 0; j < n; ++j)
+					out[i + j] = r[j];
+			}
+		}
+
+		template <bool Fast>
+		GLM_FUNC_QUALIFIER void batch_sincos(float const* in, float* outSin, float* outCos, std::size_t count)
+		{
+			typedef batch_lanes L;
+
+			std::size_t i = 0;
+			batch_vec s, c;
+			for(; i + L::size <= count; i += L::size)
+			{
+				simd_sincos<batch_lanes::size, Fast>(L::load(in + i), s, c);
+				L::store(outSin + i, s);
+				L::store(outCos + i, c);
+			}
+
+			if(i < count)
+			{
+				std::size_t const n = count - i;
+				float a[L::size] = {0}, rs[L::size], rc[L::size];
+				for(std::size_t j = 0; j < n; ++j)
+					a[j] = in[i + j];
+				simd_sincos<batch_lanes::size, Fast>(L::load(a), s, c);
+				L::store(rs, s);
+				L::store(rc, c);
+				for(std::size_t j = 0; j < n; ++j)
+				{
+					outSin[i + j] = rs[j];
+					outCos[i + j] = rc[j];
+				}
+			}
+		}
+
+		GLM_FUNC_QUALIFIER void batch_sincos(float const* in, float* outSin, float* outCos, std::size_t count, batch_accuracy accuracy)
+		{
+			if(accuracy == batch_fast)
+				batch_sincos<true>(in, outSin, outCos, count);
+			else
+				batch_sincos<false>(in, outSin, outCos, count);
+		}
+
+		template <typename Op>
+		GLM_FUNC_QUALIFIER void batch_unary(float const* in, float* out, std::size_t count, batch_accuracy accuracy)
+		{
+			if(accuracy == batch_fast)
+				batch_unary<Op, true>(in, out, count);
+			else
+				batch_unary<Op, false>(in, out, count);
+		}
+
+		template <typename Op>
+		GLM_FUNC_QUALIFIER void batch_binary(float const* x, float const* y, float* out, std::size_t count, batch_accuracy accuracy)
+		{
+			if(accuracy == batch_fast)
+				batch_binary<Op, true>(x, y, out, count);
+			else
+				batch_binary<Op, false>(x, y, out, count);
+		}
+#	else
+		GLM_FUNC_QUALIFIER void batch_sincos(float const* in, float* outSin, float* outCos, std::size_t count, batch_accuracy)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				float const x = in[i];
+				outSin[i] = std::sin(x);
+				outCos[i] = std::cos(x);
+			}
+		}
+
+		template <typename Op>
+		GLM_FUNC_QUALIFIER void batch_unary(float const* in, float* out, std::size_t count, batch_accuracy)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = Op::scalar(in[i]);
+		}
+
+		template <typename Op>
+		GLM_FUNC_QUALIFIER void batch_binary(float const* x, float const* y, float* out, std::size_t count, batch_accuracy)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+				out[i] = Op::scalar(x[i], y[i]);
+		}
+#	endif
+}//namespace detail
+
+	GLM_FUNC_QUALIFIER void sinBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy)
+	{
+		detail::batch_unary<detail::batch_sin>(in, out, count, accuracy);
+	}
+
+	GLM_FUNC_QUALIFIER void cosBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy)
+	{
+		detail::batch_unary<detail::batch_cos>(in, out, count, accuracy);
+	}
+
+	GLM_FUNC_QUALIFIER void sincosBatch(float const * in, float * outSin, float * outCos, std::size_t count, batch_accuracy accuracy)
+	{
+		detail::batch_sincos(in, outSin, outCos, count, accuracy);
+	}
+
+	GLM_FUNC_QUALIFIER void expBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy)
+	{
+		detail::batch_unary<detail::batch_exp>(in, out, count, accuracy);
+	}
+
+	GLM_FUNC_QUALIFIER void logBatch(float const * in, float * out, std::size_t count, batch_accuracy accuracy)
+	{
+		detail::batch_unary<detail::batch_log>(in, out, count, accuracy);
+	}
+
+	GLM_FUNC_QUALIFIER void powBatch(float const * x, float const * y, float * out, std::size_t count, batch_accuracy accuracy)
+	{
+		detail::batch_binary<detail::batch_pow>(x, y, out, count, accuracy);
+	}
+
+	GLM_FUNC_QUALIFIER void atan2Batch(float const * y, float const * x, float * out, std::size_t count, batch_accuracy accuracy)
+	{
+		detail::batch_binary<detail::batch_atan2>(y, x, out, count, accuracy);
+	}
+}//namespace glm
@@ -0,0 +1,105 @@
+/// @ref gtx_transform_batch
+/// @file glm/gtx/transform_batch.hpp
+///
+/// @see core (dependence)
+///
+/// @defgroup gtx_transform_batch GLM_GTX_transform_batch
+/// @ingroup gtx
+///
+/// @brief Applies 4 * 4 float matrices to arrays of vectors and matrices.
+///
+/// The kernel is selected at compile time from GLM_ARCH: 16 lanes with AVX-512,
+/// 8 lanes with AVX2, 4 lanes with SSE2 and a scalar loop otherwise.
+/// Any count is accepted, arrays don't need any alignment and
+/// the output may alias the input, element for element, as well as
+/// the single matrix applied to every element.
+/// The results have the bits of the same loop of operator*, unless
+/// the compiler contracts that loop into fused multiply-adds.
+///
+/// <glm/gtx/transform_batch.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+#include <cstddef>
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_transform_batch extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_transform_batch
+	/// @{
+
+	/// Computes out[i] = vec3(m * vec4(in[i], 1)) for count points.
+	/// The projected w is dropped, use transformVectors for clip space.
+	template <precision P>
+	GLM_FUNC_DECL void transformPoints(
+		tmat4x4<float, P> const & m,
+		tvec3<float, P> const * in,
+		tvec3<float, P> * out,
+		std::size_t count);
+
+	/// Computes out[i] = vec3(m * vec4(in[i], 0)) for count directions.
+	template <precision P>
+	GLM_FUNC_DECL void transformDirections(
+		tmat4x4<float, P> const & m,
+		tvec3<float, P> const * in,
+		tvec3<float, P> * out,
+		std::size_t count);
+
+	/// Computes out[i] = m * in[i] for count vectors.
+	template <precision P>
+	GLM_FUNC_DECL void transformVectors(
+		tmat4x4<float, P> const & m,
+		tvec4<float, P> const * in,
+		tvec4<float, P> * out,
+		std::size_t count);
+
+	/// Transforms count points stored as separate x, y and z arrays.
+	/// 'ow' receives the projected w and may be null.
+	GLM_FUNC_DECL void transformPointsSoA(
+		mat4 const & m,
+		float const * x, float const * y, float const * z,
+		float * ox, float * oy, float * oz, float * ow,
+		std::size_t count);
+
+	/// Transforms count directions stored as separate x, y and z arrays.
+	GLM_FUNC_DECL void transformDirectionsSoA(
+		mat4 const & m,
+		float const * x, float const * y, float const * z,
+		float * ox, float * oy, float * oz,
+		std::size_t count);
+
+	/// Computes out[i] = a[i] * b[i] for count matrix pairs.
+	template <precision P>
+	GLM_FUNC_DECL void mulMatrices(
+		tmat4x4<float, P> const * a,
+		tmat4x4<float, P> const * b,
+		tmat4x4<float, P> * out,
+		std::size_t count);
+
+	/// Computes out[i] = a * b[i] for count matrices.
+	template <precision P>
+	GLM_FUNC_DECL void mulMatrices(
+		tmat4x4<float, P> const & a,
+		tmat4x4<float, P> const * b,
+		tmat4x4<float, P> * out,
+		std::size_t count);
+
+	/// Computes out[i] = proj * view * world[i], the view projection
+	/// product is only built once.
+	template <precision P>
+	GLM_FUNC_DECL void composeWorldViewProj(
+		tmat4x4<float, P> const & proj,
+		tmat4x4<float, P> const & view,
+		tmat4x4<float, P> const * world,
+		tmat4x4<float, P> * out,
+		std::size_t count);
+
+	/// @}
+}//namespace glm
+
+#include "transform_batch.inl"
@@ -0,0 +1,162 @@
+/// @ref gtx_transform_batch
+/// @file glm/gtx/transform_batch.inl
+
+#include "../simd/matrix_batch.h"
+
+namespace glm{
+namespace detail
+{
+	GLM_FUNC_QUALIFIER void transform_vec3_batch(float const* m, float const* in, float* out, std::size_t count, float w)
+	{
+#		if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+			glm_mat4_transform_vec3_batch_avx512(m, in, out, count, w);
+#		elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+			glm_mat4_transform_vec3_batch_avx2(m, in, out, count, w);
+#		elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_mat4_transform_vec3_batch(m, in, out, count, w);
+#		else
+			for(std::size_t i = 0; i < count; ++i, in += 3, out += 3)
+			{
+				float const x = in[0], y = in[1], z = in[2];
+				out[0] = (m[0] * x + m[4] * y) + (m[8] * z + m[12] * w);
+				out[1] = (m[1] * x + m[5] * y) + (m[9] * z + m[13] * w);
+				out[2] = (m[2] * x + m[6] * y) + (m[10] * z + m[14] * w);
+			}
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER void transform_vec4_batch(float const* m, float const* in, float* out, std::size_t count)
+	{
+#		if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+			glm_mat4_transform_vec4_batch_avx512(m, in, out, count);
+#		elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+			glm_mat4_transform_vec4_batch_avx2(m, in, out, count);
+#		elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_mat4_transform_vec4_batch(m, in, out, count);
+#		else
+			for(std::size_t i = 0; i < count; ++i, in += 4, out += 4)
+			{
+				float const x = in[0], y = in[1], z = in[2], w = in[3];
+				out[0] = (m[0] * x + m[4] * y) + (m[8] * z + m[12] * w);
+				out[1] = (m[1] * x + m[5] * y) + (m[9] * z + m[13] * w);
+				out[2] = (m[2] * x + m[6] * y) + (m[10] * z + m[14] * w);
+				out[3] = (m[3] * x + m[7] * y) + (m[11] * z + m[15] * w);
+			}
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER void transform_soa_batch(float const* m,
+		float const* x, float const* y, float const* z,
+		float* ox, float* oy, float* oz, float* ow, std::size_t count, float w)
+	{
+#		if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+			glm_mat4_transform_soa_batch_avx512(m, x, y, z, ox, oy, oz, ow, count, w);
+#		elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+			glm_mat4_transform_soa_batch_avx2(m, x, y, z, ox, oy, oz, ow, count, w);
+#		elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_mat4_transform_soa_batch(m, x, y, z, ox, oy, oz, ow, count, w);
+#		else
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				float const vx = x[i], vy = y[i], vz = z[i];
+				ox[i] = (m[0] * vx + m[4] * vy) + (m[8] * vz + m[12] * w);
+				oy[i] = (m[1] * vx + m[5] * vy) + (m[9] * vz + m[13] * w);
+				oz[i] = (m[2] * vx + m[6] * vy) + (m[10] * vz + m[14] * w);
+				if(ow)
+					ow[i] = (m[3] * vx + m[7] * vy) + (m[11] * vz + m[15] * w);
+			}
+#		endif
+	}
+
+	GLM_FUNC_QUALIFIER void mul_mat4_batch(float const* a, std::size_t strideA, float const* b, float* out, std::size_t count)
+	{
+#		if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+			glm_mat4_mul_batch_avx512(a, strideA, b, out, count);
+#		elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+			glm_mat4_mul_batch_avx2(a, strideA, b, out, count);
+#		elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+			glm_mat4_mul_batch(a, strideA, b, out, count);
+#		else
+			// The expression of operator*, all of a is read before out is written
+			typedef tvec4<float, packed_highp> col;
+			for(std::size_t i = 0; i < count; ++i, a += strideA, b += 16, out += 16)
+			{
+				col const a0(a[0], a[1], a[2], a[3]);
+				col const a1(a[4], a[5], a[6], a[7]);
+				col const a2(a[8], a[9], a[10], a[11]);
+				col const a3(a[12], a[13], a[14], a[15]);
+				for(int j = 0; j < 4; ++j)
+				{
+					col const r = a0 * b[j * 4 + 0] + a1 * b[j * 4 + 1] + a2 * b[j * 4 + 2] + a3 * b[j * 4 + 3];
+					out[j * 4 + 0] = r.x;
+					out[j * 4 + 1] = r.y;
+					out[j * 4 + 2] = r.z;
+					out[j * 4 + 3] = r.w;
+				}
+			}
+#		endif
+	}
+}//namespace detail
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void transformPoints(tmat4x4<float, P> const & m, tvec3<float, P> const * in, tvec3<float, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<float, P>) == sizeof(float) * 3, "'transformPoints' requires tightly packed vectors");
+		// Copied: the kernels read m on every iteration and out may overlap it
+		tmat4x4<float, P> const local(m);
+		detail::transform_vec3_batch(&local[0][0], &in[0][0], &out[0][0], count, 1.0f);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void transformDirections(tmat4x4<float, P> const & m, tvec3<float, P> const * in, tvec3<float, P> * out, std::size_t count)
+	{
+		GLM_STATIC_ASSERT(sizeof(tvec3<float, P>) == sizeof(float) * 3, "'transformDirections' requires tightly packed vectors");
+		tmat4x4<float, P> const local(m);
+		detail::transform_vec3_batch(&local[0][0], &in[0][0], &out[0][0], count, 0.0f);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void transformVectors(tmat4x4<float, P> const & m, tvec4<float, P> const * in, tvec4<float, P> * out, std::size_t count)
+	{
+		tmat4x4<float, P> const local(m);
+		detail::transform_vec4_batch(&local[0][0], &in[0][0], &out[0][0], count);
+	}
+
+	GLM_FUNC_QUALIFIER void transformPointsSoA(mat4 const & m,
+		float const * x, float const * y, float const * z,
+		float * ox, float * oy, float * oz, float * ow, std::size_t count)
+	{
+		mat4 const local(m);
+		detail::transform_soa_batch(&local[0][0], x, y, z, ox, oy, oz, ow, count, 1.0f);
+	}
+
+	GLM_FUNC_QUALIFIER void transformDirectionsSoA(mat4 const & m,
+		float const * x, float const * y, float const * z,
+		float * ox, float * oy, float * oz, std::size_t count)
+	{
+		mat4 const local(m);
+		detail::transform_soa_batch(&local[0][0], x, y, z, ox, oy, oz, 0, count, 0.0f);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void mulMatrices(tmat4x4<float, P> const * a, tmat4x4<float, P> const * b, tmat4x4<float, P> * out, std::size_t count)
+	{
+		detail::mul_mat4_batch(&a[0][0][0], 16, &b[0][0][0], &out[0][0][0], count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void mulMatrices(tmat4x4<float, P> const & a, tmat4x4<float, P> const * b, tmat4x4<float, P> * out, std::size_t count)
+	{
+		// Copied: a may be one of the outputs, mulMatrices(m[0], m, m, n)
+		tmat4x4<float, P> const local(a);
+		detail::mul_mat4_batch(&local[0][0], 0, &b[0][0][0], &out[0][0][0], count);
+	}
+
+	template <precision P>
+	GLM_FUNC_QUALIFIER void composeWorldViewProj(tmat4x4<float, P> const & proj, tmat4x4<float, P> const & view,
+		tmat4x4<float, P> const * world, tmat4x4<float, P> * out, std::size_t count)
+	{
+		tmat4x4<float, P> const viewProj(proj * view);
+		mulMatrices(viewProj, world, out, count);
+	}
+}//namespace glm
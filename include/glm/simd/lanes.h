@@ -0,0 +1,388 @@
+/// @ref simd
+/// @file glm/simd/lanes.h
+
+#pragma once
+
+#include "platform.h"
+#include <cstring>
+
+// simd_lanes<N> wraps the SSE2, AVX2 and AVX-512 intrinsics for N float and
+// int32 lanes behind one set of names, so kernels are written once and
+// instantiated for each register width: arithmetic, compares, masks and
+// selects, conversions between float and int32 lanes, 8 and 16 bit integer
+// loads and stores, and half float loads with F16C. rows and unrows
+// transpose 3 or 4 floats per lane, small vectors or matrix columns, to and
+// from one register per component. batch_lanes is the widest one GLM_ARCH
+// enables.
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+namespace glm{
+namespace detail
+{
+	template <int Lanes>
+	struct simd_lanes{};
+
+	template <>
+	struct simd_lanes<4>
+	{
+		typedef __m128 vec;
+		typedef __m128i ivec;
+		typedef __m128 mask;
+		static const int size = 4;
+
+		static vec set1(float x){return _mm_set1_ps(x);}
+		static ivec iset1(int x){return _mm_set1_epi32(x);}
+		static vec load(float const* p){return _mm_loadu_ps(p);}
+		static void store(float* p, vec v){_mm_storeu_ps(p, v);}
+
+		static vec add(vec a, vec b){return _mm_add_ps(a, b);}
+		static vec sub(vec a, vec b){return _mm_sub_ps(a, b);}
+		static vec mul(vec a, vec b){return _mm_mul_ps(a, b);}
+		static vec div(vec a, vec b){return _mm_div_ps(a, b);}
+		static vec sqrt(vec a){return _mm_sqrt_ps(a);}
+		static vec min(vec a, vec b){return _mm_min_ps(a, b);}
+		static vec max(vec a, vec b){return _mm_max_ps(a, b);}
+		static vec floor(vec a)
+		{
+#			if GLM_ARCH & GLM_ARCH_SSE41_BIT
+				return _mm_floor_ps(a);
+#			else
+				// Truncate, step down where that rounded up; from 2^23 on floats are integers
+				vec const t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+				vec const f = _mm_sub_ps(t, _mm_and_ps(_mm_cmplt_ps(a, t), _mm_set1_ps(1.0f)));
+				return select(_mm_cmplt_ps(abs(a), _mm_set1_ps(8388608.0f)), f, a);
+#			endif
+		}
+		static vec madd(vec a, vec b, vec c)
+		{
+#			if defined(__FMA__)
+				return _mm_fmadd_ps(a, b, c);
+#			else
+				return _mm_add_ps(_mm_mul_ps(a, b), c);
+#			endif
+		}
+
+		static vec bxor(vec a, vec b){return _mm_xor_ps(a, b);}
+		static vec band(vec a, vec b){return _mm_and_ps(a, b);}
+		static vec abs(vec a){return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);}
+		static vec sign(vec a){return _mm_and_ps(_mm_set1_ps(-0.0f), a);}
+
+		static mask lt(vec a, vec b){return _mm_cmplt_ps(a, b);}
+		static mask le(vec a, vec b){return _mm_cmple_ps(a, b);}
+		static mask eq(vec a, vec b){return _mm_cmpeq_ps(a, b);}
+		static mask neq(vec a, vec b){return _mm_cmpneq_ps(a, b);}
+		static mask ieq(ivec a, ivec b){return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b));}
+		static mask mor(mask a, mask b){return _mm_or_ps(a, b);}
+		static mask mand(mask a, mask b){return _mm_and_ps(a, b);}
+		static int bits(mask m){return _mm_movemask_ps(m);}
+		static vec select(mask m, vec a, vec b){return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));}
+
+		static ivec round(vec a){return _mm_cvtps_epi32(a);}
+		static vec tofloat(ivec a){return _mm_cvtepi32_ps(a);}
+		static ivec iadd(ivec a, ivec b){return _mm_add_epi32(a, b);}
+		static ivec isub(ivec a, ivec b){return _mm_sub_epi32(a, b);}
+		static ivec iand(ivec a, ivec b){return _mm_and_si128(a, b);}
+		static ivec ior(ivec a, ivec b){return _mm_or_si128(a, b);}
+		static ivec ixor(ivec a, ivec b){return _mm_xor_si128(a, b);}
+		static ivec iload(unsigned int const* p){return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));}
+		static void istore(unsigned int* p, ivec v){_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);}
+		static ivec shl(ivec a, int n){return _mm_slli_epi32(a, n);}
+		static ivec shr(ivec a, int n){return _mm_srli_epi32(a, n);}
+		static vec asfloat(ivec a){return _mm_castsi128_ps(a);}
+		static ivec asint(vec a){return _mm_castps_si128(a);}
+
+		// Narrow loads zero extend, narrow stores keep the low bits of each lane
+		static ivec trunc(vec a){return _mm_cvttps_epi32(a);}
+		static ivec iload16(unsigned short const* p){return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)), _mm_setzero_si128());}
+		static void istore16(unsigned short* p, ivec v)
+		{
+			// Sign extending the low half first keeps the saturating pack exact
+			__m128i const w = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(w, w));
+		}
+		static void istore8(unsigned char* p, ivec v)
+		{
+			__m128i const w = _mm_packs_epi32(_mm_and_si128(v, _mm_set1_epi32(0xFF)), _mm_setzero_si128());
+			int const b = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+			memcpy(p, &b, sizeof(b));
+		}
+#		if defined(__F16C__)
+			static vec loadhalf(unsigned short const* p){return _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p)));}
+#		endif
+
+		// rows reads size floats, 3 or 4, at p + j * stride into lane j of
+		// v[0] to v[size - 1], unrows writes them back: a structure of arrays
+		// view of small vectors or matrix columns.
+		static __m128 row(float const* p, int size)
+		{
+			if(size == 4)
+				return _mm_loadu_ps(p);
+			return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<double const*>(p))), _mm_load_ss(p + 2));
+		}
+		static void unrow(float* p, __m128 v, int size)
+		{
+			if(size == 4)
+				_mm_storeu_ps(p, v);
+			else
+			{
+				_mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+				_mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+			}
+		}
+		static void transpose(vec & a, vec & b, vec & c, vec & d){_MM_TRANSPOSE4_PS(a, b, c, d);}
+		static void rows(float const* p, int stride, int size, vec* v)
+		{
+			vec a = row(p, size), b = row(p + stride, size), c = row(p + 2 * stride, size), d = row(p + 3 * stride, size);
+			transpose(a, b, c, d);
+			v[0] = a; v[1] = b; v[2] = c;
+			if(size == 4)
+				v[3] = d;
+		}
+		static void unrows(float* p, int stride, int size, vec const* v)
+		{
+			vec a = v[0], b = v[1], c = v[2], d = size == 4 ? v[3] : _mm_setzero_ps();
+			transpose(a, b, c, d);
+			unrow(p, a, size);
+			unrow(p + stride, b, size);
+			unrow(p + 2 * stride, c, size);
+			unrow(p + 3 * stride, d, size);
+		}
+	};
+
+#	if GLM_ARCH & GLM_ARCH_AVX2_BIT
+	template <>
+	struct simd_lanes<8>
+	{
+		typedef __m256 vec;
+		typedef __m256i ivec;
+		typedef __m256 mask;
+		static const int size = 8;
+
+		static vec set1(float x){return _mm256_set1_ps(x);}
+		static ivec iset1(int x){return _mm256_set1_epi32(x);}
+		static vec load(float const* p){return _mm256_loadu_ps(p);}
+		static void store(float* p, vec v){_mm256_storeu_ps(p, v);}
+
+		static vec add(vec a, vec b){return _mm256_add_ps(a, b);}
+		static vec sub(vec a, vec b){return _mm256_sub_ps(a, b);}
+		static vec mul(vec a, vec b){return _mm256_mul_ps(a, b);}
+		static vec div(vec a, vec b){return _mm256_div_ps(a, b);}
+		static vec sqrt(vec a){return _mm256_sqrt_ps(a);}
+		static vec min(vec a, vec b){return _mm256_min_ps(a, b);}
+		static vec max(vec a, vec b){return _mm256_max_ps(a, b);}
+		static vec floor(vec a){return _mm256_floor_ps(a);}
+		static vec madd(vec a, vec b, vec c)
+		{
+#			if defined(__FMA__)
+				return _mm256_fmadd_ps(a, b, c);
+#			else
+				return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#			endif
+		}
+
+		static vec bxor(vec a, vec b){return _mm256_xor_ps(a, b);}
+		static vec band(vec a, vec b){return _mm256_and_ps(a, b);}
+		static vec abs(vec a){return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);}
+		static vec sign(vec a){return _mm256_and_ps(_mm256_set1_ps(-0.0f), a);}
+
+		static mask lt(vec a, vec b){return _mm256_cmp_ps(a, b, _CMP_LT_OQ);}
+		static mask le(vec a, vec b){return _mm256_cmp_ps(a, b, _CMP_LE_OQ);}
+		static mask eq(vec a, vec b){return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);}
+		static mask neq(vec a, vec b){return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ);}
+		static mask ieq(ivec a, ivec b){return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b));}
+		static mask mor(mask a, mask b){return _mm256_or_ps(a, b);}
+		static mask mand(mask a, mask b){return _mm256_and_ps(a, b);}
+		static int bits(mask m){return _mm256_movemask_ps(m);}
+		static vec select(mask m, vec a, vec b){return _mm256_blendv_ps(b, a, m);}
+
+		static ivec round(vec a){return _mm256_cvtps_epi32(a);}
+		static vec tofloat(ivec a){return _mm256_cvtepi32_ps(a);}
+		static ivec iadd(ivec a, ivec b){return _mm256_add_epi32(a, b);}
+		static ivec isub(ivec a, ivec b){return _mm256_sub_epi32(a, b);}
+		static ivec iand(ivec a, ivec b){return _mm256_and_si256(a, b);}
+		static ivec ior(ivec a, ivec b){return _mm256_or_si256(a, b);}
+		static ivec ixor(ivec a, ivec b){return _mm256_xor_si256(a, b);}
+		static ivec iload(unsigned int const* p){return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));}
+		static void istore(unsigned int* p, ivec v){_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);}
+		static ivec shl(ivec a, int n){return _mm256_slli_epi32(a, n);}
+		static ivec shr(ivec a, int n){return _mm256_srli_epi32(a, n);}
+		static vec asfloat(ivec a){return _mm256_castsi256_ps(a);}
+		static ivec asint(vec a){return _mm256_castps_si256(a);}
+
+		static ivec trunc(vec a){return _mm256_cvttps_epi32(a);}
+		static ivec iload16(unsigned short const* p){return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));}
+		static void istore16(unsigned short* p, ivec v)
+		{
+			__m256i const w = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1)));
+		}
+		static void istore8(unsigned char* p, ivec v)
+		{
+			__m256i const w = _mm256_and_si256(v, _mm256_set1_epi32(0xFF));
+			__m128i const h = _mm_packs_epi32(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(h, h));
+		}
+#		if defined(__F16C__)
+			static vec loadhalf(unsigned short const* p){return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)));}
+#		endif
+
+		// 4 * 4 transposes within each 128 bit half, lanes 4 to 7 take rows 4 to 7
+		static void transpose(vec & a, vec & b, vec & c, vec & d)
+		{
+			__m256 const t0 = _mm256_unpacklo_ps(a, b);
+			__m256 const t1 = _mm256_unpackhi_ps(a, b);
+			__m256 const t2 = _mm256_unpacklo_ps(c, d);
+			__m256 const t3 = _mm256_unpackhi_ps(c, d);
+			a = _mm256_shuffle_ps(t0, t2, 0x44);
+			b = _mm256_shuffle_ps(t0, t2, 0xEE);
+			c = _mm256_shuffle_ps(t1, t3, 0x44);
+			d = _mm256_shuffle_ps(t1, t3, 0xEE);
+		}
+		static vec row(float const* p, int stride, int size)
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(simd_lanes<4>::row(p, size)), simd_lanes<4>::row(p + 4 * stride, size), 1);
+		}
+		static void unrow(float* p, int stride, vec v, int size)
+		{
+			simd_lanes<4>::unrow(p, _mm256_castps256_ps128(v), size);
+			simd_lanes<4>::unrow(p + 4 * stride, _mm256_extractf128_ps(v, 1), size);
+		}
+		static void rows(float const* p, int stride, int size, vec* v)
+		{
+			vec a = row(p, stride, size), b = row(p + stride, stride, size), c = row(p + 2 * stride, stride, size), d = row(p + 3 * stride, stride, size);
+			transpose(a, b, c, d);
+			v[0] = a; v[1] = b; v[2] = c;
+			if(size == 4)
+				v[3] = d;
+		}
+		static void unrows(float* p, int stride, int size, vec const* v)
+		{
+			vec a = v[0], b = v[1], c = v[2], d = size == 4 ? v[3] : _mm256_setzero_ps();
+			transpose(a, b, c, d);
+			unrow(p, stride, a, size);
+			unrow(p + stride, stride, b, size);
+			unrow(p + 2 * stride, stride, c, size);
+			unrow(p + 3 * stride, stride, d, size);
+		}
+	};
+#	endif//GLM_ARCH & GLM_ARCH_AVX2_BIT
+
+	// GLM_ARCH_AVX512_BIT shares its value with GLM_ARCH_ARM_BIT
+#	if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+	template <>
+	struct simd_lanes<16>
+	{
+		typedef __m512 vec;
+		typedef __m512i ivec;
+		typedef __mmask16 mask;
+		static const int size = 16;
+
+		static vec set1(float x){return _mm512_set1_ps(x);}
+		static ivec iset1(int x){return _mm512_set1_epi32(x);}
+		static vec load(float const* p){return _mm512_loadu_ps(p);}
+		static void store(float* p, vec v){_mm512_storeu_ps(p, v);}
+
+		static vec add(vec a, vec b){return _mm512_add_ps(a, b);}
+		static vec sub(vec a, vec b){return _mm512_sub_ps(a, b);}
+		static vec mul(vec a, vec b){return _mm512_mul_ps(a, b);}
+		static vec div(vec a, vec b){return _mm512_div_ps(a, b);}
+		static vec sqrt(vec a){return _mm512_sqrt_ps(a);}
+		static vec min(vec a, vec b){return _mm512_min_ps(a, b);}
+		static vec max(vec a, vec b){return _mm512_max_ps(a, b);}
+		static vec floor(vec a){return _mm512_floor_ps(a);}
+		static vec madd(vec a, vec b, vec c){return _mm512_fmadd_ps(a, b, c);}
+
+		static vec bxor(vec a, vec b){return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));}
+		static vec band(vec a, vec b){return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));}
+		static vec abs(vec a){return band(a, asfloat(_mm512_set1_epi32(0x7FFFFFFF)));}
+		static vec sign(vec a){return band(a, _mm512_set1_ps(-0.0f));}
+
+		static mask lt(vec a, vec b){return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);}
+		static mask le(vec a, vec b){return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ);}
+		static mask eq(vec a, vec b){return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);}
+		static mask neq(vec a, vec b){return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ);}
+		static mask ieq(ivec a, ivec b){return _mm512_cmpeq_epi32_mask(a, b);}
+		static mask mor(mask a, mask b){return static_cast<mask>(a | b);}
+		static mask mand(mask a, mask b){return static_cast<mask>(a & b);}
+		static int bits(mask m){return static_cast<int>(m);}
+		static vec select(mask m, vec a, vec b){return _mm512_mask_blend_ps(m, b, a);}
+
+		static ivec round(vec a){return _mm512_cvtps_epi32(a);}
+		static vec tofloat(ivec a){return _mm512_cvtepi32_ps(a);}
+		static ivec iadd(ivec a, ivec b){return _mm512_add_epi32(a, b);}
+		static ivec isub(ivec a, ivec b){return _mm512_sub_epi32(a, b);}
+		static ivec iand(ivec a, ivec b){return _mm512_and_si512(a, b);}
+		static ivec ior(ivec a, ivec b){return _mm512_or_si512(a, b);}
+		static ivec ixor(ivec a, ivec b){return _mm512_xor_si512(a, b);}
+		static ivec iload(unsigned int const* p){return _mm512_loadu_si512(p);}
+		static void istore(unsigned int* p, ivec v){_mm512_storeu_si512(p, v);}
+		static ivec shl(ivec a, int n){return _mm512_slli_epi32(a, static_cast<unsigned int>(n));}
+		static ivec shr(ivec a, int n){return _mm512_srli_epi32(a, static_cast<unsigned int>(n));}
+		static vec asfloat(ivec a){return _mm512_castsi512_ps(a);}
+		static ivec asint(vec a){return _mm512_castps_si512(a);}
+
+		static ivec trunc(vec a){return _mm512_cvttps_epi32(a);}
+		static ivec iload16(unsigned short const* p){return _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)));}
+		static void istore16(unsigned short* p, ivec v){_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi32_epi16(v));}
+		static void istore8(unsigned char* p, ivec v){_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi32_epi8(v));}
+		static vec loadhalf(unsigned short const* p){return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)));}
+
+		// 4 * 4 transposes within each 128 bit quarter, quarter k takes rows 4 * k to 4 * k + 3
+		static void transpose(vec & a, vec & b, vec & c, vec & d)
+		{
+			__m512 const t0 = _mm512_unpacklo_ps(a, b);
+			__m512 const t1 = _mm512_unpackhi_ps(a, b);
+			__m512 const t2 = _mm512_unpacklo_ps(c, d);
+			__m512 const t3 = _mm512_unpackhi_ps(c, d);
+			a = _mm512_shuffle_ps(t0, t2, 0x44);
+			b = _mm512_shuffle_ps(t0, t2, 0xEE);
+			c = _mm512_shuffle_ps(t1, t3, 0x44);
+			d = _mm512_shuffle_ps(t1, t3, 0xEE);
+		}
+		static vec row(float const* p, int stride, int size)
+		{
+			__m512 const r = _mm512_castps128_ps512(simd_lanes<4>::row(p, size));
+			__m512 const s = _mm512_insertf32x4(r, simd_lanes<4>::row(p + 4 * stride, size), 1);
+			__m512 const t = _mm512_insertf32x4(s, simd_lanes<4>::row(p + 8 * stride, size), 2);
+			return _mm512_insertf32x4(t, simd_lanes<4>::row(p + 12 * stride, size), 3);
+		}
+		static void unrow(float* p, int stride, vec v, int size)
+		{
+			simd_lanes<4>::unrow(p, _mm512_castps512_ps128(v), size);
+			simd_lanes<4>::unrow(p + 4 * stride, _mm512_extractf32x4_ps(v, 1), size);
+			simd_lanes<4>::unrow(p + 8 * stride, _mm512_extractf32x4_ps(v, 2), size);
+			simd_lanes<4>::unrow(p + 12 * stride, _mm512_extractf32x4_ps(v, 3), size);
+		}
+		static void rows(float const* p, int stride, int size, vec* v)
+		{
+			vec a = row(p, stride, size), b = row(p + stride, stride, size), c = row(p + 2 * stride, stride, size), d = row(p + 3 * stride, stride, size);
+			transpose(a, b, c, d);
+			v[0] = a; v[1] = b; v[2] = c;
+			if(size == 4)
+				v[3] = d;
+		}
+		static void unrows(float* p, int stride, int size, vec const* v)
+		{
+			vec a = v[0], b = v[1], c = v[2], d = size == 4 ? v[3] : _mm512_setzero_ps();
+			transpose(a, b, c, d);
+			unrow(p, stride, a, size);
+			unrow(p + stride, stride, b, size);
+			unrow(p + 2 * stride, stride, c, size);
+			unrow(p + 3 * stride, stride, d, size);
+		}
+	};
+#	endif//(GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+
+#	if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+		typedef simd_lanes<16> batch_lanes;
+#	elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+		typedef simd_lanes<8> batch_lanes;
+#	else
+		typedef simd_lanes<4> batch_lanes;
+#	endif
+	typedef batch_lanes::vec batch_vec;
+}//namespace detail
+}//namespace glm
+
+#endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
@@ -946,77 +946,90 @@ GLM_FUNC_QUALIFIER void glm_mat4_inverse_lowp(glm_vec4 const in[4], glm_vec4 out
 	out[2] = _mm_mul_ps(Inv2, Rcp0);
 	out[3] = _mm_mul_ps(Inv3, Rcp0);
 }
-/*
-GLM_FUNC_QUALIFIER void glm_mat4_rotate(__m128 const in[4], float Angle, float const v[3], __m128 out[4])
+
+// Result[3] = in[0] * v[0] + in[1] * v[1] + in[2] * v[2] + in[3], in the same
+// order as the scalar translate so both paths round identically, unless the
+// compiler fuses either into FMAs (see -ffp-contract).
+GLM_FUNC_QUALIFIER void glm_mat4_translate(glm_vec4 const in[4], glm_vec4 v, glm_vec4 out[4])
+{
+	__m128 const v0 = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 const v1 = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 const v2 = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+
+	__m128 const a0 = _mm_add_ps(_mm_mul_ps(in[0], v0), _mm_mul_ps(in[1], v1));
+	__m128 const a1 = _mm_add_ps(a0, _mm_mul_ps(in[2], v2));
+
+	out[0] = in[0];
+	out[1] = in[1];
+	out[2] = in[2];
+	out[3] = _mm_add_ps(a1, in[3]);
+}
+
+GLM_FUNC_QUALIFIER void glm_mat4_scale(glm_vec4 const in[4], glm_vec4 v, glm_vec4 out[4])
 {
-	float a = glm::radians(Angle);
-	float c = cos(a);
-	float s = sin(a);
-
-	glm::vec4 AxisA(v[0], v[1], v[2], float(0));
-	__m128 AxisB = _mm_set_ps(AxisA.w, AxisA.z, AxisA.y, AxisA.x);
-	__m128 AxisC = detail::sse_nrm_ps(AxisB);
-
-	__m128 Cos0 = _mm_set_ss(c);
-	__m128 CosA = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(0, 0, 0, 0));
-	__m128 Sin0 = _mm_set_ss(s);
-	__m128 SinA = _mm_shuffle_ps(Sin0, Sin0, _MM_SHUFFLE(0, 0, 0, 0));
-
-	// tvec3<T, P> temp = (valType(1) - c) * axis;
-	__m128 Temp0 = _mm_sub_ps(one, CosA);
-	__m128 Temp1 = _mm_mul_ps(Temp0, AxisC);
-	
-	//Rotate[0][0] = c + temp[0] * axis[0];
-	//Rotate[0][1] = 0 + temp[0] * axis[1] + s * axis[2];
-	//Rotate[0][2] = 0 + temp[0] * axis[2] - s * axis[1];
-	__m128 Axis0 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(0, 0, 0, 0));
-	__m128 TmpA0 = _mm_mul_ps(Axis0, AxisC);
-	__m128 CosA0 = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 1, 1, 0));
-	__m128 TmpA1 = _mm_add_ps(CosA0, TmpA0);
-	__m128 SinA0 = SinA;//_mm_set_ps(0.0f, s, -s, 0.0f);
-	__m128 TmpA2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(3, 1, 2, 3));
-	__m128 TmpA3 = _mm_mul_ps(SinA0, TmpA2);
-	__m128 TmpA4 = _mm_add_ps(TmpA1, TmpA3);
-
-	//Rotate[1][0] = 0 + temp[1] * axis[0] - s * axis[2];
-	//Rotate[1][1] = c + temp[1] * axis[1];
-	//Rotate[1][2] = 0 + temp[1] * axis[2] + s * axis[0];
-	__m128 Axis1 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(1, 1, 1, 1));
-	__m128 TmpB0 = _mm_mul_ps(Axis1, AxisC);
-	__m128 CosA1 = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 1, 0, 1));
-	__m128 TmpB1 = _mm_add_ps(CosA1, TmpB0);
-	__m128 SinB0 = SinA;//_mm_set_ps(-s, 0.0f, s, 0.0f);
-	__m128 TmpB2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(3, 0, 3, 2));
-	__m128 TmpB3 = _mm_mul_ps(SinA0, TmpB2);
-	__m128 TmpB4 = _mm_add_ps(TmpB1, TmpB3);
-
-	//Rotate[2][0] = 0 + temp[2] * axis[0] + s * axis[1];
-	//Rotate[2][1] = 0 + temp[2] * axis[1] - s * axis[0];
-	//Rotate[2][2] = c + temp[2] * axis[2];
-	__m128 Axis2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(2, 2, 2, 2));
-	__m128 TmpC0 = _mm_mul_ps(Axis2, AxisC);
-	__m128 CosA2 = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 0, 1, 1));
-	__m128 TmpC1 = _mm_add_ps(CosA2, TmpC0);
-	__m128 SinC0 = SinA;//_mm_set_ps(s, -s, 0.0f, 0.0f);
-	__m128 TmpC2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(3, 3, 0, 1));
-	__m128 TmpC3 = _mm_mul_ps(SinA0, TmpC2);
-	__m128 TmpC4 = _mm_add_ps(TmpC1, TmpC3);
-
-	__m128 Result[4];
-	Result[0] = TmpA4;
-	Result[1] = TmpB4;
-	Result[2] = TmpC4;
-	Result[3] = _mm_set_ps(1, 0, 0, 0);
-
-	//tmat4x4<valType> Result(uninitialize);
-	//Result[0] = m[0] * Rotate[0][0] + m[1] * Rotate[0][1] + m[2] * Rotate[0][2];
-	//Result[1] = m[0] * Rotate[1][0] + m[1] * Rotate[1][1] + m[2] * Rotate[1][2];
-	//Result[2] = m[0] * Rotate[2][0] + m[1] * Rotate[2][1] + m[2] * Rotate[2][2];
-	//Result[3] = m[3];
-	//return Result;
-	sse_mul_ps(in, Result, out);
+	out[0] = _mm_mul_ps(in[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+	out[1] = _mm_mul_ps(in[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+	out[2] = _mm_mul_ps(in[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+	out[3] = in[3];
 }
-*/
+
+// 'axis' must be normalized with w = 0, 'c' and 's' are the cosine and sine of the angle.
+GLM_FUNC_QUALIFIER void glm_mat4_rotate(glm_vec4 const in[4], float c, float s, glm_vec4 axis, glm_vec4 out[4])
+{
+	__m128 const CosA = _mm_set1_ps(c);
+	__m128 const Temp = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), CosA), axis);
+	__m128 const SinA = _mm_mul_ps(_mm_set1_ps(s), axis);
+	__m128 const Zero = _mm_setzero_ps();
+
+	//Rotate[0] = temp[0] * axis + vec3(c, s * axis[2], -s * axis[1])
+	//Rotate[1] = temp[1] * axis + vec3(-s * axis[2], c, s * axis[0])
+	//Rotate[2] = temp[2] * axis + vec3(s * axis[1], -s * axis[0], c)
+	__m128 const SinB0 = _mm_xor_ps(_mm_shuffle_ps(SinA, SinA, _MM_SHUFFLE(3, 1, 2, 3)), _mm_setr_ps(0.0f, 0.0f, -0.0f, 0.0f));
+	__m128 const SinB1 = _mm_xor_ps(_mm_shuffle_ps(SinA, SinA, _MM_SHUFFLE(3, 0, 3, 2)), _mm_setr_ps(-0.0f, 0.0f, 0.0f, 0.0f));
+	__m128 const SinB2 = _mm_xor_ps(_mm_shuffle_ps(SinA, SinA, _MM_SHUFFLE(3, 3, 0, 1)), _mm_setr_ps(0.0f, -0.0f, 0.0f, 0.0f));
+
+	__m128 const Diag0 = _mm_add_ps(SinB0, _mm_move_ss(Zero, CosA));
+	__m128 const Diag1 = _mm_add_ps(SinB1, _mm_shuffle_ps(_mm_unpacklo_ps(Zero, CosA), Zero, _MM_SHUFFLE(0, 0, 1, 0)));
+	__m128 const Diag2 = _mm_add_ps(SinB2, _mm_shuffle_ps(Zero, _mm_move_ss(Zero, CosA), _MM_SHUFFLE(1, 0, 0, 0)));
+
+	__m128 Rotate[3];
+	Rotate[0] = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(Temp, Temp, _MM_SHUFFLE(0, 0, 0, 0)), axis), Diag0);
+	Rotate[1] = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(Temp, Temp, _MM_SHUFFLE(1, 1, 1, 1)), axis), Diag1);
+	Rotate[2] = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(Temp, Temp, _MM_SHUFFLE(2, 2, 2, 2)), axis), Diag2);
+
+	//Result[i] = m[0] * Rotate[i][0] + m[1] * Rotate[i][1] + m[2] * Rotate[i][2];
+	for(int i = 0; i < 3; ++i)
+	{
+		__m128 const r = Rotate[i];
+		__m128 const a0 = _mm_add_ps(
+			_mm_mul_ps(in[0], _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0))),
+			_mm_mul_ps(in[1], _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1))));
+		out[i] = _mm_add_ps(a0, _mm_mul_ps(in[2], _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2))));
+	}
+	out[3] = in[3];
+}
+
+// View matrix from the orthonormal side, up and backward axes (w = 0)
+// and the eye position: the axes become rows, the eye is moved to the origin.
+GLM_FUNC_QUALIFIER void glm_mat4_lookAt(glm_vec4 s, glm_vec4 u, glm_vec4 b, glm_vec4 eye, glm_vec4 out[4])
+{
+	__m128 const t0 = _mm_unpacklo_ps(s, u); // s.x u.x s.y u.y
+	__m128 const t1 = _mm_unpackhi_ps(s, u); // s.z u.z 0 0
+	__m128 const t2 = _mm_unpacklo_ps(b, _mm_setzero_ps()); // b.x 0 b.y 0
+	__m128 const t3 = _mm_unpackhi_ps(b, _mm_setzero_ps()); // b.z 0 0 0
+
+	out[0] = _mm_movelh_ps(t0, t2);
+	out[1] = _mm_movehl_ps(t2, t0);
+	out[2] = _mm_movelh_ps(t1, t3);
+
+	__m128 const d = _mm_add_ps(
+		_mm_add_ps(
+			_mm_mul_ps(out[0], _mm_shuffle_ps(eye, eye, _MM_SHUFFLE(0, 0, 0, 0))),
+			_mm_mul_ps(out[1], _mm_shuffle_ps(eye, eye, _MM_SHUFFLE(1, 1, 1, 1)))),
+		_mm_mul_ps(out[2], _mm_shuffle_ps(eye, eye, _MM_SHUFFLE(2, 2, 2, 2))));
+	out[3] = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), d);
+}
+
 GLM_FUNC_QUALIFIER void glm_mat4_outerProduct(__m128 const & c, __m128 const & r, __m128 out[4])
 {
 	out[0] = _mm_mul_ps(c, _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0)));
@@ -0,0 +1,500 @@
+/// @ref simd
+/// @file glm/simd/matrix_batch.h
+
+#pragma once
+
+#include "matrix.h"
+#include <cstddef>
+
+// Throughput kernels applying column-major 4x4 float matrices to arrays.
+// Every function handles any count, including the tail, and never reads or
+// writes past the end of its arrays. Points use w = 1, directions use w = 0.
+// Unaligned pointers are accepted and in place operation (in == out) is safe.
+//
+// The products and sums are those of glm's operator*, in the same order and
+// without fused multiply-adds, so the results match a loop of operator* bit
+// for bit as long as the compiler doesn't contract that loop into FMAs.
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+GLM_FUNC_QUALIFIER void glm_mat4_transform_vec3_one(float const m[16], float const* in, float* out, float w)
+{
+	__m128 const x = _mm_mul_ps(_mm_loadu_ps(m + 0), _mm_set1_ps(in[0]));
+	__m128 const y = _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(in[1]));
+	__m128 const z = _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(in[2]));
+	__m128 const t = _mm_mul_ps(_mm_loadu_ps(m + 12), _mm_set1_ps(w));
+	__m128 const r = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, t));
+
+	_mm_storel_pi(reinterpret_cast<__m64*>(out), r);
+	_mm_store_ss(out + 2, _mm_movehl_ps(r, r));
+}
+
+// pshufd rather than shufps: it doesn't overwrite its source, which saves
+// the register copy before every broadcast in SSE2 code
+GLM_FUNC_QUALIFIER __m128 glm_vec4_splat_x(__m128 v)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(0, 0, 0, 0)));
+}
+
+GLM_FUNC_QUALIFIER __m128 glm_vec4_splat_y(__m128 v)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(1, 1, 1, 1)));
+}
+
+GLM_FUNC_QUALIFIER __m128 glm_vec4_splat_z(__m128 v)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(2, 2, 2, 2)));
+}
+
+GLM_FUNC_QUALIFIER __m128 glm_vec4_splat_w(__m128 v)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(3, 3, 3, 3)));
+}
+
+// Four consecutive floats of a packed vec3 array belong to two points, the
+// first starting at p[0] and the next at p[3]. These load the same
+// component of both into the lanes of their floats: p[0] p[0] p[0] p[3],
+// p[0] p[0] p[3] p[3] or p[0] p[3] p[3] p[3].
+GLM_FUNC_QUALIFIER __m128 glm_vec3_spread_0001(float const* p)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(_mm_loadu_ps(p)), _MM_SHUFFLE(3, 0, 0, 0)));
+}
+
+GLM_FUNC_QUALIFIER __m128 glm_vec3_spread_0011(float const* p)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(_mm_loadu_ps(p)), _MM_SHUFFLE(3, 3, 0, 0)));
+}
+
+GLM_FUNC_QUALIFIER __m128 glm_vec3_spread_0111(float const* p)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(_mm_loadu_ps(p)), _MM_SHUFFLE(3, 3, 3, 0)));
+}
+
+// 4 points per iteration, computed where they are stored: the outputs
+// X0 Y0 Z0 X1, Y1 Z1 X2 Y2 and Z2 X3 Y3 Z3 use the matrix rows rotated to
+// match, and each of their x, y and z operands is one load and one shuffle.
+GLM_FUNC_QUALIFIER void glm_mat4_transform_vec3_batch(float const m[16], float const* in, float* out, std::size_t count, float w)
+{
+	float const t[3] = {m[12] * w, m[13] * w, m[14] * w};
+	__m128 const x0 = _mm_setr_ps(m[0], m[1], m[2], m[0]), y0 = _mm_setr_ps(m[4], m[5], m[6], m[4]);
+	__m128 const z0 = _mm_setr_ps(m[8], m[9], m[10], m[8]), t0 = _mm_setr_ps(t[0], t[1], t[2], t[0]);
+	__m128 const x1 = _mm_setr_ps(m[1], m[2], m[0], m[1]), y1 = _mm_setr_ps(m[5], m[6], m[4], m[5]);
+	__m128 const z1 = _mm_setr_ps(m[9], m[10], m[8], m[9]), t1 = _mm_setr_ps(t[1], t[2], t[0], t[1]);
+	__m128 const x2 = _mm_setr_ps(m[2], m[0], m[1], m[2]), y2 = _mm_setr_ps(m[6], m[4], m[5], m[6]);
+	__m128 const z2 = _mm_setr_ps(m[10], m[8], m[9], m[10]), t2 = _mm_setr_ps(t[2], t[0], t[1], t[2]);
+
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4, in += 12, out += 12)
+	{
+		__m128 const r0 = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x0, glm_vec3_spread_0001(in + 0)), _mm_mul_ps(y0, glm_vec3_spread_0001(in + 1))),
+			_mm_add_ps(_mm_mul_ps(z0, glm_vec3_spread_0001(in + 2)), t0));
+		__m128 const r1 = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x1, glm_vec3_spread_0011(in + 3)), _mm_mul_ps(y1, glm_vec3_spread_0011(in + 4))),
+			_mm_add_ps(_mm_mul_ps(z1, glm_vec3_spread_0011(in + 5)), t1));
+		__m128 const r2 = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x2, glm_vec3_spread_0111(in + 6)), _mm_mul_ps(y2, glm_vec3_spread_0111(in + 7))),
+			_mm_add_ps(_mm_mul_ps(z2, glm_vec3_spread_0111(in + 8)), t2));
+
+		_mm_storeu_ps(out + 0, r0);
+		_mm_storeu_ps(out + 4, r1);
+		_mm_storeu_ps(out + 8, r2);
+	}
+
+	for(; i < count; ++i, in += 3, out += 3)
+		glm_mat4_transform_vec3_one(m, in, out, w);
+}
+
+GLM_FUNC_QUALIFIER void glm_mat4_transform_vec4_batch(float const m[16], float const* in, float* out, std::size_t count)
+{
+	__m128 const c0 = _mm_loadu_ps(m + 0);
+	__m128 const c1 = _mm_loadu_ps(m + 4);
+	__m128 const c2 = _mm_loadu_ps(m + 8);
+	__m128 const c3 = _mm_loadu_ps(m + 12);
+
+	for(std::size_t i = 0; i < count; ++i, in += 4, out += 4)
+	{
+		__m128 const v = _mm_loadu_ps(in);
+		__m128 const a0 = _mm_add_ps(_mm_mul_ps(c0, glm_vec4_splat_x(v)), _mm_mul_ps(c1, glm_vec4_splat_y(v)));
+		__m128 const a1 = _mm_add_ps(_mm_mul_ps(c2, glm_vec4_splat_z(v)), _mm_mul_ps(c3, glm_vec4_splat_w(v)));
+		_mm_storeu_ps(out, _mm_add_ps(a0, a1));
+	}
+}
+
+// SoA layout: separate x, y, z input arrays. 'ow' may be null when the
+// projected w is not needed.
+GLM_FUNC_QUALIFIER void glm_mat4_transform_soa_batch(float const m[16],
+	float const* x, float const* y, float const* z,
+	float* ox, float* oy, float* oz, float* ow, std::size_t count, float w)
+{
+	__m128 const m00 = _mm_set1_ps(m[0]), m01 = _mm_set1_ps(m[1]), m02 = _mm_set1_ps(m[2]), m03 = _mm_set1_ps(m[3]);
+	__m128 const m10 = _mm_set1_ps(m[4]), m11 = _mm_set1_ps(m[5]), m12 = _mm_set1_ps(m[6]), m13 = _mm_set1_ps(m[7]);
+	__m128 const m20 = _mm_set1_ps(m[8]), m21 = _mm_set1_ps(m[9]), m22 = _mm_set1_ps(m[10]), m23 = _mm_set1_ps(m[11]);
+	__m128 const t0 = _mm_set1_ps(m[12] * w), t1 = _mm_set1_ps(m[13] * w), t2 = _mm_set1_ps(m[14] * w), t3 = _mm_set1_ps(m[15] * w);
+
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128 const vx = _mm_loadu_ps(x + i);
+		__m128 const vy = _mm_loadu_ps(y + i);
+		__m128 const vz = _mm_loadu_ps(z + i);
+
+		__m128 const rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, vx), _mm_mul_ps(m10, vy)), _mm_add_ps(_mm_mul_ps(m20, vz), t0));
+		__m128 const ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, vx), _mm_mul_ps(m11, vy)), _mm_add_ps(_mm_mul_ps(m21, vz), t1));
+		__m128 const rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, vx), _mm_mul_ps(m12, vy)), _mm_add_ps(_mm_mul_ps(m22, vz), t2));
+		if(ow)
+			_mm_storeu_ps(ow + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m03, vx), _mm_mul_ps(m13, vy)), _mm_add_ps(_mm_mul_ps(m23, vz), t3)));
+
+		_mm_storeu_ps(ox + i, rx);
+		_mm_storeu_ps(oy + i, ry);
+		_mm_storeu_ps(oz + i, rz);
+	}
+
+	for(; i < count; ++i)
+	{
+		float const vx = x[i], vy = y[i], vz = z[i];
+		ox[i] = (m[0] * vx + m[4] * vy) + (m[8] * vz + m[12] * w);
+		oy[i] = (m[1] * vx + m[5] * vy) + (m[9] * vz + m[13] * w);
+		oz[i] = (m[2] * vx + m[6] * vy) + (m[10] * vz + m[14] * w);
+		if(ow)
+			ow[i] = (m[3] * vx + m[7] * vy) + (m[11] * vz + m[15] * w);
+	}
+}
+
+// One column of a * b, summed left to right like operator*
+GLM_FUNC_QUALIFIER __m128 glm_mat4_mul_column(__m128 a0, __m128 a1, __m128 a2, __m128 a3, __m128 b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(a0, glm_vec4_splat_x(b)),
+		_mm_mul_ps(a1, glm_vec4_splat_y(b))),
+		_mm_mul_ps(a2, glm_vec4_splat_z(b))),
+		_mm_mul_ps(a3, glm_vec4_splat_w(b)));
+}
+
+// out[i] = a[i] * b[i]. 'strideA' is the distance in floats between two left
+// matrices: 16 for pairwise products, 0 to reuse a single left matrix.
+GLM_FUNC_QUALIFIER void glm_mat4_mul_batch(float const* a, std::size_t strideA, float const* b, float* out, std::size_t count)
+{
+	for(std::size_t i = 0; i < count; ++i, a += strideA, b += 16, out += 16)
+	{
+		__m128 const a0 = _mm_loadu_ps(a + 0);
+		__m128 const a1 = _mm_loadu_ps(a + 4);
+		__m128 const a2 = _mm_loadu_ps(a + 8);
+		__m128 const a3 = _mm_loadu_ps(a + 12);
+
+		__m128 const r0 = glm_mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b + 0));
+		__m128 const r1 = glm_mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b + 4));
+		__m128 const r2 = glm_mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b + 8));
+		__m128 const r3 = glm_mat4_mul_column(a0, a1, a2, a3, _mm_loadu_ps(b + 12));
+
+		_mm_storeu_ps(out + 0, r0);
+		_mm_storeu_ps(out + 4, r1);
+		_mm_storeu_ps(out + 8, r2);
+		_mm_storeu_ps(out + 12, r3);
+	}
+}
+
+#endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+
+GLM_FUNC_QUALIFIER __m256i glm_avx2_tail_mask(std::size_t count)
+{
+	return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+// Two of the SSE2 spreads side by side: the window at 'lo' in the low
+// half, the one at 'hi' in the high half, each with its own pattern.
+GLM_FUNC_QUALIFIER __m256 glm_vec3_spread_avx2(float const* lo, float const* hi, __m256i pattern)
+{
+	__m256 const v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+	return _mm256_permutevar_ps(v, pattern);
+}
+
+// 8 points per iteration, the SSE2 kernel on two halves at a time: the
+// three outputs hold X0 Y0 Z0 X1 Y1 Z1 X2 Y2, Z2 X3 .. X5 and Y5 Z5 .. Z7.
+GLM_FUNC_QUALIFIER void glm_mat4_transform_vec3_batch_avx2(float const m[16], float const* in, float* out, std::size_t count, float w)
+{
+	float const t[3] = {m[12] * w, m[13] * w, m[14] * w};
+	__m256 const x0 = _mm256_setr_ps(m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1]);
+	__m256 const y0 = _mm256_setr_ps(m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5]);
+	__m256 const z0 = _mm256_setr_ps(m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9]);
+	__m256 const t0 = _mm256_setr_ps(t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1]);
+	__m256 const x1 = _mm256_setr_ps(m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0]);
+	__m256 const y1 = _mm256_setr_ps(m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4]);
+	__m256 const z1 = _mm256_setr_ps(m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8]);
+	__m256 const t1 = _mm256_setr_ps(t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0]);
+	__m256 const x2 = _mm256_setr_ps(m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2]);
+	__m256 const y2 = _mm256_setr_ps(m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6]);
+	__m256 const z2 = _mm256_setr_ps(m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10]);
+	__m256 const t2 = _mm256_setr_ps(t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2]);
+
+	__m256i const p0 = _mm256_setr_epi32(0, 0, 0, 3, 0, 0, 3, 3);
+	__m256i const p1 = _mm256_setr_epi32(0, 3, 3, 3, 0, 0, 0, 3);
+	__m256i const p2 = _mm256_setr_epi32(0, 0, 3, 3, 0, 3, 3, 3);
+
+	std::size_t i = 0;
+	for(; i + 8 <= count; i += 8, in += 24, out += 24)
+	{
+		__m256 const r0 = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(x0, glm_vec3_spread_avx2(in + 0, in + 3, p0)), _mm256_mul_ps(y0, glm_vec3_spread_avx2(in + 1, in + 4, p0))),
+			_mm256_add_ps(_mm256_mul_ps(z0, glm_vec3_spread_avx2(in + 2, in + 5, p0)), t0));
+		__m256 const r1 = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(x1, glm_vec3_spread_avx2(in + 6, in + 12, p1)), _mm256_mul_ps(y1, glm_vec3_spread_avx2(in + 7, in + 13, p1))),
+			_mm256_add_ps(_mm256_mul_ps(z1, glm_vec3_spread_avx2(in + 8, in + 14, p1)), t1));
+		__m256 const r2 = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(x2, glm_vec3_spread_avx2(in + 15, in + 18, p2)), _mm256_mul_ps(y2, glm_vec3_spread_avx2(in + 16, in + 19, p2))),
+			_mm256_add_ps(_mm256_mul_ps(z2, glm_vec3_spread_avx2(in + 17, in + 20, p2)), t2));
+
+		_mm256_storeu_ps(out + 0, r0);
+		_mm256_storeu_ps(out + 8, r1);
+		_mm256_storeu_ps(out + 16, r2);
+	}
+
+	glm_mat4_transform_vec3_batch(m, in, out, count - i, w);
+}
+
+// 2 points per register, the matrix columns are broadcast to both lanes
+GLM_FUNC_QUALIFIER void glm_mat4_transform_vec4_batch_avx2(float const m[16], float const* in, float* out, std::size_t count)
+{
+	__m256 const c0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(m + 0));
+	__m256 const c1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(m + 4));
+	__m256 const c2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(m + 8));
+	__m256 const c3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(m + 12));
+
+	std::size_t i = 0;
+	for(; i + 4 <= count; i += 4, in += 16, out += 16)
+	{
+		__m256 const v0 = _mm256_loadu_ps(in + 0);
+		__m256 const v1 = _mm256_loadu_ps(in + 8);
+
+		__m256 const r0 = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(c0, _mm256_permute_ps(v0, 0x00)), _mm256_mul_ps(c1, _mm256_permute_ps(v0, 0x55))),
+			_mm256_add_ps(_mm256_mul_ps(c2, _mm256_permute_ps(v0, 0xAA)), _mm256_mul_ps(c3, _mm256_permute_ps(v0, 0xFF))));
+		__m256 const r1 = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(c0, _mm256_permute_ps(v1, 0x00)), _mm256_mul_ps(c1, _mm256_permute_ps(v1, 0x55))),
+			_mm256_add_ps(_mm256_mul_ps(c2, _mm256_permute_ps(v1, 0xAA)), _mm256_mul_ps(c3, _mm256_permute_ps(v1, 0xFF))));
+
+		_mm256_storeu_ps(out + 0, r0);
+		_mm256_storeu_ps(out + 8, r1);
+	}
+
+	glm_mat4_transform_vec4_batch(m, in, out, count - i);
+}
+
+GLM_FUNC_QUALIFIER void glm_mat4_transform_soa_batch_avx2(float const m[16],
+	float const* x, float const* y, float const* z,
+	float* ox, float* oy, float* oz, float* ow, std::size_t count, float w)
+{
+	__m256 const m00 = _mm256_set1_ps(m[0]), m01 = _mm256_set1_ps(m[1]), m02 = _mm256_set1_ps(m[2]), m03 = _mm256_set1_ps(m[3]);
+	__m256 const m10 = _mm256_set1_ps(m[4]), m11 = _mm256_set1_ps(m[5]), m12 = _mm256_set1_ps(m[6]), m13 = _mm256_set1_ps(m[7]);
+	__m256 const m20 = _mm256_set1_ps(m[8]), m21 = _mm256_set1_ps(m[9]), m22 = _mm256_set1_ps(m[10]), m23 = _mm256_set1_ps(m[11]);
+	__m256 const t0 = _mm256_set1_ps(m[12] * w), t1 = _mm256_set1_ps(m[13] * w), t2 = _mm256_set1_ps(m[14] * w), t3 = _mm256_set1_ps(m[15] * w);
+
+	for(std::size_t i = 0; i < count; i += 8)
+	{
+		bool const full = i + 8 <= count;
+		__m256i const mask = full ? _mm256_set1_epi32(-1) : glm_avx2_tail_mask(count - i);
+
+		__m256 const vx = full ? _mm256_loadu_ps(x + i) : _mm256_maskload_ps(x + i, mask);
+		__m256 const vy = full ? _mm256_loadu_ps(y + i) : _mm256_maskload_ps(y + i, mask);
+		__m256 const vz = full ? _mm256_loadu_ps(z + i) : _mm256_maskload_ps(z + i, mask);
+
+		__m256 const rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, vx), _mm256_mul_ps(m10, vy)), _mm256_add_ps(_mm256_mul_ps(m20, vz), t0));
+		__m256 const ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, vx), _mm256_mul_ps(m11, vy)), _mm256_add_ps(_mm256_mul_ps(m21, vz), t1));
+		__m256 const rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, vx), _mm256_mul_ps(m12, vy)), _mm256_add_ps(_mm256_mul_ps(m22, vz), t2));
+
+		if(full)
+		{
+			_mm256_storeu_ps(ox + i, rx);
+			_mm256_storeu_ps(oy + i, ry);
+			_mm256_storeu_ps(oz + i, rz);
+		}
+		else
+		{
+			_mm256_maskstore_ps(ox + i, mask, rx);
+			_mm256_maskstore_ps(oy + i, mask, ry);
+			_mm256_maskstore_ps(oz + i, mask, rz);
+		}
+
+		if(ow)
+		{
+			__m256 const rw = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m03, vx), _mm256_mul_ps(m13, vy)), _mm256_add_ps(_mm256_mul_ps(m23, vz), t3));
+			if(full)
+				_mm256_storeu_ps(ow + i, rw);
+			else
+				_mm256_maskstore_ps(ow + i, mask, rw);
+		}
+	}
+}
+
+// Columns j and j + 1 of a * b in the two lanes, summed like operator*
+GLM_FUNC_QUALIFIER __m256 glm_mat4_mul_columns_avx2(__m256 a0, __m256 a1, __m256 a2, __m256 a3, __m256 b)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+		_mm256_mul_ps(a0, _mm256_permute_ps(b, 0x00)),
+		_mm256_mul_ps(a1, _mm256_permute_ps(b, 0x55))),
+		_mm256_mul_ps(a2, _mm256_permute_ps(b, 0xAA))),
+		_mm256_mul_ps(a3, _mm256_permute_ps(b, 0xFF)));
+}
+
+// Half a product per register, two products per iteration
+GLM_FUNC_QUALIFIER void glm_mat4_mul_batch_avx2(float const* a, std::size_t strideA, float const* b, float* out, std::size_t count)
+{
+	std::size_t i = 0;
+	for(; i + 2 <= count; i += 2, a += strideA * 2, b += 32, out += 32)
+	{
+		float const* const a1 = a + strideA;
+		__m256 const p0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 0));
+		__m256 const p1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 4));
+		__m256 const p2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 8));
+		__m256 const p3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 12));
+		__m256 const q0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a1 + 0));
+		__m256 const q1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a1 + 4));
+		__m256 const q2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a1 + 8));
+		__m256 const q3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a1 + 12));
+
+		__m256 const r0 = glm_mat4_mul_columns_avx2(p0, p1, p2, p3, _mm256_loadu_ps(b + 0));
+		__m256 const r1 = glm_mat4_mul_columns_avx2(p0, p1, p2, p3, _mm256_loadu_ps(b + 8));
+		__m256 const r2 = glm_mat4_mul_columns_avx2(q0, q1, q2, q3, _mm256_loadu_ps(b + 16));
+		__m256 const r3 = glm_mat4_mul_columns_avx2(q0, q1, q2, q3, _mm256_loadu_ps(b + 24));
+
+		_mm256_storeu_ps(out + 0, r0);
+		_mm256_storeu_ps(out + 8, r1);
+		_mm256_storeu_ps(out + 16, r2);
+		_mm256_storeu_ps(out + 24, r3);
+	}
+
+	glm_mat4_mul_batch(a, strideA, b, out, count - i);
+}
+
+#endif//GLM_ARCH & GLM_ARCH_AVX2_BIT
+
+// GLM_ARCH_AVX512_BIT shares its value with GLM_ARCH_ARM_BIT
+#if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+
+// 16 points per iteration. Like SSE2 and AVX2, but the 16 output floats of
+// a register span six points whose components all fit one 16 float window,
+// so each operand is a single load and a single permute.
+GLM_FUNC_QUALIFIER void glm_mat4_transform_vec3_batch_avx512(float const m[16], float const* in, float* out, std::size_t count, float w)
+{
+	float const t[3] = {m[12] * w, m[13] * w, m[14] * w};
+	__m512 const x0 = _mm512_setr_ps(m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0]);
+	__m512 const y0 = _mm512_setr_ps(m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4]);
+	__m512 const z0 = _mm512_setr_ps(m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8]);
+	__m512 const t0 = _mm512_setr_ps(t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0]);
+	__m512 const x1 = _mm512_setr_ps(m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1]);
+	__m512 const y1 = _mm512_setr_ps(m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5]);
+	__m512 const z1 = _mm512_setr_ps(m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9]);
+	__m512 const t1 = _mm512_setr_ps(t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1]);
+	__m512 const x2 = _mm512_setr_ps(m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2], m[0], m[1], m[2]);
+	__m512 const y2 = _mm512_setr_ps(m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6], m[4], m[5], m[6]);
+	__m512 const z2 = _mm512_setr_ps(m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10], m[8], m[9], m[10]);
+	__m512 const t2 = _mm512_setr_ps(t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2], t[0], t[1], t[2]);
+
+	// Output register k starts at point 16 * k / 3, its window at 3 times that
+	__m512i const p0 = _mm512_setr_epi32(0, 0, 0, 3, 3, 3, 6, 6, 6, 9, 9, 9, 12, 12, 12, 15);
+	__m512i const p1 = _mm512_setr_epi32(0, 0, 3, 3, 3, 6, 6, 6, 9, 9, 9, 12, 12, 12, 15, 15);
+	__m512i const p2 = _mm512_setr_epi32(0, 3, 3, 3, 6, 6, 6, 9, 9, 9, 12, 12, 12, 15, 15, 15);
+
+	std::size_t i = 0;
+	for(; i + 16 <= count; i += 16, in += 48, out += 48)
+	{
+		__m512 const r0 = _mm512_add_ps(
+			_mm512_add_ps(_mm512_mul_ps(x0, _mm512_permutexvar_ps(p0, _mm512_loadu_ps(in + 0))), _mm512_mul_ps(y0, _mm512_permutexvar_ps(p0, _mm512_loadu_ps(in + 1)))),
+			_mm512_add_ps(_mm512_mul_ps(z0, _mm512_permutexvar_ps(p0, _mm512_loadu_ps(in + 2))), t0));
+		__m512 const r1 = _mm512_add_ps(
+			_mm512_add_ps(_mm512_mul_ps(x1, _mm512_permutexvar_ps(p1, _mm512_loadu_ps(in + 15))), _mm512_mul_ps(y1, _mm512_permutexvar_ps(p1, _mm512_loadu_ps(in + 16)))),
+			_mm512_add_ps(_mm512_mul_ps(z1, _mm512_permutexvar_ps(p1, _mm512_loadu_ps(in + 17))), t1));
+		__m512 const r2 = _mm512_add_ps(
+			_mm512_add_ps(_mm512_mul_ps(x2, _mm512_permutexvar_ps(p2, _mm512_loadu_ps(in + 30))), _mm512_mul_ps(y2, _mm512_permutexvar_ps(p2, _mm512_loadu_ps(in + 31)))),
+			_mm512_add_ps(_mm512_mul_ps(z2, _mm512_permutexvar_ps(p2, _mm512_loadu_ps(in + 32))), t2));
+
+		_mm512_storeu_ps(out + 0, r0);
+		_mm512_storeu_ps(out + 16, r1);
+		_mm512_storeu_ps(out + 32, r2);
+	}
+
+	glm_mat4_transform_vec3_batch_avx2(m, in, out, count - i, w);
+}
+
+// 4 points per register, the matrix columns are broadcast to all lanes
+GLM_FUNC_QUALIFIER void glm_mat4_transform_vec4_batch_avx512(float const m[16], float const* in, float* out, std::size_t count)
+{
+	__m512 const c0 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 0));
+	__m512 const c1 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 4));
+	__m512 const c2 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 8));
+	__m512 const c3 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 12));
+
+	for(std::size_t i = 0; i < count; i += 4, in += 16, out += 16)
+	{
+		std::size_t const n = count - i < 4 ? count - i : 4;
+		__mmask16 const k = static_cast<__mmask16>(n == 4 ? 0xFFFF : (1u << (n * 4)) - 1u);
+
+		__m512 const v = _mm512_maskz_loadu_ps(k, in);
+		__m512 const r = _mm512_add_ps(
+			_mm512_add_ps(_mm512_mul_ps(c0, _mm512_permute_ps(v, 0x00)), _mm512_mul_ps(c1, _mm512_permute_ps(v, 0x55))),
+			_mm512_add_ps(_mm512_mul_ps(c2, _mm512_permute_ps(v, 0xAA)), _mm512_mul_ps(c3, _mm512_permute_ps(v, 0xFF))));
+		_mm512_mask_storeu_ps(out, k, r);
+	}
+}
+
+GLM_FUNC_QUALIFIER void glm_mat4_transform_soa_batch_avx512(float const m[16],
+	float const* x, float const* y, float const* z,
+	float* ox, float* oy, float* oz, float* ow, std::size_t count, float w)
+{
+	__m512 const m00 = _mm512_set1_ps(m[0]), m01 = _mm512_set1_ps(m[1]), m02 = _mm512_set1_ps(m[2]), m03 = _mm512_set1_ps(m[3]);
+	__m512 const m10 = _mm512_set1_ps(m[4]), m11 = _mm512_set1_ps(m[5]), m12 = _mm512_set1_ps(m[6]), m13 = _mm512_set1_ps(m[7]);
+	__m512 const m20 = _mm512_set1_ps(m[8]), m21 = _mm512_set1_ps(m[9]), m22 = _mm512_set1_ps(m[10]), m23 = _mm512_set1_ps(m[11]);
+	__m512 const t0 = _mm512_set1_ps(m[12] * w), t1 = _mm512_set1_ps(m[13] * w), t2 = _mm512_set1_ps(m[14] * w), t3 = _mm512_set1_ps(m[15] * w);
+
+	for(std::size_t i = 0; i < count; i += 16)
+	{
+		std::size_t const n = count - i < 16 ? count - i : 16;
+		__mmask16 const k = static_cast<__mmask16>(n == 16 ? 0xFFFF : (1u << n) - 1u);
+
+		__m512 const vx = _mm512_maskz_loadu_ps(k, x + i);
+		__m512 const vy = _mm512_maskz_loadu_ps(k, y + i);
+		__m512 const vz = _mm512_maskz_loadu_ps(k, z + i);
+
+		_mm512_mask_storeu_ps(ox + i, k, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m00, vx), _mm512_mul_ps(m10, vy)), _mm512_add_ps(_mm512_mul_ps(m20, vz), t0)));
+		_mm512_mask_storeu_ps(oy + i, k, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m01, vx), _mm512_mul_ps(m11, vy)), _mm512_add_ps(_mm512_mul_ps(m21, vz), t1)));
+		_mm512_mask_storeu_ps(oz + i, k, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m02, vx), _mm512_mul_ps(m12, vy)), _mm512_add_ps(_mm512_mul_ps(m22, vz), t2)));
+		if(ow)
+			_mm512_mask_storeu_ps(ow + i, k, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(m03, vx), _mm512_mul_ps(m13, vy)), _mm512_add_ps(_mm512_mul_ps(m23, vz), t3)));
+	}
+}
+
+// The four columns of a * b side by side, summed like operator*
+GLM_FUNC_QUALIFIER __m512 glm_mat4_mul_avx512(float const* a, __m512 b)
+{
+	__m512 const a0 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 0));
+	__m512 const a1 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 4));
+	__m512 const a2 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 8));
+	__m512 const a3 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 12));
+
+	return _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(
+		_mm512_mul_ps(a0, _mm512_permute_ps(b, 0x00)),
+		_mm512_mul_ps(a1, _mm512_permute_ps(b, 0x55))),
+		_mm512_mul_ps(a2, _mm512_permute_ps(b, 0xAA))),
+		_mm512_mul_ps(a3, _mm512_permute_ps(b, 0xFF)));
+}
+
+// One product per register, two products per iteration
+GLM_FUNC_QUALIFIER void glm_mat4_mul_batch_avx512(float const* a, std::size_t strideA, float const* b, float* out, std::size_t count)
+{
+	std::size_t i = 0;
+	for(; i + 2 <= count; i += 2, a += strideA * 2, b += 32, out += 32)
+	{
+		__m512 const r0 = glm_mat4_mul_avx512(a, _mm512_loadu_ps(b + 0));
+		__m512 const r1 = glm_mat4_mul_avx512(a + strideA, _mm512_loadu_ps(b + 16));
+
+		_mm512_storeu_ps(out + 0, r0);
+		_mm512_storeu_ps(out + 16, r1);
+	}
+
+	if(i < count)
+		_mm512_storeu_ps(out, glm_mat4_mul_avx512(a, _mm512_loadu_ps(b)));
+}
+
+#endif//(GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
@@ -0,0 +1,466 @@
+/// @ref simd
+/// @file glm/simd/transcendental.h
+
+#pragma once
+
+#include "lanes.h"
+#include <limits>
+
+// Polynomial sin, cos, sincos, exp, log, pow and atan2 on 4 (SSE2), 8 (AVX2)
+// and 16 (AVX-512) float lanes. The algorithms are written once against
+// glm::detail::simd_lanes<N> of lanes.h and instantiated for each lane count.
+//
+// Two accuracy tiers, maximum errors measured against double precision libm:
+//
+// function  precise                               fast
+// sin, cos  1.5 ulp in [-pi, pi], 1e-7 absolute    1e-6 absolute
+// exp       1.3 ulp                               6e-6 relative
+// log       0.8 ulp                               2e-6 relative
+// pow       32 ulp for |y * log(x)| < 18          9e-6 relative
+// atan2     3.1 ulp                               5e-7 absolute
+//
+// pow is exp(y * log(x)) so its error grows with |y * log(x)|.
+// Beyond |x| = 8192 the sin/cos range reduction loses bits progressively.
+// exp flushes results under FLT_MIN to 0 and overflows to +inf, log
+// returns -inf for 0 and NaN for negative inputs, denormal log inputs are
+// treated as 0. pow is only defined for x >= 0 (NaN otherwise), pow(x, 0)
+// and pow(1, y) are 1 as in C, for NaN and infinities too. sin keeps the
+// sign of zero and sin, cos of infinities are NaN. atan2 follows C for
+// signed zeros and infinities, atan2(+-inf, -inf) = +-3pi/4 for instance.
+// Other NaN inputs propagate.
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+namespace glm{
+namespace detail
+{
+	// x reduced to r in [-pi/4, pi/4] and the quadrant j such that x = j * pi/2 + r,
+	// pi/2 is split in three parts (Cody-Waite) so the subtraction stays exact.
+	template <int N, bool Fast>
+	GLM_FUNC_QUALIFIER void simd_sincos(typename simd_lanes<N>::vec x, typename simd_lanes<N>::vec & s, typename simd_lanes<N>::vec & c)
+	{
+		typedef simd_lanes<N> L;
+		typedef typename L::vec V;
+
+		typename L::ivec const j = L::round(L::mul(x, L::set1(0.636619772367581343f)));
+		V const fj = L::tofloat(j);
+		V r = L::madd(fj, L::set1(-1.5703125f), x);
+		r = L::madd(fj, L::set1(-4.837512969970703125e-4f), r);
+		r = L::madd(fj, L::set1(-7.549789948768648e-8f), r);
+		V const z = L::mul(r, r);
+
+		V ps, pc;
+		if(Fast)
+		{
+			ps = L::madd(L::mul(L::madd(z, L::set1(8.15299234e-3f), L::set1(-1.66628338e-1f)), z), r, r);
+			pc = L::madd(z, L::set1(-1.36524502e-3f), L::set1(4.16612786e-2f));
+			pc = L::madd(L::mul(pc, z), z, L::madd(z, L::set1(-0.5f), L::set1(1.0f)));
+		}
+		else
+		{
+			ps = L::madd(z, L::set1(-1.9515295891e-4f), L::set1(8.3321608736e-3f));
+			ps = L::madd(ps, z, L::set1(-1.6666654611e-1f));
+			ps = L::madd(L::mul(ps, z), r, r);
+
+			pc = L::madd(z, L::set1(2.443315711809948e-5f), L::set1(-1.388731625493765e-3f));
+			pc = L::madd(pc, z, L::set1(4.166664568298827e-2f));
+			pc = L::madd(L::mul(pc, z), z, L::madd(z, L::set1(-0.5f), L::set1(1.0f)));
+		}
+
+		// Odd quadrants swap sin and cos, quadrants 2 and 3 negate sin, 1 and 2 negate cos
+		typename L::mask const swap = L::ieq(L::iand(j, L::iset1(1)), L::iset1(1));
+		V const signS = L::asfloat(L::shl(L::iand(j, L::iset1(2)), 30));
+		V const signC = L::asfloat(L::shl(L::iand(L::iadd(j, L::iset1(1)), L::iset1(2)), 30));
+
+		// r + r * z * p rounds -0 to +0, zero inputs are their own sine.
+		// Infinities reduce to garbage, x - x turns them and NaNs into NaN.
+		typename L::mask const finite = L::lt(L::abs(x), L::set1(std::numeric_limits<float>::infinity()));
+		s = L::select(L::eq(x, L::set1(0.0f)), x, L::bxor(L::select(swap, pc, ps), signS));
+		s = L::select(finite, s, L::sub(x, x));
+		c = L::select(finite, L::bxor(L::select(swap, ps, pc), signC), L::sub(x, x));
+	}
+
+	// exp(x) = 2^n * exp(r) with n = round(x / ln2) and |r| <= ln2 / 2
+	template <int N, bool Fast>
+	GLM_FUNC_QUALIFIER typename simd_lanes<N>::vec simd_exp(typename simd_lanes<N>::vec x)
+	{
+		typedef simd_lanes<N> L;
+		typedef typename L::vec V;
+
+		V const xc = L::min(L::max(x, L::set1(-87.33654475f)), L::set1(88.37626266f));
+		typename L::ivec const n = L::round(L::mul(xc, L::set1(1.44269504088896341f)));
+		V const fn = L::tofloat(n);
+		V r = L::madd(fn, L::set1(-0.693359375f), xc);
+		r = L::madd(fn, L::set1(2.12194440e-4f), r);
+
+		V p;
+		if(Fast)
+		{
+			p = L::madd(r, L::set1(4.12776898e-2f), L::set1(1.67535271e-1f));
+			p = L::madd(p, r, L::set1(5.00051176e-1f));
+			p = L::madd(L::mul(p, r), r, L::add(r, L::set1(1.0f)));
+		}
+		else
+		{
+			p = L::madd(r, L::set1(1.9875691500e-4f), L::set1(1.3981999507e-3f));
+			p = L::madd(p, r, L::set1(8.3334519073e-3f));
+			p = L::madd(p, r, L::set1(4.1665795894e-2f));
+			p = L::madd(p, r, L::set1(1.6666665459e-1f));
+			p = L::madd(p, r, L::set1(5.0000001201e-1f));
+			p = L::madd(L::mul(p, r), r, L::add(r, L::set1(1.0f)));
+		}
+
+		V Result = L::mul(p, L::asfloat(L::shl(L::iadd(n, L::iset1(127)), 23)));
+		Result = L::select(L::lt(x, L::set1(-87.33654475f)), L::set1(0.0f), Result);
+		Result = L::select(L::lt(L::set1(88.72283905f), x), L::set1(std::numeric_limits<float>::infinity()), Result);
+		return L::select(L::neq(x, x), x, Result);
+	}
+
+	// log(x) = e * ln2 + log(m) with the mantissa m in [sqrt(0.5), sqrt(2))
+	template <int N, bool Fast>
+	GLM_FUNC_QUALIFIER typename simd_lanes<N>::vec simd_log(typename simd_lanes<N>::vec x)
+	{
+		typedef simd_lanes<N> L;
+		typedef typename L::vec V;
+
+		typename L::ivec const bits = L::asint(x);
+		typename L::ivec e = L::isub(L::shr(bits, 23), L::iset1(126));
+		V m = L::asfloat(L::iadd(L::iand(bits, L::iset1(0x007FFFFF)), L::iset1(0x3F000000)));
+
+		typename L::mask const small = L::lt(m, L::set1(0.707106781186547524f));
+		e = L::isub(e, L::asint(L::select(small, L::asfloat(L::iset1(1)), L::set1(0.0f))));
+		m = L::sub(L::add(m, L::select(small, m, L::set1(0.0f))), L::set1(1.0f));
+		V const fe = L::tofloat(e);
+		V const z = L::mul(m, m);
+
+		V p;
+		if(Fast)
+		{
+			p = L::madd(m, L::set1(1.17819814e-1f), L::set1(-1.84072902e-1f));
+			p = L::madd(p, m, L::set1(2.04422023e-1f));
+			p = L::madd(p, m, L::set1(-2.49438264e-1f));
+			p = L::madd(p, m, L::set1(3.33208599e-1f));
+			p = L::mul(L::mul(p, m), z);
+		}
+		else
+		{
+			p = L::madd(m, L::set1(7.0376836292e-2f), L::set1(-1.1514610310e-1f));
+			p = L::madd(p, m, L::set1(1.1676998740e-1f));
+			p = L::madd(p, m, L::set1(-1.2420140846e-1f));
+			p = L::madd(p, m, L::set1(1.4249322787e-1f));
+			p = L::madd(p, m, L::set1(-1.6668057665e-1f));
+			p = L::madd(p, m, L::set1(2.0000714765e-1f));
+			p = L::madd(p, m, L::set1(-2.4999993993e-1f));
+			p = L::madd(p, m, L::set1(3.3333331174e-1f));
+			p = L::mul(L::mul(p, m), z);
+		}
+
+		p = L::madd(fe, L::set1(-2.12194440e-4f), p);
+		p = L::madd(z, L::set1(-0.5f), p);
+		V Result = L::madd(fe, L::set1(0.693359375f), L::add(m, p));
+
+		Result = L::select(L::eq(x, L::set1(std::numeric_limits<float>::infinity())), x, Result);
+		Result = L::select(L::lt(x, L::set1(std::numeric_limits<float>::min())), L::set1(-std::numeric_limits<float>::infinity()), Result);
+		return L::select(L::mor(L::lt(x, L::set1(0.0f)), L::neq(x, x)), L::set1(std::numeric_limits<float>::quiet_NaN()), Result);
+	}
+
+	template <int N, bool Fast>
+	GLM_FUNC_QUALIFIER typename simd_lanes<N>::vec simd_pow(typename simd_lanes<N>::vec x, typename simd_lanes<N>::vec y)
+	{
+		typedef simd_lanes<N> L;
+		typedef typename L::vec V;
+
+		V const Result = simd_exp<N, Fast>(L::mul(y, simd_log<N, Fast>(x)));
+		// exp(inf * 0) would be NaN for pow(1, +-inf)
+		return L::select(L::mor(L::eq(y, L::set1(0.0f)), L::eq(x, L::set1(1.0f))), L::set1(1.0f), Result);
+	}
+
+	// atan of t = min(|x|, |y|) / max(|x|, |y|) in [0, 1], reduced once more
+	// around tan(pi/8), then moved to the right octant.
+	template <int N, bool Fast>
+	GLM_FUNC_QUALIFIER typename simd_lanes<N>::vec simd_atan2(typename simd_lanes<N>::vec y, typename simd_lanes<N>::vec x)
+	{
+		typedef simd_lanes<N> L;
+		typedef typename L::vec V;
+
+		V const ax = L::abs(x);
+		V const ay = L::abs(y);
+		V const hi = L::max(ax, ay);
+		V const lo = L::min(ax, ay);
+		V const t = L::div(lo, L::select(L::eq(hi, L::set1(0.0f)), L::set1(1.0f), hi));
+		// Both infinite: inf / inf, taken as 1 for the +-pi/4 and +-3pi/4 diagonals
+		V const tc = L::select(L::eq(lo, L::set1(std::numeric_limits<float>::infinity())), L::set1(1.0f), t);
+
+		typename L::mask const big = L::lt(L::set1(0.4142135623730950f), tc);
+		V const u = L::select(big, L::div(L::sub(tc, L::set1(1.0f)), L::add(tc, L::set1(1.0f))), tc);
+		V const base = L::select(big, L::set1(0.785398163397448309f), L::set1(0.0f));
+		V const z = L::mul(u, u);
+
+		V p;
+		if(Fast)
+		{
+			p = L::madd(z, L::set1(-1.12250837e-1f), L::set1(1.97141280e-1f));
+			p = L::madd(p, z, L::set1(-3.33255071e-1f));
+		}
+		else
+		{
+			p = L::madd(z, L::set1(8.05374449538e-2f), L::set1(-1.38776856032e-1f));
+			p = L::madd(p, z, L::set1(1.99777106478e-1f));
+			p = L::madd(p, z, L::set1(-3.33329491539e-1f));
+		}
+		V r = L::add(L::madd(L::mul(p, z), u, u), base);
+
+		r = L::select(L::lt(ax, ay), L::sub(L::set1(1.57079632679489662f), r), r);
+		// Negative x, including -0 so that atan2(+-0, -0) = +-pi
+		typename L::mask const negX = L::ieq(L::asint(L::sign(x)), L::asint(L::set1(-0.0f)));
+		r = L::select(negX, L::sub(L::set1(3.14159265358979324f), r), r);
+		r = L::bxor(r, L::sign(y));
+		// min and max drop a NaN operand, x + y brings it back
+		return L::select(L::mor(L::neq(x, x), L::neq(y, y)), L::add(x, y), r);
+	}
+}//namespace detail
+}//namespace glm
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_sin(glm_vec4 x)
+{
+	glm_vec4 s, c;
+	glm::detail::simd_sincos<4, false>(x, s, c);
+	return s;
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_cos(glm_vec4 x)
+{
+	glm_vec4 s, c;
+	glm::detail::simd_sincos<4, false>(x, s, c);
+	return c;
+}
+
+GLM_FUNC_QUALIFIER void glm_vec4_sincos(glm_vec4 x, glm_vec4 & s, glm_vec4 & c)
+{
+	glm::detail::simd_sincos<4, false>(x, s, c);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_exp(glm_vec4 x)
+{
+	return glm::detail::simd_exp<4, false>(x);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_log(glm_vec4 x)
+{
+	return glm::detail::simd_log<4, false>(x);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_pow(glm_vec4 x, glm_vec4 y)
+{
+	return glm::detail::simd_pow<4, false>(x, y);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_atan2(glm_vec4 y, glm_vec4 x)
+{
+	return glm::detail::simd_atan2<4, false>(y, x);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_sin_lowp(glm_vec4 x)
+{
+	glm_vec4 s, c;
+	glm::detail::simd_sincos<4, true>(x, s, c);
+	return s;
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_cos_lowp(glm_vec4 x)
+{
+	glm_vec4 s, c;
+	glm::detail::simd_sincos<4, true>(x, s, c);
+	return c;
+}
+
+GLM_FUNC_QUALIFIER void glm_vec4_sincos_lowp(glm_vec4 x, glm_vec4 & s, glm_vec4 & c)
+{
+	glm::detail::simd_sincos<4, true>(x, s, c);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_exp_lowp(glm_vec4 x)
+{
+	return glm::detail::simd_exp<4, true>(x);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_log_lowp(glm_vec4 x)
+{
+	return glm::detail::simd_log<4, true>(x);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_pow_lowp(glm_vec4 x, glm_vec4 y)
+{
+	return glm::detail::simd_pow<4, true>(x, y);
+}
+
+GLM_FUNC_QUALIFIER glm_vec4 glm_vec4_atan2_lowp(glm_vec4 y, glm_vec4 x)
+{
+	return glm::detail::simd_atan2<4, true>(y, x);
+}
+
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_sin(__m256 x)
+{
+	__m256 s, c;
+	glm::detail::simd_sincos<8, false>(x, s, c);
+	return s;
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_cos(__m256 x)
+{
+	__m256 s, c;
+	glm::detail::simd_sincos<8, false>(x, s, c);
+	return c;
+}
+
+GLM_FUNC_QUALIFIER void glm_vec8_sincos(__m256 x, __m256 & s, __m256 & c)
+{
+	glm::detail::simd_sincos<8, false>(x, s, c);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_exp(__m256 x)
+{
+	return glm::detail::simd_exp<8, false>(x);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_log(__m256 x)
+{
+	return glm::detail::simd_log<8, false>(x);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_pow(__m256 x, __m256 y)
+{
+	return glm::detail::simd_pow<8, false>(x, y);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_atan2(__m256 y, __m256 x)
+{
+	return glm::detail::simd_atan2<8, false>(y, x);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_sin_lowp(__m256 x)
+{
+	__m256 s, c;
+	glm::detail::simd_sincos<8, true>(x, s, c);
+	return s;
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_cos_lowp(__m256 x)
+{
+	__m256 s, c;
+	glm::detail::simd_sincos<8, true>(x, s, c);
+	return c;
+}
+
+GLM_FUNC_QUALIFIER void glm_vec8_sincos_lowp(__m256 x, __m256 & s, __m256 & c)
+{
+	glm::detail::simd_sincos<8, true>(x, s, c);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_exp_lowp(__m256 x)
+{
+	return glm::detail::simd_exp<8, true>(x);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_log_lowp(__m256 x)
+{
+	return glm::detail::simd_log<8, true>(x);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_pow_lowp(__m256 x, __m256 y)
+{
+	return glm::detail::simd_pow<8, true>(x, y);
+}
+
+GLM_FUNC_QUALIFIER __m256 glm_vec8_atan2_lowp(__m256 y, __m256 x)
+{
+	return glm::detail::simd_atan2<8, true>(y, x);
+}
+
+#endif//GLM_ARCH & GLM_ARCH_AVX2_BIT
+
+#if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_sin(__m512 x)
+{
+	__m512 s, c;
+	glm::detail::simd_sincos<16, false>(x, s, c);
+	return s;
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_cos(__m512 x)
+{
+	__m512 s, c;
+	glm::detail::simd_sincos<16, false>(x, s, c);
+	return c;
+}
+
+GLM_FUNC_QUALIFIER void glm_vec16_sincos(__m512 x, __m512 & s, __m512 & c)
+{
+	glm::detail::simd_sincos<16, false>(x, s, c);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_exp(__m512 x)
+{
+	return glm::detail::simd_exp<16, false>(x);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_log(__m512 x)
+{
+	return glm::detail::simd_log<16, false>(x);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_pow(__m512 x, __m512 y)
+{
+	return glm::detail::simd_pow<16, false>(x, y);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_atan2(__m512 y, __m512 x)
+{
+	return glm::detail::simd_atan2<16, false>(y, x);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_sin_lowp(__m512 x)
+{
+	__m512 s, c;
+	glm::detail::simd_sincos<16, true>(x, s, c);
+	return s;
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_cos_lowp(__m512 x)
+{
+	__m512 s, c;
+	glm::detail::simd_sincos<16, true>(x, s, c);
+	return c;
+}
+
+GLM_FUNC_QUALIFIER void glm_vec16_sincos_lowp(__m512 x, __m512 & s, __m512 & c)
+{
+	glm::detail::simd_sincos<16, true>(x, s, c);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_exp_lowp(__m512 x)
+{
+	return glm::detail::simd_exp<16, true>(x);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_log_lowp(__m512 x)
+{
+	return glm::detail::simd_log<16, true>(x);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_pow_lowp(__m512 x, __m512 y)
+{
+	return glm::detail::simd_pow<16, true>(x, y);
+}
+
+GLM_FUNC_QUALIFIER __m512 glm_vec16_atan2_lowp(__m512 y, __m512 x)
+{
+	return glm::detail::simd_atan2<16, true>(y, x);
+}
+
+#endif//(GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+
+#endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
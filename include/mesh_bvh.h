@@ -0,0 +1,100 @@
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include "thread_pool.h"
+
+#include "glm/glm.hpp"
+
+#include <vector>
+
+/* Segment origin + t * direction for t in [tMin, tMax). direction doesn't
+ * need to be normalized, t is then in units of its length. */
+struct BVHRay {
+    glm::vec3 origin;
+    float tMin;
+    glm::vec3 direction;
+    float tMax;
+};
+
+/* Closest hit: the point is (1 - u - v) * v0 + u * v1 + v * v2, the same
+ * barycentrics glm::intersectRayTriangle returns in x and y. */
+struct BVHHit {
+    float t;
+    float u, v;
+    unsigned triangle;      // index in the mesh, MESH_BVH_MISS if none
+};
+
+static const unsigned MESH_BVH_MISS = 0xFFFFFFFFu;
+
+/* Bounding volume hierarchy over the triangles of a mesh, four children
+ * per node. Child boxes and the (up to four) triangles of a leaf are
+ * stored across SSE lanes, so a single ray tests all the children of a
+ * node or all the triangles of a leaf in one instruction.
+ *
+ * The batch queries trace packets of 4, 8 or 16 rays (SSE2, AVX2 or
+ * AVX-512) down the tree together, one lane per ray, and spread packets
+ * across a ThreadPool, pass NULL to stay on the calling thread. They work
+ * best on coherent rays such as camera rays or a shadow ray per pixel,
+ * sort incoherent ones first or use the single ray queries.
+ *
+ * The triangle test is the Moller-Trumbore test of glm::intersectRayTriangle,
+ * without back face culling. The BVH copies the triangles, the mesh
+ * doesn't need to outlive it. */
+class MeshBVH {
+
+public:
+    /* indices holds three vertex indices per triangle, NULL for
+     * unindexed triangles taken three positions at a time */
+    MeshBVH(const glm::vec3 *positions, const unsigned *indices,
+            size_t triangleCount);
+
+    size_t triangleCount() const { return triangles; }
+    size_t nodeCount() const { return nodes.size(); }
+
+    /* Closest hit along the ray, false and hit.triangle = MESH_BVH_MISS
+     * if there is none */
+    bool intersect(const BVHRay &ray, BVHHit &hit) const;
+
+    /* Whether anything lies along the ray, stops at the first hit found */
+    bool occluded(const BVHRay &ray) const;
+
+    void intersect(const BVHRay *rays, BVHHit *hits, size_t count,
+            ThreadPool *pool = &ThreadPool::shared()) const;
+    void occluded(const BVHRay *rays, bool *occluded, size_t count,
+            ThreadPool *pool = &ThreadPool::shared()) const;
+
+    /* Rays per packet of the batch queries */
+    static int packetSize();
+
+private:
+    /* Bounds of the four children as minX, minY, minZ, maxX, maxY, maxZ
+     * rows; unused slots hold an empty box */
+    struct Node {
+        float bounds[6][4];
+        unsigned children[4];   // node index, or MESH_BVH_LEAF | leaf index
+    };
+
+    /* v0, v1 - v0 and v2 - v0 of four triangles, padding triangles are
+     * degenerate and never hit */
+    struct Leaf {
+        float v0[3][4];
+        float e1[3][4];
+        float e2[3][4];
+        unsigned triangles[4];
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Leaf> leaves;
+    size_t triangles;
+
+    template <bool AnyHit>
+    bool traverse(const BVHRay &ray, BVHHit &hit) const;
+    /* Up to packetSize() rays */
+    template <bool AnyHit>
+    void tracePacket(const BVHRay *rays, size_t count, BVHHit *hits,
+            bool *occluded) const;
+
+    friend struct MeshBVHBuilder;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef MORTON_SORT_H
+#define MORTON_SORT_H
+
+#include "thread_pool.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
+
+#include <vector>
+
+/* Orders points along a Z-order curve, so that objects close in space end
+ * up close in memory and in draw order. Positions are quantised to the
+ * bounding box of the set, 10 bits per axis for 30 bit keys or 21 bits for
+ * 63 bit keys, and their bits interleaved as glm::bitfieldInterleave does,
+ * x in bit 0. 30 bit keys are built 4, 8 or 16 at a time (SSE2, AVX2,
+ * AVX-512), 63 bit keys with BMI2 pdep when built for it.
+ *
+ * The keys are sorted by a least significant digit radix sort, 10 or 11
+ * bits per pass: every pass histograms chunks of MORTON_GRAIN keys on the
+ * thread pool, and after a prefix sum each chunk scatters its keys to its
+ * own runs. The sort is stable and passes whose digit is the same for
+ * every key are skipped.
+ *
+ * 30 bits give 1024 steps per axis, enough for draw order and culling
+ * coherence. 63 bits suit large sets spread very unevenly, such as
+ * particles over a whole level. */
+class MortonSort {
+
+public:
+    static const size_t MORTON_GRAIN = 16384;
+
+    /* keyBits is 30 or 63 */
+    explicit MortonSort(int keyBits = 30);
+
+    int keyBits() const { return bits; }
+
+    /* Sorts count positions read as x, y, z at positions + i * stride
+     * floats: stride 3 for a vec3 array, 4 for vec4 and 16 with
+     * &m[0][3].x for the translations of a mat4 array. */
+    void sort(const float *positions, size_t stride, size_t count,
+            ThreadPool *pool = &ThreadPool::shared());
+
+    /* order()[i] is the input index of the i-th position along the curve */
+    const std::vector<unsigned> &order() const { return sorted; }
+
+    /* Bounds the last sort quantised positions to */
+    glm::vec3 lower() const { return lo; }
+    glm::vec3 upper() const { return hi; }
+
+    /* Reorders the count items of the last sort, items[i] becoming the
+     * former items[order()[i]]: instances, particles or any array that
+     * parallels the positions. */
+    template <typename T>
+    void apply(T *items, ThreadPool *pool = &ThreadPool::shared()) const;
+
+    /* Keys of count positions quantised to [lo, hi], clamped outside.
+     * NaN coordinates quantise to 0. */
+    static void keys30(const float *positions, size_t stride, size_t count,
+            glm::vec3 lo, glm::vec3 hi, glm::uint32 *keys);
+    static void keys63(const float *positions, size_t stride, size_t count,
+            glm::vec3 lo, glm::vec3 hi, glm::uint64 *keys);
+
+private:
+    int bits;
+    glm::vec3 lo, hi;
+    std::vector<unsigned> sorted;
+
+    /* Scratch of sort(), kept to avoid reallocating every frame */
+    std::vector<glm::uint32> keys32, scratch32;
+    std::vector<glm::uint64> keys64, scratch64;
+    std::vector<unsigned> scratchIds;
+    std::vector<unsigned> histograms;
+
+    template <typename K>
+    void radixSort(std::vector<K> &keys, std::vector<K> &scratch, size_t count,
+            int digitBits, ThreadPool *pool);
+};
+
+template <typename T>
+void MortonSort::apply(T *items, ThreadPool *pool) const {
+    std::vector<T> copy(items, items + sorted.size());
+    ThreadPool::Task task = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            items[i] = copy[sorted[i]];
+    };
+    if (pool)
+        pool->parallelFor(sorted.size(), MORTON_GRAIN, task);
+    else
+        task(0, sorted.size());
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef NOISE_FIELD_H
+#define NOISE_FIELD_H
+
+#include "thread_pool.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtx/noise_batch.hpp"
+
+/* Octave stacking of a procedural heightfield or texture, see fbmGrid and
+ * ridgedGrid in glm/gtx/noise_batch.hpp. */
+struct NoiseFractal {
+    glm::noise_basis basis;
+    int octaves;
+    float lacunarity;   // frequency ratio between octaves
+    float gain;         // amplitude ratio between octaves
+    bool ridged;
+
+    NoiseFractal()
+        : basis(glm::noise_perlin), octaves(6), lacunarity(2.0f), gain(0.5f),
+          ridged(false) {}
+};
+
+/* out[y * width + x] = fractal sum at origin + vec2(x, y) * step. Bands of
+ * rows are split across pool, pass NULL to run on the calling thread only.
+ * Every row is one fbmGrid / ridgedGrid call so the field doesn't depend on
+ * how it was split and matches a single call over the whole grid. */
+void noiseFieldGenerate(float *out, size_t width, size_t height,
+        glm::vec2 origin, glm::vec2 step, const NoiseFractal &fractal,
+        ThreadPool *pool = &ThreadPool::shared());
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef NULL_GL_H
+#define NULL_GL_H
+
+struct NullGLStats {
+    unsigned long long calls;           // every entry point
+    unsigned long long drawCalls;
+    unsigned long long vertices;        // count * instances of all draws
+    unsigned long long uniformUpdates;
+    unsigned long long stateChanges;    // binds, enables, program switches
+    unsigned long long bufferBytes;     // uploaded through glBuffer*Data
+    unsigned long long textureBytes;    // uploaded through glTex*Image*
+    unsigned long long errors;
+};
+
+/* A GL 3.3 core implementation that never touches a GPU: it hands out
+ * object names, tracks bindings, validates usage like a core profile
+ * driver would and counts the work submitted. Load it with
+ *
+ *   gladLoadGLLoader((GLADloadproc) NullGL::getProcAddress);
+ *
+ * to measure the CPU cost of building and submitting frames. */
+class NullGL {
+
+public:
+    static void *getProcAddress(const char *name);
+
+    static const NullGLStats &stats();
+    static void resetStats();
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef PARTICLE_RENDERER_H
+#define PARTICLE_RENDERER_H
+
+#include <glad/glad.h>
+
+#include "particles.h"
+#include "shader.h"
+
+/* Draws ParticleSystem output as instanced camera facing quads (see
+ * src/particle.vs). Instances go through a ring of PARTICLE_FRAMES regions
+ * of one vertex buffer, each guarded by a fence, so the CPU fills one
+ * region while the GPU reads the others.
+ *
+ * With GL 4.4 or GL_ARB_buffer_storage the buffer is allocated with
+ * glBufferStorage and mapped once, persistently and coherently; otherwise
+ * each frame maps its region unsynchronized with glMapBufferRange. glad
+ * only covers GL 3.3, so glBufferStorage is looked up through the loader
+ * passed to the constructor. Writes through the mapping bypass the GL
+ * entry points and don't appear in GL_TRACE or GL_CAPTURE output. */
+class ParticleRenderer {
+
+public:
+    static const int PARTICLE_FRAMES = 3;
+
+    /* Needs a current context, capacity is in particles per frame */
+    ParticleRenderer(size_t capacity, GLADloadproc loader);
+    ~ParticleRenderer();
+
+    /* Waits for the region of this frame and returns where to write it,
+     * capacity is 0 if the buffer could not be mapped */
+    ParticleInstances beginFrame();
+
+    /* Draws the first count instances written since beginFrame() */
+    void draw(size_t count, Shader &shader, const glm::mat4 &view,
+            const glm::mat4 &proj);
+
+    bool isPersistent() const { return persistent != NULL; }
+
+private:
+    size_t capacity;
+    GLsizeiptr regionBytes;
+    GLsizeiptr colorOffset;     // of the colour stream within a region
+    unsigned int vao;
+    unsigned int vbo;
+    char *persistent;           // whole buffer while persistently mapped
+    bool mapped;
+    GLsync fences[PARTICLE_FRAMES];
+    int frame;
+
+    ParticleRenderer(const ParticleRenderer &);
+    ParticleRenderer &operator=(const ParticleRenderer &);
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "thread_pool.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
+
+#include <vector>
+
+class MortonSort;
+
+/* Where and how particles are born. Random values are uniform in
+ * [value - spread, value + spread]. */
+struct ParticleEmitter {
+    glm::vec3 position;
+    float radius;           // births on a sphere of this radius around position
+    glm::vec3 velocity;
+    float speedSpread;      // plus a random direction of this length
+    float lifetime;         // seconds
+    float lifetimeSpread;
+    float size;             // billboard width in world units
+    float sizeSpread;
+    glm::vec4 color;        // RGBA, alpha fades to 0 over the lifetime
+
+    ParticleEmitter()
+        : position(0.0f), radius(0.0f), velocity(0.0f), speedSpread(1.0f),
+          lifetime(2.0f), lifetimeSpread(0.0f), size(0.05f), sizeSpread(0.0f),
+          color(1.0f) {}
+};
+
+struct ParticleForces {
+    glm::vec3 gravity;
+    float drag;             // fraction of the velocity lost per second
+
+    ParticleForces() : gravity(0.0f, -9.81f, 0.0f), drag(0.0f) {}
+};
+
+/* Instanced billboard data: two tightly packed streams, typically pointing
+ * into a mapped vertex buffer. */
+struct ParticleInstances {
+    glm::vec4 *positionSize;    // xyz centre, w size
+    glm::uint32 *colors;        // RGBA8, alpha scaled by the remaining life
+    size_t capacity;
+};
+
+/* Particles stored as 64 byte aligned SoA streams (position, velocity, age,
+ * lifetime, size, colour) in chunks of PARTICLE_CHUNK. Each chunk keeps its
+ * live particles at its front: update() drops the dead ones with a
+ * branchless pass, emit() appends to chunks with room, and
+ * writeInstances() packs the chunks densely through a prefix sum. All
+ * three split the chunks across a ThreadPool, pass NULL to stay on the
+ * calling thread. Emission draws from gtx/random_batch streams numbered by
+ * call and chunk, so a given sequence of calls produces the same particles
+ * however many threads run it. */
+class ParticleSystem {
+
+public:
+    static const size_t PARTICLE_CHUNK = 4096;
+
+    /* capacity is rounded up to a multiple of PARTICLE_CHUNK */
+    explicit ParticleSystem(size_t capacity, glm::uint64 seed = 0);
+
+    size_t capacity() const { return live.size() * PARTICLE_CHUNK; }
+    size_t size() const { return total; }
+
+    /* Spawns count particles, fewer once full, returns how many */
+    size_t emit(const ParticleEmitter &emitter, size_t count,
+            ThreadPool *pool = &ThreadPool::shared());
+
+    /* Applies forces, integrates over dt and removes expired particles */
+    void update(float dt, const ParticleForces &forces,
+            ThreadPool *pool = &ThreadPool::shared());
+
+    /* Writes up to out.capacity live particles, returns how many */
+    size_t writeInstances(const ParticleInstances &out,
+            ThreadPool *pool = &ThreadPool::shared()) const;
+
+    /* Reorders the live particles along the Morton curve of sorter and
+     * packs them into the first chunks, so particles close in space are
+     * close in the streams and in the instance buffer. Worth running every
+     * few frames, emit() keeps filling the chunks with room. */
+    void sortSpatially(MortonSort &sorter,
+            ThreadPool *pool = &ThreadPool::shared());
+
+    enum Stream {
+        POSITION_X, POSITION_Y, POSITION_Z,
+        VELOCITY_X, VELOCITY_Y, VELOCITY_Z,
+        AGE, LIFETIME, SIZE,
+        FLOAT_STREAMS
+    };
+
+    /* Raw access to chunk c: its live particles are [0, liveCount(c)) */
+    float *stream(Stream s, size_t c) { return streams[s] + c * PARTICLE_CHUNK; }
+    glm::uint32 *colorStream(size_t c) { return colors + c * PARTICLE_CHUNK; }
+    unsigned liveCount(size_t c) const { return live[c]; }
+
+private:
+    std::vector<unsigned> live;     // live particles per chunk
+    std::vector<char> storage;
+    float *streams[FLOAT_STREAMS];
+    glm::uint32 *colors;
+    size_t total;
+    glm::uint64 seed;
+    glm::uint64 emitCalls;
+
+    void spawn(const ParticleEmitter &emitter, size_t chunk, size_t begin,
+            size_t count, glm::uint64 stream);
+    void updateChunk(size_t chunk, float dt, const ParticleForces &forces);
+    void writeChunk(size_t chunk, size_t first, size_t count,
+            const ParticleInstances &out) const;
+
+    ParticleSystem(const ParticleSystem &);
+    ParticleSystem &operator=(const ParticleSystem &);
+};
+
+#endif
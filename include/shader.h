@@ -2,6 +2,9 @@
 #define SHADER_H
 
 #include "glm/glm.hpp"
+#include "shader_preprocessor.h"
+
+#include <map>
 
 class Shader {
 
@@ -9,6 +12,8 @@ public:
     unsigned int programID;
 
     Shader(const char* vertexPath, const char* fragmentPath);
+    Shader(const char* vertexPath, const char* fragmentPath,
+            const ShaderDefines &defines);
 
     void use();
 
@@ -17,6 +22,25 @@ public:
     void setInt(const char* name, int value) const;
     void setMat4(const char* name, glm::mat4 value) const;
     void setVec3(const char* name, glm::vec3 value) const;
+
+private:
+    void compile(const char* vertexPath, const char* fragmentPath,
+            const ShaderDefines &defines);
+};
+
+/* One program per (vertex, fragment, defines) permutation, compiled lazily
+ * the first time it is requested. */
+class ShaderVariantCache {
+
+public:
+    Shader &get(const char* vertexPath, const char* fragmentPath,
+            const ShaderDefines &defines);
+
+    size_t size() const { return variants.size(); }
+    void clear();
+
+private:
+    std::map<std::string, Shader> variants;    // by ShaderPreprocessor::variantKey
 };
 
 #endif
@@ -0,0 +1,32 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <map>
+#include <set>
+#include <string>
+
+/* NAME -> VALUE, kept sorted so the variant key is stable */
+typedef std::map<std::string, std::string> ShaderDefines;
+
+class ShaderPreprocessor {
+
+public:
+    ShaderPreprocessor(const ShaderDefines &defines);
+
+    /* Reads 'path', expands #include "file" (relative to the including
+     * file) and injects the defines right after the #version line. */
+    bool process(const char* path, std::string &output);
+
+    /* The shader paths and the sorted define set in one string, equal for
+     * two requests exactly when they build the same program */
+    static std::string variantKey(const char* vertexPath,
+            const char* fragmentPath, const ShaderDefines &defines);
+
+private:
+    const ShaderDefines &defines;
+    std::set<std::string> includeStack;
+
+    bool expand(const std::string &path, int depth, std::string &output);
+};
+
+#endif
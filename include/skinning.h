@@ -0,0 +1,66 @@
+#ifndef SKINNING_H
+#define SKINNING_H
+
+#include "animation.h"
+#include "thread_pool.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
+#include "glm/gtx/affine.hpp"
+#include "glm/gtx/dual_quaternion.hpp"
+
+#include <vector>
+
+/* Joint hierarchy, every parent stored before its children. */
+struct Skeleton {
+    std::vector<int> parents;               // -1 for a root
+    std::vector<glm::affine> inverseBind;   // model space to joint space
+};
+
+/* Bind pose vertices with four influences each, weights summing to 1.
+ * Unused influences get a weight of 0 and any valid joint. */
+struct SkinSource {
+    const glm::vec3 *positions;
+    const glm::vec3 *normals;       // NULL to skin positions only
+    const glm::u16vec4 *joints;
+    const glm::vec4 *weights;
+    size_t count;
+};
+
+/* Where skinned vertices go, usually a mapped streaming vertex buffer:
+ * vertex i starts at data + i * stride with the position at offset 0 and
+ * the normal at normalOffset. Only those 12 or 24 bytes are written, in
+ * order, which suits write-combined memory. */
+struct SkinTarget {
+    void *data;
+    size_t stride;
+    size_t normalOffset;
+};
+
+/* Model space transform of each joint from a sampled local pose */
+void skinWorldTransforms(const Skeleton &skeleton, const LocalPose &pose,
+        std::vector<glm::affine> &world);
+
+/* world * inverseBind per joint, the matrices linear blend skinning uses */
+void skinLinearPalette(const Skeleton &skeleton,
+        const std::vector<glm::affine> &world,
+        std::vector<glm::affine> &palette);
+
+/* The same transforms as unit dual quaternions, which can't carry scale:
+ * it is dropped from the palette matrices. */
+void skinDualQuatPalette(const Skeleton &skeleton,
+        const std::vector<glm::affine> &world,
+        std::vector<glm::dualquat> &palette);
+
+/* Blend the palette entries of each vertex and transform its position and
+ * normal into target. Normals are renormalized. Vertices are split across
+ * pool in chunks, pass NULL to run on the calling thread only. With
+ * GLM_FORCE_PURE both fall back to plain glm code, which is the reference
+ * the SSE2 / AVX paths are checked against. */
+void skinLinear(const SkinSource &source, const glm::affine *palette,
+        const SkinTarget &target, ThreadPool *pool = &ThreadPool::shared());
+
+void skinDualQuat(const SkinSource &source, const glm::dualquat *palette,
+        const SkinTarget &target, ThreadPool *pool = &ThreadPool::shared());
+
+#endif
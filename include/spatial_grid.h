@@ -0,0 +1,94 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "thread_pool.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
+
+#include <vector>
+
+/* Uniform grid over unbounded space for proximity queries on points that
+ * move every frame. Only occupied cells are stored, in an open addressing
+ * table keyed by cell coordinates and hashed with the gtx_hash std::hash
+ * of glm::ivec3.
+ *
+ * build() is a counting sort: points are bucketed by the top bits of their
+ * cell hash, each bucket owns a run of table slots and a run of the sorted
+ * point arrays, and buckets are filled independently on the thread pool.
+ * A bucket's slots are sized by the distinct cells each chunk of points
+ * brings to it, so the table follows the occupied cells however clustered
+ * the points are.
+ * Points of a cell end up contiguous, stored as x, y, z streams that the
+ * queries test 4, 8 or 16 at a time (SSE2, AVX2, AVX-512).
+ *
+ * Queries are const and may run concurrently. They return indices into the
+ * array given to build(). Cell coordinates wrap every 2^21 cells: distant
+ * cells may share a slot, which costs extra distance tests but never
+ * changes results. */
+class SpatialGrid {
+
+public:
+    explicit SpatialGrid(float cellSize);
+
+    float cellSize() const { return size; }
+    size_t pointCount() const { return total; }
+    size_t cellCount() const { return cells; }
+    size_t tableSlots() const { return table.size(); }
+
+    /* Replaces the content with points[0, count) */
+    void build(const glm::vec3 *points, size_t count,
+            ThreadPool *pool = &ThreadPool::shared());
+
+    /* Appends the points within radius of center, in no particular order */
+    void querySphere(glm::vec3 center, float radius,
+            std::vector<unsigned> &out) const;
+
+    /* Appends the points inside the box, bounds included */
+    void queryBox(glm::vec3 lo, glm::vec3 hi, std::vector<unsigned> &out) const;
+
+    /* The k points closest to p within maxDistance, nearest first. Fills
+     * indices and, when not NULL, distances; returns how many were found. */
+    size_t nearest(glm::vec3 p, size_t k, float maxDistance, unsigned *indices,
+            float *distances = NULL) const;
+
+private:
+    struct Slot {
+        glm::uint64 key;        // packed cell coordinates, SPATIAL_GRID_EMPTY if free
+        unsigned begin;         // first point of the cell in the sorted streams
+        unsigned count;
+    };
+
+    /* A point copied to its bucket by build() */
+    struct Staged {
+        glm::vec3 position;
+        unsigned id;
+        unsigned hash;          // low bits of the cell hash, then its slot
+    };
+
+    float size;
+    float inverseSize;
+    size_t total;
+    size_t cells;
+    glm::ivec3 cellLo, cellHi;  // cells spanned by the points
+    std::vector<size_t> slotStart;  // bucket b owns slots [slotStart[b], slotStart[b + 1])
+    std::vector<Slot> table;
+
+    /* Points sorted by cell, padded so a full register can always be read */
+    std::vector<float> xs, ys, zs;
+    std::vector<unsigned> ids;
+
+    /* Scratch of build(), kept to avoid reallocating every frame */
+    std::vector<Staged> staged;
+    std::vector<unsigned> bucketStart;
+    std::vector<unsigned> histograms;
+    std::vector<unsigned> chunkCells;
+
+    const Slot *find(glm::ivec3 cell) const;
+    size_t fillBucket(size_t bucket);
+
+    template <typename Visit>
+    void visitCells(glm::vec3 lo, glm::vec3 hi, Visit visit) const;
+};
+
+#endif
@@ -229,6 +229,15 @@ RECENT REVISION HISTORY:
 // (at least this is true for iOS and Android). Therefore, the NEON support is
 // toggled by a build flag: define STBI_NEON to get NEON loops.
 //
+// On top of SSE2, x86 builds with GCC 4.9+, Clang or Visual C++ 2012+ also
+// compile AVX2 versions of the JPEG IDCT, upsampling and color conversion,
+// used when a run-time test finds AVX2; they give the same results as the SSE2
+// ones. Define STBI_NO_AVX2 to leave them out.
+//
+// The PNG decoder uses the same SSE2 or NEON paths to unfilter the rows of
+// 8-bit and 16-bit RGB and RGBA images, adding the alpha channel in the same
+// pass when one is requested.
+//
 // If for some reason you do not want to use any of SIMD code, or if
 // you have issues compiling it, you can disable it entirely by
 // defining STBI_NO_SIMD.
@@ -382,6 +391,21 @@ STBIDEF stbi_uc *stbi_load_from_file  (FILE *f, int *x, int *y, int *channels_in
 // for stbi_load_from_file, file pointer is left pointing immediately after image
 #endif
 
+// decode into memory of the caller's, such as a mapped pixel buffer: y rows
+// of x*desired_channels bytes, stride_in_bytes apart from 'out', written
+// bottom row first if flip_vertically is set (the global flip setting does
+// not apply). x and y must be the size stbi_info reports, desired_channels
+// 1..4. JPEG and non-interlaced 8-bit PNG files without tRNS or a palette
+// decode their final pixels straight into 'out'; other images are decoded as
+// usual and copied in a single pass. Returns 1 on success, 0 on failure.
+STBIDEF int      stbi_load_from_memory_into   (stbi_uc           const *buffer, int len   , stbi_uc *out, int x, int y, int stride_in_bytes, int *channels_in_file, int desired_channels, int flip_vertically);
+STBIDEF int      stbi_load_from_callbacks_into(stbi_io_callbacks const *clbk  , void *user, stbi_uc *out, int x, int y, int stride_in_bytes, int *channels_in_file, int desired_channels, int flip_vertically);
+
+#ifndef STBI_NO_STDIO
+STBIDEF int      stbi_load_into               (char const *filename, stbi_uc *out, int x, int y, int stride_in_bytes, int *channels_in_file, int desired_channels, int flip_vertically);
+STBIDEF int      stbi_load_from_file_into     (FILE *f, stbi_uc *out, int x, int y, int stride_in_bytes, int *channels_in_file, int desired_channels, int flip_vertically);
+#endif
+
 #ifndef STBI_NO_GIF
 STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int **delays, int *x, int *y, int *z, int *comp, int req_comp);
 #endif
@@ -475,6 +499,30 @@ STBIDEF void stbi_set_flip_vertically_on_load(int flag_true_if_should_flip);
 // calling it will fail to link if your compiler doesn't
 STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_flip);
 
+// decode JPEGs on several threads. stb_image creates no threads itself: 'run'
+// must call task(task_data, i) for every i in [0, count) on up to 'threads'
+// threads and return once they have all returned, which is what a thread
+// pool's parallel-for does. Running the tasks one after another is valid too,
+// just not faster. With run NULL or threads below 2 (the default) JPEGs decode
+// on the calling thread, as do images under 256x256 pixels.
+//
+// Baseline files with restart markers decode their restart intervals in
+// parallel; other baseline files decode on one thread while the others run
+// the IDCT and colour conversion of the rows already decoded. Upsampling and
+// colour conversion of everything else runs in bands of rows. The output is
+// identical to a serial decode, and corrupt files load or fail as they do
+// serially. Files with restart markers loaded from a file or callbacks are
+// read to their end before decoding.
+typedef void stbi_parallel_for(void *user, int count, void (*task)(void *task_data, int index), void *task_data);
+STBIDEF void stbi_set_jpeg_parallel(stbi_parallel_for *run, void *user, int threads);
+
+// decode PNGs on two threads through the same kind of callback: one inflates
+// while the other unfilters the rows already inflated, so the inflated data
+// goes through a window of a few hundred KB rather than being held whole.
+// Interlaced and 1/2/4-bit files and images under 256x256 pixels decode on
+// the calling thread. The output is identical to a serial decode.
+STBIDEF void stbi_set_png_parallel(stbi_parallel_for *run, void *user, int threads);
+
 // ZLIB client - used by PNG, available for other purposes
 
 STBIDEF char *stbi_zlib_decode_malloc_guesssize(const char *buffer, int len, int initial_size, int *outlen);
@@ -485,6 +533,10 @@ STBIDEF int   stbi_zlib_decode_buffer(char *obuffer, int olen, const char *ibuff
 STBIDEF char *stbi_zlib_decode_noheader_malloc(const char *buffer, int len, int *outlen);
 STBIDEF int   stbi_zlib_decode_noheader_buffer(char *obuffer, int olen, const char *ibuffer, int ilen);
 
+// check the Adler-32 at the end of zlib streams, PNG image data included, and
+// fail on a mismatch. Off by default: stb_image has always ignored it.
+STBIDEF void stbi_set_zlib_verify_adler32(int flag_true_if_should_verify);
+
 
 #ifdef __cplusplus
 }
@@ -588,12 +640,14 @@ typedef unsigned short stbi__uint16;
 typedef   signed short stbi__int16;
 typedef unsigned int   stbi__uint32;
 typedef   signed int   stbi__int32;
+typedef unsigned __int64 stbi__uint64;
 #else
 #include <stdint.h>
 typedef uint16_t stbi__uint16;
 typedef int16_t  stbi__int16;
 typedef uint32_t stbi__uint32;
 typedef int32_t  stbi__int32;
+typedef uint64_t stbi__uint64;
 #endif
 
 // should produce compiler error if size is wrong
@@ -695,7 +749,7 @@ static int stbi__cpuid3(void)
 
 #define STBI_SIMD_ALIGN(type, name) __declspec(align(16)) type name
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_ZLIB)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
    int info3 = stbi__cpuid3();
@@ -706,7 +760,7 @@ static int stbi__sse2_available(void)
 #else // assume GCC-style if not VC++
 #define STBI_SIMD_ALIGN(type, name) type name __attribute__((aligned(16)))
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_ZLIB)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
    // If we're even attempting to compile this on GCC/Clang, that means
@@ -719,6 +773,40 @@ static int stbi__sse2_available(void)
 #endif
 #endif
 
+// AVX2 JPEG kernels, compiled for the AVX2 target and picked at run time
+#if defined(STBI_SSE2) && !defined(STBI_NO_AVX2) && !defined(STBI_NO_JPEG)
+#if defined(_MSC_VER) && _MSC_VER >= 1700
+#define STBI_AVX2
+#define STBI__AVX2_TARGET
+#elif defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define STBI_AVX2
+#define STBI__AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef STBI_AVX2
+#include <immintrin.h>
+
+static int stbi__avx2_available(void)
+{
+#if defined(__AVX2__)
+   return 1;
+#elif defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7) return 0;
+   // the OS has to save ymm registers too: OSXSAVE and AVX, then XCR0
+   __cpuid(info, 1);
+   if ((info[2] & (3 << 27)) != (3 << 27) || (_xgetbv(0) & 6) != 6) return 0;
+   __cpuidex(info, 7, 0);
+   return (info[1] >> 5) & 1;
+#else
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
 // ARM NEON
 #if defined(STBI_NO_SIMD) && defined(STBI_NEON)
 #undef STBI_NEON
@@ -738,12 +826,21 @@ static int stbi__sse2_available(void)
 //
 //  stbi__context struct and start_xxx functions
 
+// destination of the stbi_load_into functions: row j of the image starts at
+// out + j*stride, stride being negative when flipping
+typedef struct
+{
+   stbi_uc *out;
+   int w, h, stride, n;
+} stbi__into;
+
 // stbi__context structure is our basic context used by all images, so it
 // contains all the IO context, plus some basic image information
 typedef struct
 {
    stbi__uint32 img_x, img_y;
    int img_n, img_out_n;
+   stbi__into *into;   // NULL unless decoding for stbi_load_into
 
    stbi_io_callbacks io;
    void *io_user_data;
@@ -763,6 +860,7 @@ static void stbi__refill_buffer(stbi__context *s);
 static void stbi__start_mem(stbi__context *s, stbi_uc const *buffer, int len)
 {
    s->io.read = NULL;
+   s->into = NULL;
    s->read_from_callbacks = 0;
    s->img_buffer = s->img_buffer_original = (stbi_uc *) buffer;
    s->img_buffer_end = s->img_buffer_original_end = (stbi_uc *) buffer+len;
@@ -773,6 +871,7 @@ static void stbi__start_callbacks(stbi__context *s, stbi_io_callbacks *c, void *
 {
    s->io = *c;
    s->io_user_data = user;
+   s->into = NULL;
    s->buflen = sizeof(s->buffer_start);
    s->read_from_callbacks = 1;
    s->img_buffer_original = s->buffer_start;
@@ -1030,6 +1129,28 @@ STBIDEF void stbi_set_flip_vertically_on_load(int flag_true_if_should_flip)
    stbi__vertically_flip_on_load_global = flag_true_if_should_flip;
 }
 
+static stbi_parallel_for *stbi__jpeg_parallel_run = NULL;
+static void *stbi__jpeg_parallel_user = NULL;
+static int stbi__jpeg_parallel_threads = 1;
+
+STBIDEF void stbi_set_jpeg_parallel(stbi_parallel_for *run, void *user, int threads)
+{
+   stbi__jpeg_parallel_run = run;
+   stbi__jpeg_parallel_user = user;
+   stbi__jpeg_parallel_threads = threads;
+}
+
+static stbi_parallel_for *stbi__png_parallel_run = NULL;
+static void *stbi__png_parallel_user = NULL;
+static int stbi__png_parallel_threads = 1;
+
+STBIDEF void stbi_set_png_parallel(stbi_parallel_for *run, void *user, int threads)
+{
+   stbi__png_parallel_run = run;
+   stbi__png_parallel_user = user;
+   stbi__png_parallel_threads = threads;
+}
+
 #ifndef STBI_THREAD_LOCAL
 #define stbi__vertically_flip_on_load  stbi__vertically_flip_on_load_global
 #else
@@ -1187,6 +1308,49 @@ static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x,
    return (unsigned char *) result;
 }
 
+// the stbi_load_into functions: decoders that write the final rows through
+// s->into return its 'out', the others return an image of req_comp
+// components that is narrowed, flipped and copied here in one pass
+static int stbi__load_into(stbi__context *s, stbi_uc *out, int x, int y, int stride, int *comp, int req_comp, int flip)
+{
+   stbi__into into;
+   stbi__result_info ri;
+   void *result;
+   int w, h, j, i;
+
+   if (req_comp < 1 || req_comp > 4) return stbi__err("bad req_comp", "Internal error");
+   if (!out || x <= 0 || y <= 0 || !stbi__mul2sizes_valid(x, req_comp) || stride < x*req_comp)
+      return stbi__err("bad output", "Invalid output buffer");
+
+   into.out = flip ? out + (size_t) (y-1) * stride : out;
+   into.stride = flip ? -stride : stride;
+   into.w = x;
+   into.h = y;
+   into.n = req_comp;
+   s->into = &into;
+   result = stbi__load_main(s, &w, &h, comp, req_comp, &ri, 8);
+   s->into = NULL;
+
+   if (result == NULL) return 0;
+   if (result == into.out) return 1;
+   if (w != x || h != y) {
+      STBI_FREE(result);
+      return stbi__err("bad size", "Image size differs from output");
+   }
+   for (j=0; j < h; ++j) {
+      stbi_uc *row = into.out + (ptrdiff_t) j * into.stride;
+      if (ri.bits_per_channel == 16) {
+         stbi__uint16 *src = (stbi__uint16 *) result + (size_t) j * w * req_comp;
+         for (i=0; i < w * req_comp; ++i)
+            row[i] = (stbi_uc) (src[i] >> 8);
+      } else {
+         memcpy(row, (stbi_uc *) result + (size_t) j * w * req_comp, (size_t) w * req_comp);
+      }
+   }
+   STBI_FREE(result);
+   return 1;
+}
+
 static stbi__uint16 *stbi__load_and_postprocess_16bit(stbi__context *s, int *x, int *y, int *comp, int req_comp)
 {
    stbi__result_info ri;
@@ -1288,6 +1452,29 @@ STBIDEF stbi_uc *stbi_load_from_file(FILE *f, int *x, int *y, int *comp, int req
    return result;
 }
 
+STBIDEF int stbi_load_into(char const *filename, stbi_uc *out, int x, int y, int stride_in_bytes, int *comp, int req_comp, int flip_vertically)
+{
+   FILE *f = stbi__fopen(filename, "rb");
+   int result;
+   if (!f) return stbi__err("can't fopen", "Unable to open file");
+   result = stbi_load_from_file_into(f,out,x,y,stride_in_bytes,comp,req_comp,flip_vertically);
+   fclose(f);
+   return result;
+}
+
+STBIDEF int stbi_load_from_file_into(FILE *f, stbi_uc *out, int x, int y, int stride_in_bytes, int *comp, int req_comp, int flip_vertically)
+{
+   int result;
+   stbi__context s;
+   stbi__start_file(&s,f);
+   result = stbi__load_into(&s,out,x,y,stride_in_bytes,comp,req_comp,flip_vertically);
+   if (result) {
+      // need to 'unget' all the characters in the IO buffer
+      fseek(f, - (int) (s.img_buffer_end - s.img_buffer), SEEK_CUR);
+   }
+   return result;
+}
+
 STBIDEF stbi__uint16 *stbi_load_from_file_16(FILE *f, int *x, int *y, int *comp, int req_comp)
 {
    stbi__uint16 *result;
@@ -1342,6 +1529,20 @@ STBIDEF stbi_uc *stbi_load_from_callbacks(stbi_io_callbacks const *clbk, void *u
    return stbi__load_and_postprocess_8bit(&s,x,y,comp,req_comp);
 }
 
+STBIDEF int stbi_load_from_memory_into(stbi_uc const *buffer, int len, stbi_uc *out, int x, int y, int stride_in_bytes, int *comp, int req_comp, int flip_vertically)
+{
+   stbi__context s;
+   stbi__start_mem(&s,buffer,len);
+   return stbi__load_into(&s,out,x,y,stride_in_bytes,comp,req_comp,flip_vertically);
+}
+
+STBIDEF int stbi_load_from_callbacks_into(stbi_io_callbacks const *clbk, void *user, stbi_uc *out, int x, int y, int stride_in_bytes, int *comp, int req_comp, int flip_vertically)
+{
+   stbi__context s;
+   stbi__start_callbacks(&s, (stbi_io_callbacks *) clbk, user);
+   return stbi__load_into(&s,out,x,y,stride_in_bytes,comp,req_comp,flip_vertically);
+}
+
 #ifndef STBI_NO_GIF
 STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int **delays, int *x, int *y, int *z, int *comp, int req_comp)
 {
@@ -1808,6 +2009,42 @@ static stbi_uc *stbi__hdr_to_ldr(float   *data, int x, int y, int comp)
 }
 #endif
 
+// threads share decode progress through a few counters; compilers without
+// these atomics always decode serially, as do builds defining
+// STBI_NO_JPEG_THREADS or STBI_NO_PNG_THREADS for that format
+#if !defined(STBI_NO_JPEG) && !defined(STBI_NO_JPEG_THREADS) && (defined(__GNUC__) || defined(_MSC_VER))
+#define STBI__JPEG_THREADS
+#endif
+#if !defined(STBI_NO_PNG) && !defined(STBI_NO_PNG_THREADS) && (defined(__GNUC__) || defined(_MSC_VER))
+#define STBI__PNG_THREADS
+#endif
+
+#if defined(STBI__JPEG_THREADS) || defined(STBI__PNG_THREADS)
+#ifdef _MSC_VER
+#include <intrin.h>
+typedef long stbi__atomic;
+static int stbi__atomic_get(stbi__atomic *p) { return (int) _InterlockedOr(p, 0); }
+static void stbi__atomic_set(stbi__atomic *p, int v) { _InterlockedExchange(p, v); }
+static int stbi__atomic_inc(stbi__atomic *p) { return (int) _InterlockedExchangeAdd(p, 1); }
+// moves *p from 'from' to from+1, fails if another thread got there first
+static int stbi__atomic_claim(stbi__atomic *p, int from) { return _InterlockedCompareExchange(p, from + 1, from) == from; }
+#else
+typedef int stbi__atomic;
+static int stbi__atomic_get(stbi__atomic *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void stbi__atomic_set(stbi__atomic *p, int v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static int stbi__atomic_inc(stbi__atomic *p) { return __atomic_fetch_add(p, 1, __ATOMIC_ACQ_REL); }
+static int stbi__atomic_claim(stbi__atomic *p, int from) { return __atomic_compare_exchange_n(p, &from, from + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); }
+#endif
+
+static void stbi__pause(void)
+{
+#ifdef STBI_SSE2
+   _mm_pause();
+#endif
+}
+
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //  "baseline" JPEG/JFIF decoder
@@ -1831,6 +2068,13 @@ static stbi_uc *stbi__hdr_to_ldr(float   *data, int x, int y, int comp)
 
 #ifndef STBI_NO_JPEG
 
+#ifdef STBI__JPEG_THREADS
+// images with fewer pixels decode on the calling thread
+#define STBI__JPEG_THREAD_MIN_PIXELS  (256*256)
+// pauses a helper task waits for work before leaving the rest to the decoder
+#define STBI__JPEG_MAX_SPINS          (1 << 16)
+#endif
+
 // huffman decoding acceleration
 #define FAST_BITS   9  // larger handles more cases; smaller stomps less cache
 
@@ -1895,8 +2139,20 @@ typedef struct
 
 // kernels
    void (*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
+   void (*idct_2blocks_kernel)(stbi_uc *out, int out_stride, short data[128]); // NULL if none
    void (*YCbCr_to_RGB_kernel)(stbi_uc *out, const stbi_uc *y, const stbi_uc *pcb, const stbi_uc *pcr, int count, int step);
    stbi_uc *(*resample_row_hv_2_kernel)(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs);
+
+// output, allocated once the frame is known so the decode can fill it, or
+// the caller's rows for stbi_load_into
+   int req_comp, out_n, decode_n, is_rgb;
+   stbi_uc *output;
+   int output_stride, output_into;
+   int converted;      // set once the whole output is written
+
+// rest of a callback stream, read in to split it at restart markers
+   stbi__context in_memory;
+   stbi_uc *in_memory_data;
 } stbi__jpeg;
 
 static int stbi__build_huffman(stbi__huffman *h, int *count)
@@ -2031,6 +2287,8 @@ stbi_inline static int stbi__jpeg_huff_decode(stbi__jpeg *j, stbi__huffman *h)
 
    // convert the huffman code to the symbol id
    c = ((j->code_buffer >> (32 - k)) & stbi__bmask[k]) + h->delta[k];
+   if (c < 0 || c >= 256) // symbol id out of bounds
+      return -1;
    STBI_ASSERT((((j->code_buffer) >> (32 - h->size[c])) & stbi__bmask[h->size[c]]) == h->code[c]);
 
    // convert the id to a symbol
@@ -2106,7 +2364,7 @@ static int stbi__jpeg_decode_block(stbi__jpeg *j, short data[64], stbi__huffman
 
    if (j->code_bits < 16) stbi__grow_buffer_unsafe(j);
    t = stbi__jpeg_huff_decode(j, hdc);
-   if (t < 0) return stbi__err("bad huffman code","Corrupt JPEG");
+   if (t < 0 || t > 15) return stbi__err("bad huffman code","Corrupt JPEG");
 
    // 0 all the ac values now so we can do it 32-bits at a time
    memset(data,0,64*sizeof(data[0]));
@@ -2163,6 +2421,7 @@ static int stbi__jpeg_decode_block_prog_dc(stbi__jpeg *j, short data[64], stbi__
       // first scan for DC coefficient, must be first
       memset(data,0,64*sizeof(data[0])); // 0 all the ac values now
       t = stbi__jpeg_huff_decode(j, hdc);
+      if (t < 0 || t > 15) return stbi__err("bad huffman code","Corrupt JPEG");
       diff = t ? stbi__extend_receive(j, t) : 0;
 
       dc = j->img_comp[b].dc_pred + diff;
@@ -2589,6 +2848,181 @@ static void stbi__idct_simd(stbi_uc *out, int out_stride, short data[64])
 
 #endif // STBI_SSE2
 
+#ifdef STBI_AVX2
+// avx2 version of stbi__idct_simd, same arithmetic on two horizontally
+// adjacent blocks at once: data[0..63] is written to out, data[64..127] to
+// out+8. Each 128-bit lane runs the sse2 code on one block.
+static STBI__AVX2_TARGET void stbi__idct_avx2(stbi_uc *out, int out_stride, short data[128])
+{
+   __m256i row0, row1, row2, row3, row4, row5, row6, row7;
+   __m256i tmp;
+
+   #define dct_const(x,y)  _mm256_setr_epi16((x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y))
+
+   #define dct_rot(out0,out1, x,y,c0,c1) \
+      __m256i c0##lo = _mm256_unpacklo_epi16((x),(y)); \
+      __m256i c0##hi = _mm256_unpackhi_epi16((x),(y)); \
+      __m256i out0##_l = _mm256_madd_epi16(c0##lo, c0); \
+      __m256i out0##_h = _mm256_madd_epi16(c0##hi, c0); \
+      __m256i out1##_l = _mm256_madd_epi16(c0##lo, c1); \
+      __m256i out1##_h = _mm256_madd_epi16(c0##hi, c1)
+
+   #define dct_widen(out, in) \
+      __m256i out##_l = _mm256_srai_epi32(_mm256_unpacklo_epi16(_mm256_setzero_si256(), (in)), 4); \
+      __m256i out##_h = _mm256_srai_epi32(_mm256_unpackhi_epi16(_mm256_setzero_si256(), (in)), 4)
+
+   #define dct_wadd(out, a, b) \
+      __m256i out##_l = _mm256_add_epi32(a##_l, b##_l); \
+      __m256i out##_h = _mm256_add_epi32(a##_h, b##_h)
+
+   #define dct_wsub(out, a, b) \
+      __m256i out##_l = _mm256_sub_epi32(a##_l, b##_l); \
+      __m256i out##_h = _mm256_sub_epi32(a##_h, b##_h)
+
+   #define dct_bfly32o(out0, out1, a,b,bias,s) \
+      { \
+         __m256i abiased_l = _mm256_add_epi32(a##_l, bias); \
+         __m256i abiased_h = _mm256_add_epi32(a##_h, bias); \
+         dct_wadd(sum, abiased, b); \
+         dct_wsub(dif, abiased, b); \
+         out0 = _mm256_packs_epi32(_mm256_srai_epi32(sum_l, s), _mm256_srai_epi32(sum_h, s)); \
+         out1 = _mm256_packs_epi32(_mm256_srai_epi32(dif_l, s), _mm256_srai_epi32(dif_h, s)); \
+      }
+
+   #define dct_interleave8(a, b) \
+      tmp = a; \
+      a = _mm256_unpacklo_epi8(a, b); \
+      b = _mm256_unpackhi_epi8(tmp, b)
+
+   #define dct_interleave16(a, b) \
+      tmp = a; \
+      a = _mm256_unpacklo_epi16(a, b); \
+      b = _mm256_unpackhi_epi16(tmp, b)
+
+   #define dct_pass(bias,shift) \
+      { \
+         /* even part */ \
+         dct_rot(t2e,t3e, row2,row6, rot0_0,rot0_1); \
+         __m256i sum04 = _mm256_add_epi16(row0, row4); \
+         __m256i dif04 = _mm256_sub_epi16(row0, row4); \
+         dct_widen(t0e, sum04); \
+         dct_widen(t1e, dif04); \
+         dct_wadd(x0, t0e, t3e); \
+         dct_wsub(x3, t0e, t3e); \
+         dct_wadd(x1, t1e, t2e); \
+         dct_wsub(x2, t1e, t2e); \
+         /* odd part */ \
+         dct_rot(y0o,y2o, row7,row3, rot2_0,rot2_1); \
+         dct_rot(y1o,y3o, row5,row1, rot3_0,rot3_1); \
+         __m256i sum17 = _mm256_add_epi16(row1, row7); \
+         __m256i sum35 = _mm256_add_epi16(row3, row5); \
+         dct_rot(y4o,y5o, sum17,sum35, rot1_0,rot1_1); \
+         dct_wadd(x4, y0o, y4o); \
+         dct_wadd(x5, y1o, y5o); \
+         dct_wadd(x6, y2o, y5o); \
+         dct_wadd(x7, y3o, y4o); \
+         dct_bfly32o(row0,row7, x0,x7,bias,shift); \
+         dct_bfly32o(row1,row6, x1,x6,bias,shift); \
+         dct_bfly32o(row2,row5, x2,x5,bias,shift); \
+         dct_bfly32o(row3,row4, x3,x4,bias,shift); \
+      }
+
+   // row k of the first block in the low lane, of the second in the high lane
+   #define dct_load(k) \
+      _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_load_si128((const __m128i *) (data + (k)*8))), \
+                              _mm_load_si128((const __m128i *) (data + 64 + (k)*8)), 1)
+
+   // p holds rows r, r+1 of both blocks as qwords A(r) A(r+1) B(r) B(r+1)
+   #define dct_store2(p) \
+      { \
+         __m256i q = _mm256_permute4x64_epi64(p, 0xd8); \
+         _mm_storeu_si128((__m128i *) out, _mm256_castsi256_si128(q)); out += out_stride; \
+         _mm_storeu_si128((__m128i *) out, _mm256_extracti128_si256(q, 1)); out += out_stride; \
+      }
+
+   __m256i rot0_0 = dct_const(stbi__f2f(0.5411961f), stbi__f2f(0.5411961f) + stbi__f2f(-1.847759065f));
+   __m256i rot0_1 = dct_const(stbi__f2f(0.5411961f) + stbi__f2f( 0.765366865f), stbi__f2f(0.5411961f));
+   __m256i rot1_0 = dct_const(stbi__f2f(1.175875602f) + stbi__f2f(-0.899976223f), stbi__f2f(1.175875602f));
+   __m256i rot1_1 = dct_const(stbi__f2f(1.175875602f), stbi__f2f(1.175875602f) + stbi__f2f(-2.562915447f));
+   __m256i rot2_0 = dct_const(stbi__f2f(-1.961570560f) + stbi__f2f( 0.298631336f), stbi__f2f(-1.961570560f));
+   __m256i rot2_1 = dct_const(stbi__f2f(-1.961570560f), stbi__f2f(-1.961570560f) + stbi__f2f( 3.072711026f));
+   __m256i rot3_0 = dct_const(stbi__f2f(-0.390180644f) + stbi__f2f( 2.053119869f), stbi__f2f(-0.390180644f));
+   __m256i rot3_1 = dct_const(stbi__f2f(-0.390180644f), stbi__f2f(-0.390180644f) + stbi__f2f( 1.501321110f));
+
+   __m256i bias_0 = _mm256_set1_epi32(512);
+   __m256i bias_1 = _mm256_set1_epi32(65536 + (128<<17));
+
+   row0 = dct_load(0);
+   row1 = dct_load(1);
+   row2 = dct_load(2);
+   row3 = dct_load(3);
+   row4 = dct_load(4);
+   row5 = dct_load(5);
+   row6 = dct_load(6);
+   row7 = dct_load(7);
+
+   // column pass
+   dct_pass(bias_0, 10);
+
+   {
+      // 16bit 8x8 transposes, within each lane
+      dct_interleave16(row0, row4);
+      dct_interleave16(row1, row5);
+      dct_interleave16(row2, row6);
+      dct_interleave16(row3, row7);
+
+      dct_interleave16(row0, row2);
+      dct_interleave16(row1, row3);
+      dct_interleave16(row4, row6);
+      dct_interleave16(row5, row7);
+
+      dct_interleave16(row0, row1);
+      dct_interleave16(row2, row3);
+      dct_interleave16(row4, row5);
+      dct_interleave16(row6, row7);
+   }
+
+   // row pass
+   dct_pass(bias_1, 17);
+
+   {
+      __m256i p0 = _mm256_packus_epi16(row0, row1);
+      __m256i p1 = _mm256_packus_epi16(row2, row3);
+      __m256i p2 = _mm256_packus_epi16(row4, row5);
+      __m256i p3 = _mm256_packus_epi16(row6, row7);
+
+      // 8bit 8x8 transposes, within each lane
+      dct_interleave8(p0, p2);
+      dct_interleave8(p1, p3);
+
+      dct_interleave8(p0, p1);
+      dct_interleave8(p2, p3);
+
+      dct_interleave8(p0, p2);
+      dct_interleave8(p1, p3);
+
+      // store, 16 bytes per row covering both blocks
+      dct_store2(p0);
+      dct_store2(p2);
+      dct_store2(p1);
+      dct_store2(p3);
+   }
+
+#undef dct_const
+#undef dct_rot
+#undef dct_widen
+#undef dct_wadd
+#undef dct_wsub
+#undef dct_bfly32o
+#undef dct_interleave8
+#undef dct_interleave16
+#undef dct_pass
+#undef dct_load
+#undef dct_store2
+}
+
+#endif // STBI_AVX2
+
 #ifdef STBI_NEON
 
 // NEON integer IDCT. should produce bit-identical
@@ -2831,13 +3265,65 @@ static void stbi__jpeg_reset(stbi__jpeg *j)
    // since we don't even allow 1<<30 pixels
 }
 
+// IDCT count consecutive blocks of data to consecutive 8x8 blocks of out,
+// two at a time where there is a kernel for it
+static void stbi__jpeg_idct_blocks(stbi__jpeg *z, stbi_uc *out, int out_stride, short *data, int count)
+{
+   int i = 0;
+   if (z->idct_2blocks_kernel)
+      for (; i+2 <= count; i += 2)
+         z->idct_2blocks_kernel(out + i*8, out_stride, data + i*64);
+   for (; i < count; ++i)
+      z->idct_block_kernel(out + i*8, out_stride, data + i*64);
+}
+
+// holds a decoded block back until the one to its right is decoded, so
+// both go through the two block IDCT
+typedef struct
+{
+   STBI_SIMD_ALIGN(short, data[128]);
+   stbi_uc *out;
+   int out_stride, pending;
+} stbi__jpeg_idct_pair;
+
+static short *stbi__jpeg_pair_next(stbi__jpeg_idct_pair *p)
+{
+   return p->data + p->pending * 64;
+}
+
+static void stbi__jpeg_pair_flush(stbi__jpeg *z, stbi__jpeg_idct_pair *p)
+{
+   if (p->pending) z->idct_block_kernel(p->out, p->out_stride, p->data);
+   p->pending = 0;
+}
+
+// the block just decoded into stbi__jpeg_pair_next goes to out
+static void stbi__jpeg_pair_put(stbi__jpeg *z, stbi__jpeg_idct_pair *p, stbi_uc *out, int out_stride)
+{
+   if (!z->idct_2blocks_kernel) {
+      z->idct_block_kernel(out, out_stride, p->data);
+   } else if (p->pending && out == p->out + 8) {
+      z->idct_2blocks_kernel(p->out, p->out_stride, p->data);
+      p->pending = 0;
+   } else {
+      if (p->pending) {
+         // not its neighbour: IDCT the held block, keep the new one
+         z->idct_block_kernel(p->out, p->out_stride, p->data);
+         memcpy(p->data, p->data + 64, 64 * sizeof(short));
+      }
+      p->out = out;
+      p->out_stride = out_stride;
+      p->pending = 1;
+   }
+}
+
 static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 {
    stbi__jpeg_reset(z);
    if (!z->progressive) {
       if (z->scan_n == 1) {
          int i,j;
-         STBI_SIMD_ALIGN(short, data[64]);
+         stbi__jpeg_idct_pair pair;
          int n = z->order[0];
          // non-interleaved data, we just need to process one block at a time,
          // in trivial scanline order
@@ -2845,25 +3331,27 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
          // component has, independent of interleaved MCU blocking and such
          int w = (z->img_comp[n].x+7) >> 3;
          int h = (z->img_comp[n].y+7) >> 3;
+         pair.pending = 0;
          for (j=0; j < h; ++j) {
             for (i=0; i < w; ++i) {
                int ha = z->img_comp[n].ha;
-               if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               if (!stbi__jpeg_decode_block(z, stbi__jpeg_pair_next(&pair), z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+               stbi__jpeg_pair_put(z, &pair, z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2);
                // every data block is an MCU, so countdown the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
                   // if it's NOT a restart, then just bail, so we get corrupt data
                   // rather than no data
-                  if (!STBI__RESTART(z->marker)) return 1;
+                  if (!STBI__RESTART(z->marker)) { stbi__jpeg_pair_flush(z, &pair); return 1; }
                   stbi__jpeg_reset(z);
                }
             }
          }
+         stbi__jpeg_pair_flush(z, &pair);
          return 1;
       } else { // interleaved
          int i,j,k,x,y;
-         STBI_SIMD_ALIGN(short, data[64]);
+         STBI_SIMD_ALIGN(short, data[4*64]);
          for (j=0; j < z->img_mcu_y; ++j) {
             for (i=0; i < z->img_mcu_x; ++i) {
                // scan an interleaved mcu... process scan_n components in order
@@ -2872,13 +3360,12 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
                   // scan out an mcu's worth of this component; that's just determined
                   // by the basic H and V specified for the component
                   for (y=0; y < z->img_comp[n].v; ++y) {
-                     for (x=0; x < z->img_comp[n].h; ++x) {
-                        int x2 = (i*z->img_comp[n].h + x)*8;
-                        int y2 = (j*z->img_comp[n].v + y)*8;
-                        int ha = z->img_comp[n].ha;
-                        if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                        z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
-                     }
+                     int x2 = i*z->img_comp[n].h*8;
+                     int y2 = (j*z->img_comp[n].v + y)*8;
+                     int ha = z->img_comp[n].ha;
+                     for (x=0; x < z->img_comp[n].h; ++x)
+                        if (!stbi__jpeg_decode_block(z, data + x*64, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+                     stbi__jpeg_idct_blocks(z, z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data, z->img_comp[n].h);
                   }
                }
                // after all interleaved components, that's an interleaved MCU,
@@ -2971,11 +3458,10 @@ static void stbi__jpeg_finish(stbi__jpeg *z)
          int w = (z->img_comp[n].x+7) >> 3;
          int h = (z->img_comp[n].y+7) >> 3;
          for (j=0; j < h; ++j) {
-            for (i=0; i < w; ++i) {
-               short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
-               stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
-            }
+            short *data = z->img_comp[n].coeff + 64 * j * z->img_comp[n].coeff_w;
+            for (i=0; i < w; ++i)
+               stbi__jpeg_dequantize(data + 64*i, z->dequant[z->img_comp[n].tq]);
+            stbi__jpeg_idct_blocks(z, z->img_comp[n].data+z->img_comp[n].w2*j*8, z->img_comp[n].w2, data, w);
          }
       }
    }
@@ -3261,10 +3747,14 @@ static int stbi__decode_jpeg_header(stbi__jpeg *z, int scan)
    return 1;
 }
 
+#ifdef STBI__JPEG_THREADS
+static int stbi__jpeg_parallel_scan(stbi__jpeg *z);
+#endif
+
 // decode image to YCbCr format
 static int stbi__decode_jpeg_image(stbi__jpeg *j)
 {
-   int m;
+   int m, r;
    for (m = 0; m < 4; m++) {
       j->img_comp[m].raw_data = NULL;
       j->img_comp[m].raw_coeff = NULL;
@@ -3275,7 +3765,12 @@ static int stbi__decode_jpeg_image(stbi__jpeg *j)
    while (!stbi__EOI(m)) {
       if (stbi__SOS(m)) {
          if (!stbi__process_scan_header(j)) return 0;
-         if (!stbi__parse_entropy_coded_data(j)) return 0;
+         r = -1;
+#ifdef STBI__JPEG_THREADS
+         r = stbi__jpeg_parallel_scan(j);
+#endif
+         if (r < 0) r = stbi__parse_entropy_coded_data(j);
+         if (!r) return 0;
          if (j->marker == STBI__MARKER_none ) {
             // handle 0s at the end of image data from IP Kamera 9060
             while (!stbi__at_eof(j->s)) {
@@ -3499,6 +3994,70 @@ static stbi_uc *stbi__resample_row_hv_2_simd(stbi_uc *out, stbi_uc *in_near, stb
 }
 #endif
 
+#ifdef STBI_AVX2
+// stbi__resample_row_hv_2_simd on 16 pixels at a time
+static STBI__AVX2_TARGET stbi_uc *stbi__resample_row_hv_2_avx2(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs)
+{
+   int i=0,t0,t1;
+
+   if (w == 1) {
+      out[0] = out[1] = stbi__div4(3*in_near[0] + in_far[0] + 2);
+      return out;
+   }
+
+   t1 = 3*in_near[0] + in_far[0];
+   for (; i < ((w-1) & ~15); i += 16) {
+      // vertical pass, 3*x + y = 4*x + (y - x)
+      __m256i farw  = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *) (in_far + i)));
+      __m256i nearw = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *) (in_near + i)));
+      __m256i diff  = _mm256_sub_epi16(farw, nearw);
+      __m256i nears = _mm256_slli_epi16(nearw, 2);
+      __m256i curr  = _mm256_add_epi16(nears, diff);
+
+      // the shifts by one pixel cross the lanes: bring in the other lane
+      // (or zero) before alignr, then insert the pixels from outside
+      __m256i prv0 = _mm256_alignr_epi8(curr, _mm256_permute2x128_si256(curr, curr, 0x08), 14);
+      __m256i nxt0 = _mm256_alignr_epi8(_mm256_permute2x128_si256(curr, curr, 0x81), curr, 2);
+      __m256i prev = _mm256_insert_epi16(prv0, t1, 0);
+      __m256i next = _mm256_insert_epi16(nxt0, 3*in_near[i+16] + in_far[i+16], 15);
+
+      // horizontal pass, same polyphase filter as the sse2 version
+      __m256i bias = _mm256_set1_epi16(8);
+      __m256i curs = _mm256_slli_epi16(curr, 2);
+      __m256i prvd = _mm256_sub_epi16(prev, curr);
+      __m256i nxtd = _mm256_sub_epi16(next, curr);
+      __m256i curb = _mm256_add_epi16(curs, bias);
+      __m256i even = _mm256_add_epi16(prvd, curb);
+      __m256i odd  = _mm256_add_epi16(nxtd, curb);
+
+      // interleave and undo scaling; each lane packs back to its 8 pixels
+      __m256i int0 = _mm256_unpacklo_epi16(even, odd);
+      __m256i int1 = _mm256_unpackhi_epi16(even, odd);
+      __m256i de0  = _mm256_srli_epi16(int0, 4);
+      __m256i de1  = _mm256_srli_epi16(int1, 4);
+      _mm256_storeu_si256((__m256i *) (out + i*2), _mm256_packus_epi16(de0, de1));
+
+      t1 = 3*in_near[i+15] + in_far[i+15];
+   }
+
+   t0 = t1;
+   t1 = 3*in_near[i] + in_far[i];
+   out[i*2] = stbi__div16(3*t1 + t0 + 8);
+
+   for (++i; i < w; ++i) {
+      t0 = t1;
+      t1 = 3*in_near[i]+in_far[i];
+      out[i*2-1] = stbi__div16(3*t0 + t1 + 8);
+      out[i*2  ] = stbi__div16(3*t1 + t0 + 8);
+   }
+   out[w*2-1] = stbi__div4(t1+2);
+
+   STBI_NOTUSED(hs);
+
+   return out;
+}
+#endif
+
 static stbi_uc *stbi__resample_row_generic(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs)
 {
    // resample with nearest-neighbor
@@ -3673,20 +4232,134 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
 }
 #endif
 
-// set up the kernels
-static void stbi__setup_jpeg(stbi__jpeg *j)
+#ifdef STBI_AVX2
+// stbi__YCbCr_to_RGB_simd on 16 pixels at a time, for step 3 as well as 4
+static STBI__AVX2_TARGET void stbi__YCbCr_to_RGB_avx2(stbi_uc *out, stbi_uc const *y, stbi_uc const *pcb, stbi_uc const *pcr, int count, int step)
 {
-   j->idct_block_kernel = stbi__idct_block;
-   j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
-   j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
+   int i = 0;
 
-#ifdef STBI_SSE2
-   if (stbi__sse2_available()) {
-      j->idct_block_kernel = stbi__idct_simd;
-      j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_simd;
-      j->resample_row_hv_2_kernel = stbi__resample_row_hv_2_simd;
-   }
-#endif
+   if (step == 3 || step == 4) {
+      __m128i signflip  = _mm_set1_epi8(-0x80);
+      __m256i cr_const0 = _mm256_set1_epi16(   (short) ( 1.40200f*4096.0f+0.5f));
+      __m256i cr_const1 = _mm256_set1_epi16( - (short) ( 0.71414f*4096.0f+0.5f));
+      __m256i cb_const0 = _mm256_set1_epi16( - (short) ( 0.34414f*4096.0f+0.5f));
+      __m256i cb_const1 = _mm256_set1_epi16(   (short) ( 1.77200f*4096.0f+0.5f));
+      __m256i y_bias = _mm256_set1_epi16(128);
+      __m256i xw = _mm256_set1_epi16(255); // alpha channel
+
+      for (; i+15 < count; i += 16) {
+         // load, -128 on cr and cb
+         __m128i y_bytes = _mm_loadu_si128((__m128i *) (y+i));
+         __m128i cr_biased = _mm_xor_si128(_mm_loadu_si128((__m128i *) (pcr+i)), signflip);
+         __m128i cb_biased = _mm_xor_si128(_mm_loadu_si128((__m128i *) (pcb+i)), signflip);
+
+         // to short, the byte in the high half as the sse2 unpacks leave it
+         __m256i yw  = _mm256_or_si256(_mm256_slli_epi16(_mm256_cvtepu8_epi16(y_bytes), 8), y_bias);
+         __m256i crw = _mm256_slli_epi16(_mm256_cvtepi8_epi16(cr_biased), 8);
+         __m256i cbw = _mm256_slli_epi16(_mm256_cvtepi8_epi16(cb_biased), 8);
+
+         // color transform
+         __m256i yws = _mm256_srli_epi16(yw, 4);
+         __m256i cr0 = _mm256_mulhi_epi16(cr_const0, crw);
+         __m256i cb0 = _mm256_mulhi_epi16(cb_const0, cbw);
+         __m256i cb1 = _mm256_mulhi_epi16(cbw, cb_const1);
+         __m256i cr1 = _mm256_mulhi_epi16(crw, cr_const1);
+         __m256i rws = _mm256_add_epi16(cr0, yws);
+         __m256i gwt = _mm256_add_epi16(cb0, yws);
+         __m256i bws = _mm256_add_epi16(yws, cb1);
+         __m256i gws = _mm256_add_epi16(gwt, cr1);
+
+         // descale
+         __m256i rw = _mm256_srai_epi16(rws, 4);
+         __m256i bw = _mm256_srai_epi16(bws, 4);
+         __m256i gw = _mm256_srai_epi16(gws, 4);
+
+         if (step == 4) {
+            // the sse2 transpose in each lane gives pixels 0-3 and 8-11 in
+            // o0, 4-7 and 12-15 in o1
+            __m256i brb = _mm256_packus_epi16(rw, bw);
+            __m256i gxb = _mm256_packus_epi16(gw, xw);
+            __m256i t0 = _mm256_unpacklo_epi8(brb, gxb);
+            __m256i t1 = _mm256_unpackhi_epi8(brb, gxb);
+            __m256i o0 = _mm256_unpacklo_epi16(t0, t1);
+            __m256i o1 = _mm256_unpackhi_epi16(t0, t1);
+            _mm256_storeu_si256((__m256i *) (out + 0), _mm256_permute2x128_si256(o0, o1, 0x20));
+            _mm256_storeu_si256((__m256i *) (out + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+            out += 64;
+         } else {
+            // 16 bytes per channel, then each 16 byte chunk of the output
+            // gathers its bytes of r, g and b with one shuffle each
+            __m256i rg = _mm256_permute4x64_epi64(_mm256_packus_epi16(rw, gw), 0xd8);
+            __m256i bb = _mm256_permute4x64_epi64(_mm256_packus_epi16(bw, bw), 0xd8);
+            __m128i r = _mm256_castsi256_si128(rg);
+            __m128i g = _mm256_extracti128_si256(rg, 1);
+            __m128i b = _mm256_castsi256_si128(bb);
+            __m128i o0 = _mm_or_si128(_mm_or_si128(
+               _mm_shuffle_epi8(r, _mm_setr_epi8( 0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1, 5)),
+               _mm_shuffle_epi8(g, _mm_setr_epi8(-1, 0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1))),
+               _mm_shuffle_epi8(b, _mm_setr_epi8(-1,-1, 0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1)));
+            __m128i o1 = _mm_or_si128(_mm_or_si128(
+               _mm_shuffle_epi8(r, _mm_setr_epi8(-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1,10,-1)),
+               _mm_shuffle_epi8(g, _mm_setr_epi8( 5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1,10))),
+               _mm_shuffle_epi8(b, _mm_setr_epi8(-1, 5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1)));
+            __m128i o2 = _mm_or_si128(_mm_or_si128(
+               _mm_shuffle_epi8(r, _mm_setr_epi8(-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15,-1,-1)),
+               _mm_shuffle_epi8(g, _mm_setr_epi8(-1,-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15,-1))),
+               _mm_shuffle_epi8(b, _mm_setr_epi8(10,-1,-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15)));
+            _mm_storeu_si128((__m128i *) (out + 0), o0);
+            _mm_storeu_si128((__m128i *) (out + 16), o1);
+            _mm_storeu_si128((__m128i *) (out + 32), o2);
+            out += 48;
+         }
+      }
+   }
+
+   for (; i < count; ++i) {
+      int y_fixed = (y[i] << 20) + (1<<19); // rounding
+      int r,g,b;
+      int cr = pcr[i] - 128;
+      int cb = pcb[i] - 128;
+      r = y_fixed + cr* stbi__float2fixed(1.40200f);
+      g = y_fixed + cr*-stbi__float2fixed(0.71414f) + ((cb*-stbi__float2fixed(0.34414f)) & 0xffff0000);
+      b = y_fixed                                   +   cb* stbi__float2fixed(1.77200f);
+      r >>= 20;
+      g >>= 20;
+      b >>= 20;
+      if ((unsigned) r > 255) { if (r < 0) r = 0; else r = 255; }
+      if ((unsigned) g > 255) { if (g < 0) g = 0; else g = 255; }
+      if ((unsigned) b > 255) { if (b < 0) b = 0; else b = 255; }
+      out[0] = (stbi_uc)r;
+      out[1] = (stbi_uc)g;
+      out[2] = (stbi_uc)b;
+      out[3] = 255;
+      out += step;
+   }
+}
+#endif
+
+// set up the kernels
+static void stbi__setup_jpeg(stbi__jpeg *j)
+{
+   j->idct_block_kernel = stbi__idct_block;
+   j->idct_2blocks_kernel = NULL;
+   j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
+   j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
+
+#ifdef STBI_SSE2
+   if (stbi__sse2_available()) {
+      j->idct_block_kernel = stbi__idct_simd;
+      j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_simd;
+      j->resample_row_hv_2_kernel = stbi__resample_row_hv_2_simd;
+   }
+#endif
+
+#ifdef STBI_AVX2
+   if (stbi__avx2_available()) {
+      j->idct_2blocks_kernel = stbi__idct_avx2;
+      j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_avx2;
+      j->resample_row_hv_2_kernel = stbi__resample_row_hv_2_avx2;
+   }
+#endif
 
 #ifdef STBI_NEON
    j->idct_block_kernel = stbi__idct_simd;
@@ -3699,6 +4372,14 @@ static void stbi__setup_jpeg(stbi__jpeg *j)
 static void stbi__cleanup_jpeg(stbi__jpeg *j)
 {
    stbi__free_jpeg_components(j, j->s->img_n, 0);
+   if (j->output) {
+      if (!j->output_into) STBI_FREE(j->output);
+      j->output = NULL;
+   }
+   if (j->in_memory_data) {
+      STBI_FREE(j->in_memory_data);
+      j->in_memory_data = NULL;
+   }
 }
 
 typedef struct
@@ -3718,157 +4399,662 @@ static stbi_uc stbi__blinn_8x8(stbi_uc x, stbi_uc y)
    return (stbi_uc) ((t + (t >>8)) >> 8);
 }
 
-static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp, int req_comp)
+// set up resampling of component k as it stands after 'row' output rows
+static void stbi__jpeg_resampler(stbi__jpeg *z, int k, int row, stbi__resample *r)
 {
-   int n, decode_n, is_rgb;
-   z->s->img_n = 0; // make stbi__cleanup_jpeg safe
+   int t, wraps, last = z->img_comp[k].y - 1;
 
-   // validate req_comp
-   if (req_comp < 0 || req_comp > 4) return stbi__errpuc("bad req_comp", "Internal error");
+   r->hs      = z->img_h_max / z->img_comp[k].h;
+   r->vs      = z->img_v_max / z->img_comp[k].v;
+   r->w_lores = (z->s->img_x + r->hs-1) / r->hs;
 
-   // load a jpeg image from whichever source, but leave in YCbCr format
-   if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
+   if      (r->hs == 1 && r->vs == 1) r->resample = resample_row_1;
+   else if (r->hs == 1 && r->vs == 2) r->resample = stbi__resample_row_v_2;
+   else if (r->hs == 2 && r->vs == 1) r->resample = stbi__resample_row_h_2;
+   else if (r->hs == 2 && r->vs == 2) r->resample = z->resample_row_hv_2_kernel;
+   else                               r->resample = stbi__resample_row_generic;
+
+   // ystep starts at vs/2 and wraps at vs; every wrap moves line0 to line1
+   // and line1 down a row, until the last row
+   t = (r->vs >> 1) + row;
+   wraps = t / r->vs;
+   r->ystep = t % r->vs;
+   r->ypos  = wraps;
+   r->line1 = z->img_comp[k].data + (wraps < last ? wraps : last) * z->img_comp[k].w2;
+   r->line0 = wraps ? z->img_comp[k].data + (wraps-1 < last ? wraps-1 : last) * z->img_comp[k].w2
+                    : z->img_comp[k].data;
+}
+
+// choose the output components and allocate the output, once the frame
+// header is known
+static int stbi__jpeg_begin_output(stbi__jpeg *z)
+{
+   if (z->output) return 1;
 
    // determine actual number of components to generate
-   n = req_comp ? req_comp : z->s->img_n >= 3 ? 3 : 1;
+   z->out_n = z->req_comp ? z->req_comp : z->s->img_n >= 3 ? 3 : 1;
 
-   is_rgb = z->s->img_n == 3 && (z->rgb == 3 || (z->app14_color_transform == 0 && !z->jfif));
+   z->is_rgb = z->s->img_n == 3 && (z->rgb == 3 || (z->app14_color_transform == 0 && !z->jfif));
 
-   if (z->s->img_n == 3 && n < 3 && !is_rgb)
-      decode_n = 1;
+   if (z->s->img_n == 3 && z->out_n < 3 && !z->is_rgb)
+      z->decode_n = 1;
    else
-      decode_n = z->s->img_n;
+      z->decode_n = z->s->img_n;
+
+   if (z->s->into) {
+      stbi__into *into = z->s->into;
+      if (z->s->img_x != (stbi__uint32) into->w || z->s->img_y != (stbi__uint32) into->h)
+         return stbi__err("bad size", "Image size differs from output");
+      z->output = into->out;
+      z->output_stride = into->stride;
+      z->output_into = 1;
+      return 1;
+   }
 
-   // resample and color-convert
-   {
-      int k;
-      unsigned int i,j;
-      stbi_uc *output;
-      stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
+   z->output = (stbi_uc *) stbi__malloc_mad3(z->out_n, z->s->img_x, z->s->img_y, 1);
+   if (!z->output) return stbi__err("outofmem", "Out of memory");
+   z->output_stride = z->out_n * z->s->img_x;
+   return 1;
+}
 
-      stbi__resample res_comp[4];
+// whether every output row goes through a 'last' buffer: the caller's rows
+// have no byte to spare for the conversions to 3 components, or from 4 to 1
+static int stbi__jpeg_bounce_rows(stbi__jpeg *z)
+{
+   return z->output_into && (z->out_n == 3 || (z->out_n == 1 && z->s->img_n == 4));
+}
 
-      for (k=0; k < decode_n; ++k) {
-         stbi__resample *r = &res_comp[k];
+// resample and color-convert output rows [j0,j1), with decode_n line
+// buffers big enough for upsampling off the edges. Some conversions write a
+// byte past the end of every row; with a 'last' buffer of img_x*4+1 bytes
+// the last row goes through it, leaving the next row to another thread.
+static void stbi__jpeg_convert(stbi__jpeg *z, int j0, int j1, stbi_uc **linebuf, stbi_uc *last)
+{
+   int k, n = z->out_n, decode_n = z->decode_n, is_rgb = z->is_rgb;
+   int bounce_all = stbi__jpeg_bounce_rows(z);
+   unsigned int i,j;
+   stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
+   stbi__resample res_comp[4];
 
-         // allocate line buffer big enough for upsampling off the edges
-         // with upsample factor of 4
-         z->img_comp[k].linebuf = (stbi_uc *) stbi__malloc(z->s->img_x + 3);
-         if (!z->img_comp[k].linebuf) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
-
-         r->hs      = z->img_h_max / z->img_comp[k].h;
-         r->vs      = z->img_v_max / z->img_comp[k].v;
-         r->ystep   = r->vs >> 1;
-         r->w_lores = (z->s->img_x + r->hs-1) / r->hs;
-         r->ypos    = 0;
-         r->line0   = r->line1 = z->img_comp[k].data;
-
-         if      (r->hs == 1 && r->vs == 1) r->resample = resample_row_1;
-         else if (r->hs == 1 && r->vs == 2) r->resample = stbi__resample_row_v_2;
-         else if (r->hs == 2 && r->vs == 1) r->resample = stbi__resample_row_h_2;
-         else if (r->hs == 2 && r->vs == 2) r->resample = z->resample_row_hv_2_kernel;
-         else                               r->resample = stbi__resample_row_generic;
-      }
+   for (k=0; k < decode_n; ++k)
+      stbi__jpeg_resampler(z, k, j0, &res_comp[k]);
 
-      // can't error after this so, this is safe
-      output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
-      if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
-
-      // now go ahead and resample
-      for (j=0; j < z->s->img_y; ++j) {
-         stbi_uc *out = output + n * z->s->img_x * j;
-         for (k=0; k < decode_n; ++k) {
-            stbi__resample *r = &res_comp[k];
-            int y_bot = r->ystep >= (r->vs >> 1);
-            coutput[k] = r->resample(z->img_comp[k].linebuf,
-                                     y_bot ? r->line1 : r->line0,
-                                     y_bot ? r->line0 : r->line1,
-                                     r->w_lores, r->hs);
-            if (++r->ystep >= r->vs) {
-               r->ystep = 0;
-               r->line0 = r->line1;
-               if (++r->ypos < z->img_comp[k].y)
-                  r->line1 += z->img_comp[k].w2;
-            }
+   for (j=j0; j < (unsigned int) j1; ++j) {
+      stbi_uc *row = z->output + (ptrdiff_t) j * z->output_stride;
+      stbi_uc *out = row;
+      if (last && (bounce_all || j+1 == (unsigned int) j1)) out = last;
+      for (k=0; k < decode_n; ++k) {
+         stbi__resample *r = &res_comp[k];
+         int y_bot = r->ystep >= (r->vs >> 1);
+         coutput[k] = r->resample(linebuf[k],
+                                  y_bot ? r->line1 : r->line0,
+                                  y_bot ? r->line0 : r->line1,
+                                  r->w_lores, r->hs);
+         if (++r->ystep >= r->vs) {
+            r->ystep = 0;
+            r->line0 = r->line1;
+            if (++r->ypos < z->img_comp[k].y)
+               r->line1 += z->img_comp[k].w2;
          }
-         if (n >= 3) {
-            stbi_uc *y = coutput[0];
-            if (z->s->img_n == 3) {
-               if (is_rgb) {
-                  for (i=0; i < z->s->img_x; ++i) {
-                     out[0] = y[i];
-                     out[1] = coutput[1][i];
-                     out[2] = coutput[2][i];
-                     out[3] = 255;
-                     out += n;
-                  }
-               } else {
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-               }
-            } else if (z->s->img_n == 4) {
-               if (z->app14_color_transform == 0) { // CMYK
-                  for (i=0; i < z->s->img_x; ++i) {
-                     stbi_uc m = coutput[3][i];
-                     out[0] = stbi__blinn_8x8(coutput[0][i], m);
-                     out[1] = stbi__blinn_8x8(coutput[1][i], m);
-                     out[2] = stbi__blinn_8x8(coutput[2][i], m);
-                     out[3] = 255;
-                     out += n;
-                  }
-               } else if (z->app14_color_transform == 2) { // YCCK
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-                  for (i=0; i < z->s->img_x; ++i) {
-                     stbi_uc m = coutput[3][i];
-                     out[0] = stbi__blinn_8x8(255 - out[0], m);
-                     out[1] = stbi__blinn_8x8(255 - out[1], m);
-                     out[2] = stbi__blinn_8x8(255 - out[2], m);
-                     out += n;
-                  }
-               } else { // YCbCr + alpha?  Ignore the fourth channel for now
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-               }
-            } else
+      }
+      if (n >= 3) {
+         stbi_uc *y = coutput[0];
+         if (z->s->img_n == 3) {
+            if (is_rgb) {
                for (i=0; i < z->s->img_x; ++i) {
-                  out[0] = out[1] = out[2] = y[i];
-                  out[3] = 255; // not used if n==3
+                  out[0] = y[i];
+                  out[1] = coutput[1][i];
+                  out[2] = coutput[2][i];
+                  out[3] = 255;
                   out += n;
                }
-         } else {
-            if (is_rgb) {
-               if (n == 1)
-                  for (i=0; i < z->s->img_x; ++i)
-                     *out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-               else {
-                  for (i=0; i < z->s->img_x; ++i, out += 2) {
-                     out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-                     out[1] = 255;
-                  }
-               }
-            } else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
+            } else {
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+            }
+         } else if (z->s->img_n == 4) {
+            if (z->app14_color_transform == 0) { // CMYK
                for (i=0; i < z->s->img_x; ++i) {
                   stbi_uc m = coutput[3][i];
-                  stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
-                  stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
-                  stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
-                  out[0] = stbi__compute_y(r, g, b);
-                  out[1] = 255;
+                  out[0] = stbi__blinn_8x8(coutput[0][i], m);
+                  out[1] = stbi__blinn_8x8(coutput[1][i], m);
+                  out[2] = stbi__blinn_8x8(coutput[2][i], m);
+                  out[3] = 255;
                   out += n;
                }
-            } else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
+            } else if (z->app14_color_transform == 2) { // YCCK
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
                for (i=0; i < z->s->img_x; ++i) {
-                  out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
-                  out[1] = 255;
+                  stbi_uc m = coutput[3][i];
+                  out[0] = stbi__blinn_8x8(255 - out[0], m);
+                  out[1] = stbi__blinn_8x8(255 - out[1], m);
+                  out[2] = stbi__blinn_8x8(255 - out[2], m);
                   out += n;
                }
-            } else {
-               stbi_uc *y = coutput[0];
-               if (n == 1)
-                  for (i=0; i < z->s->img_x; ++i) out[i] = y[i];
-               else
-                  for (i=0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
+            } else { // YCbCr + alpha?  Ignore the fourth channel for now
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+            }
+         } else
+            for (i=0; i < z->s->img_x; ++i) {
+               out[0] = out[1] = out[2] = y[i];
+               out[3] = 255; // not used if n==3
+               out += n;
+            }
+      } else {
+         if (is_rgb) {
+            if (n == 1)
+               for (i=0; i < z->s->img_x; ++i)
+                  *out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+            else {
+               for (i=0; i < z->s->img_x; ++i, out += 2) {
+                  out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+                  out[1] = 255;
+               }
+            }
+         } else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
+            for (i=0; i < z->s->img_x; ++i) {
+               stbi_uc m = coutput[3][i];
+               stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
+               stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
+               stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
+               out[0] = stbi__compute_y(r, g, b);
+               out[1] = 255;
+               out += n;
             }
+         } else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
+            for (i=0; i < z->s->img_x; ++i) {
+               out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
+               out[1] = 255;
+               out += n;
+            }
+         } else {
+            stbi_uc *y = coutput[0];
+            if (n == 1)
+               for (i=0; i < z->s->img_x; ++i) out[i] = y[i];
+            else
+               for (i=0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
          }
       }
+      if (last && (bounce_all || j+1 == (unsigned int) j1))
+         memcpy(row, last, n * z->s->img_x);
+   }
+}
+
+#ifdef STBI__JPEG_THREADS
+// Parallel decoding through stbi_set_jpeg_parallel(). A baseline scan with
+// restart markers is cut at the markers and every task Huffman decodes and
+// IDCTs whole intervals straight into the component planes. A scan without
+// them holding every component is pipelined: the first task to start
+// Huffman decodes MCU rows into a ring of coefficient rows, while the
+// others run the IDCT of decoded rows and convert the output rows of MCU
+// rows whose neighbours are done too. The decoder helps with the IDCT when
+// the ring is full and joins the others at the end. Any task may find the
+// work done and return, so running the tasks one by one still completes.
+// Anything else converts in bands of rows once decoded.
+
+// threads to decode z with, 0 to stay on the calling thread
+static int stbi__jpeg_threads(stbi__jpeg *z)
+{
+   if (!stbi__jpeg_parallel_run || stbi__jpeg_parallel_threads < 2) return 0;
+   if (z->s->img_x * z->s->img_y < STBI__JPEG_THREAD_MIN_PIXELS) return 0;
+   return stbi__jpeg_parallel_threads;
+}
+
+// switch a callback stream to memory, reading in the rest of it
+static int stbi__jpeg_in_memory(stbi__jpeg *z)
+{
+   stbi__context *s = z->s;
+   stbi_uc *data;
+   int len, size;
+   if (!s->read_from_callbacks) return 1;
+
+   len = (int) (s->img_buffer_end - s->img_buffer);
+   size = len + 65536;
+   data = (stbi_uc *) stbi__malloc(size);
+   if (!data) return stbi__err("outofmem", "Out of memory");
+   memcpy(data, s->img_buffer, len);
+   for (;;) {
+      int n;
+      if (len == size) {
+         stbi_uc *p;
+         if (size > INT_MAX / 2) { STBI_FREE(data); return stbi__err("too large", "Corrupt JPEG"); }
+         p = (stbi_uc *) STBI_REALLOC_SIZED(data, size, size * 2);
+         if (!p) { STBI_FREE(data); return stbi__err("outofmem", "Out of memory"); }
+         data = p;
+         size *= 2;
+      }
+      n = (s->io.read)(s->io_user_data, (char *) data + len, size - len);
+      if (n <= 0) break;
+      len += n;
+   }
+   s->img_buffer = s->img_buffer_end;
+   s->read_from_callbacks = 0;
+
+   z->in_memory = *s;
+   stbi__start_mem(&z->in_memory, data, len);
+   z->in_memory.into = s->into;
+   z->in_memory_data = data;
+   z->s = &z->in_memory;
+   return 1;
+}
+
+// MCUs per row and MCU rows of the current scan; a scan of one component
+// has one block per MCU
+static void stbi__jpeg_scan_size(stbi__jpeg *z, int *mcus_x, int *mcus_y)
+{
+   if (z->scan_n == 1) {
+      int n = z->order[0];
+      *mcus_x = (z->img_comp[n].x+7) >> 3;
+      *mcus_y = (z->img_comp[n].y+7) >> 3;
+   } else {
+      *mcus_x = z->img_mcu_x;
+      *mcus_y = z->img_mcu_y;
+   }
+}
+
+static int stbi__jpeg_mcu_blocks(stbi__jpeg *z)
+{
+   int k, blocks = 0;
+   if (z->scan_n == 1) return 1;
+   for (k=0; k < z->scan_n; ++k)
+      blocks += z->img_comp[z->order[k]].h * z->img_comp[z->order[k]].v;
+   return blocks;
+}
+
+// Huffman decode the next MCU of the current scan into consecutive blocks of coeff
+static int stbi__jpeg_decode_mcu(stbi__jpeg *z, short *coeff)
+{
+   int k, b;
+   for (k=0; k < z->scan_n; ++k) {
+      int n = z->order[k];
+      int ha = z->img_comp[n].ha;
+      int blocks = z->scan_n == 1 ? 1 : z->img_comp[n].h * z->img_comp[n].v;
+      for (b=0; b < blocks; ++b, coeff += 64)
+         if (!stbi__jpeg_decode_block(z, coeff, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+   }
+   return 1;
+}
+
+// IDCT the blocks of MCU m into the component planes
+static void stbi__jpeg_idct_mcu(stbi__jpeg *z, int m, short *coeff)
+{
+   int k,y;
+   if (z->scan_n == 1) {
+      int n = z->order[0];
+      int w = (z->img_comp[n].x+7) >> 3;
+      z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*(m/w)*8+(m%w)*8, z->img_comp[n].w2, coeff);
+      return;
+   }
+   for (k=0; k < z->scan_n; ++k) {
+      int n = z->order[k];
+      for (y=0; y < z->img_comp[n].v; ++y, coeff += 64 * z->img_comp[n].h) {
+         int x2 = (m % z->img_mcu_x)*z->img_comp[n].h*8;
+         int y2 = ((m / z->img_mcu_x)*z->img_comp[n].v + y)*8;
+         stbi__jpeg_idct_blocks(z, z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, coeff, z->img_comp[n].h);
+      }
+   }
+}
+
+typedef struct
+{
+   stbi__jpeg *z;
+   stbi_uc **start;     // entropy-coded data of every interval, then the marker ending the scan
+   stbi_uc *end;        // just past that marker
+   stbi_uc *resume;     // where the serial decoder would leave the scan
+   int marker;          // and the marker it would have read
+   int intervals, tasks, mcus, mcu_blocks;
+   stbi__atomic failed; // 1 corrupt, 2 out of memory
+} stbi__jpeg_restarts;
+
+static void stbi__jpeg_restart_task(void *data, int index)
+{
+   stbi__jpeg_restarts *r = (stbi__jpeg_restarts *) data;
+   int first = index * r->intervals / r->tasks;
+   int last = (index+1) * r->intervals / r->tasks;
+   int ri = r->z->restart_interval;
+   int i,m;
+   stbi__context s;
+   short *coeff;
+   // a copy of the decoder each, with the MCU's coefficients after it
+   stbi__jpeg *z = (stbi__jpeg *) stbi__malloc(sizeof(stbi__jpeg) + r->mcu_blocks * 64 * sizeof(short) + 15);
+   if (!z) { stbi__atomic_set(&r->failed, 2); return; }
+   *z = *r->z;
+   z->s = &s;
+   coeff = (short *) (((size_t) (z + 1) + 15) & ~15);
+
+   stbi__start_mem(&s, r->start[first], (int) (r->end - r->start[first]));
+   for (i=first; i < last && !stbi__atomic_get(&r->failed); ++i) {
+      s.img_buffer = r->start[i];
+      stbi__jpeg_reset(z);
+      for (m=i*ri; m < (i+1)*ri && m < r->mcus; ++m) {
+         if (!stbi__jpeg_decode_mcu(z, coeff)) { stbi__atomic_set(&r->failed, 1); break; }
+         stbi__jpeg_idct_mcu(z, m, coeff);
+      }
+      if (m < r->mcus && m < (i+1)*ri) break; // bad Huffman code
+      // the serial decoder looks for the marker after every full interval and
+      // stops the scan where it is not the next RSTn
+      if (m == (i+1)*ri && z->code_bits < 24)
+         stbi__grow_buffer_unsafe(z);
+      if (i+1 < r->intervals) {
+         if (!STBI__RESTART(z->marker) || s.img_buffer != r->start[i+1])
+            stbi__atomic_set(&r->failed, 1);
+      } else {
+         r->resume = s.img_buffer;
+         r->marker = z->marker;
+      }
+   }
+   STBI_FREE(z);
+}
+
+// decode the restart intervals of the current scan in parallel, -1 if the
+// markers do not match the intervals expected or the data is corrupt: the
+// serial decoder then decodes the scan again, so that what loads and what
+// fails does not depend on the threads
+static int stbi__jpeg_restart_scan(stbi__jpeg *z, int threads)
+{
+   stbi__jpeg_restarts r;
+   stbi_uc *p, *end;
+   int mcus_x, mcus_y, n = 0, failed;
+
+   stbi__jpeg_scan_size(z, &mcus_x, &mcus_y);
+   r.mcus = mcus_x * mcus_y;
+   r.intervals = (r.mcus + z->restart_interval - 1) / z->restart_interval;
+   if (r.intervals < 2) return -1;
+   if (!stbi__jpeg_in_memory(z)) return 0;
+   r.start = (stbi_uc **) stbi__malloc_mad2(r.intervals + 1, sizeof(stbi_uc *), 0);
+   if (!r.start) return stbi__err("outofmem", "Out of memory");
+
+   // find the RSTn markers, skipping stuffed zeros and fill bytes
+   p = z->s->img_buffer;
+   end = z->s->img_buffer_end;
+   r.start[n++] = p;
+   for (;;) {
+      p = (stbi_uc *) memchr(p, 0xff, end - p);
+      if (!p) { p = end; break; }
+      while (p+1 < end && p[1] == 0xff) ++p;
+      if (p+1 >= end) break;
+      if (p[1] == 0) { p += 2; continue; }
+      if (!STBI__RESTART(p[1])) break;
+      if (n == r.intervals) { n = 0; break; }
+      p += 2;
+      r.start[n++] = p;
+   }
+   if (n != r.intervals) { STBI_FREE(r.start); return -1; }
+   r.start[n] = p;
+   r.end = p + 2 <= end ? p + 2 : end;
+
+   r.z = z;
+   r.mcu_blocks = stbi__jpeg_mcu_blocks(z);
+   r.tasks = r.intervals < threads * 4 ? r.intervals : threads * 4;
+   r.failed = 0;
+   stbi__jpeg_parallel_run(stbi__jpeg_parallel_user, r.tasks, stbi__jpeg_restart_task, &r);
+   STBI_FREE(r.start);
+   failed = r.failed;
+   if (failed == 2) return stbi__err("outofmem", "Out of memory");
+   if (failed) return -1;
+
+   // carry on from where the last interval left the scan
+   z->s->img_buffer = r.resume;
+   z->marker = (stbi_uc) r.marker;
+   return 1;
+}
+
+typedef struct
+{
+   stbi__jpeg *z;
+   short *coeff;            // ring of 'slots' rows of coefficients, row r in slot r % slots
+   int rows, row_mcus, mcu_blocks, slots;
+   int bands, band_h;       // output rows are converted per MCU row
+   stbi__atomic role;       // tasks started, the first one decodes
+   stbi__atomic decoded;    // rows Huffman decoded
+   stbi__atomic end_row;    // rows from here on were cut short by a missing restart marker
+   stbi__atomic idct_next, convert_next, converted;
+   stbi__atomic failed;     // 1 corrupt, 2 out of memory
+   stbi__atomic *idct_done; // per row
+} stbi__jpeg_pipe;
+
+// Huffman decode the next row of the scan into coeff, counting down restart
+// intervals as stbi__parse_entropy_coded_data does; 2 where it stops early
+static int stbi__jpeg_pipe_decode(stbi__jpeg_pipe *p, short *coeff)
+{
+   stbi__jpeg *z = p->z;
+   int i;
+   for (i=0; i < p->row_mcus; ++i, coeff += 64 * p->mcu_blocks) {
+      if (!stbi__jpeg_decode_mcu(z, coeff)) return 0;
+      if (--z->todo <= 0) {
+         if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
+         if (!STBI__RESTART(z->marker)) {
+            memset(coeff + 64 * p->mcu_blocks, 0, (p->row_mcus-i-1) * 64 * p->mcu_blocks * sizeof(short));
+            return 2;
+         }
+         stbi__jpeg_reset(z);
+      }
+   }
+   return 1;
+}
+
+// IDCT the next decoded row, 0 if there is none
+static int stbi__jpeg_pipe_idct(stbi__jpeg_pipe *p)
+{
+   int r = stbi__atomic_get(&p->idct_next), m;
+   short *coeff;
+   if (r >= stbi__atomic_get(&p->decoded) || !stbi__atomic_claim(&p->idct_next, r)) return 0;
+   if (r < stbi__atomic_get(&p->end_row)) {
+      stbi__jpeg *z = p->z;
+      coeff = p->coeff + (size_t) (r % p->slots) * p->row_mcus * p->mcu_blocks * 64;
+      if (z->scan_n == 1) {
+         // the row's blocks are side by side in the plane
+         int n = z->order[0];
+         stbi__jpeg_idct_blocks(z, z->img_comp[n].data+z->img_comp[n].w2*r*8, z->img_comp[n].w2, coeff, p->row_mcus);
+      } else {
+         for (m=0; m < p->row_mcus; ++m, coeff += 64 * p->mcu_blocks)
+            stbi__jpeg_idct_mcu(z, r * p->row_mcus + m, coeff);
+      }
+   }
+   stbi__atomic_set(&p->idct_done[r], 1);
+   return 1;
+}
+
+// convert the next band, 0 if it still waits for an MCU row
+static int stbi__jpeg_pipe_convert(stbi__jpeg_pipe *p, stbi_uc **linebuf)
+{
+   int b = stbi__atomic_get(&p->convert_next);
+   int above = b > 0 ? b-1 : 0, below = b+1 < p->rows ? b+1 : p->rows-1;
+   int j1 = (b+1) * p->band_h;
+   if (b >= p->bands || !stbi__atomic_get(&p->idct_done[above]) || !stbi__atomic_get(&p->idct_done[b])
+       || !stbi__atomic_get(&p->idct_done[below]) || !stbi__atomic_claim(&p->convert_next, b))
+      return 0;
+   stbi__jpeg_convert(p->z, b * p->band_h, j1 < (int) p->z->s->img_y ? j1 : (int) p->z->s->img_y, linebuf, linebuf[p->z->decode_n]);
+   stbi__atomic_inc(&p->converted);
+   return 1;
+}
+
+static void stbi__jpeg_pipe_task(void *data, int index)
+{
+   stbi__jpeg_pipe *p = (stbi__jpeg_pipe *) data;
+   stbi__jpeg *z = p->z;
+   int decoder = stbi__atomic_inc(&p->role) == 0;
+   int k,r,idle;
+   stbi_uc *linebuf[5];
+   stbi_uc *lines = (stbi_uc *) stbi__malloc_mad2(z->decode_n + 4, z->s->img_x + 3, 0);
+   STBI_NOTUSED(index);
+   if (!lines) {
+      // the others manage without this task, but not without the decoder
+      if (decoder) stbi__atomic_set(&p->failed, 2);
+      return;
+   }
+   for (k=0; k <= z->decode_n; ++k)
+      linebuf[k] = lines + k * (z->s->img_x + 3);
+
+   if (decoder) {
+      for (r=0; r < p->rows; ++r) {
+         short *coeff = p->coeff + (size_t) (r % p->slots) * p->row_mcus * p->mcu_blocks * 64;
+         int result;
+         // the row that had this slot must be through the IDCT
+         while (r >= p->slots && !stbi__atomic_get(&p->idct_done[r - p->slots]))
+            if (!stbi__jpeg_pipe_idct(p)) stbi__pause();
+         result = stbi__jpeg_pipe_decode(p, coeff);
+         if (!result) { stbi__atomic_set(&p->failed, 1); break; }
+         if (result == 2) {
+            stbi__atomic_set(&p->end_row, r + 1);
+            stbi__atomic_set(&p->decoded, p->rows);
+            break;
+         }
+         stbi__atomic_set(&p->decoded, r + 1);
+      }
+   }
+
+   // the decoder finishes whatever is left, so the others give up once they
+   // have waited long for work, rather than spin on a busy machine
+   idle = 0;
+   while (stbi__atomic_get(&p->converted) < p->bands && !stbi__atomic_get(&p->failed)) {
+      if (stbi__jpeg_pipe_idct(p) || stbi__jpeg_pipe_convert(p, linebuf))
+         idle = 0;
+      else if (!decoder && ++idle > STBI__JPEG_MAX_SPINS)
+         break;
+      else
+         stbi__pause();
+   }
+   STBI_FREE(lines);
+}
+
+// decode the current scan, which holds every component, pipelined with the
+// IDCT and colour conversion
+static int stbi__jpeg_pipeline_scan(stbi__jpeg *z, int threads)
+{
+   stbi__jpeg_pipe p;
+   void *raw_coeff;
+   int r, failed;
+
+   if (!stbi__jpeg_begin_output(z)) return 0;
+   stbi__jpeg_scan_size(z, &p.row_mcus, &p.rows);
+   p.z = z;
+   p.mcu_blocks = stbi__jpeg_mcu_blocks(z);
+   p.slots = 2 * threads + 2;
+   p.band_h = z->scan_n == 1 ? 8 : z->img_mcu_h;
+   p.bands = (z->s->img_y + p.band_h - 1) / p.band_h;
+   raw_coeff = stbi__malloc_mad3(p.slots, p.row_mcus * p.mcu_blocks, 64 * sizeof(short), 15);
+   p.idct_done = (stbi__atomic *) stbi__malloc_mad2(p.rows, sizeof(stbi__atomic), 0);
+   if (!raw_coeff || !p.idct_done) {
+      if (raw_coeff) STBI_FREE(raw_coeff);
+      if (p.idct_done) STBI_FREE(p.idct_done);
+      return stbi__err("outofmem", "Out of memory");
+   }
+   p.coeff = (short *) (((size_t) raw_coeff + 15) & ~15);
+   for (r=0; r < p.rows; ++r)
+      p.idct_done[r] = 0;
+   p.role = p.decoded = p.idct_next = p.convert_next = p.converted = p.failed = 0;
+   p.end_row = p.rows;
+
+   stbi__jpeg_reset(z);
+   stbi__jpeg_parallel_run(stbi__jpeg_parallel_user, threads, stbi__jpeg_pipe_task, &p);
+   STBI_FREE(raw_coeff);
+   STBI_FREE(p.idct_done);
+   failed = p.failed;
+   if (failed == 2) return stbi__err("outofmem", "Out of memory");
+   if (failed) return stbi__err("bad huffman code", "Corrupt JPEG");
+   z->converted = 1;
+   return 1;
+}
+
+// decode the current scan on several threads, -1 where the serial decoder
+// takes it
+static int stbi__jpeg_parallel_scan(stbi__jpeg *z)
+{
+   int threads = stbi__jpeg_threads(z);
+   if (!threads || z->progressive) return -1;
+   if (z->restart_interval) {
+      int r = stbi__jpeg_restart_scan(z, threads);
+      if (r >= 0) return r;
+   }
+   if (z->scan_n == z->s->img_n)
+      return stbi__jpeg_pipeline_scan(z, threads);
+   return -1;
+}
+
+typedef struct
+{
+   stbi__jpeg *z;
+   int band_h;
+   stbi__atomic failed;
+} stbi__jpeg_bands;
+
+static void stbi__jpeg_band_task(void *data, int index)
+{
+   stbi__jpeg_bands *b = (stbi__jpeg_bands *) data;
+   stbi__jpeg *z = b->z;
+   int k, j0 = index * b->band_h, j1 = j0 + b->band_h;
+   stbi_uc *linebuf[5];
+   stbi_uc *lines = (stbi_uc *) stbi__malloc_mad2(z->decode_n + 4, z->s->img_x + 3, 0);
+   if (!lines) { stbi__atomic_set(&b->failed, 1); return; }
+   for (k=0; k <= z->decode_n; ++k)
+      linebuf[k] = lines + k * (z->s->img_x + 3);
+   stbi__jpeg_convert(z, j0, j1 < (int) z->s->img_y ? j1 : (int) z->s->img_y, linebuf, linebuf[z->decode_n]);
+   STBI_FREE(lines);
+}
+
+// resample and color-convert the decoded image in bands of rows; 0 if it
+// stays on the calling thread or ran out of memory
+static int stbi__jpeg_parallel_convert(stbi__jpeg *z)
+{
+   stbi__jpeg_bands b;
+   int threads = stbi__jpeg_threads(z), h = z->s->img_y;
+   if (!threads) return 0;
+   b.z = z;
+   b.band_h = (h + threads * 4 - 1) / (threads * 4);
+   if (b.band_h < 16) b.band_h = 16;
+   b.failed = 0;
+   stbi__jpeg_parallel_run(stbi__jpeg_parallel_user, (h + b.band_h - 1) / b.band_h, stbi__jpeg_band_task, &b);
+   return !b.failed;
+}
+#endif // STBI__JPEG_THREADS
+
+static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp, int req_comp)
+{
+   z->s->img_n = 0; // make stbi__cleanup_jpeg safe
+   z->req_comp = req_comp;
+   z->output = NULL;
+   z->output_into = 0;
+   z->converted = 0;
+   z->in_memory_data = NULL;
+
+   // validate req_comp
+   if (req_comp < 0 || req_comp > 4) return stbi__errpuc("bad req_comp", "Internal error");
+
+   // load a jpeg image from whichever source, but leave in YCbCr format
+   if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
+
+   // resample and color-convert
+   {
+      int k;
+      stbi_uc *output;
+      stbi_uc *linebuf[4];
+
+      if (!stbi__jpeg_begin_output(z)) { stbi__cleanup_jpeg(z); return NULL; }
+
+#ifdef STBI__JPEG_THREADS
+      if (!z->converted)
+         z->converted = stbi__jpeg_parallel_convert(z);
+#endif
+      if (!z->converted) {
+         for (k=0; k < z->decode_n; ++k) {
+            // allocate line buffer big enough for upsampling off the edges
+            // with upsample factor of 4
+            z->img_comp[k].linebuf = (stbi_uc *) stbi__malloc(z->s->img_x + 3);
+            if (!z->img_comp[k].linebuf) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+            linebuf[k] = z->img_comp[k].linebuf;
+         }
+         if (stbi__jpeg_bounce_rows(z)) {
+            stbi_uc *last = (stbi_uc *) stbi__malloc_mad2(z->s->img_x, 4, 1);
+            if (!last) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+            stbi__jpeg_convert(z, 0, z->s->img_y, linebuf, last);
+            STBI_FREE(last);
+         } else {
+            stbi__jpeg_convert(z, 0, z->s->img_y, linebuf, NULL);
+         }
+      }
+
+      output = z->output;
+      z->output = NULL;
       stbi__cleanup_jpeg(z);
       *out_x = z->s->img_x;
       *out_y = z->s->img_y;
@@ -3930,6 +5116,8 @@ static int stbi__jpeg_info(stbi__context *s, int *x, int *y, int *comp)
 //      - all output is written to a single output buffer (can malloc/realloc)
 //    performance
 //      - fast huffman
+//      - 64-bit bit buffer refilled 8 bytes at a time, up to two literals
+//        per table lookup and 8 byte match copies away from buffer ends
 
 #ifndef STBI_NO_ZLIB
 
@@ -3937,6 +5125,13 @@ static int stbi__jpeg_info(stbi__context *s, int *x, int *y, int *comp)
 #define STBI__ZFAST_BITS  9 // accelerate all cases in default tables
 #define STBI__ZFAST_MASK  ((1 << STBI__ZFAST_BITS) - 1)
 
+// wider tables for the inner loop of huffman blocks, see stbi__zbuild_wide
+#define STBI__ZLIT_BITS   11
+#define STBI__ZDIST_BITS  10
+// the inner loop runs while it can write a whole match and the 8 byte copy
+// overrun without checking the output size
+#define STBI__ZFAST_OUT   (258 + 8)
+
 // zlib-style huffman encoding
 // (jpegs packs from left, zlib from right, so can't share code)
 typedef struct
@@ -4019,18 +5214,28 @@ static int stbi__zbuild_huffman(stbi__zhuffman *z, const stbi_uc *sizelist, int
 //    we require PNG read all the IDATs and combine them into a single
 //    memory buffer
 
+//
+//    the bit buffer is 64 bits. Bits past num_bits are either zero or the
+//    next bits of the input, which a refill ORs in again at the same place.
+
 typedef struct
 {
    stbi_uc *zbuffer, *zbuffer_end;
    int num_bits;
-   stbi__uint32 code_buffer;
+   int num_padding;   // zero bytes past the end of the input in code_buffer
+   stbi__uint64 code_buffer;
 
    char *zout;
    char *zout_start;
    char *zout_end;
    int   z_expandable;
+   // with a drain, zout_start..zout_end is a window the drain makes room in
+   int (*drain)(void *user, char *zout, int n);
+   void *drain_user;
+   stbi__uint32 adler;  // Adler-32 of the output the window has moved past
 
    stbi__zhuffman z_length, z_distance;
+   stbi__uint32 lit_wide[1 << STBI__ZLIT_BITS], dist_wide[1 << STBI__ZDIST_BITS];
 } stbi__zbuf;
 
 stbi_inline static stbi_uc stbi__zget8(stbi__zbuf *z)
@@ -4042,28 +5247,41 @@ stbi_inline static stbi_uc stbi__zget8(stbi__zbuf *z)
 static void stbi__fill_bits(stbi__zbuf *z)
 {
    do {
-      STBI_ASSERT(z->code_buffer < (1U << z->num_bits));
-      z->code_buffer |= (unsigned int) stbi__zget8(z) << z->num_bits;
+      if (z->zbuffer >= z->zbuffer_end) ++z->num_padding;
+      z->code_buffer |= (stbi__uint64) stbi__zget8(z) << z->num_bits;
       z->num_bits += 8;
-   } while (z->num_bits <= 24);
+   } while (z->num_bits <= 48);
 }
 
 stbi_inline static unsigned int stbi__zreceive(stbi__zbuf *z, int n)
 {
    unsigned int k;
    if (z->num_bits < n) stbi__fill_bits(z);
-   k = z->code_buffer & ((1 << n) - 1);
+   k = (unsigned int) z->code_buffer & ((1 << n) - 1);
    z->code_buffer >>= n;
    z->num_bits -= n;
    return k;
 }
 
+// 8 input bytes as a little-endian integer
+stbi_inline static stbi__uint64 stbi__zload64(const stbi_uc *p)
+{
+#if defined(STBI__X86_TARGET) || defined(STBI__X64_TARGET) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+   stbi__uint64 v;
+   memcpy(&v, p, 8);
+   return v;
+#else
+   return (stbi__uint64) (p[0] | (p[1] << 8) | (p[2] << 16) | ((stbi__uint32) p[3] << 24))
+        | (stbi__uint64) (p[4] | (p[5] << 8) | (p[6] << 16) | ((stbi__uint32) p[7] << 24)) << 32;
+#endif
+}
+
 static int stbi__zhuffman_decode_slowpath(stbi__zbuf *a, stbi__zhuffman *z)
 {
    int b,s,k;
    // not resolved by fast table, so compute it the slow way
    // use jpeg approach, which requires MSbits at top
-   k = stbi__bit_reverse(a->code_buffer, 16);
+   k = stbi__bit_reverse((int) (a->code_buffer & 0xffff), 16);
    for (s=STBI__ZFAST_BITS+1; ; ++s)
       if (k < z->maxcode[s])
          break;
@@ -4080,7 +5298,7 @@ stbi_inline static int stbi__zhuffman_decode(stbi__zbuf *a, stbi__zhuffman *z)
 {
    int b,s;
    if (a->num_bits < 16) stbi__fill_bits(a);
-   b = z->fast[a->code_buffer & STBI__ZFAST_MASK];
+   b = z->fast[(int) a->code_buffer & STBI__ZFAST_MASK];
    if (b) {
       s = b >> 9;
       a->code_buffer >>= s;
@@ -4095,6 +5313,7 @@ static int stbi__zexpand(stbi__zbuf *z, char *zout, int n)  // need to make room
    char *q;
    int cur, limit, old_limit;
    z->zout = zout;
+   if (z->drain) return z->drain(z->drain_user, zout, n);
    if (!z->z_expandable) return stbi__err("output buffer limit","Corrupt PNG");
    cur   = (int) (z->zout     - z->zout_start);
    limit = old_limit = (int) (z->zout_end - z->zout_start);
@@ -4123,11 +5342,159 @@ static const int stbi__zdist_base[32] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129
 static const int stbi__zdist_extra[32] =
 { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
 
+// Tables of the inner loop, indexed by the next STBI__ZLIT_BITS or
+// STBI__ZDIST_BITS input bits. 0 means the code is longer, use the slow
+// path. Otherwise bits 0-4 hold the code length and
+//    literal/length: bits 5-6 kind (1 literals, 2 length, 3 end of block
+//       or invalid code in bit 16). Literals: count (1 or 2) in bits 7-8,
+//       the bytes in bits 16-23 and 24-31; the second one is there when
+//       both codes fit the index. Lengths: extra bits in 8-11, base in 16-31.
+//    distance: extra bits in 8-11, invalid code in bit 12, base in 16-31.
+static void stbi__zbuild_wide(stbi__uint32 *wide, int bits, const stbi__zhuffman *z, int is_distance)
+{
+   int s,c,j;
+   memset(wide, 0, sizeof(*wide) << bits);
+   for (s=1; s <= bits; ++s) {
+      for (c=z->firstsymbol[s]; c < z->firstsymbol[s+1]; ++c) {
+         int v = z->value[c];
+         stbi__uint32 e;
+         if (is_distance)
+            e = v < 30 ? (stbi__uint32) stbi__zdist_base[v] << 16 | stbi__zdist_extra[v] << 8 : 1 << 12;
+         else if (v < 256)
+            e = 1 << 5 | 1 << 7 | (stbi__uint32) v << 16;
+         else if (v == 256 || v > 285)
+            e = 3 << 5 | (v > 285) << 16;
+         else
+            e = 2 << 5 | stbi__zlength_extra[v-257] << 8 | (stbi__uint32) stbi__zlength_base[v-257] << 16;
+         e |= s;
+         for (j = stbi__bit_reverse(z->firstcode[s] + c - z->firstsymbol[s], s); j < (1 << bits); j += 1 << s)
+            wide[j] = e;
+      }
+   }
+   if (is_distance) return;
+   // pair up literals, from the top so that wide[j >> s] is still single
+   for (j=(1 << bits)-1; j >= 0; --j) {
+      stbi__uint32 e = wide[j], f;
+      if ((e & 0x1e0) != (1 << 5 | 1 << 7)) continue;
+      s = e & 31;
+      f = wide[j >> s];
+      if ((f & 0x1e0) == (1 << 5 | 1 << 7) && s + (int) (f & 31) <= bits)
+         wide[j] = (e & 0x00ff0000) | (f & 0xff0000) << 8 | 1 << 5 | 2 << 7 | (s + (f & 31));
+   }
+}
+
+// decodes a huffman block while at least 8 input bytes and STBI__ZFAST_OUT
+// output bytes are left; 1 at the end of the block, 2 near the ends of the
+// buffers, 0 on error. The bit buffer lives in locals, written back around
+// the slow path so that stores through zout don't force it to memory.
+static int stbi__parse_huffman_fast(stbi__zbuf *a)
+{
+   stbi_uc *in = a->zbuffer, *in_end = a->zbuffer_end - 8;
+   char *zout = a->zout, *zout_end = a->zout_end - STBI__ZFAST_OUT;
+   stbi__uint64 bits = a->code_buffer;
+   int num_bits = a->num_bits, r = 2;
+   stbi__uint32 e;
+
+   #define stbi__zconsume(n) (bits >>= (n), num_bits -= (n))
+   #define stbi__zsync() (a->zbuffer = in, a->code_buffer = bits, a->num_bits = num_bits)
+   #define stbi__zunsync() (bits = a->code_buffer, num_bits = a->num_bits)
+
+   while (in <= in_end && zout <= zout_end) {
+      int len, dist, z;
+      stbi_uc *p;
+      // branchless refill to 56 to 63 bits, enough for a length and a distance
+      bits |= stbi__zload64(in) << num_bits;
+      in += (63 - num_bits) >> 3;
+      num_bits |= 56;
+
+      e = a->lit_wide[bits & ((1 << STBI__ZLIT_BITS) - 1)];
+      if ((e & 0x60) == 1 << 5) {
+         // one or two literals, both stored, zout moves by the count
+         zout[0] = (char) (e >> 16);
+         zout[1] = (char) (e >> 24);
+         zout += (e >> 7) & 3;
+         stbi__zconsume(e & 31);
+         continue;
+      }
+      if (e == 0) {
+         stbi__zsync();
+         z = stbi__zhuffman_decode_slowpath(a, &a->z_length);
+         stbi__zunsync();
+         if (z < 0 || z > 285) { r = stbi__err("bad huffman code","Corrupt PNG"); break; }
+         if (z < 256) { *zout++ = (char) z; continue; }
+         if (z == 256) { r = 1; break; }
+         len = stbi__zlength_base[z-257] + (int) (bits & ((1 << stbi__zlength_extra[z-257]) - 1));
+         stbi__zconsume(stbi__zlength_extra[z-257]);
+      } else if ((e & 0x60) == 3 << 5) {
+         stbi__zconsume(e & 31);
+         r = (e >> 16) ? stbi__err("bad huffman code","Corrupt PNG") : 1;
+         break;
+      } else {
+         int extra = (e >> 8) & 15;
+         stbi__zconsume(e & 31);
+         len = (int) (e >> 16) + (int) (bits & ((1 << extra) - 1));
+         stbi__zconsume(extra);
+      }
+
+      e = a->dist_wide[bits & ((1 << STBI__ZDIST_BITS) - 1)];
+      if (e == 0) {
+         stbi__zsync();
+         z = stbi__zhuffman_decode_slowpath(a, &a->z_distance);
+         stbi__zunsync();
+         if (z < 0 || z >= 30) { r = stbi__err("bad huffman code","Corrupt PNG"); break; }
+         dist = stbi__zdist_base[z] + (int) (bits & ((1 << stbi__zdist_extra[z]) - 1));
+         stbi__zconsume(stbi__zdist_extra[z]);
+      } else {
+         int extra = (e >> 8) & 15;
+         if (e & (1 << 12)) { r = stbi__err("bad huffman code","Corrupt PNG"); break; }
+         stbi__zconsume(e & 31);
+         dist = (int) (e >> 16) + (int) (bits & ((1 << extra) - 1));
+         stbi__zconsume(extra);
+      }
+      if (zout - a->zout_start < dist) { r = stbi__err("bad dist","Corrupt PNG"); break; }
+
+      p = (stbi_uc *) (zout - dist);
+      if (dist >= 8) {
+         // 8 bytes at a time, the last copy may run up to 7 bytes past the
+         // match; those get overwritten by what follows
+         char *end = zout + len;
+         do { memcpy(zout, p, 8); zout += 8; p += 8; } while (zout < end);
+         zout = end;
+      } else if (dist == 1) { // run of one byte; common in images.
+         memset(zout, *p, len);
+         zout += len;
+      } else {
+         do *zout++ = *p++; while (--len);
+      }
+   }
+
+   #undef stbi__zconsume
+   #undef stbi__zsync
+   #undef stbi__zunsync
+
+   a->zbuffer = in;
+   a->code_buffer = bits;
+   a->num_bits = num_bits;
+   a->zout = zout;
+   return r;
+}
+
 static int stbi__parse_huffman_block(stbi__zbuf *a)
 {
    char *zout = a->zout;
    for(;;) {
-      int z = stbi__zhuffman_decode(a, &a->z_length);
+      int z;
+      if (a->zbuffer_end - a->zbuffer >= 8 && a->zout_end - zout >= STBI__ZFAST_OUT) {
+         int r;
+         a->zout = zout;
+         r = stbi__parse_huffman_fast(a);
+         if (r != 2) return r;
+         zout = a->zout;
+      }
+      // one symbol at a time near the ends of the buffers
+      z = stbi__zhuffman_decode(a, &a->z_length);
+      // bits of the zero padding read as a code: the input was cut short
+      if (a->num_padding * 8 > a->num_bits) return stbi__err("unexpected end","Corrupt PNG");
       if (z < 256) {
          if (z < 0) return stbi__err("bad huffman code","Corrupt PNG"); // error in huffman codes
          if (zout >= a->zout_end) {
@@ -4220,17 +5587,14 @@ static int stbi__parse_uncompressed_block(stbi__zbuf *a)
    int len,nlen,k;
    if (a->num_bits & 7)
       stbi__zreceive(a, a->num_bits & 7); // discard
-   // drain the bit-packed data into header
-   k = 0;
-   while (a->num_bits > 0) {
-      header[k++] = (stbi_uc) (a->code_buffer & 255); // suppress MSVC run-time check
-      a->code_buffer >>= 8;
-      a->num_bits -= 8;
-   }
-   STBI_ASSERT(a->num_bits == 0);
-   // now fill header the normal way
-   while (k < 4)
-      header[k++] = stbi__zget8(a);
+   // hand the whole bytes still in the bit buffer back to the input
+   k = (a->num_bits >> 3) - a->num_padding;
+   if (k > 0) a->zbuffer -= k;
+   a->code_buffer = 0;
+   a->num_bits = 0;
+   a->num_padding = 0;
+   for (k=0; k < 4; ++k)
+      header[k] = stbi__zget8(a);
    len  = header[1] * 256 + header[0];
    nlen = header[3] * 256 + header[2];
    if (nlen != (len ^ 0xffff)) return stbi__err("zlib corrupt","Corrupt PNG");
@@ -4285,12 +5649,64 @@ Init algorithm:
 }
 */
 
+static int stbi__zlib_verify_adler32 = 0;
+
+STBIDEF void stbi_set_zlib_verify_adler32(int flag_true_if_should_verify)
+{
+   stbi__zlib_verify_adler32 = flag_true_if_should_verify;
+}
+
+// Adler-32 of n bytes continuing from adler. Blocks of 5552 bytes keep the
+// sums in 32 bits until they are reduced, as in zlib.
+static stbi__uint32 stbi__adler32(stbi__uint32 adler, const stbi_uc *p, size_t n)
+{
+   stbi__uint32 s1 = adler & 0xffff, s2 = adler >> 16;
+   while (n) {
+      size_t block = n < 5552 ? n : 5552, i = 0;
+      n -= block;
+#ifdef STBI_SSE2
+      if (block >= 16 && stbi__sse2_available()) {
+         // per 16 bytes: s2 += 16*s1 + 16*b0 + 15*b1 + ... + 1*b15 and s1 += sum;
+         // the 16*s1 terms are summed up in vps and applied at the end
+         __m128i zero = _mm_setzero_si128();
+         __m128i w0 = _mm_setr_epi16(16,15,14,13,12,11,10,9);
+         __m128i w1 = _mm_setr_epi16(8,7,6,5,4,3,2,1);
+         __m128i vs1 = zero, vs2 = zero, vps = zero;
+         stbi__uint32 t[4], sum1, sums, sump;
+         size_t chunks = block >> 4;
+         for (; i < chunks << 4; i += 16) {
+            __m128i b = _mm_loadu_si128((const __m128i *) (p + i));
+            vps = _mm_add_epi32(vps, vs1);
+            vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(b, zero));
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_unpacklo_epi8(b, zero), w0));
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_unpackhi_epi8(b, zero), w1));
+         }
+         _mm_storeu_si128((__m128i *) t, vs1); sum1 = t[0] + t[2];
+         _mm_storeu_si128((__m128i *) t, vs2); sums = t[0] + t[1] + t[2] + t[3];
+         _mm_storeu_si128((__m128i *) t, vps); sump = t[0] + t[2];
+         s2 = (s2 + (stbi__uint32) i * s1) % 65521;
+         s2 = (s2 + ((sump % 65521) << 4) + sums) % 65521;
+         s1 += sum1;
+      }
+#endif
+      for (; i < block; ++i) {
+         s1 += p[i];
+         s2 += s1;
+      }
+      s1 %= 65521;
+      s2 %= 65521;
+      p += block;
+   }
+   return s2 << 16 | s1;
+}
+
 static int stbi__parse_zlib(stbi__zbuf *a, int parse_header)
 {
    int final, type;
    if (parse_header)
       if (!stbi__parse_zlib_header(a)) return 0;
    a->num_bits = 0;
+   a->num_padding = 0;
    a->code_buffer = 0;
    do {
       final = stbi__zreceive(a,1);
@@ -4307,9 +5723,22 @@ static int stbi__parse_zlib(stbi__zbuf *a, int parse_header)
          } else {
             if (!stbi__compute_huffman_codes(a)) return 0;
          }
+         stbi__zbuild_wide(a->lit_wide, STBI__ZLIT_BITS, &a->z_length, 0);
+         stbi__zbuild_wide(a->dist_wide, STBI__ZDIST_BITS, &a->z_distance, 1);
          if (!stbi__parse_huffman_block(a)) return 0;
       }
    } while (!final);
+   if (parse_header && stbi__zlib_verify_adler32) {
+      stbi__uint32 adler = 0;
+      int k;
+      if (a->num_bits & 7)
+         stbi__zreceive(a, a->num_bits & 7);
+      for (k=0; k < 4; ++k)
+         adler = adler << 8 | stbi__zreceive(a, 8);
+      if (a->num_padding * 8 > a->num_bits) return stbi__err("no adler32","Corrupt PNG");
+      if (adler != stbi__adler32(a->adler, (stbi_uc *) a->zout_start, a->zout - a->zout_start))
+         return stbi__err("bad adler32","Corrupt PNG");
+   }
    return 1;
 }
 
@@ -4319,6 +5748,8 @@ static int stbi__do_zlib(stbi__zbuf *a, char *obuf, int olen, int exp, int parse
    a->zout       = obuf;
    a->zout_end   = obuf + olen;
    a->z_expandable = exp;
+   a->drain = NULL;
+   a->adler = 1;
 
    return stbi__parse_zlib(a, parse_header);
 }
@@ -4438,6 +5869,8 @@ typedef struct
    stbi__context *s;
    stbi_uc *idata, *expanded, *out;
    int depth;
+   int out_stride;  // bytes from one output row to the next
+   int into;        // out is the caller's, see stbi__png_into
 } stbi__png;
 
 
@@ -4474,23 +5907,347 @@ static int stbi__paeth(int a, int b, int c)
 
 static const stbi_uc stbi__depth_scale_table[9] = { 0, 0xff, 0x55, 0, 0x11, 0,0,0, 0x01 };
 
+#if defined(STBI_SSE2) || defined(STBI_NEON)
+#define STBI__PNG_SIMD
+// Rows of 3 or 4 channel 8-bit and 16-bit images are unfiltered a pixel at a
+// time in a vector register: Sub, Avg and Paeth depend on the pixel to the
+// left, so that is all the parallelism there is; Up and None without
+// expansion go 16 bytes at a time. A pixel is n = 3, 4, 6 or 8 bytes, loaded
+// and stored exactly so that nothing is read or written past a row. Adding
+// the alpha channel is done in the same pass.
+
+#ifdef STBI_SSE2
+typedef __m128i stbi__png_px;
+
+stbi_inline static stbi__png_px stbi__png_px_load(const stbi_uc *p, int n)
+{
+   stbi__uint32 lo, hi = 0;
+   if (n == 3) lo = p[0] | p[1] << 8 | p[2] << 16;
+   else memcpy(&lo, p, 4);
+   if (n == 6) hi = p[4] | p[5] << 8;
+   else if (n == 8) memcpy(&hi, p+4, 4);
+   return _mm_unpacklo_epi32(_mm_cvtsi32_si128((int) lo), _mm_cvtsi32_si128((int) hi));
+}
+
+stbi_inline static void stbi__png_px_store(stbi_uc *p, stbi__png_px v, int n)
+{
+   stbi__uint32 lo = (stbi__uint32) _mm_cvtsi128_si32(v);
+   if (n == 3) { p[0] = (stbi_uc) lo; p[1] = (stbi_uc) (lo >> 8); p[2] = (stbi_uc) (lo >> 16); return; }
+   memcpy(p, &lo, 4);
+   if (n > 4) {
+      stbi__uint32 hi = (stbi__uint32) _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+      if (n == 6) { p[4] = (stbi_uc) hi; p[5] = (stbi_uc) (hi >> 8); }
+      else memcpy(p+4, &hi, 4);
+   }
+}
+
+#define stbi__png_px_zero()      _mm_setzero_si128()
+#define stbi__png_px_add(a,b)    _mm_add_epi8(a, b)
+#define stbi__png_px_or(a,b)     _mm_or_si128(a, b)
+#define stbi__png_px_set(lo,hi)  _mm_setr_epi32((int) (lo), (int) (hi), 0, 0)
+
+// (a + b) >> 1; pavgb rounds up, take the carried bit back off
+stbi_inline static stbi__png_px stbi__png_px_avg(stbi__png_px a, stbi__png_px b)
+{
+   stbi__png_px odd = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1));
+   return _mm_sub_epi8(_mm_avg_epu8(a, b), odd);
+}
+
+// stbi__paeth on every byte, in 16 bits
+stbi_inline static stbi__png_px stbi__png_px_paeth(stbi__png_px a, stbi__png_px b, stbi__png_px c)
+{
+   __m128i zero = _mm_setzero_si128();
+   __m128i aw = _mm_unpacklo_epi8(a, zero), bw = _mm_unpacklo_epi8(b, zero), cw = _mm_unpacklo_epi8(c, zero);
+   __m128i p = _mm_sub_epi16(bw, cw), q = _mm_sub_epi16(aw, cw), r = _mm_add_epi16(p, q);
+   __m128i pa = _mm_max_epi16(p, _mm_sub_epi16(zero, p));
+   __m128i pb = _mm_max_epi16(q, _mm_sub_epi16(zero, q));
+   __m128i pc = _mm_max_epi16(r, _mm_sub_epi16(zero, r));
+   __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+   // a if pa is the smallest, else b if pb is, else c
+   __m128i use_b = _mm_cmpeq_epi16(pb, smallest), use_a = _mm_cmpeq_epi16(pa, smallest);
+   __m128i pred = _mm_or_si128(_mm_and_si128(use_b, bw), _mm_andnot_si128(use_b, cw));
+   pred = _mm_or_si128(_mm_and_si128(use_a, aw), _mm_andnot_si128(use_a, pred));
+   return _mm_packus_epi16(pred, zero);
+}
+
+stbi_inline static void stbi__png_add_rows(stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int n, int *k)
+{
+   for (; *k+16 <= n; *k += 16)
+      _mm_storeu_si128((__m128i *) (cur + *k), _mm_add_epi8(_mm_loadu_si128((const __m128i *) (raw + *k)),
+                                                             _mm_loadu_si128((const __m128i *) (prior + *k))));
+}
+
+#else // STBI_NEON
+typedef uint8x8_t stbi__png_px;
+
+stbi_inline static stbi__png_px stbi__png_px_load(const stbi_uc *p, int n)
+{
+   stbi__uint32 lo, hi = 0;
+   if (n == 3) lo = p[0] | p[1] << 8 | p[2] << 16;
+   else memcpy(&lo, p, 4);
+   if (n == 6) hi = p[4] | p[5] << 8;
+   else if (n == 8) memcpy(&hi, p+4, 4);
+   return vcreate_u8((stbi__uint64) hi << 32 | lo);
+}
+
+stbi_inline static void stbi__png_px_store(stbi_uc *p, stbi__png_px v, int n)
+{
+   stbi__uint64 w = vget_lane_u64(vreinterpret_u64_u8(v), 0);
+   int i;
+   for (i=0; i < n; ++i)
+      p[i] = (stbi_uc) (w >> (i*8));
+}
+
+#define stbi__png_px_zero()      vdup_n_u8(0)
+#define stbi__png_px_add(a,b)    vadd_u8(a, b)
+#define stbi__png_px_or(a,b)     vorr_u8(a, b)
+#define stbi__png_px_set(lo,hi)  vcreate_u8((stbi__uint64) (hi) << 32 | (lo))
+#define stbi__png_px_avg(a,b)    vhadd_u8(a, b)
+
+stbi_inline static stbi__png_px stbi__png_px_paeth(stbi__png_px a, stbi__png_px b, stbi__png_px c)
+{
+   int16x8_t p = vreinterpretq_s16_u16(vsubl_u8(b, c));
+   int16x8_t q = vreinterpretq_s16_u16(vsubl_u8(a, c));
+   int16x8_t pa = vabsq_s16(p), pb = vabsq_s16(q), pc = vabsq_s16(vaddq_s16(p, q));
+   uint8x8_t use_a = vmovn_u16(vandq_u16(vcleq_s16(pa, pb), vcleq_s16(pa, pc)));
+   uint8x8_t use_b = vmovn_u16(vcleq_s16(pb, pc));
+   return vbsl_u8(use_a, a, vbsl_u8(use_b, b, c));
+}
+
+stbi_inline static void stbi__png_add_rows(stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int n, int *k)
+{
+   for (; *k+16 <= n; *k += 16)
+      vst1q_u8(cur + *k, vaddq_u8(vld1q_u8(raw + *k), vld1q_u8(prior + *k)));
+}
+#endif
+
+// unfilter a row of width pixels of in_n bytes into pixels of out_n bytes,
+// out_n > in_n filling the extra bytes with 255; prior is NULL on the first row
+stbi_inline static void stbi__png_unfilter_row_n(stbi_uc *cur, const stbi_uc *prior, const stbi_uc *raw, int filter, stbi__uint32 width, int in_n, int out_n)
+{
+   stbi__png_px a = stbi__png_px_zero(), b, c = stbi__png_px_zero(), x;
+   stbi__png_px alpha = stbi__png_px_zero();
+   stbi__uint32 i;
+   if (out_n == 4 && in_n == 3) alpha = stbi__png_px_set(0xff000000, 0);
+   if (out_n == 8 && in_n == 6) alpha = stbi__png_px_set(0, 0xffff0000);
+
+   if (filter == STBI__F_paeth_first) filter = STBI__F_sub; // paeth(a,0,0) is a
+   if (in_n == out_n && (filter == STBI__F_none || filter == STBI__F_up)) {
+      int n = (int) width * in_n, k = 0;
+      if (filter == STBI__F_none) {
+         memcpy(cur, raw, n);
+         return;
+      }
+      stbi__png_add_rows(cur, raw, prior, n, &k);
+      for (; k < n; ++k)
+         cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+      return;
+   }
+
+   #define STBI__PNG_LOOP(body) \
+      for (i=0; i < width; ++i, raw += in_n, cur += out_n) { \
+         x = stbi__png_px_load(raw, in_n); \
+         body \
+         stbi__png_px_store(cur, stbi__png_px_or(a, alpha), out_n); \
+      }
+   switch (filter) {
+      case STBI__F_none:
+         STBI__PNG_LOOP(a = x;)
+         break;
+      case STBI__F_sub:
+         STBI__PNG_LOOP(a = stbi__png_px_add(x, a);)
+         break;
+      case STBI__F_up:
+         STBI__PNG_LOOP(a = stbi__png_px_add(x, stbi__png_px_load(prior + i*out_n, in_n));)
+         break;
+      case STBI__F_avg:
+         STBI__PNG_LOOP(a = stbi__png_px_add(x, stbi__png_px_avg(a, stbi__png_px_load(prior + i*out_n, in_n)));)
+         break;
+      case STBI__F_avg_first:
+         STBI__PNG_LOOP(a = stbi__png_px_add(x, stbi__png_px_avg(a, stbi__png_px_zero()));)
+         break;
+      case STBI__F_paeth:
+         STBI__PNG_LOOP(b = stbi__png_px_load(prior + i*out_n, in_n);
+                        a = stbi__png_px_add(x, stbi__png_px_paeth(a, b, c));
+                        c = b;)
+         break;
+   }
+   #undef STBI__PNG_LOOP
+}
+
+// the pixel size as a constant in each call, so the loads and stores inline
+static void stbi__png_unfilter_row_simd(stbi_uc *cur, const stbi_uc *prior, const stbi_uc *raw, int filter, stbi__uint32 width, int in_n, int out_n)
+{
+   switch (in_n * 16 + out_n) {
+      case 3*16+3: stbi__png_unfilter_row_n(cur, prior, raw, filter, width, 3, 3); break;
+      case 3*16+4: stbi__png_unfilter_row_n(cur, prior, raw, filter, width, 3, 4); break;
+      case 4*16+4: stbi__png_unfilter_row_n(cur, prior, raw, filter, width, 4, 4); break;
+      case 6*16+6: stbi__png_unfilter_row_n(cur, prior, raw, filter, width, 6, 6); break;
+      case 6*16+8: stbi__png_unfilter_row_n(cur, prior, raw, filter, width, 6, 8); break;
+      case 8*16+8: stbi__png_unfilter_row_n(cur, prior, raw, filter, width, 8, 8); break;
+      default: STBI_ASSERT(0);
+   }
+}
+#endif
+
 // create the png data from post-deflated data
+// unfilter row j of an image x pixels wide from raw, which follows the row's
+// filter byte, into a->out, whose rows are a->out_stride bytes apart; 1/2/4-bit
+// rows are left packed at the right end of their output row for
+// stbi__create_png_image_raw to expand
+static void stbi__png_unfilter_row(stbi__png *a, stbi_uc *raw, int filter, stbi__uint32 j, stbi__uint32 x, int depth, int out_n, int simd)
+{
+   int bytes = (depth == 16? 2 : 1);
+   int img_n = a->s->img_n;
+   stbi__uint32 i;
+   int k;
+   int output_bytes = out_n*bytes;
+   int filter_bytes = img_n*bytes;
+   int width = x;
+   stbi_uc *cur = a->out + (ptrdiff_t) j * a->out_stride;
+   stbi_uc *prior;
+   STBI_NOTUSED(simd);
+
+   if (depth < 8) {
+      stbi__uint32 img_width_bytes = (((img_n * x * depth) + 7) >> 3);
+      cur += x*out_n - img_width_bytes; // store output to the rightmost img_len bytes, so we can decode in place
+      filter_bytes = 1;
+      width = img_width_bytes;
+   }
+   prior = cur - a->out_stride; // bugfix: need to compute this after 'cur +=' computation above
+
+   // if first row, use special filter that doesn't sample previous row
+   if (j == 0) filter = first_row_filter[filter];
+
+#ifdef STBI__PNG_SIMD
+   if (simd) {
+      stbi__png_unfilter_row_simd(cur, j ? prior : NULL, raw, filter, x, filter_bytes, output_bytes);
+      return;
+   }
+#endif
+
+   // handle first byte explicitly
+   for (k=0; k < filter_bytes; ++k) {
+      switch (filter) {
+         case STBI__F_none       : cur[k] = raw[k]; break;
+         case STBI__F_sub        : cur[k] = raw[k]; break;
+         case STBI__F_up         : cur[k] = STBI__BYTECAST(raw[k] + prior[k]); break;
+         case STBI__F_avg        : cur[k] = STBI__BYTECAST(raw[k] + (prior[k]>>1)); break;
+         case STBI__F_paeth      : cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(0,prior[k],0)); break;
+         case STBI__F_avg_first  : cur[k] = raw[k]; break;
+         case STBI__F_paeth_first: cur[k] = raw[k]; break;
+      }
+   }
+
+   if (depth == 8) {
+      if (img_n != out_n)
+         cur[img_n] = 255; // first pixel
+      raw += img_n;
+      cur += out_n;
+      prior += out_n;
+   } else if (depth == 16) {
+      if (img_n != out_n) {
+         cur[filter_bytes]   = 255; // first pixel top byte
+         cur[filter_bytes+1] = 255; // first pixel bottom byte
+      }
+      raw += filter_bytes;
+      cur += output_bytes;
+      prior += output_bytes;
+   } else {
+      raw += 1;
+      cur += 1;
+      prior += 1;
+   }
+
+   // this is a little gross, so that we don't switch per-pixel or per-component
+   if (depth < 8 || img_n == out_n) {
+      int nk = (width - 1)*filter_bytes;
+      #define STBI__CASE(f) \
+          case f:     \
+             for (k=0; k < nk; ++k)
+      switch (filter) {
+         // "none" filter turns into a memcpy here; make that explicit.
+         case STBI__F_none:         memcpy(cur, raw, nk); break;
+         STBI__CASE(STBI__F_sub)          { cur[k] = STBI__BYTECAST(raw[k] + cur[k-filter_bytes]); } break;
+         STBI__CASE(STBI__F_up)           { cur[k] = STBI__BYTECAST(raw[k] + prior[k]); } break;
+         STBI__CASE(STBI__F_avg)          { cur[k] = STBI__BYTECAST(raw[k] + ((prior[k] + cur[k-filter_bytes])>>1)); } break;
+         STBI__CASE(STBI__F_paeth)        { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k-filter_bytes],prior[k],prior[k-filter_bytes])); } break;
+         STBI__CASE(STBI__F_avg_first)    { cur[k] = STBI__BYTECAST(raw[k] + (cur[k-filter_bytes] >> 1)); } break;
+         STBI__CASE(STBI__F_paeth_first)  { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k-filter_bytes],0,0)); } break;
+      }
+      #undef STBI__CASE
+   } else {
+      STBI_ASSERT(img_n+1 == out_n);
+      #define STBI__CASE(f) \
+          case f:     \
+             for (i=x-1; i >= 1; --i, cur[filter_bytes]=255,raw+=filter_bytes,cur+=output_bytes,prior+=output_bytes) \
+                for (k=0; k < filter_bytes; ++k)
+      switch (filter) {
+         STBI__CASE(STBI__F_none)         { cur[k] = raw[k]; } break;
+         STBI__CASE(STBI__F_sub)          { cur[k] = STBI__BYTECAST(raw[k] + cur[k- output_bytes]); } break;
+         STBI__CASE(STBI__F_up)           { cur[k] = STBI__BYTECAST(raw[k] + prior[k]); } break;
+         STBI__CASE(STBI__F_avg)          { cur[k] = STBI__BYTECAST(raw[k] + ((prior[k] + cur[k- output_bytes])>>1)); } break;
+         STBI__CASE(STBI__F_paeth)        { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k- output_bytes],prior[k],prior[k- output_bytes])); } break;
+         STBI__CASE(STBI__F_avg_first)    { cur[k] = STBI__BYTECAST(raw[k] + (cur[k- output_bytes] >> 1)); } break;
+         STBI__CASE(STBI__F_paeth_first)  { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k- output_bytes],0,0)); } break;
+      }
+      #undef STBI__CASE
+
+      // the loop above sets the high byte of the pixels' alpha, but for
+      // 16 bit png files we also need the low byte set. we'll do that here.
+      if (depth == 16) {
+         cur = a->out + (ptrdiff_t) j * a->out_stride; // start at the beginning of the row again
+         for (i=0; i < x; ++i,cur+=output_bytes) {
+            cur[filter_bytes+1] = 255;
+         }
+      }
+   }
+}
+
+// force 16-bit samples from big-endian to platform-native
+static void stbi__png_swap16(stbi_uc *cur, stbi__uint32 n)
+{
+   stbi__uint16 *cur16 = (stbi__uint16*)cur;
+   stbi__uint32 i;
+   for(i=0; i < n; ++i,cur16++,cur+=2) {
+      *cur16 = (cur[0] << 8) | cur[1];
+   }
+}
+
+// point a->out at the caller's rows or allocate an image of x*y pixels
+static int stbi__png_begin_output(stbi__png *a, stbi__uint32 x, stbi__uint32 y, int out_bytes)
+{
+   if (a->into) {
+      a->out = a->s->into->out;
+      a->out_stride = a->s->into->stride;
+      return 1;
+   }
+   a->out = (stbi_uc *) stbi__malloc_mad3(x, y, out_bytes, 0); // extra bytes to write off the end into
+   if (!a->out) return stbi__err("outofmem", "Out of memory");
+   a->out_stride = x * out_bytes;
+   return 1;
+}
+
 static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
 {
    int bytes = (depth == 16? 2 : 1);
    stbi__context *s = a->s;
-   stbi__uint32 i,j,stride = x*out_n*bytes;
+   stbi__uint32 j,stride = x*out_n*bytes;
    stbi__uint32 img_len, img_width_bytes;
    int k;
    int img_n = s->img_n; // copy it into a local for later
 
    int output_bytes = out_n*bytes;
-   int filter_bytes = img_n*bytes;
-   int width = x;
+   int simd = 0;
+#ifdef STBI__PNG_SIMD
+   simd = depth >= 8 && (img_n == 3 || img_n == 4);
+#ifdef STBI_SSE2
+   simd = simd && stbi__sse2_available();
+#endif
+#endif
 
    STBI_ASSERT(out_n == s->img_n || out_n == s->img_n+1);
-   a->out = (stbi_uc *) stbi__malloc_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
-   if (!a->out) return stbi__err("outofmem", "Out of memory");
+   if (!stbi__png_begin_output(a, x, y, output_bytes)) return 0;
 
    if (!stbi__mad3sizes_valid(img_n, x, depth, 7)) return stbi__err("too large", "Corrupt PNG");
    img_width_bytes = (((img_n * x * depth) + 7) >> 3);
@@ -4501,102 +6258,13 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
    // so just check for raw_len < img_len always.
    if (raw_len < img_len) return stbi__err("not enough pixels","Corrupt PNG");
 
+   STBI_ASSERT(depth >= 8 || img_width_bytes <= x);
    for (j=0; j < y; ++j) {
-      stbi_uc *cur = a->out + stride*j;
-      stbi_uc *prior;
       int filter = *raw++;
-
       if (filter > 4)
          return stbi__err("invalid filter","Corrupt PNG");
-
-      if (depth < 8) {
-         STBI_ASSERT(img_width_bytes <= x);
-         cur += x*out_n - img_width_bytes; // store output to the rightmost img_len bytes, so we can decode in place
-         filter_bytes = 1;
-         width = img_width_bytes;
-      }
-      prior = cur - stride; // bugfix: need to compute this after 'cur +=' computation above
-
-      // if first row, use special filter that doesn't sample previous row
-      if (j == 0) filter = first_row_filter[filter];
-
-      // handle first byte explicitly
-      for (k=0; k < filter_bytes; ++k) {
-         switch (filter) {
-            case STBI__F_none       : cur[k] = raw[k]; break;
-            case STBI__F_sub        : cur[k] = raw[k]; break;
-            case STBI__F_up         : cur[k] = STBI__BYTECAST(raw[k] + prior[k]); break;
-            case STBI__F_avg        : cur[k] = STBI__BYTECAST(raw[k] + (prior[k]>>1)); break;
-            case STBI__F_paeth      : cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(0,prior[k],0)); break;
-            case STBI__F_avg_first  : cur[k] = raw[k]; break;
-            case STBI__F_paeth_first: cur[k] = raw[k]; break;
-         }
-      }
-
-      if (depth == 8) {
-         if (img_n != out_n)
-            cur[img_n] = 255; // first pixel
-         raw += img_n;
-         cur += out_n;
-         prior += out_n;
-      } else if (depth == 16) {
-         if (img_n != out_n) {
-            cur[filter_bytes]   = 255; // first pixel top byte
-            cur[filter_bytes+1] = 255; // first pixel bottom byte
-         }
-         raw += filter_bytes;
-         cur += output_bytes;
-         prior += output_bytes;
-      } else {
-         raw += 1;
-         cur += 1;
-         prior += 1;
-      }
-
-      // this is a little gross, so that we don't switch per-pixel or per-component
-      if (depth < 8 || img_n == out_n) {
-         int nk = (width - 1)*filter_bytes;
-         #define STBI__CASE(f) \
-             case f:     \
-                for (k=0; k < nk; ++k)
-         switch (filter) {
-            // "none" filter turns into a memcpy here; make that explicit.
-            case STBI__F_none:         memcpy(cur, raw, nk); break;
-            STBI__CASE(STBI__F_sub)          { cur[k] = STBI__BYTECAST(raw[k] + cur[k-filter_bytes]); } break;
-            STBI__CASE(STBI__F_up)           { cur[k] = STBI__BYTECAST(raw[k] + prior[k]); } break;
-            STBI__CASE(STBI__F_avg)          { cur[k] = STBI__BYTECAST(raw[k] + ((prior[k] + cur[k-filter_bytes])>>1)); } break;
-            STBI__CASE(STBI__F_paeth)        { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k-filter_bytes],prior[k],prior[k-filter_bytes])); } break;
-            STBI__CASE(STBI__F_avg_first)    { cur[k] = STBI__BYTECAST(raw[k] + (cur[k-filter_bytes] >> 1)); } break;
-            STBI__CASE(STBI__F_paeth_first)  { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k-filter_bytes],0,0)); } break;
-         }
-         #undef STBI__CASE
-         raw += nk;
-      } else {
-         STBI_ASSERT(img_n+1 == out_n);
-         #define STBI__CASE(f) \
-             case f:     \
-                for (i=x-1; i >= 1; --i, cur[filter_bytes]=255,raw+=filter_bytes,cur+=output_bytes,prior+=output_bytes) \
-                   for (k=0; k < filter_bytes; ++k)
-         switch (filter) {
-            STBI__CASE(STBI__F_none)         { cur[k] = raw[k]; } break;
-            STBI__CASE(STBI__F_sub)          { cur[k] = STBI__BYTECAST(raw[k] + cur[k- output_bytes]); } break;
-            STBI__CASE(STBI__F_up)           { cur[k] = STBI__BYTECAST(raw[k] + prior[k]); } break;
-            STBI__CASE(STBI__F_avg)          { cur[k] = STBI__BYTECAST(raw[k] + ((prior[k] + cur[k- output_bytes])>>1)); } break;
-            STBI__CASE(STBI__F_paeth)        { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k- output_bytes],prior[k],prior[k- output_bytes])); } break;
-            STBI__CASE(STBI__F_avg_first)    { cur[k] = STBI__BYTECAST(raw[k] + (cur[k- output_bytes] >> 1)); } break;
-            STBI__CASE(STBI__F_paeth_first)  { cur[k] = STBI__BYTECAST(raw[k] + stbi__paeth(cur[k- output_bytes],0,0)); } break;
-         }
-         #undef STBI__CASE
-
-         // the loop above sets the high byte of the pixels' alpha, but for
-         // 16 bit png files we also need the low byte set. we'll do that here.
-         if (depth == 16) {
-            cur = a->out + stride*j; // start at the beginning of the row again
-            for (i=0; i < x; ++i,cur+=output_bytes) {
-               cur[filter_bytes+1] = 255;
-            }
-         }
-      }
+      stbi__png_unfilter_row(a, raw, filter, j, x, depth, out_n, simd);
+      raw += img_width_bytes;
    }
 
    // we make a separate pass to expand bits to pixels; for performance,
@@ -4676,12 +6344,7 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       // this is done in a separate pass due to the decoding relying
       // on the data being untouched, but could probably be done
       // per-line during decode if care is taken.
-      stbi_uc *cur = a->out;
-      stbi__uint16 *cur16 = (stbi__uint16*)cur;
-
-      for(i=0; i < x*y*out_n; ++i,cur16++,cur+=2) {
-         *cur16 = (cur[0] << 8) | cur[1];
-      }
+      stbi__png_swap16(a->out, x*y*out_n);
    }
 
    return 1;
@@ -4731,6 +6394,196 @@ static int stbi__create_png_image(stbi__png *a, stbi_uc *image_data, stbi__uint3
    return 1;
 }
 
+#ifdef STBI__PNG_THREADS
+// Pipelined decoding through stbi_set_png_parallel(). The first task to start
+// inflates the IDAT data into a window, handing over the rows it completes
+// every STBI__PNG_PIPE_STEP bytes; the other task unfilters them in order.
+// When the window is full the inflater waits until every complete row is
+// unfiltered, doing them itself if the other task is not running, then moves
+// the last 32KB, which later matches may copy from, and the incomplete row
+// back to its start. 16-bit rows are byte swapped once the row below them no
+// longer needs them.
+
+// images with fewer pixels decode on the calling thread
+#define STBI__PNG_THREAD_MIN_PIXELS  (256*256)
+// inflated bytes between hand-overs; the window holds eight of these
+#define STBI__PNG_PIPE_STEP          (1 << 16)
+// pauses the unfiltering task waits for rows before leaving the rest to the inflater
+#define STBI__PNG_MAX_SPINS          (1 << 16)
+
+typedef struct
+{
+   stbi__png *a;
+   stbi__zbuf *z;
+   char *window, *window_end;
+   size_t base;             // stream offset of window[0]
+   size_t row_bytes;        // one row of the stream, with its filter byte
+   stbi__uint32 x, stride;
+   int rows, depth, out_n, simd;
+   int zlib_header, zlib_ok;
+   const char *zlib_error;  // the failure reason is per thread
+   stbi__atomic role;       // tasks started, the first one inflates
+   stbi__atomic ready;      // rows inflated
+   stbi__atomic next, done; // rows claimed and finished by the unfiltering
+   stbi__atomic finished;   // the inflater is done
+   stbi__atomic bad_filter;
+} stbi__png_pipe;
+
+// threads to decode a with, 0 to stay on the calling thread
+static int stbi__png_threads(stbi__png *a)
+{
+   if (!stbi__png_parallel_run || stbi__png_parallel_threads < 2) return 0;
+   if (a->s->img_x * a->s->img_y < STBI__PNG_THREAD_MIN_PIXELS) return 0;
+   return 2;
+}
+
+// hand over the rows complete up to zout
+static void stbi__png_pipe_publish(stbi__png_pipe *p, char *zout)
+{
+   size_t rows = (p->base + (size_t) (zout - p->window)) / p->row_bytes;
+   stbi__atomic_set(&p->ready, rows < (size_t) p->rows ? (int) rows : p->rows);
+}
+
+// unfilter the next inflated row, 0 if there is none
+static int stbi__png_pipe_unfilter(stbi__png_pipe *p)
+{
+   int r = stbi__atomic_get(&p->next);
+   stbi_uc *raw;
+   if (r >= stbi__atomic_get(&p->ready) || !stbi__atomic_claim(&p->next, r)) return 0;
+   // row r is unfiltered against row r-1, which the other task may be on
+   while (stbi__atomic_get(&p->done) < r)
+      stbi__pause();
+   raw = (stbi_uc *) p->window + ((size_t) r * p->row_bytes - p->base);
+   if (raw[0] > 4 || stbi__atomic_get(&p->bad_filter))
+      stbi__atomic_set(&p->bad_filter, 1);
+   else
+      stbi__png_unfilter_row(p->a, raw+1, raw[0], r, p->x, p->depth, p->out_n, p->simd);
+   if (p->depth == 16 && r > 0)
+      stbi__png_swap16(p->a->out + (size_t) (r-1) * p->stride, p->x * p->out_n);
+   stbi__atomic_set(&p->done, r + 1);
+   return 1;
+}
+
+// stbi__zexpand of the inflater: hand over the complete rows, and make room
+// for n bytes and the next step
+static int stbi__png_pipe_drain(void *user, char *zout, int n)
+{
+   stbi__png_pipe *p = (stbi__png_pipe *) user;
+   stbi__zbuf *z = p->z;
+   stbi__png_pipe_publish(p, zout);
+   if (p->window_end - zout < n + STBI__PNG_PIPE_STEP) {
+      int ready = stbi__atomic_get(&p->ready);
+      char *keep = zout - 32768;
+      while (stbi__atomic_get(&p->done) < ready)
+         if (!stbi__png_pipe_unfilter(p)) stbi__pause();
+      if (ready < p->rows) {
+         char *row = p->window + ((size_t) ready * p->row_bytes - p->base);
+         if (row < keep) keep = row;
+      }
+      if (keep > p->window) {
+         if (stbi__zlib_verify_adler32)
+            z->adler = stbi__adler32(z->adler, (stbi_uc *) p->window, keep - p->window);
+         memmove(p->window, keep, zout - keep);
+         p->base += keep - p->window;
+         zout -= keep - p->window;
+      }
+      if (p->window_end - zout < n) return stbi__err("output buffer limit","Corrupt PNG");
+   }
+   z->zout = zout;
+   z->zout_end = p->window_end - zout > n + STBI__PNG_PIPE_STEP ? zout + n + STBI__PNG_PIPE_STEP : p->window_end;
+   return 1;
+}
+
+static void stbi__png_pipe_task(void *data, int index)
+{
+   stbi__png_pipe *p = (stbi__png_pipe *) data;
+   int idle = 0;
+   STBI_NOTUSED(index);
+   if (stbi__atomic_inc(&p->role) == 0) {
+      const char *reason = stbi__g_failure_reason;
+      stbi__g_failure_reason = NULL;
+      p->zlib_ok = stbi__parse_zlib(p->z, p->zlib_header);
+      p->zlib_error = stbi__g_failure_reason;
+      stbi__g_failure_reason = reason;
+      stbi__png_pipe_publish(p, p->z->zout);
+      stbi__atomic_set(&p->finished, 1);
+      while (stbi__atomic_get(&p->done) < stbi__atomic_get(&p->ready))
+         if (!stbi__png_pipe_unfilter(p)) stbi__pause();
+      return;
+   }
+
+   // the inflater finishes whatever is left, so give up after waiting long
+   // for rows rather than spin on a busy machine
+   while (!stbi__atomic_get(&p->finished) || stbi__atomic_get(&p->next) < stbi__atomic_get(&p->ready)) {
+      if (stbi__png_pipe_unfilter(p))
+         idle = 0;
+      else if (++idle > STBI__PNG_MAX_SPINS)
+         break;
+      else
+         stbi__pause();
+   }
+}
+
+// inflate the ilen bytes of IDAT data of a non-interlaced 8 or 16-bit image
+// pipelined with the unfiltering into a->out
+static int stbi__png_pipeline(stbi__png *a, stbi_uc *idata, stbi__uint32 ilen, int zlib_header, int out_n, int threads)
+{
+   stbi__context *s = a->s;
+   int bytes = (a->depth == 16 ? 2 : 1);
+   size_t size;
+   stbi__zbuf z;
+   stbi__png_pipe p;
+
+   STBI_ASSERT(out_n == s->img_n || out_n == s->img_n+1);
+   if (!stbi__png_begin_output(a, s->img_x, s->img_y, out_n*bytes)) return 0;
+   p.a = a;
+   p.z = &z;
+   p.x = s->img_x;
+   p.rows = s->img_y;
+   p.depth = a->depth;
+   p.out_n = out_n;
+   p.stride = s->img_x * out_n * bytes;
+   p.row_bytes = (size_t) s->img_x * s->img_n * bytes + 1;
+   p.simd = 0;
+#ifdef STBI__PNG_SIMD
+   p.simd = s->img_n == 3 || s->img_n == 4;
+#ifdef STBI_SSE2
+   p.simd = p.simd && stbi__sse2_available();
+#endif
+#endif
+   // the last 32KB and an incomplete row stay behind, a stored block can add 64KB at once
+   size = 32768 + p.row_bytes + 65536 + 8 * STBI__PNG_PIPE_STEP;
+   p.window = (char *) stbi__malloc(size);
+   if (!p.window) return stbi__err("outofmem", "Out of memory");
+   p.window_end = p.window + size;
+   p.base = 0;
+   p.zlib_header = zlib_header;
+   p.zlib_ok = 0;
+   p.role = p.ready = p.next = p.done = p.finished = p.bad_filter = 0;
+
+   z.zbuffer = idata;
+   z.zbuffer_end = idata + ilen;
+   z.zout_start = z.zout = p.window;
+   z.zout_end = p.window + STBI__PNG_PIPE_STEP;
+   z.z_expandable = 0;
+   z.drain = stbi__png_pipe_drain;
+   z.drain_user = &p;
+   z.adler = 1;
+
+   stbi__png_parallel_run(stbi__png_parallel_user, threads, stbi__png_pipe_task, &p);
+   STBI_FREE(p.window);
+   if (!p.zlib_ok) {
+      if (p.zlib_error) stbi__g_failure_reason = p.zlib_error;
+      return 0;
+   }
+   if (p.ready < p.rows) return stbi__err("not enough pixels","Corrupt PNG");
+   if (p.bad_filter) return stbi__err("invalid filter","Corrupt PNG");
+   if (p.depth == 16)
+      stbi__png_swap16(a->out + (size_t) (p.rows-1) * p.stride, p.x * out_n);
+   return 1;
+}
+#endif // STBI__PNG_THREADS
+
 static int stbi__compute_transparency(stbi__png *z, stbi_uc tc[3], int out_n)
 {
    stbi__context *s = z->s;
@@ -4876,6 +6729,16 @@ static void stbi__de_iphone(stbi__png *z)
 
 #define STBI__PNG_TYPE(a,b,c,d)  (((unsigned) (a) << 24) + ((unsigned) (b) << 16) + ((unsigned) (c) << 8) + (unsigned) (d))
 
+// whether the 8-bit image z unfilters to req_comp components and the size
+// of the rows of stbi_load_into, so it can be written straight into them
+static int stbi__png_into(stbi__png *z, int req_comp)
+{
+   stbi__context *s = z->s;
+   if (!s->into || z->depth != 8) return 0;
+   if (s->img_x != (stbi__uint32) s->into->w || s->img_y != (stbi__uint32) s->into->h) return 0;
+   return s->img_out_n == req_comp;
+}
+
 static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
 {
    stbi_uc palette[1024], pal_img_n=0;
@@ -4888,6 +6751,7 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
    z->expanded = NULL;
    z->idata = NULL;
    z->out = NULL;
+   z->into = 0;
 
    if (!stbi__check_png_header(s)) return 0;
 
@@ -4988,20 +6852,31 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
 
          case STBI__PNG_TYPE('I','E','N','D'): {
             stbi__uint32 raw_len, bpl;
+            int threads = 0;
             if (first) return stbi__err("first not IHDR", "Corrupt PNG");
             if (scan != STBI__SCAN_load) return 1;
             if (z->idata == NULL) return stbi__err("no IDAT","Corrupt PNG");
-            // initial guess for decoded data size to avoid unnecessary reallocs
-            bpl = (s->img_x * z->depth + 7) / 8; // bytes per line, per component
-            raw_len = bpl * s->img_y * s->img_n /* pixels */ + s->img_y /* filter mode per row */;
-            z->expanded = (stbi_uc *) stbi_zlib_decode_malloc_guesssize_headerflag((char *) z->idata, ioff, raw_len, (int *) &raw_len, !is_iphone);
-            if (z->expanded == NULL) return 0; // zlib should set error
-            STBI_FREE(z->idata); z->idata = NULL;
             if ((req_comp == s->img_n+1 && req_comp != 3 && !pal_img_n) || has_trans)
                s->img_out_n = s->img_n+1;
             else
                s->img_out_n = s->img_n;
-            if (!stbi__create_png_image(z, z->expanded, raw_len, s->img_out_n, z->depth, color, interlace)) return 0;
+            // de-interlacing, tRNS, palettes and de-iPhoning take another pass over the image
+            z->into = !interlace && !has_trans && !pal_img_n && !is_iphone && stbi__png_into(z, req_comp);
+#ifdef STBI__PNG_THREADS
+            if (!interlace && z->depth >= 8)
+               threads = stbi__png_threads(z);
+            if (threads && !stbi__png_pipeline(z, z->idata, ioff, !is_iphone, s->img_out_n, threads)) return 0;
+#endif
+            if (!threads) {
+               // initial guess for decoded data size to avoid unnecessary reallocs
+               bpl = (s->img_x * z->depth + 7) / 8; // bytes per line, per component
+               raw_len = bpl * s->img_y * s->img_n /* pixels */ + s->img_y /* filter mode per row */;
+               z->expanded = (stbi_uc *) stbi_zlib_decode_malloc_guesssize_headerflag((char *) z->idata, ioff, raw_len, (int *) &raw_len, !is_iphone);
+               if (z->expanded == NULL) return 0; // zlib should set error
+               STBI_FREE(z->idata); z->idata = NULL;
+               if (!stbi__create_png_image(z, z->expanded, raw_len, s->img_out_n, z->depth, color, interlace)) return 0;
+            }
+            STBI_FREE(z->idata); z->idata = NULL;
             if (has_trans) {
                if (z->depth == 16) {
                   if (!stbi__compute_transparency16(z, tc16, s->img_out_n)) return 0;
@@ -5073,6 +6948,7 @@ static void *stbi__do_png(stbi__png *p, int *x, int *y, int *n, int req_comp, st
       *y = p->s->img_y;
       if (n) *n = p->s->img_n;
    }
+   if (p->into) p->out = NULL; // the caller's
    STBI_FREE(p->out);      p->out      = NULL;
    STBI_FREE(p->expanded); p->expanded = NULL;
    STBI_FREE(p->idata);    p->idata    = NULL;
@@ -0,0 +1,55 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Fixed set of worker threads running data parallel loops. parallelFor()
+ * splits [0, count) in chunks of grain items that the workers and the
+ * calling thread take from a shared counter, and returns once every chunk
+ * has run. One loop runs at a time; a call made from inside a task runs
+ * serially on the calling thread. */
+class ThreadPool {
+
+public:
+    typedef std::function<void(size_t begin, size_t end)> Task;
+
+    /* threads counts the caller, 0 picks the number of hardware threads */
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    /* Number of threads taking part in a loop, the caller included */
+    unsigned size() const { return (unsigned)workers.size() + 1; }
+
+    void parallelFor(size_t count, size_t grain, const Task &task);
+
+    /* Process wide pool sized to the machine, created on first use */
+    static ThreadPool &shared();
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex loop;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const Task *task;
+    size_t count;
+    size_t grain;
+    size_t next;            // first item not handed out yet, under lock
+    unsigned active;        // workers still inside the current loop
+    unsigned long long generation;
+    bool stopping;
+
+    void workerMain();
+    void runChunks();
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+};
+
+#endif
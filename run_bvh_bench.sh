@@ -0,0 +1,4 @@
+g++ -O2 -march=native -I./include src/bvh_bench.cpp src/mesh_bvh.cpp \
+    src/thread_pool.cpp \
+    -lpthread -o bvh_bench \
+    && ./bvh_bench "$@"
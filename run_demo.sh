@@ -1,5 +1,8 @@
 
 g++ -I./include src/hello.cpp src/glad.c \
-    src/shader.cpp src/stb_image.cpp \
+    src/shader.cpp src/shader_preprocessor.cpp src/stb_image.cpp \
+    src/gl_trace.cpp src/gl_capture.cpp src/null_gl.cpp \
+    src/particles.cpp src/particle_renderer.cpp src/morton_sort.cpp \
+    src/thread_pool.cpp \
     -lglfw3 -ldl -lX11 -lpthread \
     && ./a.out
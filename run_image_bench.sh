@@ -0,0 +1,7 @@
+# SSE2 kernels then AVX2 kernels, the pixel hashes must match
+for flags in "-DSTBI_NO_AVX2" ""; do
+    g++ -O2 -march=native $flags -I./include src/image_bench.cpp src/stb_image.cpp \
+        src/thread_pool.cpp \
+        -lpthread -o image_bench \
+        && ./image_bench "$@" || exit 1
+done
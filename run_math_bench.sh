@@ -0,0 +1,9 @@
+# One binary per instruction set, all results in a single CSV on stdout.
+# -ffp-contract=off keeps the generic code from being fused into FMAs in the
+# -mfma build, so the bit for bit check of the SIMD paths holds there too.
+header=
+for flags in "-DGLM_FORCE_PURE" "-msse2" "-msse4.1" "-mavx" "-mavx2 -mfma"; do
+    g++ -O2 -ffp-contract=off $flags -I./include src/math_bench.cpp -o math_bench \
+        && ./math_bench $header "$@" || exit 1
+    header=--no-header
+done
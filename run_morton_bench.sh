@@ -0,0 +1,4 @@
+g++ -O2 -march=native -I./include src/morton_bench.cpp src/morton_sort.cpp \
+    src/particles.cpp src/spatial_grid.cpp src/thread_pool.cpp \
+    -lpthread -o morton_bench \
+    && ./morton_bench "$@"
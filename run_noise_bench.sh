@@ -0,0 +1,4 @@
+g++ -O2 -march=native -ffp-contract=off -I./include src/noise_bench.cpp src/noise_field.cpp \
+    src/thread_pool.cpp \
+    -lpthread -o noise_bench \
+    && ./noise_bench "$@"
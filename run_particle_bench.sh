@@ -0,0 +1,5 @@
+g++ -O2 -march=native -I./include src/particle_bench.cpp src/particles.cpp \
+    src/morton_sort.cpp \
+    src/thread_pool.cpp \
+    -lpthread -o particle_bench \
+    && ./particle_bench "$@"
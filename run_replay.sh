@@ -0,0 +1,3 @@
+g++ -O2 -I./include src/gl_replay.cpp src/glad.c \
+    -lglfw3 -ldl -lX11 -lpthread -o gl_replay \
+    && ./gl_replay "$@"
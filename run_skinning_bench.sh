@@ -0,0 +1,4 @@
+g++ -O2 -march=native -I./include src/skinning_bench.cpp src/skinning.cpp \
+    src/animation.cpp src/thread_pool.cpp \
+    -lpthread -o skinning_bench \
+    && ./skinning_bench "$@"
@@ -0,0 +1,4 @@
+g++ -O2 -march=native -I./include src/spatial_grid_bench.cpp src/spatial_grid.cpp \
+    src/thread_pool.cpp \
+    -lpthread -o spatial_grid_bench \
+    && ./spatial_grid_bench "$@"
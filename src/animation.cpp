@@ -0,0 +1,130 @@
+#include "animation.h"
+#include "glm/gtx/quaternion_batch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Joints gathered per call to the batch interpolation
+static const unsigned ANIMATION_BLOCK = 256;
+
+/* Index of the last key at or before time, starting from the cached one.
+ * Playback moves at most one key per frame in the common case, which is a
+ * single comparison; jumps and rewinds fall back to a binary search. */
+static unsigned animationFindKey(const float *times, unsigned count,
+        unsigned cached, float time) {
+    unsigned last = count - 1;
+    if (cached <= last && times[cached] <= time) {
+        unsigned next = cached < last ? cached + 1 : last;
+        cached = times[next] <= time ? next : cached;
+        if (cached == last || times[cached + 1] > time)
+            return cached;
+    }
+
+    unsigned key = (unsigned)(std::upper_bound(times, times + count, time) - times);
+    return key ? key - 1 : 0;
+}
+
+/* The two keys around time and the factor between them, clamped to the
+ * first or last key outside the track */
+template <typename T>
+static bool animationKeys(const AnimationChannel<T> &channel, unsigned joint,
+        unsigned &cursor, float time, unsigned &a, unsigned &b, float &t) {
+    unsigned count = channel.count[joint];
+    if (!count)
+        return false;
+
+    unsigned first = channel.first[joint];
+    const float *times = &channel.times[first];
+    unsigned key = animationFindKey(times, count, cursor, time);
+    unsigned next = key + 1 < count ? key + 1 : key;
+    cursor = key;
+
+    float span = times[next] - times[key];
+    float factor = span > 0.0f ? (time - times[key]) / span : 0.0f;
+    a = first + key;
+    b = first + next;
+    t = glm::clamp(factor, 0.0f, 1.0f);
+    return true;
+}
+
+static void animationSampleVec3(const AnimationChannel<glm::vec3> &channel,
+        std::vector<unsigned> &cursors, float time, glm::vec3 *out,
+        unsigned firstJoint, unsigned count) {
+    for (unsigned j = firstJoint; j < firstJoint + count; j++) {
+        unsigned a, b;
+        float t;
+        if (animationKeys(channel, j, cursors[j], time, a, b, t))
+            out[j] = glm::mix(channel.values[a], channel.values[b], t);
+    }
+}
+
+static void animationSampleRotations(const AnimationChannel<glm::quat> &channel,
+        std::vector<unsigned> &cursors, float time, glm::quat *out,
+        unsigned firstJoint, unsigned count, AnimationRotationMode mode) {
+    glm::quat from[ANIMATION_BLOCK];
+    glm::quat to[ANIMATION_BLOCK];
+    glm::quat result[ANIMATION_BLOCK];
+    float factor[ANIMATION_BLOCK];
+    unsigned target[ANIMATION_BLOCK];
+
+    unsigned j = firstJoint;
+    unsigned end = firstJoint + count;
+    while (j < end) {
+        unsigned n = 0;
+        for (; j < end && n < ANIMATION_BLOCK; j++) {
+            unsigned a, b;
+            if (!animationKeys(channel, j, cursors[j], time, a, b, factor[n]))
+                continue;
+            from[n] = channel.values[a];
+            to[n] = channel.values[b];
+            target[n] = j;
+            n++;
+        }
+
+        if (mode == ANIMATION_SLERP)
+            glm::slerpBatch(from, to, factor, result, n);
+        else
+            glm::nlerpBatch(from, to, factor, result, n);
+
+        for (unsigned i = 0; i < n; i++)
+            out[target[i]] = result[i];
+    }
+}
+
+AnimationClip::AnimationClip(unsigned jointCount, float duration)
+    : joints(jointCount), length(duration) {
+    translation.first.assign(jointCount, 0);
+    translation.count.assign(jointCount, 0);
+    rotation.first.assign(jointCount, 0);
+    rotation.count.assign(jointCount, 0);
+    scale.first.assign(jointCount, 0);
+    scale.count.assign(jointCount, 0);
+}
+
+float AnimationClip::wrap(float time) const {
+    if (length <= 0.0f)
+        return 0.0f;
+    float wrapped = std::fmod(time, length);
+    return wrapped < 0.0f ? wrapped + length : wrapped;
+}
+
+void AnimationClip::initCursor(AnimationCursor &cursor) const {
+    cursor.translation.assign(joints, 0);
+    cursor.rotation.assign(joints, 0);
+    cursor.scale.assign(joints, 0);
+}
+
+void AnimationClip::sample(float time, AnimationCursor &cursor,
+        LocalPose &pose, unsigned firstJoint, unsigned count,
+        AnimationRotationMode mode) const {
+    if (firstJoint >= joints)
+        return;
+    count = std::min(count, joints - firstJoint);
+
+    animationSampleVec3(translation, cursor.translation, time,
+            &pose.translations[0], firstJoint, count);
+    animationSampleRotations(rotation, cursor.rotation, time,
+            &pose.rotations[0], firstJoint, count, mode);
+    animationSampleVec3(scale, cursor.scale, time,
+            &pose.scales[0], firstJoint, count);
+}
@@ -0,0 +1,192 @@
+#include "mesh_bvh.h"
+
+#include "glm/gtc/noise.hpp"
+#include "glm/gtx/intersect.hpp"
+#include "glm/gtx/random_batch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* Builds a BVH over a perlin terrain and traces camera rays, shadow rays
+ * toward a light from the camera hits and random rays through it. Reports
+ * rays per second of glm::intersectRayTriangle run over every triangle,
+ * of single ray BVH queries and of packets on one thread and on the pool,
+ * after checking a sample of BVH hits against the brute force loop.
+ *
+ *   bvh_bench [grid] [width] [height]
+ */
+
+static const size_t BENCH_REFERENCE_RAYS = 256;
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+/* The existing glm answer: every triangle, keep the closest */
+static BVHHit benchBruteForce(const BVHRay &ray, const std::vector<glm::vec3> &positions,
+        const std::vector<unsigned> &indices) {
+    BVHHit hit = { ray.tMax, 0.0f, 0.0f, MESH_BVH_MISS };
+    for (size_t t = 0; t < indices.size() / 3; t++) {
+        glm::vec3 bary;
+        if (glm::intersectRayTriangle(ray.origin, ray.direction, positions[indices[t * 3]],
+                    positions[indices[t * 3 + 1]], positions[indices[t * 3 + 2]], bary)
+                && bary.z >= ray.tMin && bary.z < hit.t) {
+            hit.t = bary.z;
+            hit.u = bary.x;
+            hit.v = bary.y;
+            hit.triangle = (unsigned)t;
+        }
+    }
+    return hit;
+}
+
+/* Hits agree when they find the same surface: ties on shared edges may
+ * pick either triangle */
+static bool benchSameHit(const BVHHit &a, const BVHHit &b) {
+    if ((a.triangle == MESH_BVH_MISS) != (b.triangle == MESH_BVH_MISS))
+        return false;
+    return a.triangle == MESH_BVH_MISS || glm::abs(a.t - b.t) <= 1e-4f * glm::max(1.0f, a.t);
+}
+
+/* Times the rays and checks them, false if any disagree */
+static bool benchRays(const char *name, const MeshBVH &bvh, const std::vector<BVHRay> &rays,
+        const std::vector<glm::vec3> &positions, const std::vector<unsigned> &indices,
+        bool occlusion) {
+    size_t count = rays.size();
+    std::vector<BVHHit> single(count), packet(count);
+    std::vector<bool> singleOccluded(count);
+    bool *packetOccluded = new bool[count];
+    ThreadPool &pool = ThreadPool::shared();
+
+    // Reference: glm over every triangle, on a sample of the rays
+    size_t stride = count / BENCH_REFERENCE_RAYS;
+    std::vector<BVHHit> reference(BENCH_REFERENCE_RAYS);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCH_REFERENCE_RAYS; i++)
+        reference[i] = benchBruteForce(rays[i * stride], positions, indices);
+    double bruteRate = BENCH_REFERENCE_RAYS / benchSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        if (occlusion)
+            singleOccluded[i] = bvh.occluded(rays[i]);
+        else
+            bvh.intersect(rays[i], single[i]);
+    }
+    double singleRate = count / benchSeconds(start);
+
+    double packetRate[2];
+    for (int threaded = 0; threaded < 2; threaded++) {
+        start = std::chrono::steady_clock::now();
+        if (occlusion)
+            bvh.occluded(&rays[0], packetOccluded, count, threaded ? &pool : NULL);
+        else
+            bvh.intersect(&rays[0], &packet[0], count, threaded ? &pool : NULL);
+        packetRate[threaded] = count / benchSeconds(start);
+    }
+
+    size_t mismatches = 0, hits = 0;
+    for (size_t i = 0; i < BENCH_REFERENCE_RAYS; i++) {
+        size_t r = i * stride;
+        bool expected = reference[i].triangle != MESH_BVH_MISS;
+        if (occlusion)
+            mismatches += singleOccluded[r] != expected || packetOccluded[r] != expected;
+        else
+            mismatches += !benchSameHit(reference[i], single[r]) || !benchSameHit(reference[i], packet[r]);
+        hits += expected;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (occlusion)
+            mismatches += singleOccluded[i] != packetOccluded[i];
+        else
+            mismatches += !benchSameHit(single[i], packet[i]);
+    }
+
+    printf("%-7s %8zu rays: glm brute force %8.0f, BVH single %6.2f M, "
+            "packets of %d %6.2f M, %2u thread(s) %6.2f M rays/s, %zu/%zu sampled hits%s\n",
+            name, count, bruteRate, singleRate * 1e-6, MeshBVH::packetSize(),
+            packetRate[0] * 1e-6, pool.size(), packetRate[1] * 1e-6,
+            hits, BENCH_REFERENCE_RAYS, mismatches ? ", MISMATCHES" : "");
+    if (mismatches)
+        printf("FAIL: %zu rays disagree\n", mismatches);
+    delete[] packetOccluded;
+    return !mismatches;
+}
+
+int main(int argc, char *argv[]) {
+    int grid = argc > 1 ? atoi(argv[1]) : 512;
+    int width = argc > 2 ? atoi(argv[2]) : 1024;
+    int height = argc > 3 ? atoi(argv[3]) : 768;
+
+    // Terrain over [-1, 1]^2, heights from two octaves of perlin noise
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned> indices;
+    for (int y = 0; y < grid; y++)
+        for (int x = 0; x < grid; x++) {
+            glm::vec2 p = glm::vec2(x, y) / (float)(grid - 1) * 2.0f - 1.0f;
+            float h = 0.15f * glm::perlin(p * 3.0f) + 0.04f * glm::perlin(p * 11.0f);
+            positions.push_back(glm::vec3(p.x, h, p.y));
+        }
+    for (int y = 0; y + 1 < grid; y++)
+        for (int x = 0; x + 1 < grid; x++) {
+            unsigned i = y * grid + x;
+            unsigned quad[6] = { i, i + grid, i + 1, i + 1, i + grid, i + grid + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MeshBVH bvh(&positions[0], &indices[0], indices.size() / 3);
+    printf("%zu triangles, %zu nodes, built in %.1f ms\n",
+            bvh.triangleCount(), bvh.nodeCount(), benchSeconds(start) * 1e3);
+
+    // Camera rays in tiles of one packet, 4x4 pixels for 16 rays, so each
+    // packet covers a compact patch of the image
+    int tileW = MeshBVH::packetSize() >= 4 ? 4 : 1;
+    int tileH = MeshBVH::packetSize() / tileW;
+    glm::vec3 eye(0.0f, 0.8f, 1.6f);
+    glm::vec3 forward = glm::normalize(glm::vec3(0.0f, -0.1f, 0.0f) - eye);
+    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 up = glm::cross(right, forward);
+    std::vector<BVHRay> camera;
+    for (int ty = 0; ty < height; ty += tileH)
+        for (int tx = 0; tx < width; tx += tileW)
+            for (int y = ty; y < ty + tileH && y < height; y++)
+                for (int x = tx; x < tx + tileW && x < width; x++) {
+                    glm::vec2 ndc = (glm::vec2(x, y) + 0.5f) / glm::vec2(width, height) * 2.0f - 1.0f;
+                    BVHRay ray = { eye, 0.0f,
+                        glm::normalize(forward + right * ndc.x * 0.6f - up * ndc.y * 0.45f), 100.0f };
+                    camera.push_back(ray);
+                }
+    std::vector<BVHHit> cameraHits(camera.size());
+    bvh.intersect(&camera[0], &cameraHits[0], camera.size());
+
+    // Shadow rays from every camera hit toward a low light
+    glm::vec3 light(-3.0f, 1.0f, -2.0f);
+    std::vector<BVHRay> shadow;
+    for (size_t i = 0; i < camera.size(); i++) {
+        if (cameraHits[i].triangle == MESH_BVH_MISS)
+            continue;
+        glm::vec3 p = camera[i].origin + camera[i].direction * cameraHits[i].t;
+        BVHRay ray = { p, 1e-3f, light - p, 1.0f };
+        shadow.push_back(ray);
+    }
+
+    // Random rays from points above the terrain, no coherence at all
+    std::vector<BVHRay> random(width * height);
+    std::vector<glm::vec3> points(random.size()), directions(random.size());
+    glm::batch_rng rng(7);
+    glm::sphericalRandBatch(rng, &points[0], points.size(), 1.0f);
+    glm::sphericalRandBatch(rng, &directions[0], directions.size(), 1.0f);
+    for (size_t i = 0; i < random.size(); i++) {
+        BVHRay ray = { points[i] * glm::vec3(1.0f, 0.3f, 1.0f) + glm::vec3(0.0f, 0.3f, 0.0f),
+            0.0f, directions[i], 100.0f };
+        random[i] = ray;
+    }
+
+    bool ok = benchRays("camera", bvh, camera, positions, indices, false);
+    ok = benchRays("shadow", bvh, shadow, positions, indices, true) && ok;
+    ok = benchRays("random", bvh, random, positions, indices, false) && ok;
+    return ok ? 0 : 1;
+}
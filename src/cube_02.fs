@@ -5,25 +5,16 @@ in vec2 lightMapCoord;
 in mat4 fmodel;
 in vec3 fPos;
 
+#ifndef USE_TEXTURE
+#define USE_TEXTURE 0
+#endif
+
+#if USE_TEXTURE
 uniform sampler2D ourTexture;
-uniform vec3 lightPos;
+#endif
 uniform vec3 viewPos;
 
-struct Material {
-    //vec3 ambient;
-    sampler2D diffuse;
-    sampler2D specular;
-    float shininess;
-};
-uniform Material material;
-
-struct Light {
-    vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-uniform Light light;
+#include "lighting.glsl"
 
 out vec4 FragColor;
 
@@ -38,20 +29,34 @@ void main() {
     normalVec = vec3(fmodel * vec4(normalVec, 0.0));
 
     vec3 lightMapTex = vec3(texture(material.diffuse, lightMapCoord));
+#if USE_SPECULAR
     vec3 specuMapTex = vec3(texture(material.specular, lightMapCoord));
-
-    vec3 ambient = lightMapTex * light.ambient;
+#endif
 
     vec3 normVec = normalize(normalVec);
-    vec3 lightDir = normalize(light.position - fragPos);
-    float diff = max(0.0, dot(normVec, lightDir));
-    vec3 diffuse = diff * lightMapTex * light.diffuse;
-
     vec3 viewDir = normalize(viewPos - fragPos);
-    vec3 reflectDir = reflect(-lightDir, normVec);
-    float spec = pow(max(0.0, dot(viewDir, reflectDir)), material.shininess);
-    vec3 specular = spec * specuMapTex * light.specular;
+    vec3 result = vec3(0.0);
+
+    for (int i = 0; i < LIGHT_COUNT; i++) {
+        vec3 ambient = lightMapTex * light[i].ambient;
+
+        vec3 lightDir = normalize(light[i].position - fragPos);
+        float diff = max(0.0, dot(normVec, lightDir));
+        vec3 diffuse = diff * lightMapTex * light[i].diffuse;
+
+        result += ambient + diffuse;
+
+#if USE_SPECULAR
+        vec3 reflectDir = reflect(-lightDir, normVec);
+        float spec = pow(max(0.0, dot(viewDir, reflectDir)), material.shininess);
+        result += spec * specuMapTex * light[i].specular;
+#endif
+    }
 
+#if USE_TEXTURE
     vec3 objectColor = vec3(texture(ourTexture, texCoord));
-    FragColor = vec4((ambient + diffuse + specular) * objectColor, 1.0);
+    FragColor = vec4(result * objectColor, 1.0);
+#else
+    FragColor = vec4(result, 1.0);
+#endif
 }
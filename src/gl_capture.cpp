@@ -0,0 +1,229 @@
+#include "gl_capture.h"
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static bool glCaptureUnpackBufferBound();
+static bool glCapturePackBufferBound();
+static size_t glCaptureImageSize(GLsizei width, GLsizei height,
+        GLsizei depth, GLenum format, GLenum type);
+
+class GLCaptureWriter {
+
+public:
+    FILE *file;
+    unsigned long long written;
+
+    GLCaptureWriter() : file(NULL), written(0) {
+    }
+
+    void write(const void *data, size_t bytes) {
+        fwrite(data, 1, bytes, file);
+        written += bytes;
+    }
+
+    template <typename T> void put(T value) {
+        write(&value, sizeof(T));
+    }
+
+    void begin(unsigned short index) {
+        put(index);
+    }
+
+    void pad() {
+        static const char zeros[8] = { 0 };
+        if (written % 8)
+            write(zeros, 8 - written % 8);
+    }
+
+    void putPointer(const void *data, size_t bytes) {
+        if (!data) {
+            put((unsigned char)GL_CAPTURE_PTR_NULL);
+            return;
+        }
+        put((unsigned char)GL_CAPTURE_PTR_DATA);
+        put((unsigned long long)bytes);
+        pad();
+        write(data, bytes);
+    }
+
+    void putOffset(const void *pointer) {
+        put((unsigned char)GL_CAPTURE_PTR_OFFSET);
+        put((unsigned long long)(size_t)pointer);
+    }
+
+    void putImage(const void *pixels, size_t bytes) {
+        if (pixels && glCaptureUnpackBufferBound())
+            putOffset(pixels);
+        else
+            putPointer(pixels, bytes);
+    }
+
+    /* glReadPixels only needs its target when a pack buffer is bound */
+    void putPackOffset(const void *pixels) {
+        if (glCapturePackBufferBound())
+            putOffset(pixels);
+        else
+            put((unsigned char)GL_CAPTURE_PTR_NULL);
+    }
+
+    void putString(const char *text) {
+        putPointer(text, text ? strlen(text) + 1 : 0);
+    }
+
+    void putStrings(GLsizei count, const GLchar *const *strings,
+            const GLint *lengths) {
+        put((unsigned int)count);
+        for (GLsizei i = 0; i < count; i++) {
+            size_t len = (lengths && lengths[i] >= 0) ?
+                (size_t)lengths[i] : strlen(strings[i]);
+            putPointer(std::string(strings[i], len).c_str(), len + 1);
+        }
+    }
+};
+
+static GLCaptureWriter captureWriter;
+static bool captureUnsupportedWarned[1024];
+
+static GLCaptureWriter &glCaptureWriter() {
+    return captureWriter;
+}
+
+static void glCaptureUnsupported(int index);
+
+#include "gl_capture_gen.inc"
+
+static_assert(GL_CAPTURE_ENTRY_COUNT < GL_CAPTURE_FRAME_MARKER
+        && GL_CAPTURE_ENTRY_COUNT <= 1024, "entry index does not fit");
+
+static void glCaptureUnsupported(int index) {
+    if (captureUnsupportedWarned[index])
+        return;
+    captureUnsupportedWarned[index] = true;
+    std::cout << "GL_CAPTURE: " << glCaptureNames[index]
+        << " is not captured, replay may diverge" << std::endl;
+}
+
+static GLint glCaptureGetInteger(GLenum pname) {
+    GLint value = 0;
+    capreal_glGetIntegerv(pname, &value);
+    return value;
+}
+
+static bool glCaptureUnpackBufferBound() {
+    return glCaptureGetInteger(GL_PIXEL_UNPACK_BUFFER_BINDING) != 0;
+}
+
+static bool glCapturePackBufferBound() {
+    return glCaptureGetInteger(GL_PIXEL_PACK_BUFFER_BINDING) != 0;
+}
+
+static size_t glCapturePixelSize(GLenum format, GLenum type) {
+    switch (type) {
+    case GL_UNSIGNED_BYTE_3_3_2:
+    case GL_UNSIGNED_BYTE_2_3_3_REV:
+        return 1;
+    case GL_UNSIGNED_SHORT_5_6_5:
+    case GL_UNSIGNED_SHORT_5_6_5_REV:
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+    case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+    case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+        return 2;
+    case GL_UNSIGNED_INT_8_8_8_8:
+    case GL_UNSIGNED_INT_8_8_8_8_REV:
+    case GL_UNSIGNED_INT_10_10_10_2:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_24_8:
+    case GL_UNSIGNED_INT_10F_11F_11F_REV:
+    case GL_UNSIGNED_INT_5_9_9_9_REV:
+        return 4;
+    case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        return 8;
+    }
+
+    size_t components = 4;
+    switch (format) {
+    case GL_RED: case GL_RED_INTEGER:
+    case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+        components = 1; break;
+    case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL:
+        components = 2; break;
+    case GL_RGB: case GL_RGB_INTEGER: case GL_BGR: case GL_BGR_INTEGER:
+        components = 3; break;
+    }
+
+    switch (type) {
+    case GL_UNSIGNED_BYTE: case GL_BYTE:
+        return components;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+        return components * 2;
+    default:
+        return components * 4;
+    }
+}
+
+/* bytes the driver reads for an upload, honouring the unpack state */
+static size_t glCaptureImageSize(GLsizei width, GLsizei height,
+        GLsizei depth, GLenum format, GLenum type) {
+    if (width <= 0 || height <= 0 || depth <= 0)
+        return 0;
+
+    size_t pixel = glCapturePixelSize(format, type);
+    size_t alignment = glCaptureGetInteger(GL_UNPACK_ALIGNMENT);
+    GLint rowLength = glCaptureGetInteger(GL_UNPACK_ROW_LENGTH);
+    GLint imageHeight = glCaptureGetInteger(GL_UNPACK_IMAGE_HEIGHT);
+
+    size_t rowBytes = (rowLength > 0 ? rowLength : width) * pixel;
+    rowBytes = (rowBytes + alignment - 1) / alignment * alignment;
+    size_t imageBytes = rowBytes * (imageHeight > 0 ? imageHeight : height);
+
+    size_t skip = glCaptureGetInteger(GL_UNPACK_SKIP_IMAGES) * imageBytes
+        + glCaptureGetInteger(GL_UNPACK_SKIP_ROWS) * rowBytes
+        + glCaptureGetInteger(GL_UNPACK_SKIP_PIXELS) * pixel;
+
+    return skip + imageBytes * (depth - 1) + rowBytes * (height - 1)
+        + width * pixel;
+}
+
+bool GLCapture::begin(const char *path) {
+    if (captureWriter.file)
+        return false;
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        std::cout << "ERROR::GL_CAPTURE::OPEN_FAILED: " << path << std::endl;
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+
+    captureWriter.file = file;
+    captureWriter.written = 0;
+    captureWriter.write(GL_CAPTURE_MAGIC, 8);
+    captureWriter.put((unsigned int)GL_CAPTURE_ENTRY_COUNT);
+
+    glCaptureSwapIn();
+    return true;
+}
+
+void GLCapture::endFrame() {
+    if (captureWriter.file)
+        captureWriter.put((unsigned short)GL_CAPTURE_FRAME_MARKER);
+}
+
+void GLCapture::end() {
+    if (!captureWriter.file)
+        return;
+    glCaptureSwapOut();
+
+    captureWriter.put((unsigned short)GL_CAPTURE_END_MARKER);
+    fclose(captureWriter.file);
+    captureWriter.file = NULL;
+}
+
+bool GLCapture::isCapturing() {
+    return captureWriter.file != NULL;
+}
@@ -0,0 +1,317 @@
+/* Offline replayer for streams written by GLCapture (see gl_capture.h).
+ * Plays the recorded calls back as fast as possible on a hidden window,
+ * without any of the demo's application logic:
+ *
+ *   ./gl_replay capture.bin [--loops N] [--finish]
+ *
+ * Everything before the first frame marker is played once as setup, the
+ * frames are then replayed N times. --finish waits for the GPU after each
+ * frame so the timings include driver-side work. */
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "gl_capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+enum GLNameClass {
+    NAME_BUFFER, NAME_TEXTURE, NAME_ARRAY, NAME_FRAMEBUFFER,
+    NAME_RENDERBUFFER, NAME_SAMPLER, NAME_QUERY, NAME_PROGRAM,
+    NAME_CLASS_COUNT
+};
+
+class GLReplayReader {
+
+public:
+    const char *begin;
+    const char *cur;
+    const char *end;
+    bool failed;
+
+    GLReplayReader(const char *data, size_t size)
+        : begin(data), cur(data), end(data + size), failed(false) {
+    }
+
+    bool atEnd() const { return failed || cur >= end; }
+
+    template <typename T> T get() {
+        T value = T();
+        if (cur + sizeof(T) > end) {
+            failed = true; cur = end;
+            return value;
+        }
+        memcpy(&value, cur, sizeof(T));
+        cur += sizeof(T);
+        return value;
+    }
+
+    /* pointers to client data point straight into the loaded stream */
+    const void *pointer() {
+        unsigned char kind = get<unsigned char>();
+        if (kind == GL_CAPTURE_PTR_OFFSET)
+            return (const void *)(size_t)get<unsigned long long>();
+        if (kind != GL_CAPTURE_PTR_DATA)
+            return NULL;
+
+        unsigned long long bytes = get<unsigned long long>();
+        size_t offset = cur - begin;
+        cur += (8 - offset % 8) % 8;
+        if (cur > end || bytes > (unsigned long long)(end - cur)) {
+            failed = true; cur = end;
+            return NULL;
+        }
+        const void *data = cur;
+        cur += bytes;
+        return data;
+    }
+
+    const GLchar *string() {
+        return (const GLchar *)pointer();
+    }
+
+    const GLchar *const *strings() {
+        unsigned int count = get<unsigned int>();
+        stringTable.clear();
+        for (unsigned int i = 0; i < count && !failed; i++)
+            stringTable.push_back(string());
+        return stringTable.empty() ? NULL : &stringTable[0];
+    }
+
+private:
+    std::vector<const GLchar *> stringTable;
+};
+
+class GLReplayState {
+
+public:
+    GLuint currentProgram;
+
+    GLReplayState() : currentProgram(0) {
+    }
+
+    GLuint map(int cls, GLuint captured) {
+        std::map<GLuint, GLuint>::const_iterator it = names[cls].find(captured);
+        return it == names[cls].end() ? captured : it->second;
+    }
+
+    const GLuint *mapArray(int cls, GLReplayReader &in) {
+        unsigned char kind = in.cur < in.end ? (unsigned char)*in.cur : 0;
+        const GLuint *captured = (const GLuint *)in.pointer();
+        if (kind != GL_CAPTURE_PTR_DATA)
+            return captured;
+
+        size_t count = (in.cur - (const char *)captured) / sizeof(GLuint);
+        mapped.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            GLuint name;
+            memcpy(&name, captured + i, sizeof(GLuint));
+            mapped[i] = map(cls, name);
+        }
+        return mapped.empty() ? NULL : &mapped[0];
+    }
+
+    void registerName(int cls, GLuint captured, GLuint actual) {
+        names[cls][captured] = actual;
+    }
+
+    void registerNames(int cls, GLsizei n, const GLuint *actual,
+            GLReplayReader &in) {
+        const GLuint *captured = (const GLuint *)in.pointer();
+        for (GLsizei i = 0; captured && i < n; i++) {
+            GLuint name;
+            memcpy(&name, captured + i, sizeof(GLuint));
+            registerName(cls, name, actual[i]);
+        }
+    }
+
+    GLint location(GLuint capturedProgram, GLint captured) {
+        if (captured < 0)
+            return captured;
+        std::map<unsigned long long, GLint>::const_iterator it =
+            locations.find(locationKey(capturedProgram, captured));
+        return it == locations.end() ? captured : it->second;
+    }
+
+    void registerLocation(GLuint capturedProgram, GLint captured,
+            GLint actual) {
+        if (captured >= 0)
+            locations[locationKey(capturedProgram, captured)] = actual;
+    }
+
+    /* output buffers for getters; one per argument slot so they never alias */
+    void *scratch(int slot, size_t bytes) {
+        std::vector<char> &buffer = scratchBuffers[slot % 16];
+        if (buffer.size() < bytes)
+            buffer.resize(bytes);
+        return buffer.empty() ? NULL : &buffer[0];
+    }
+
+private:
+    std::map<GLuint, GLuint> names[NAME_CLASS_COUNT];
+    std::map<unsigned long long, GLint> locations;
+    std::vector<GLuint> mapped;
+    std::vector<char> scratchBuffers[16];
+
+    static unsigned long long locationKey(GLuint program, GLint location) {
+        return ((unsigned long long)program << 32) | (unsigned int)location;
+    }
+};
+
+#include "gl_replay_gen.inc"
+
+struct ReplayStats {
+    unsigned long long calls;
+    std::vector<double> frameMs;
+};
+
+/* Replays records until a frame marker (true) or the end of stream (false) */
+static bool replayUntilFrame(GLReplayReader &in, GLReplayState &state,
+        ReplayStats &stats) {
+    while (!in.atEnd()) {
+        unsigned short index = in.get<unsigned short>();
+        if (index == GL_CAPTURE_FRAME_MARKER)
+            return true;
+        if (index == GL_CAPTURE_END_MARKER)
+            return false;
+        if (!glReplayDispatch(index, in, state)) {
+            std::cout << "ERROR::GL_REPLAY::BAD_RECORD: entry " << index
+                << " at offset " << (in.cur - in.begin) << std::endl;
+            in.failed = true;
+            return false;
+        }
+        stats.calls++;
+    }
+    return false;
+}
+
+static bool loadStream(const char *path, std::vector<char> &data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    data.assign(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    int loops = 1;
+    bool finish = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc)
+            loops = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--finish") == 0)
+            finish = true;
+        else
+            path = argv[i];
+    }
+    if (!path) {
+        std::cout << "usage: " << argv[0]
+            << " capture.bin [--loops N] [--finish]" << std::endl;
+        return 1;
+    }
+
+    std::vector<char> stream;
+    if (!loadStream(path, stream) || stream.size() < 12
+            || memcmp(&stream[0], GL_CAPTURE_MAGIC, 8) != 0) {
+        std::cout << "ERROR::GL_REPLAY::BAD_STREAM: " << path << std::endl;
+        return 1;
+    }
+    GLReplayReader in(&stream[0], stream.size());
+    in.cur += 8;
+    if (in.get<unsigned int>() != GL_REPLAY_ENTRY_COUNT) {
+        std::cout << "ERROR::GL_REPLAY::ENTRY_COUNT_MISMATCH: "
+            << "stream was captured with a different glad.h" << std::endl;
+        return 1;
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, 0);
+
+    GLFWwindow *window = glfwCreateWindow(800, 600, "gl-replay", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate(); return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate(); return 1;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    GLReplayState state;
+    ReplayStats stats;
+    stats.calls = 0;
+
+    Clock::time_point start = Clock::now();
+    bool hasFrames = replayUntilFrame(in, state, stats);
+    double setupMs = std::chrono::duration<double, std::milli>(
+            Clock::now() - start).count();
+
+    const char *framesBegin = in.cur;
+    unsigned long long setupCalls = stats.calls;
+
+    start = Clock::now();
+    for (int loop = 0; hasFrames && loop < loops; loop++) {
+        in.cur = framesBegin;
+        bool more = true;
+        while (more) {
+            Clock::time_point frameStart = Clock::now();
+            more = replayUntilFrame(in, state, stats);
+            if (!more)  // end of stream, not a complete frame
+                break;
+            if (finish)
+                glFinish();
+            glfwSwapBuffers(window);
+            stats.frameMs.push_back(std::chrono::duration<double, std::milli>(
+                        Clock::now() - frameStart).count());
+        }
+        if (in.failed)
+            break;
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(
+            Clock::now() - start).count();
+
+    glfwTerminate();
+
+    if (in.failed) {
+        std::cout << "ERROR::GL_REPLAY::TRUNCATED_STREAM" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> &ms = stats.frameMs;
+    std::sort(ms.begin(), ms.end());
+    double frameCalls = ms.empty() ? 0.0 :
+        double(stats.calls - setupCalls) / ms.size();
+
+    printf("setup_ms=%.3f setup_calls=%llu\n", setupMs, setupCalls);
+    printf("frames=%zu total_ms=%.3f calls_per_frame=%.1f\n",
+            ms.size(), totalMs, frameCalls);
+    if (!ms.empty()) {
+        double sum = 0.0;
+        for (size_t i = 0; i < ms.size(); i++)
+            sum += ms[i];
+        printf("frame_ms_avg=%.4f frame_ms_min=%.4f frame_ms_median=%.4f "
+                "frame_ms_max=%.4f\n", sum / ms.size(), ms.front(),
+                ms[ms.size() / 2], ms.back());
+        printf("calls_per_sec=%.0f\n",
+                (stats.calls - setupCalls) / (totalMs / 1000.0));
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "gl_trace.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+typedef std::chrono::steady_clock TraceClock;
+
+static bool traceEnabled = false;
+static bool traceLogArgs = false;
+
+static const int MAX_TRACE_ENTRIES = 1024;
+
+static unsigned long long callCounts[MAX_TRACE_ENTRIES];
+static TraceClock::duration callTimes[MAX_TRACE_ENTRIES];
+static std::vector<GLCallStats> lastFrame;
+
+struct GLTraceScope {
+    int index;
+    bool logging;
+    TraceClock::time_point start;
+
+    GLTraceScope(int index)
+        : index(index), logging(traceLogArgs), start(TraceClock::now()) {
+    }
+
+    ~GLTraceScope() {
+        callCounts[index]++;
+        callTimes[index] += TraceClock::now() - start;
+    }
+};
+
+static void glTraceLogArgs(int index, const char *format, ...);
+
+#include "gl_trace_gen.inc"
+
+static_assert(GL_TRACE_ENTRY_COUNT <= MAX_TRACE_ENTRIES,
+        "regenerate with a larger MAX_TRACE_ENTRIES");
+
+static void glTraceLogArgs(int index, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    fputs(glTraceNames[index], stderr);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void GLTracer::enable(bool logArgs) {
+    traceLogArgs = logArgs;
+    if (traceEnabled)
+        return;
+    std::fill(callCounts, callCounts + GL_TRACE_ENTRY_COUNT, 0);
+    std::fill(callTimes, callTimes + GL_TRACE_ENTRY_COUNT,
+            TraceClock::duration::zero());
+    glTraceSwapIn();
+    traceEnabled = true;
+}
+
+void GLTracer::disable() {
+    if (!traceEnabled)
+        return;
+    glTraceSwapOut();
+    traceEnabled = false;
+}
+
+bool GLTracer::isEnabled() {
+    return traceEnabled;
+}
+
+static bool slowerThan(const GLCallStats &a, const GLCallStats &b) {
+    return a.seconds > b.seconds;
+}
+
+void GLTracer::endFrame() {
+    lastFrame.clear();
+    for (int i = 0; i < GL_TRACE_ENTRY_COUNT; i++) {
+        if (callCounts[i] == 0)
+            continue;
+        GLCallStats stats;
+        stats.name = glTraceNames[i];
+        stats.calls = callCounts[i];
+        stats.seconds = std::chrono::duration<double>(callTimes[i]).count();
+        lastFrame.push_back(stats);
+
+        callCounts[i] = 0;
+        callTimes[i] = TraceClock::duration::zero();
+    }
+    std::sort(lastFrame.begin(), lastFrame.end(), slowerThan);
+}
+
+const std::vector<GLCallStats> &GLTracer::frameHistogram() {
+    return lastFrame;
+}
+
+void GLTracer::printFrameHistogram(std::ostream &out, int topN) {
+    unsigned long long totalCalls = 0;
+    double totalSeconds = 0.0;
+    for (size_t i = 0; i < lastFrame.size(); i++) {
+        totalCalls += lastFrame[i].calls;
+        totalSeconds += lastFrame[i].seconds;
+    }
+    out << "GL calls: " << totalCalls << ", "
+        << totalSeconds * 1e3 << " ms" << std::endl;
+
+    for (size_t i = 0; i < lastFrame.size() && (int)i < topN; i++) {
+        char line[128];
+        snprintf(line, sizeof(line), "  %-28s %8llu %10.3f us",
+                lastFrame[i].name, lastFrame[i].calls,
+                lastFrame[i].seconds * 1e6);
+        out << line << std::endl;
+    }
+}
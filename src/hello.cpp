@@ -1,14 +1,25 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
 
 #include "shader.h"
+#include "gl_trace.h"
+#include "gl_capture.h"
+#include "null_gl.h"
 #include "stb_image.h"
 #include "cube_data.h"
+#include "particles.h"
+#include "particle_renderer.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "glm/gtc/type_aligned.hpp"
+#include "glm/gtx/random_batch.hpp"
 
 float win_width = 800.0f;
 float win_height = 600.0f;
@@ -17,6 +28,14 @@ glm::vec3 cubePos(-0.8f, 0.0f, -3.0f);
 glm::vec3 lightPos(1.5f, 0.8f, -2.5f);
 glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
 
+/* animation clock: glfwGetTime() normally, a fixed step on the null backend */
+double frameTime = 0.0;
+
+/* fountain above the cube, only with PARTICLES=n */
+ParticleSystem *particles = NULL;
+ParticleRenderer *particleRenderer = NULL;
+Shader *particleShader = NULL;
+
 void window_size_changed_cb(GLFWwindow *win, int width, int height) {
     std::cout << "GLFW window size changed: "<< width
         << "x" << height << std::endl;
@@ -86,6 +105,16 @@ void configLightVAO(unsigned int *ptrVAO) {
     glBindVertexArray(0);
 }
 
+/* Runs the tasks of stb_image's parallel JPEG and PNG decoders on a ThreadPool */
+static void stbiParallelFor(void *user, int count,
+        void (*task)(void *data, int index), void *data) {
+    ThreadPool *pool = (ThreadPool *)user;
+    pool->parallelFor((size_t)count, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            task(data, (int)i);
+    });
+}
+
 void generateTexture(int texUnitID, const char *resPath) {
     unsigned int textureID;
     glGenTextures(1, &textureID);
@@ -98,21 +127,54 @@ void generateTexture(int texUnitID, const char *resPath) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+    /* The image decodes straight into a mapped pixel unpack buffer, rows
+     * padded to GL_UNPACK_ALIGNMENT. A capture can't see writes through a
+     * mapping, so while capturing it decodes into client memory instead. */
     int width, height, nchannels;
-
-    unsigned char *data =
-        stbi_load(resPath, &width, &height, &nchannels, 0);
-    if (!data) {
+    unsigned char *pixels = NULL;
+    std::vector<unsigned char> client;
+    unsigned int pbo = 0;
+    bool loaded = stbi_info(resPath, &width, &height, &nchannels) != 0;
+    int channels = nchannels == 2 || nchannels == 4 ? 4 : 3;
+    int stride = (width * channels + 3) & ~3;
+    if (loaded && GLCapture::isCapturing()) {
+        client.resize((size_t)stride * height);
+        pixels = &client[0];
+    } else if (loaded) {
+        GLsizeiptr size = (GLsizeiptr)stride * height;
+        glGenBuffers(1, &pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        pixels = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+    loaded = pixels && stbi_load_into(resPath, pixels, width, height, stride,
+            NULL, channels, 0);
+    if (pbo && pixels)
+        loaded = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) && loaded;
+    if (!loaded) {
         std::cout << "Failed to load texture: " << resPath << std::endl;
         glfwTerminate(); exit(-1);
     }
 
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0,
-            nchannels == 4 ? GL_RGBA : GL_RGB,
-            GL_UNSIGNED_BYTE, data);
+            channels == 4 ? GL_RGBA : GL_RGB,
+            GL_UNSIGNED_BYTE, pbo ? NULL : pixels);
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    stbi_image_free(data);
+    if (pbo) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &pbo);
+    }
+}
+
+/* Axis with components in {-1, -0.5, 0, 0.5, 1} seeded by the clock, each
+ * object draws from its own stream */
+glm::vec3 randomRotationAxis(glm::uint64 stream) {
+    glm::batch_rng rng((glm::uint64)(1000 * frameTime), stream);
+    float steps[3];
+    glm::linearRandBatch(rng, steps, 3, 0.0f, 5.0f);
+    return (glm::floor(glm::vec3(steps[0], steps[1], steps[2])) - 2.0f) / 2.0f;
 }
 
 void configCubeModelMatrix(Shader &shader) {
@@ -120,21 +182,23 @@ void configCubeModelMatrix(Shader &shader) {
     static bool rot_axis_set = false;
 
     if (!rot_axis_set) { // init only once
-        srand(1000 * glfwGetTime());
-        float vecx = (rand()%5 - 2) / 2.0f;
-        float vecy = (rand()%5 - 2) / 2.0f;
-        float vecz = (rand()%5 - 2) / 2.0f;
+        glm::vec3 axis = randomRotationAxis(0);
+        float vecx = axis.x;
+        float vecy = axis.y;
+        float vecz = axis.z;
         std::cout << "rotating axis: " << vecx<< ", "
             << vecy << ", " << vecz << std::endl;
         rot_axis = glm::vec3(vecx, vecy, vecz);
         rot_axis_set = (vecx != 0 || vecy != 0 || vecz != 0);
     }
-    float rot_degrees = glfwGetTime() * 60.0f;
-
-    glm::mat4 model(1.0f);
-    model = glm::translate(model, cubePos);
-    model = glm::rotate(model, glm::radians(rot_degrees), rot_axis);
-    shader.setMat4("model", model);
+    float rot_degrees = frameTime * 60.0f;
+
+    // aligned types take the SSE paths of translate/rotate
+    glm::tmat4x4<float, glm::aligned_highp> model(1.0f);
+    model = glm::translate(model, glm::aligned_vec3(cubePos));
+    model = glm::rotate(model, glm::radians(rot_degrees),
+            glm::aligned_vec3(rot_axis));
+    shader.setMat4("model", glm::mat4(model));
 }
 
 void configLightModelMatrix(Shader &shader) {
@@ -142,16 +206,16 @@ void configLightModelMatrix(Shader &shader) {
     static bool rot_axis_set = false;
 
     if (!rot_axis_set) { // init only once
-        srand(1000 * glfwGetTime());
-        float vecx = (rand()%5 - 2) / 2.0f;
-        float vecy = (rand()%5 - 2) / 2.0f;
-        float vecz = (rand()%5 - 2) / 2.0f;
+        glm::vec3 axis = randomRotationAxis(1);
+        float vecx = axis.x;
+        float vecy = axis.y;
+        float vecz = axis.z;
         std::cout << "rotating axis: " << vecx<< ", "
             << vecy << ", " << vecz << std::endl;
         rot_axis = glm::vec3(vecx, vecy, vecz);
         rot_axis_set = (vecx != 0 || vecy != 0 || vecz != 0);
     }
-    float rot_degrees = glfwGetTime() * 150.0f;
+    float rot_degrees = frameTime * 150.0f;
 
     glm::mat4 model(1.0f);
     model = glm::translate(model, lightPos);
@@ -184,10 +248,10 @@ void drawCubeObject(unsigned int cubeVAO, Shader &shader) {
     shader.setInt("material.diffuse", 1);
     shader.setInt("material.specular", 2);
     //shader.setVec3("lightColor", lightColor);
-    shader.setVec3("light.position", lightPos);
-    shader.setVec3("light.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    shader.setVec3("light.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader.setVec3("light.specular", glm::vec3(1.0f, 1.0f, 1.0f));
+    shader.setVec3("light[0].position", lightPos);
+    shader.setVec3("light[0].ambient", glm::vec3(0.2f, 0.2f, 0.2f));
+    shader.setVec3("light[0].diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
+    shader.setVec3("light[0].specular", glm::vec3(1.0f, 1.0f, 1.0f));
 
     //shader.setVec3("material.ambient", glm::vec3(1.0f, 0.5f, 0.31f));
     //shader.setVec3("material.diffuse", glm::vec3(1.0f, 0.5f, 0.31f));
@@ -217,15 +281,109 @@ void drawLightObject(unsigned int lightVAO, Shader &shader) {
     glBindVertexArray(0);
 }
 
-int main() {
-    GLFWwindow *window = configGlfwWindow();
+void drawParticles() {
+    static double lastTime = frameTime;
+    float dt = glm::clamp((float)(frameTime - lastTime), 0.0f, 0.1f);
+    lastTime = frameTime;
+
+    ParticleEmitter emitter;
+    emitter.position = cubePos + glm::vec3(0.0f, 0.6f, 0.0f);
+    emitter.radius = 0.05f;
+    emitter.velocity = glm::vec3(0.0f, 2.5f, 0.0f);
+    emitter.speedSpread = 0.8f;
+    emitter.lifetime = 1.5f;
+    emitter.lifetimeSpread = 0.5f;
+    emitter.size = 0.02f;
+    emitter.color = glm::vec4(1.0f, 0.6f, 0.2f, 0.8f);
+
+    /* births balance deaths at about the capacity */
+    particles->update(dt, ParticleForces());
+    particles->emit(emitter,
+            (size_t)(particles->capacity() * dt / emitter.lifetime));
+
+    ParticleInstances instances = particleRenderer->beginFrame();
+    size_t count = particles->writeInstances(instances);
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 1.0f),
+            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f),
+            win_width / win_height, 0.1f, 100.0f);
+    particleRenderer->draw(count, *particleShader, view, proj);
+}
+
+void drawFrame(unsigned int cubeVAO, Shader &cubeShader,
+        unsigned int lightVAO, Shader &lightShader) {
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    drawCubeObject(cubeVAO, cubeShader);
+    drawLightObject(lightVAO, lightShader);
+    if (particles)
+        drawParticles();
+}
+
+/* Windowless loop on the null GL backend: measures the CPU side only */
+void runNullLoop(int frames, unsigned int cubeVAO, Shader &cubeShader,
+        unsigned int lightVAO, Shader &lightShader) {
+    NullGL::resetStats();
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    for (int i = 0; i < frames; i++) {
+        frameTime = i / 60.0;
+        drawFrame(cubeVAO, cubeShader, lightVAO, lightShader);
+        if (GLTracer::isEnabled()) {
+            GLTracer::endFrame();
+            if ((i + 1) % 300 == 0)
+                GLTracer::printFrameHistogram(std::cout);
+        }
+        GLCapture::endFrame();
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    const NullGLStats &stats = NullGL::stats();
+    std::cout << "null-gl: " << frames << " frames, " << ms << " ms, "
+        << ms * 1000.0 / frames << " us/frame" << std::endl
+        << "  calls: " << stats.calls << ", draws: " << stats.drawCalls
+        << ", vertices: " << stats.vertices
+        << ", uniforms: " << stats.uniformUpdates
+        << ", state changes: " << stats.stateChanges
+        << ", errors: " << stats.errors << std::endl;
+    // Short runs still get the histogram of their last frame
+    if (GLTracer::isEnabled() && frames % 300 != 0)
+        GLTracer::printFrameHistogram(std::cout);
+}
+
+int main(int argc, char **argv) {
+    /* --null-gl [frames]: no window and no GPU, see runNullLoop() */
+    int nullFrames = 0;
+    if (argc > 1 && strcmp(argv[1], "--null-gl") == 0)
+        nullFrames = argc > 2 ? atoi(argv[2]) : 10000;
+
+    GLFWwindow *window = NULL;
+    GLADloadproc loader = (GLADloadproc) NullGL::getProcAddress;
+    if (nullFrames <= 0) {
+        window = configGlfwWindow();
+        loader = (GLADloadproc) glfwGetProcAddress;
+    }
 
     /* Loading OpenGL functions */
-    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+    if (!gladLoadGLLoader(loader)) {
         std::cout << "Failed to initialize GLAD" << std::endl;
         glfwTerminate(); exit(-1);
     }
 
+    /* GL_TRACE=1 counts/times every GL call, GL_TRACE=args also logs them */
+    const char *traceEnv = getenv("GL_TRACE");
+    if (traceEnv && *traceEnv && strcmp(traceEnv, "0") != 0)
+        GLTracer::enable(strcmp(traceEnv, "args") == 0);
+
+    /* GL_CAPTURE=file records every GL call for gl_replay */
+    const char *captureEnv = getenv("GL_CAPTURE");
+    if (captureEnv && *captureEnv)
+        GLCapture::begin(captureEnv);
+
     glEnable(GL_DEPTH_TEST);
 
     glViewport(0, 0, win_width, win_height);
@@ -235,27 +393,72 @@ int main() {
     configCubeVAO(&cubeVAO);
     configLightVAO(&lightVAO);
 
-    Shader cubeShader("src/cube_02.vs", "src/cube_02.fs");
-    Shader lightShader("src/light_01.vs", "src/light_01.fs");
+    /* features are compiled in/out per variant, no dynamic branches */
+    ShaderDefines cubeFeatures;
+    cubeFeatures["USE_TEXTURE"] = "1";
+    cubeFeatures["USE_SPECULAR"] = "1";
+    cubeFeatures["LIGHT_COUNT"] = "1";
+
+    ShaderVariantCache shaderCache;
+    Shader &cubeShader =
+        shaderCache.get("src/cube_02.vs", "src/cube_02.fs", cubeFeatures);
+    Shader &lightShader =
+        shaderCache.get("src/light_01.vs", "src/light_01.fs", ShaderDefines());
+
+    /* JPEG textures decode on every core, PNGs inflate and unfilter on two */
+    ThreadPool &pool = ThreadPool::shared();
+    stbi_set_jpeg_parallel(stbiParallelFor, &pool, (int)pool.size());
+    stbi_set_png_parallel(stbiParallelFor, &pool, (int)pool.size());
 
     generateTexture(0, "res/moting.jpg");
     generateTexture(1, "res/container2.png");
     generateTexture(2, "res/container2_specular.png");
 
+    /* PARTICLES=n simulates n particles on the thread pool */
+    const char *particlesEnv = getenv("PARTICLES");
+    if (particlesEnv && atoi(particlesEnv) > 0) {
+        particles = new ParticleSystem(atoi(particlesEnv));
+        particleRenderer = new ParticleRenderer(particles->capacity(), loader);
+        particleShader = &shaderCache.get("src/particle.vs", "src/particle.fs",
+                ShaderDefines());
+        std::cout << "particles: " << particles->capacity() << ", "
+            << (particleRenderer->isPersistent() ? "persistent" : "mapped")
+            << " instance buffer" << std::endl;
+    }
+
+    GLCapture::endFrame();  // everything recorded so far is setup
+
+    if (!window) {
+        runNullLoop(nullFrames, cubeVAO, cubeShader, lightVAO, lightShader);
+        GLCapture::end();
+        delete particleRenderer;
+        delete particles;
+        return 0;
+    }
+
     while (!glfwWindowShouldClose(window)) {
 
         processKeyInput(window);
 
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        drawCubeObject(cubeVAO, cubeShader);
-        drawLightObject(lightVAO, lightShader);
+        frameTime = glfwGetTime();
+        drawFrame(cubeVAO, cubeShader, lightVAO, lightShader);
 
         glfwSwapBuffers(window);
         glfwPollEvents();
+
+        if (GLTracer::isEnabled()) {
+            static int frames = 0;
+            GLTracer::endFrame();
+            if (++frames % 300 == 0)
+                GLTracer::printFrameHistogram(std::cout);
+        }
+        GLCapture::endFrame();
     }
 
+    GLCapture::end();
+
+    delete particleRenderer;
+    delete particles;
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,252 @@
+#include "stb_image.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* Decodes images with stb_image on the calling thread and with the parallel
+ * JPEG and pipelined PNG decoders on the shared pool, checks that both give
+ * the same pixels for every requested component count, from memory and
+ * from the file, and reports the best decode time of each.
+ * stbi_load_from_memory_into must give the same rows too, flipped into a
+ * padded buffer, and is timed against stbi_load followed by the flip and
+ * copy it replaces. The hash of the decoded pixels lets builds be compared:
+ * run_image_bench.sh builds once with -DSTBI_NO_AVX2 (SSE2 kernels) and
+ * once with the AVX2 kernels, both must print the same hashes. PNGs are
+ * also timed with the zlib Adler-32 checked. Corrupt copies of each JPEG
+ * must load, or fail, the same serially and on pools of 2 and 4 threads.
+ *
+ *   image_bench [image...]      the .jpg and .png files in res/ by default
+ */
+
+static const int BENCH_RUNS = 5;
+static const int BENCH_CORRUPT_COPIES = 64;
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void benchParallelFor(void *user, int count,
+        void (*task)(void *data, int index), void *data) {
+    ((ThreadPool *)user)->parallelFor((size_t)count, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            task(data, (int)i);
+    });
+}
+
+/* Parallel decoding on pool, or on the calling thread with NULL */
+static void benchParallel(ThreadPool *pool) {
+    stbi_set_jpeg_parallel(pool ? benchParallelFor : NULL, pool, pool ? (int)pool->size() : 1);
+    stbi_set_png_parallel(pool ? benchParallelFor : NULL, pool, pool ? (int)pool->size() : 1);
+}
+
+static bool benchRead(const char *path, std::vector<stbi_uc> &bytes) {
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    fseek(f, 0, SEEK_END);
+    bytes.resize((size_t)ftell(f));
+    fseek(f, 0, SEEK_SET);
+    bool ok = fread(&bytes[0], 1, bytes.size(), f) == bytes.size();
+    fclose(f);
+    return ok;
+}
+
+/* FNV-1a, continuing from hash */
+static unsigned benchHash(unsigned hash, const stbi_uc *bytes, size_t size) {
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+/* Best time of stbi_load_from_memory with the current settings */
+static double benchDecode(const std::vector<stbi_uc> &bytes) {
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        int x, y, n;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        stbi_uc *pixels = stbi_load_from_memory(&bytes[0], (int)bytes.size(), &x, &y, &n, 0);
+        best = std::min(best, benchSeconds(start));
+        stbi_image_free(pixels);
+    }
+    return best;
+}
+
+/* Best time of getting RGBA rows pitch bytes apart, bottom row first, into
+ * out: decoded in place, or stbi_load then flipped and copied */
+static double benchDecodeInto(const std::vector<stbi_uc> &bytes, int x, int y,
+        size_t pitch, std::vector<stbi_uc> &out, bool into) {
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        int px, py, pn;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (into) {
+            stbi_load_from_memory_into(&bytes[0], (int)bytes.size(), &out[0], x, y,
+                    (int)pitch, &pn, 4, 1);
+        } else {
+            stbi_uc *pixels = stbi_load_from_memory(&bytes[0], (int)bytes.size(), &px, &py, &pn, 4);
+            for (int j = 0; pixels && j < y; j++)
+                memcpy(&out[(size_t)(y - 1 - j) * pitch], pixels + (size_t)j * x * 4, (size_t)x * 4);
+            stbi_image_free(pixels);
+        }
+        best = std::min(best, benchSeconds(start));
+    }
+    return best;
+}
+
+/* Decodes bytes with the current settings into pixels, false if it fails */
+static bool benchLoad(const std::vector<stbi_uc> &bytes, std::vector<stbi_uc> &pixels) {
+    int x, y, n;
+    stbi_uc *data = stbi_load_from_memory(&bytes[0], (int)bytes.size(), &x, &y, &n, 0);
+    if (!data)
+        return false;
+    pixels.assign(data, data + (size_t)x * y * n);
+    stbi_image_free(data);
+    return true;
+}
+
+/* Corrupts copies of a JPEG after its first scan header, flipping bits or
+ * writing spans of random bytes, and decodes each serially and on pools.
+ * Whether a copy loads, and its pixels when it does, must not depend on the
+ * threads. Returns the copies that load, -1 if any decode differs. */
+static int benchCorrupt(const char *path, const std::vector<stbi_uc> &bytes,
+        ThreadPool *const *pools, int poolCount) {
+    static const unsigned char sos[2] = { 0xff, 0xda };
+    size_t scan = std::search(bytes.begin(), bytes.end(), sos, sos + 2) - bytes.begin();
+    if (scan + 4 >= bytes.size())
+        return 0;
+    scan += 2 + (bytes[scan + 2] << 8 | bytes[scan + 3]);
+    if (scan >= bytes.size())
+        return 0;
+    int loaded = 0;
+    srand(1);
+    for (int copy = 0; copy < BENCH_CORRUPT_COPIES; copy++) {
+        std::vector<stbi_uc> corrupt(bytes);
+        size_t at = scan + (size_t)rand() % (corrupt.size() - scan);
+        if (copy % 2 == 0) {
+            for (int flip = 0; flip <= copy % 8; flip++) {
+                size_t bit = (size_t)rand() % ((corrupt.size() - scan) * 8);
+                corrupt[scan + bit / 8] ^= (stbi_uc)(1 << bit % 8);
+            }
+        } else {
+            for (size_t span = 1 + (size_t)rand() % 64; span && at < corrupt.size(); span--)
+                corrupt[at++] = (stbi_uc)rand();
+        }
+
+        std::vector<stbi_uc> serial, parallel;
+        benchParallel(NULL);
+        bool loads = benchLoad(corrupt, serial);
+        for (int p = 0; p < poolCount; p++) {
+            benchParallel(pools[p]);
+            bool same = benchLoad(corrupt, parallel) == loads && (!loads || parallel == serial);
+            if (!same) {
+                printf("FAIL: %s: corrupt copy %d %s serially, differs on %u threads\n",
+                        path, copy, loads ? "loads" : "fails", pools[p]->size());
+                return -1;
+            }
+        }
+        loaded += loads;
+    }
+    return loaded;
+}
+
+int main(int argc, char *argv[]) {
+    static const char *defaults[] = {
+        "res/fangmao.jpg", "res/moting.jpg", "res/pokemon.jpg", "res/wall.jpg",
+        "res/container2.png", "res/container2_specular.png", "res/melabear.png"
+    };
+    std::vector<const char *> paths(defaults, defaults + 7);
+    if (argc > 1)
+        paths.assign(argv + 1, argv + argc);
+    ThreadPool &pool = ThreadPool::shared();
+    ThreadPool two(2), four(4);
+    ThreadPool *corruptPools[2] = { &two, &four };
+    bool ok = true;
+#ifdef STBI_NO_AVX2
+    printf("kernels: sse2\n");
+#else
+    printf("kernels: avx2 where the cpu has it\n");
+#endif
+
+    for (size_t p = 0; p < paths.size(); p++) {
+        std::vector<stbi_uc> bytes;
+        if (!benchRead(paths[p], bytes)) {
+            printf("%s: cannot read\n", paths[p]);
+            ok = false;
+            continue;
+        }
+
+        // Serial reference for every req_comp, then the same from the pool
+        bool same = true;
+        int x = 0, y = 0, n = 0;
+        unsigned hash = 2166136261u;
+        for (int req = 0; req <= 4; req++) {
+            benchParallel(NULL);
+            stbi_uc *serial = stbi_load_from_memory(&bytes[0], (int)bytes.size(), &x, &y, &n, req);
+            if (!serial) {
+                printf("%s: %s\n", paths[p], stbi_failure_reason());
+                same = false;
+                break;
+            }
+            size_t size = (size_t)x * y * (req ? req : n);
+            hash = benchHash(hash, serial, size);
+            benchParallel(&pool);
+            for (int file = 0; file < 2; file++) {
+                int px, py, pn;
+                stbi_uc *parallel = file ? stbi_load(paths[p], &px, &py, &pn, req)
+                        : stbi_load_from_memory(&bytes[0], (int)bytes.size(), &px, &py, &pn, req);
+                same = same && parallel && px == x && py == y && pn == n
+                        && memcmp(parallel, serial, size) == 0;
+                stbi_image_free(parallel);
+            }
+            if (req) {
+                // Into rows padded past the alignment, bottom row first
+                size_t pitch = (size_t)x * req + 7;
+                std::vector<stbi_uc> into(pitch * y);
+                int in;
+                same = same && stbi_load_from_memory_into(&bytes[0], (int)bytes.size(),
+                        &into[0], x, y, (int)pitch, &in, req, 1) && in == n;
+                for (int j = 0; same && j < y; j++)
+                    same = memcmp(&into[(size_t)(y - 1 - j) * pitch],
+                            serial + (size_t)j * x * req, (size_t)x * req) == 0;
+            }
+            stbi_image_free(serial);
+        }
+        ok = ok && same;
+        if (!same) {
+            printf("%s: parallel decode DIFFERS\n", paths[p]);
+            continue;
+        }
+
+        benchParallel(NULL);
+        double serialTime = benchDecode(bytes);
+        benchParallel(&pool);
+        double parallelTime = benchDecode(bytes);
+        printf("%s %dx%dx%d: serial %.2f ms, %2u thread(s) %.2f ms, same pixels, hash %08x\n",
+                paths[p], x, y, n, serialTime * 1e3, pool.size(), parallelTime * 1e3, hash);
+        size_t pitch = ((size_t)x * 4 + 255) & ~(size_t)255;
+        std::vector<stbi_uc> rows(pitch * y);
+        double copyTime = benchDecodeInto(bytes, x, y, pitch, rows, false);
+        double intoTime = benchDecodeInto(bytes, x, y, pitch, rows, true);
+        printf("%s: flipped RGBA rows, load + copy %.2f ms, into %.2f ms\n",
+                paths[p], copyTime * 1e3, intoTime * 1e3);
+        if (bytes.size() > 8 && memcmp(&bytes[0], "\x89PNG", 4) == 0) {
+            stbi_set_zlib_verify_adler32(1);
+            double checkedTime = benchDecode(bytes);
+            stbi_set_zlib_verify_adler32(0);
+            printf("%s: %.2f ms with the Adler-32 checked\n", paths[p], checkedTime * 1e3);
+        }
+        if (bytes.size() > 2 && bytes[0] == 0xff && bytes[1] == 0xd8) {
+            int loaded = benchCorrupt(paths[p], bytes, corruptPools, 2);
+            ok = ok && loaded >= 0;
+            if (loaded >= 0)
+                printf("%s: corrupt copies decode the same on 1, 2 and 4 threads, %d of %d load\n",
+                        paths[p], loaded, BENCH_CORRUPT_COPIES);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -1,11 +1,9 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
+#include "transform.glsl"
 
 void main() {
     //gl_Position = vec4(aPos, 1.0);
-    gl_Position = proj * view * model * vec4(aPos, 1.0);
+    gl_Position = toClipSpace(aPos);
 }
@@ -0,0 +1,30 @@
+#ifndef LIGHTING_GLSL
+#define LIGHTING_GLSL
+
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 1
+#endif
+
+#ifndef USE_SPECULAR
+#define USE_SPECULAR 0
+#endif
+
+struct Material {
+    //vec3 ambient;
+    sampler2D diffuse;
+#if USE_SPECULAR
+    sampler2D specular;
+#endif
+    float shininess;
+};
+uniform Material material;
+
+struct Light {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+uniform Light light[LIGHT_COUNT];
+
+#endif
@@ -0,0 +1,375 @@
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/packing.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "glm/gtx/inverse_batch.hpp"
+#include "glm/gtx/packing_batch.hpp"
+#include "glm/gtx/transform_batch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* Times the glm functions the renderer and the simulation call most, over
+ * arrays of inputs so every call does real work, for the packed types and,
+ * where the compiler supports them, the aligned types that select the
+ * glm/simd intrinsics. Prints one CSV line per function and layout:
+ *
+ *   arch,layout,op,ns_per_op,mops
+ *
+ * arch is the GLM_ARCH the binary was built for, ns_per_op the best of a
+ * few runs. run_math_bench.sh builds and runs one binary per instruction
+ * set; compare lines of the same op and layout across builds.
+ *
+ * Before timing, checks that the aligned translate, rotate, scale and
+ * lookAt return the same bits as the generic code on the packed types, and
+ * the batch transforms the same bits as the operator* loops they replace,
+ * and exits with status 1 if they don't. Build with -ffp-contract=off: when
+ * the compiler contracts the generic code into FMAs the two paths round
+ * differently.
+ *
+ *   math_bench [--no-header] [milliseconds per op]
+ */
+
+static const size_t BENCH_ITEMS = 1024;
+static const int BENCH_RUNS = 5;
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static const char *benchArch() {
+#if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+    return "avx512";
+#elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+    return "avx2";
+#elif GLM_ARCH & GLM_ARCH_AVX_BIT
+    return "avx";
+#elif GLM_ARCH & GLM_ARCH_SSE42_BIT
+    return "sse42";
+#elif GLM_ARCH & GLM_ARCH_SSE41_BIT
+    return "sse41";
+#elif GLM_ARCH & GLM_ARCH_SSSE3_BIT
+    return "ssse3";
+#elif GLM_ARCH & GLM_ARCH_SSE3_BIT
+    return "sse3";
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+    return "sse2";
+#elif GLM_ARCH & GLM_ARCH_NEON_BIT
+    return "neon";
+#else
+    return "pure";
+#endif
+}
+
+static double benchBudget = 0.02;
+static volatile float benchSink;
+
+/* Runs op(i) over BENCH_ITEMS items enough times to fill the budget, and
+ * prints the best time per call */
+template <typename Op>
+static void benchRun(const char *layout, const char *name, Op op) {
+    size_t rounds = 1;
+    for (;;) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; r++)
+            for (size_t i = 0; i < BENCH_ITEMS; i++)
+                op(i);
+        if (benchSeconds(start) * BENCH_RUNS >= benchBudget)
+            break;
+        rounds *= 2;
+    }
+
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; r++)
+            for (size_t i = 0; i < BENCH_ITEMS; i++)
+                op(i);
+        double ns = benchSeconds(start) * 1e9 / (double)(rounds * BENCH_ITEMS);
+        if (ns < best)
+            best = ns;
+    }
+    printf("%s,%s,%s,%.3f,%.2f\n", benchArch(), layout, name, best, 1e3 / best);
+}
+
+static float benchRandom() {
+    return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+/* Results go to arrays the compiler can't see through, read back into
+ * benchSink once per op */
+template <glm::precision P>
+static void benchLayout(const char *layout) {
+    typedef glm::tvec3<float, P> vec3;
+    typedef glm::tvec4<float, P> vec4;
+    typedef glm::tmat4x4<float, P> mat4;
+    typedef glm::tquat<float, P> quat;
+
+    std::vector<mat4> a(BENCH_ITEMS), b(BENCH_ITEMS), m(BENCH_ITEMS);
+    std::vector<vec4> u(BENCH_ITEMS), v(BENCH_ITEMS), w(BENCH_ITEMS);
+    std::vector<vec3> p(BENCH_ITEMS), q(BENCH_ITEMS), r(BENCH_ITEMS);
+    std::vector<quat> qa(BENCH_ITEMS), qb(BENCH_ITEMS), qr(BENCH_ITEMS);
+    std::vector<float> f(BENCH_ITEMS);
+    for (size_t i = 0; i < BENCH_ITEMS; i++) {
+        // Rigid transforms with some scale, always invertible
+        vec3 axis(benchRandom(), benchRandom(), benchRandom() + 2.0f);
+        a[i] = glm::scale(glm::rotate(glm::translate(mat4(1.0f), vec3(benchRandom(), benchRandom(), benchRandom())),
+                    benchRandom() * 3.0f, axis), vec3(1.5f + benchRandom()));
+        b[i] = glm::rotate(mat4(1.0f), benchRandom() * 3.0f, vec3(benchRandom(), 2.0f, benchRandom()));
+        u[i] = vec4(benchRandom(), benchRandom(), benchRandom(), benchRandom() + 2.0f);
+        v[i] = vec4(benchRandom(), benchRandom(), benchRandom(), benchRandom());
+        p[i] = vec3(benchRandom(), benchRandom(), benchRandom() + 2.0f);
+        q[i] = vec3(benchRandom(), benchRandom(), benchRandom());
+        qa[i] = glm::angleAxis(benchRandom() * 3.0f, glm::normalize(p[i]));
+        qb[i] = glm::angleAxis(benchRandom() * 3.0f, glm::normalize(vec3(q[i].x, q[i].y, 1.0f)));
+    }
+
+    benchRun(layout, "mat4_mul", [&](size_t i) { m[i] = a[i] * b[i]; });
+    benchRun(layout, "mat4_mul_shared", [&](size_t i) { m[i] = a[0] * b[i]; });
+    benchRun(layout, "transform_points", [&](size_t i) { r[i] = vec3(a[0] * vec4(p[i], 1.0f)); });
+    benchRun(layout, "mat4_mul_vec4", [&](size_t i) { w[i] = a[i] * u[i]; });
+    benchRun(layout, "mat4_inverse", [&](size_t i) { m[i] = glm::inverse(a[i]); });
+    benchRun(layout, "mat4_transpose", [&](size_t i) { m[i] = glm::transpose(a[i]); });
+    benchRun(layout, "mat4_determinant", [&](size_t i) { f[i] = glm::determinant(a[i]); });
+    benchRun(layout, "vec4_normalize", [&](size_t i) { w[i] = glm::normalize(u[i]); });
+    benchRun(layout, "vec4_dot", [&](size_t i) { f[i] = glm::dot(u[i], v[i]); });
+    benchRun(layout, "vec3_normalize", [&](size_t i) { r[i] = glm::normalize(p[i]); });
+    benchRun(layout, "vec3_cross", [&](size_t i) { r[i] = glm::cross(p[i], q[i]); });
+    benchRun(layout, "quat_mul", [&](size_t i) { qr[i] = qa[i] * qb[i]; });
+    benchRun(layout, "quat_rotate_vec3", [&](size_t i) { r[i] = qa[i] * p[i]; });
+    benchRun(layout, "quat_normalize", [&](size_t i) { qr[i] = glm::normalize(qa[i]); });
+    benchRun(layout, "quat_slerp", [&](size_t i) { qr[i] = glm::slerp(qa[i], qb[i], 0.3f); });
+    benchRun(layout, "quat_mat4_cast", [&](size_t i) { m[i] = glm::mat4_cast(qa[i]); });
+    benchRun(layout, "translate", [&](size_t i) { m[i] = glm::translate(a[i], p[i]); });
+    benchRun(layout, "rotate", [&](size_t i) { m[i] = glm::rotate(a[i], f[i], p[i]); });
+    benchRun(layout, "lookAt", [&](size_t i) { m[i] = glm::lookAt(p[i], q[i], vec3(0.0f, 1.0f, 0.0f)); });
+
+    float sum = 0.0f;
+    for (size_t i = 0; i < BENCH_ITEMS; i++)
+        sum += m[i][3][0] + w[i].x + r[i].y + qr[i].z + f[i];
+    benchSink = sum;
+}
+
+/* Functions that only take the default types or plain floats */
+static void benchDefault() {
+    std::vector<glm::vec4> v(BENCH_ITEMS);
+    std::vector<glm::mat4> m(BENCH_ITEMS), inv(BENCH_ITEMS), a(BENCH_ITEMS), b(BENCH_ITEMS);
+    std::vector<glm::vec3> p(BENCH_ITEMS), q(BENCH_ITEMS);
+    std::vector<glm::mat3> normal(BENCH_ITEMS);
+    std::vector<glm::uint64> h(BENCH_ITEMS);
+    std::vector<glm::uint32> n(BENCH_ITEMS);
+    std::vector<float> x(BENCH_ITEMS * 4);
+    std::vector<glm::uint16> halves(BENCH_ITEMS * 4);
+    std::vector<glm::uint8> bytes(BENCH_ITEMS * 4);
+    for (size_t i = 0; i < BENCH_ITEMS; i++) {
+        v[i] = glm::vec4(benchRandom(), benchRandom(), benchRandom(), benchRandom()) * 100.0f;
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++) {
+                a[i][c][r] = benchRandom();
+                b[i][c][r] = benchRandom();
+            }
+        p[i] = glm::vec3(benchRandom(), benchRandom(), benchRandom());
+    }
+    memcpy(&x[0], &v[0], x.size() * sizeof(float));
+    const char *layout = glm::detail::is_aligned<glm::defaultp>::value ? "aligned" : "packed";
+
+    benchRun(layout, "perspective", [&](size_t i) {
+        m[i] = glm::perspective(0.5f + v[i].x * 1e-3f, 1.5f, 0.1f, 100.0f);
+    });
+    benchRun("batch", "mat4_inverse", [&](size_t i) {
+        if (i == 0)
+            glm::inverseBatch(&m[0], &inv[0], m.size());
+    });
+    benchRun("batch", "normal_matrix", [&](size_t i) {
+        if (i == 0)
+            glm::normalMatrixBatch(&m[0], &normal[0], m.size());
+    });
+    // Per matrix or point, against the loops of the same name in benchLayout
+    benchRun("batch", "mat4_mul", [&](size_t i) {
+        if (i == 0)
+            glm::mulMatrices(&a[0], &b[0], &m[0], m.size());
+    });
+    benchRun("batch", "mat4_mul_shared", [&](size_t i) {
+        if (i == 0)
+            glm::mulMatrices(a[0], &b[0], &m[0], m.size());
+    });
+    benchRun("batch", "transform_points", [&](size_t i) {
+        if (i == 0)
+            glm::transformPoints(a[0], &p[0], &q[0], p.size());
+    });
+    benchRun("packed", "packHalf4x16", [&](size_t i) { h[i] = glm::packHalf4x16(v[i]); });
+    benchRun("packed", "unpackHalf4x16", [&](size_t i) { v[i] = glm::unpackHalf4x16(h[i]); });
+    benchRun("packed", "packUnorm4x8", [&](size_t i) { n[i] = glm::packUnorm4x8(v[i]); });
+    benchRun("packed", "packSnorm4x16", [&](size_t i) { h[i] = glm::packSnorm4x16(v[i]); });
+
+    // Per vec4, the batch functions over the whole array
+    benchRun("batch", "packHalf4x16", [&](size_t i) {
+        if (i == 0)
+            glm::packHalf1x16Batch(&x[0], &halves[0], x.size());
+    });
+    benchRun("batch", "unpackHalf4x16", [&](size_t i) {
+        if (i == 0)
+            glm::unpackHalf1x16Batch(&halves[0], &x[0], x.size());
+    });
+    benchRun("batch", "packUnorm4x8", [&](size_t i) {
+        if (i == 0)
+            glm::packUnorm1x8Batch(&x[0], &bytes[0], x.size());
+    });
+    benchRun("batch", "packSnorm4x16", [&](size_t i) {
+        if (i == 0)
+            glm::packSnorm1x16Batch(&x[0], &halves[0], x.size());
+    });
+
+    float sum = 0.0f;
+    for (size_t i = 0; i < BENCH_ITEMS; i++)
+        sum += m[i][0][0] + inv[i][1][1] + normal[i][2][2] + q[i].z + v[i].x + (float)(h[i] + n[i] + halves[i] + bytes[i]) + x[i];
+    benchSink = sum;
+}
+
+/* Number of the inputs for which op(i) finds an aligned or batch transform
+ * differs from the generic code, printed to stderr when not zero */
+template <typename Op>
+static size_t benchExactRun(const char *name, size_t count, Op op) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++)
+        mismatches += !op(i);
+    if (mismatches)
+        fprintf(stderr, "FAIL: %s: %s differs from the generic code for %zu of %zu inputs%s\n",
+                benchArch(), name, mismatches, count,
+#ifdef __FMA__
+                ", was the generic code contracted into FMAs?"
+#else
+                ""
+#endif
+                );
+    return mismatches;
+}
+
+static size_t benchExact() {
+    typedef glm::tvec3<float, glm::packed_highp> vec3;
+    typedef glm::tvec4<float, glm::packed_highp> vec4;
+    typedef glm::tmat4x4<float, glm::packed_highp> mat4;
+    size_t mismatches = 0;
+
+    struct Random {
+        static vec3 vec() { return vec3(benchRandom(), benchRandom(), benchRandom()) * 100.0f; }
+        static mat4 mat() {
+            mat4 m;
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++)
+                    m[c][r] = benchRandom() * 10.0f;
+            return m;
+        }
+    };
+
+    // 16 * 255 + 8 + 4 + 3 items: every kernel width runs, and so does the tail
+    const size_t items = 4095;
+    std::vector<mat4> a(items), b(items), ab(items), nb(items);
+    std::vector<vec3> p(items), pm(items), dm(items);
+    std::vector<vec4> u(items), um(items);
+    std::vector<float> x(items), y(items), z(items), ox(items), oy(items), oz(items), ow(items);
+    for (size_t i = 0; i < items; i++) {
+        a[i] = Random::mat();
+        b[i] = Random::mat();
+        p[i] = Random::vec();
+        u[i] = vec4(Random::vec(), benchRandom());
+        x[i] = p[i].x;
+        y[i] = p[i].y;
+        z[i] = p[i].z;
+    }
+    mat4 const m = Random::mat(), n = Random::mat();
+    glm::mulMatrices(&a[0], &b[0], &ab[0], items);
+    glm::mulMatrices(n, &b[0], &nb[0], items);
+    glm::transformPoints(m, &p[0], &pm[0], items);
+    glm::transformDirections(m, &p[0], &dm[0], items);
+    glm::transformVectors(m, &u[0], &um[0], items);
+    glm::transformPointsSoA(m, &x[0], &y[0], &z[0], &ox[0], &oy[0], &oz[0], &ow[0], items);
+
+    mismatches += benchExactRun("batch mulMatrices", items, [&](size_t i) {
+        mat4 const r = a[i] * b[i];
+        return !memcmp(&r, &ab[i], sizeof(r));
+    });
+    mismatches += benchExactRun("batch mulMatrices with one matrix", items, [&](size_t i) {
+        mat4 const r = n * b[i];
+        return !memcmp(&r, &nb[i], sizeof(r));
+    });
+    mismatches += benchExactRun("batch transformPoints", items, [&](size_t i) {
+        vec3 const r(m * vec4(p[i], 1.0f));
+        return !memcmp(&r, &pm[i], sizeof(r));
+    });
+    mismatches += benchExactRun("batch transformDirections", items, [&](size_t i) {
+        vec3 const r(m * vec4(p[i], 0.0f));
+        return !memcmp(&r, &dm[i], sizeof(r));
+    });
+    mismatches += benchExactRun("batch transformVectors", items, [&](size_t i) {
+        vec4 const r(m * u[i]);
+        return !memcmp(&r, &um[i], sizeof(r));
+    });
+    mismatches += benchExactRun("batch transformPointsSoA", items, [&](size_t i) {
+        vec4 const r(m * vec4(p[i], 1.0f));
+        vec4 const soa(ox[i], oy[i], oz[i], ow[i]);
+        return !memcmp(&r, &soa, sizeof(r));
+    });
+
+#if GLM_HAS_ALIGNED_TYPE
+    typedef glm::tvec3<float, glm::aligned_highp> aligned_vec3;
+    typedef glm::tmat4x4<float, glm::aligned_highp> aligned_mat4;
+    const size_t count = 200000;
+
+    struct Same {
+        static bool call(mat4 const &a, aligned_mat4 const &b) {
+            return !memcmp(&a[0][0], &b[0][0], sizeof(float) * 16);
+        }
+    };
+
+    mismatches += benchExactRun("aligned translate", count, [&](size_t) {
+        mat4 m = Random::mat();
+        vec3 v = Random::vec();
+        return Same::call(glm::translate(m, v), glm::translate(aligned_mat4(m), aligned_vec3(v)));
+    });
+    mismatches += benchExactRun("aligned rotate", count, [&](size_t) {
+        mat4 m = Random::mat();
+        vec3 v = Random::vec();
+        float angle = benchRandom() * 4.0f;
+        return Same::call(glm::rotate(m, angle, v), glm::rotate(aligned_mat4(m), angle, aligned_vec3(v)));
+    });
+    mismatches += benchExactRun("aligned scale", count, [&](size_t) {
+        mat4 m = Random::mat();
+        vec3 v = Random::vec();
+        return Same::call(glm::scale(m, v), glm::scale(aligned_mat4(m), aligned_vec3(v)));
+    });
+    mismatches += benchExactRun("aligned lookAt", count, [&](size_t) {
+        vec3 eye = Random::vec(), center = Random::vec(), up = Random::vec();
+        return Same::call(glm::lookAtRH(eye, center, up),
+                glm::lookAtRH(aligned_vec3(eye), aligned_vec3(center), aligned_vec3(up)))
+            && Same::call(glm::lookAtLH(eye, center, up),
+                glm::lookAtLH(aligned_vec3(eye), aligned_vec3(center), aligned_vec3(up)));
+    });
+#endif
+    return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+    bool header = true;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--no-header"))
+            header = false;
+        else
+            benchBudget = atof(argv[i]) * 1e-3;
+    }
+    if (header)
+        printf("arch,layout,op,ns_per_op,mops\n");
+
+    srand(1);
+    if (benchExact())
+        return 1;
+    benchLayout<glm::packed_highp>("packed");
+#if GLM_HAS_ALIGNED_TYPE
+    benchLayout<glm::aligned_highp>("aligned");
+#endif
+    benchDefault();
+    return 0;
+}
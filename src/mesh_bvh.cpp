@@ -0,0 +1,589 @@
+#include "mesh_bvh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include "glm/simd/lanes.h"
+
+typedef glm::detail::simd_lanes<4> BVHNodeLanes;
+#if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+typedef glm::detail::simd_lanes<16> BVHPacketLanes;
+#elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+typedef glm::detail::simd_lanes<8> BVHPacketLanes;
+#else
+typedef glm::detail::simd_lanes<4> BVHPacketLanes;
+#endif
+#else
+/* The simd_lanes operations the kernels use, one lane at a time */
+struct BVHScalarLanes {
+    typedef float vec;
+    typedef bool mask;
+    static const int size = 1;
+
+    static vec set1(float x) { return x; }
+    static vec load(const float *p) { return *p; }
+    static void store(float *p, vec v) { *p = v; }
+    static vec add(vec a, vec b) { return a + b; }
+    static vec sub(vec a, vec b) { return a - b; }
+    static vec mul(vec a, vec b) { return a * b; }
+    static vec div(vec a, vec b) { return a / b; }
+    static vec min(vec a, vec b) { return a < b ? a : b; }
+    static vec max(vec a, vec b) { return a > b ? a : b; }
+    static vec abs(vec a) { return a < 0.0f ? -a : a; }
+    static mask lt(vec a, vec b) { return a < b; }
+    static mask le(vec a, vec b) { return a <= b; }
+    static mask mand(mask a, mask b) { return a && b; }
+    static int bits(mask m) { return m ? 1 : 0; }
+    static vec select(mask m, vec a, vec b) { return m ? a : b; }
+};
+
+typedef BVHScalarLanes BVHNodeLanes;
+typedef BVHScalarLanes BVHPacketLanes;
+#endif
+
+static const unsigned MESH_BVH_LEAF = 0x80000000u;
+static const unsigned MESH_BVH_EMPTY = 0xFFFFFFFFu;
+
+// Triangles per leaf, one per lane of a Leaf
+static const size_t MESH_BVH_LEAF_SIZE = 4;
+
+// Split candidates per axis when building
+static const int MESH_BVH_BINS = 16;
+
+// Past this many levels ranges are split at the median, which bounds the
+// depth and so the traversal stack
+static const int MESH_BVH_MAX_DEPTH = 48;
+static const int MESH_BVH_STACK = 256;
+
+// Packets per task handed to the thread pool
+static const size_t MESH_BVH_GRAIN = 16;
+
+/* Per lane ray data in the form the kernels take */
+template <typename L>
+struct BVHLanesRay {
+    typename L::vec ox, oy, oz;
+    typename L::vec dx, dy, dz;
+    typename L::vec ix, iy, iz;     // 1 / direction, kept finite
+    typename L::vec tMin, tMax;
+};
+
+static float bvhInverse(float d) {
+    return glm::clamp(1.0f / d, -FLT_MAX, FLT_MAX);
+}
+
+/* Slab test of the box against each lane, near gets the entry distance */
+template <typename L>
+static typename L::mask bvhBox(const BVHLanesRay<L> &r,
+        typename L::vec minX, typename L::vec minY, typename L::vec minZ,
+        typename L::vec maxX, typename L::vec maxY, typename L::vec maxZ,
+        typename L::vec &near) {
+    typedef typename L::vec V;
+    V x0 = L::mul(L::sub(minX, r.ox), r.ix), x1 = L::mul(L::sub(maxX, r.ox), r.ix);
+    V y0 = L::mul(L::sub(minY, r.oy), r.iy), y1 = L::mul(L::sub(maxY, r.oy), r.iy);
+    V z0 = L::mul(L::sub(minZ, r.oz), r.iz), z1 = L::mul(L::sub(maxZ, r.oz), r.iz);
+    near = L::max(L::max(L::min(x0, x1), L::min(y0, y1)),
+            L::max(L::min(z0, z1), r.tMin));
+    V far = L::min(L::min(L::max(x0, x1), L::max(y0, y1)),
+            L::min(L::max(z0, z1), r.tMax));
+    return L::le(near, far);
+}
+
+/* glm::intersectRayTriangle on each lane, same operations in the same
+ * order, plus the [tMin, tMax) range */
+template <typename L>
+static typename L::mask bvhTriangle(const BVHLanesRay<L> &r,
+        typename L::vec v0x, typename L::vec v0y, typename L::vec v0z,
+        typename L::vec e1x, typename L::vec e1y, typename L::vec e1z,
+        typename L::vec e2x, typename L::vec e2y, typename L::vec e2z,
+        typename L::vec &t, typename L::vec &u, typename L::vec &v) {
+    typedef typename L::vec V;
+    V px = L::sub(L::mul(r.dy, e2z), L::mul(r.dz, e2y));
+    V py = L::sub(L::mul(r.dz, e2x), L::mul(r.dx, e2z));
+    V pz = L::sub(L::mul(r.dx, e2y), L::mul(r.dy, e2x));
+    V a = L::add(L::add(L::mul(e1x, px), L::mul(e1y, py)), L::mul(e1z, pz));
+    V f = L::div(L::set1(1.0f), a);
+
+    V sx = L::sub(r.ox, v0x), sy = L::sub(r.oy, v0y), sz = L::sub(r.oz, v0z);
+    u = L::mul(f, L::add(L::add(L::mul(sx, px), L::mul(sy, py)), L::mul(sz, pz)));
+
+    V qx = L::sub(L::mul(sy, e1z), L::mul(sz, e1y));
+    V qy = L::sub(L::mul(sz, e1x), L::mul(sx, e1z));
+    V qz = L::sub(L::mul(sx, e1y), L::mul(sy, e1x));
+    v = L::mul(f, L::add(L::add(L::mul(r.dx, qx), L::mul(r.dy, qy)), L::mul(r.dz, qz)));
+    t = L::mul(f, L::add(L::add(L::mul(e2x, qx), L::mul(e2y, qy)), L::mul(e2z, qz)));
+
+    V zero = L::set1(0.0f), one = L::set1(1.0f);
+    typename L::mask hit = L::le(L::set1(std::numeric_limits<float>::epsilon()), L::abs(a));
+    hit = L::mand(hit, L::mand(L::le(zero, u), L::le(u, one)));
+    hit = L::mand(hit, L::mand(L::le(zero, v), L::le(L::add(v, u), one)));
+    return L::mand(hit, L::mand(L::le(r.tMin, t), L::lt(t, r.tMax)));
+}
+
+/* ---- build ---- */
+
+struct MeshBVHBuilder {
+    struct Prim {
+        glm::vec3 lo, hi, centroid;
+        unsigned triangle;
+    };
+
+    struct Range {
+        size_t begin, end;
+        glm::vec3 lo, hi;
+
+        size_t count() const { return end - begin; }
+        float area() const {
+            glm::vec3 d = hi - lo;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+    };
+
+    /* Triangles whose centroid falls in a slice of the split axis */
+    struct Bin {
+        size_t count;
+        glm::vec3 lo, hi;
+
+        Bin() : count(0), lo(FLT_MAX), hi(-FLT_MAX) {}
+
+        void add(glm::vec3 boxLo, glm::vec3 boxHi, size_t n) {
+            count += n;
+            lo = glm::min(lo, boxLo);
+            hi = glm::max(hi, boxHi);
+        }
+        float cost() const {
+            glm::vec3 d = hi - lo;
+            return count ? 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x) * count : 0.0f;
+        }
+    };
+
+    MeshBVH &bvh;
+    const glm::vec3 *positions;
+    const unsigned *indices;
+    std::vector<Prim> prims;
+
+    MeshBVHBuilder(MeshBVH &bvh, const glm::vec3 *positions,
+            const unsigned *indices)
+        : bvh(bvh), positions(positions), indices(indices) {}
+
+    glm::vec3 vertex(unsigned triangle, int corner) const {
+        size_t i = (size_t)triangle * 3 + corner;
+        return positions[indices ? indices[i] : i];
+    }
+
+    Range makeRange(size_t begin, size_t end) const {
+        Range range = { begin, end, glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+        for (size_t i = begin; i < end; i++) {
+            range.lo = glm::min(range.lo, prims[i].lo);
+            range.hi = glm::max(range.hi, prims[i].hi);
+        }
+        return range;
+    }
+
+    /* Binned surface area heuristic on the axis where centroids spread
+     * most, the median when that fails or the tree gets too deep */
+    void split(const Range &range, int level, Range &left, Range &right) {
+        glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+        for (size_t i = range.begin; i < range.end; i++) {
+            lo = glm::min(lo, prims[i].centroid);
+            hi = glm::max(hi, prims[i].centroid);
+        }
+        glm::vec3 extent = hi - lo;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2)
+            : (extent.y > extent.z ? 1 : 2);
+
+        size_t mid = range.begin;
+        if (level < MESH_BVH_MAX_DEPTH && extent[axis] > 0.0f) {
+            float scale = MESH_BVH_BINS / extent[axis];
+            Bin bins[MESH_BVH_BINS];
+            for (size_t i = range.begin; i < range.end; i++)
+                bins[binOf(prims[i], axis, lo[axis], scale)].add(prims[i].lo, prims[i].hi, 1);
+
+            // Cost of cutting after bin b, the right sides swept first
+            float rightCost[MESH_BVH_BINS];
+            Bin side;
+            for (int b = MESH_BVH_BINS - 1; b > 0; b--) {
+                side.add(bins[b].lo, bins[b].hi, bins[b].count);
+                rightCost[b - 1] = side.cost();
+            }
+            int best = -1;
+            float bestCost = FLT_MAX;
+            side = Bin();
+            for (int b = 0; b < MESH_BVH_BINS - 1; b++) {
+                side.add(bins[b].lo, bins[b].hi, bins[b].count);
+                float cost = side.cost() + rightCost[b];
+                if (side.count && side.count < range.count() && cost < bestCost) {
+                    best = b;
+                    bestCost = cost;
+                }
+            }
+            if (best >= 0) {
+                Prim *cut = std::partition(&prims[range.begin], &prims[0] + range.end,
+                        [&](const Prim &p) { return binOf(p, axis, lo[axis], scale) <= best; });
+                mid = cut - &prims[0];
+            }
+        }
+        if (mid == range.begin || mid == range.end) {
+            mid = range.begin + range.count() / 2;
+            std::nth_element(&prims[range.begin], &prims[mid], &prims[0] + range.end,
+                    [&](const Prim &a, const Prim &b) { return a.centroid[axis] < b.centroid[axis]; });
+        }
+        left = makeRange(range.begin, mid);
+        right = makeRange(mid, range.end);
+    }
+
+    static int binOf(const Prim &p, int axis, float lo, float scale) {
+        return std::min(MESH_BVH_BINS - 1, (int)((p.centroid[axis] - lo) * scale));
+    }
+
+    unsigned leaf(const Range &range) {
+        MeshBVH::Leaf leaf = {};
+        for (size_t k = 0; k < MESH_BVH_LEAF_SIZE; k++) {
+            leaf.triangles[k] = MESH_BVH_MISS;
+            if (k >= range.count())
+                continue;
+            unsigned triangle = prims[range.begin + k].triangle;
+            glm::vec3 v0 = vertex(triangle, 0);
+            glm::vec3 e1 = vertex(triangle, 1) - v0;
+            glm::vec3 e2 = vertex(triangle, 2) - v0;
+            for (int c = 0; c < 3; c++) {
+                leaf.v0[c][k] = v0[c];
+                leaf.e1[c][k] = e1[c];
+                leaf.e2[c][k] = e2[c];
+            }
+            leaf.triangles[k] = triangle;
+        }
+        bvh.leaves.push_back(leaf);
+        return MESH_BVH_LEAF | (unsigned)(bvh.leaves.size() - 1);
+    }
+
+    /* Opens the largest ranges until there are four children */
+    unsigned node(const Range &range, int level) {
+        Range children[4] = { range };
+        int count = 1;
+        while (count < 4) {
+            int largest = -1;
+            for (int c = 0; c < count; c++)
+                if (children[c].count() > MESH_BVH_LEAF_SIZE
+                        && (largest < 0 || children[c].area() > children[largest].area()))
+                    largest = c;
+            if (largest < 0)
+                break;
+            Range whole = children[largest];
+            split(whole, level, children[largest], children[count]);
+            count++;
+        }
+
+        unsigned index = (unsigned)bvh.nodes.size();
+        bvh.nodes.push_back(MeshBVH::Node());
+        for (int c = 0; c < 4; c++) {
+            unsigned child = MESH_BVH_EMPTY;
+            glm::vec3 lo(0.0f), hi(0.0f);
+            if (c < count) {
+                lo = children[c].lo;
+                hi = children[c].hi;
+                child = children[c].count() <= MESH_BVH_LEAF_SIZE
+                    ? leaf(children[c]) : node(children[c], level + 1);
+            }
+            MeshBVH::Node &n = bvh.nodes[index];
+            for (int axis = 0; axis < 3; axis++) {
+                n.bounds[axis][c] = lo[axis];
+                n.bounds[axis + 3][c] = hi[axis];
+            }
+            n.children[c] = child;
+        }
+        return index;
+    }
+};
+
+MeshBVH::MeshBVH(const glm::vec3 *positions, const unsigned *indices,
+        size_t triangleCount)
+    : triangles(triangleCount) {
+    if (!triangleCount)
+        return;
+
+    MeshBVHBuilder builder(*this, positions, indices);
+    builder.prims.resize(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        MeshBVHBuilder::Prim &prim = builder.prims[t];
+        glm::vec3 a = builder.vertex((unsigned)t, 0);
+        glm::vec3 b = builder.vertex((unsigned)t, 1);
+        glm::vec3 c = builder.vertex((unsigned)t, 2);
+        prim.lo = glm::min(glm::min(a, b), c);
+        prim.hi = glm::max(glm::max(a, b), c);
+        prim.centroid = (prim.lo + prim.hi) * 0.5f;
+        prim.triangle = (unsigned)t;
+    }
+    nodes.reserve(triangleCount / 8 + 1);
+    leaves.reserve(triangleCount / 2 + 1);
+    builder.node(builder.makeRange(0, triangleCount), 0);
+}
+
+/* ---- single rays ---- */
+
+template <bool AnyHit>
+bool MeshBVH::traverse(const BVHRay &ray, BVHHit &hit) const {
+    typedef BVHNodeLanes L;
+    typedef L::vec V;
+
+    hit.t = ray.tMax;
+    hit.u = hit.v = 0.0f;
+    hit.triangle = MESH_BVH_MISS;
+    if (nodes.empty())
+        return false;
+
+    BVHLanesRay<L> r;
+    r.ox = L::set1(ray.origin.x);
+    r.oy = L::set1(ray.origin.y);
+    r.oz = L::set1(ray.origin.z);
+    r.dx = L::set1(ray.direction.x);
+    r.dy = L::set1(ray.direction.y);
+    r.dz = L::set1(ray.direction.z);
+    r.ix = L::set1(bvhInverse(ray.direction.x));
+    r.iy = L::set1(bvhInverse(ray.direction.y));
+    r.iz = L::set1(bvhInverse(ray.direction.z));
+    r.tMin = L::set1(ray.tMin);
+    r.tMax = L::set1(ray.tMax);
+
+    // Entries remember how far their box starts, to skip it once a closer
+    // hit is known
+    unsigned stack[MESH_BVH_STACK];
+    float stackNear[MESH_BVH_STACK];
+    int top = 0;
+    stack[top] = 0;
+    stackNear[top++] = ray.tMin;
+
+    while (top) {
+        top--;
+        if (stackNear[top] > hit.t)
+            continue;
+        unsigned code = stack[top];
+
+        if (code & MESH_BVH_LEAF) {
+            const Leaf &leaf = leaves[code & ~MESH_BVH_LEAF];
+            float t[4], u[4], v[4];
+            int mask = 0;
+            for (int k = 0; k < 4; k += L::size) {
+                V lt, lu, lv;
+                L::mask m = bvhTriangle<L>(r,
+                        L::load(&leaf.v0[0][k]), L::load(&leaf.v0[1][k]), L::load(&leaf.v0[2][k]),
+                        L::load(&leaf.e1[0][k]), L::load(&leaf.e1[1][k]), L::load(&leaf.e1[2][k]),
+                        L::load(&leaf.e2[0][k]), L::load(&leaf.e2[1][k]), L::load(&leaf.e2[2][k]),
+                        lt, lu, lv);
+                L::store(t + k, lt);
+                L::store(u + k, lu);
+                L::store(v + k, lv);
+                mask |= L::bits(m) << k;
+            }
+            for (int k = 0; k < 4; k++)
+                if ((mask >> k & 1) && t[k] < hit.t) {
+                    hit.t = t[k];
+                    hit.u = u[k];
+                    hit.v = v[k];
+                    hit.triangle = leaf.triangles[k];
+                }
+            if (hit.triangle != MESH_BVH_MISS) {
+                if (AnyHit)
+                    return true;
+                r.tMax = L::set1(hit.t);
+            }
+            continue;
+        }
+
+        const Node &node = nodes[code];
+        float near[4];
+        int mask = 0;
+        for (int k = 0; k < 4; k += L::size) {
+            V n;
+            L::mask m = bvhBox<L>(r,
+                    L::load(&node.bounds[0][k]), L::load(&node.bounds[1][k]), L::load(&node.bounds[2][k]),
+                    L::load(&node.bounds[3][k]), L::load(&node.bounds[4][k]), L::load(&node.bounds[5][k]),
+                    n);
+            L::store(near + k, n);
+            mask |= L::bits(m) << k;
+        }
+
+        // Push the farthest child first so the nearest is visited next
+        int order[4], hits = 0;
+        for (int c = 0; c < 4; c++) {
+            if (!(mask >> c & 1) || node.children[c] == MESH_BVH_EMPTY)
+                continue;
+            int at = hits++;
+            while (at > 0 && near[order[at - 1]] < near[c]) {
+                order[at] = order[at - 1];
+                at--;
+            }
+            order[at] = c;
+        }
+        for (int i = 0; i < hits; i++) {
+            stack[top] = node.children[order[i]];
+            stackNear[top++] = near[order[i]];
+        }
+    }
+    return hit.triangle != MESH_BVH_MISS;
+}
+
+bool MeshBVH::intersect(const BVHRay &ray, BVHHit &hit) const {
+    return traverse<false>(ray, hit);
+}
+
+bool MeshBVH::occluded(const BVHRay &ray) const {
+    BVHHit hit;
+    return traverse<true>(ray, hit);
+}
+
+/* ---- packets ---- */
+
+int MeshBVH::packetSize() {
+    return BVHPacketLanes::size;
+}
+
+template <bool AnyHit>
+void MeshBVH::tracePacket(const BVHRay *rays, size_t count, BVHHit *hits,
+        bool *occluded) const {
+    typedef BVHPacketLanes L;
+    typedef L::vec V;
+    const int N = L::size;
+
+    // Transpose the rays, missing lanes get an empty range and never hit
+    float lanes[11][N];
+    for (int i = 0; i < N; i++) {
+        BVHRay ray = { glm::vec3(0.0f), 0.0f, glm::vec3(1.0f), -1.0f };
+        if ((size_t)i < count)
+            ray = rays[i];
+        for (int c = 0; c < 3; c++) {
+            lanes[c][i] = ray.origin[c];
+            lanes[c + 3][i] = ray.direction[c];
+            lanes[c + 6][i] = bvhInverse(ray.direction[c]);
+        }
+        lanes[9][i] = ray.tMin;
+        lanes[10][i] = ray.tMax;
+    }
+    BVHLanesRay<L> r;
+    r.ox = L::load(lanes[0]); r.oy = L::load(lanes[1]); r.oz = L::load(lanes[2]);
+    r.dx = L::load(lanes[3]); r.dy = L::load(lanes[4]); r.dz = L::load(lanes[5]);
+    r.ix = L::load(lanes[6]); r.iy = L::load(lanes[7]); r.iz = L::load(lanes[8]);
+    r.tMin = L::load(lanes[9]);
+    r.tMax = L::load(lanes[10]);
+
+    V u = L::set1(0.0f), v = L::set1(0.0f);
+    unsigned triangle[N];
+    for (int i = 0; i < N; i++)
+        triangle[i] = MESH_BVH_MISS;
+    const int all = (int)((1u << N) - 1);
+    int done = all & ~(int)((1u << std::min(count, (size_t)N)) - 1);
+
+    unsigned stack[MESH_BVH_STACK];
+    int top = 0;
+    if (!nodes.empty())
+        stack[top++] = 0;
+
+    while (top && done != all) {
+        unsigned code = stack[--top];
+
+        if (code & MESH_BVH_LEAF) {
+            const Leaf &leaf = leaves[code & ~MESH_BVH_LEAF];
+            for (int k = 0; k < 4 && leaf.triangles[k] != MESH_BVH_MISS; k++) {
+                V t, lu, lv;
+                L::mask m = bvhTriangle<L>(r,
+                        L::set1(leaf.v0[0][k]), L::set1(leaf.v0[1][k]), L::set1(leaf.v0[2][k]),
+                        L::set1(leaf.e1[0][k]), L::set1(leaf.e1[1][k]), L::set1(leaf.e1[2][k]),
+                        L::set1(leaf.e2[0][k]), L::set1(leaf.e2[1][k]), L::set1(leaf.e2[2][k]),
+                        t, lu, lv);
+                int mask = L::bits(m);
+                if (!mask)
+                    continue;
+                r.tMax = L::select(m, t, r.tMax);
+                u = L::select(m, lu, u);
+                v = L::select(m, lv, v);
+                for (int i = 0; i < N; i++)
+                    if (mask >> i & 1)
+                        triangle[i] = leaf.triangles[k];
+                if (AnyHit) {
+                    // Lanes that hit are finished, an empty range retires them
+                    r.tMax = L::select(m, L::set1(-FLT_MAX), r.tMax);
+                    done |= mask;
+                }
+            }
+            continue;
+        }
+
+        const Node &node = nodes[code];
+        float near[4];
+        int order[4], hits = 0;
+        for (int c = 0; c < 4; c++) {
+            if (node.children[c] == MESH_BVH_EMPTY)
+                continue;
+            V n;
+            L::mask m = bvhBox<L>(r,
+                    L::set1(node.bounds[0][c]), L::set1(node.bounds[1][c]), L::set1(node.bounds[2][c]),
+                    L::set1(node.bounds[3][c]), L::set1(node.bounds[4][c]), L::set1(node.bounds[5][c]),
+                    n);
+            int mask = L::bits(m);
+            if (!mask)
+                continue;
+
+            // Ordered by the nearest entry among the lanes that hit
+            float entries[N];
+            L::store(entries, n);
+            near[c] = FLT_MAX;
+            for (int i = 0; i < N; i++)
+                if (mask >> i & 1)
+                    near[c] = std::min(near[c], entries[i]);
+            int at = hits++;
+            while (at > 0 && near[order[at - 1]] < near[c]) {
+                order[at] = order[at - 1];
+                at--;
+            }
+            order[at] = c;
+        }
+        for (int i = 0; i < hits; i++)
+            stack[top++] = node.children[order[i]];
+    }
+
+    float t[N], bu[N], bv[N];
+    L::store(t, r.tMax);
+    L::store(bu, u);
+    L::store(bv, v);
+    for (size_t i = 0; i < count && i < (size_t)N; i++) {
+        if (AnyHit) {
+            occluded[i] = triangle[i] != MESH_BVH_MISS;
+            continue;
+        }
+        hits[i].t = t[i];
+        hits[i].u = bu[i];
+        hits[i].v = bv[i];
+        hits[i].triangle = triangle[i];
+    }
+}
+
+void MeshBVH::intersect(const BVHRay *rays, BVHHit *hits, size_t count,
+        ThreadPool *pool) const {
+    size_t packets = (count + packetSize() - 1) / packetSize();
+    auto task = [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++) {
+            size_t first = p * packetSize();
+            tracePacket<false>(rays + first, count - first, hits + first, NULL);
+        }
+    };
+    if (pool)
+        pool->parallelFor(packets, MESH_BVH_GRAIN, task);
+    else
+        task(0, packets);
+}
+
+void MeshBVH::occluded(const BVHRay *rays, bool *occluded, size_t count,
+        ThreadPool *pool) const {
+    size_t packets = (count + packetSize() - 1) / packetSize();
+    auto task = [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++) {
+            size_t first = p * packetSize();
+            tracePacket<true>(rays + first, count - first, NULL, occluded + first);
+        }
+    };
+    if (pool)
+        pool->parallelFor(packets, MESH_BVH_GRAIN, task);
+    else
+        task(0, packets);
+}
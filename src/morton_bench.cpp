@@ -0,0 +1,179 @@
+#include "morton_sort.h"
+#include "particles.h"
+#include "spatial_grid.h"
+
+#include "glm/gtc/bitfield.hpp"
+#include "glm/gtx/random_batch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* Checks the 30 and 63 bit keys against glm::bitfieldInterleave and the
+ * sorted order against std::stable_sort, then reports key and sort times
+ * on one thread and on the pool next to std::sort. Finally shows what the
+ * order buys: SpatialGrid sphere queries issued in random and in Morton
+ * order, and ParticleSystem::sortSpatially on a fountain.
+ *
+ *   morton_bench [points] [queries]
+ */
+
+static const float BENCH_BOX = 100.0f;
+static const int BENCH_RUNS = 5;
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+/* Reference key: the quantisation of MortonSort written out, then gtc_bitfield */
+static glm::uint64 benchKey(glm::vec3 p, glm::vec3 lo, glm::vec3 hi, int bits) {
+    float steps = bits == 30 ? 1024.0f : 2097152.0f;
+    glm::uint32 q[3];
+    for (int a = 0; a < 3; a++) {
+        float scale = hi[a] > lo[a] ? steps / (hi[a] - lo[a]) : 0.0f;
+        float v = (p[a] - lo[a]) * scale;
+        v = v > 0.0f ? v : 0.0f;
+        q[a] = (glm::uint32)(v < steps - 1.0f ? v : steps - 1.0f);
+    }
+    if (bits == 30)
+        return glm::bitfieldInterleave((glm::uint16)q[0], (glm::uint16)q[1], (glm::uint16)q[2]);
+    return glm::bitfieldInterleave(q[0], q[1], q[2]);
+}
+
+static bool benchCheck(const std::vector<glm::vec3> &points, int bits, ThreadPool &pool) {
+    size_t count = points.size();
+    MortonSort sorter(bits);
+    sorter.sort(&points[0].x, 3, count, &pool);
+    glm::vec3 lo = sorter.lower(), hi = sorter.upper();
+
+    // Keys, at offsets covering every tail length
+    std::vector<glm::uint32> keys32(count);
+    std::vector<glm::uint64> keys64(count);
+    size_t mismatches = 0;
+    for (size_t offset = 0; offset < 17; offset++) {
+        size_t n = count - offset;
+        if (bits == 30)
+            MortonSort::keys30(&points[offset].x, 3, n, lo, hi, &keys32[0]);
+        else
+            MortonSort::keys63(&points[offset].x, 3, n, lo, hi, &keys64[0]);
+        for (size_t i = 0; i < n; i++) {
+            glm::uint64 key = bits == 30 ? keys32[i] : keys64[i];
+            mismatches += key != benchKey(points[offset + i], lo, hi, bits);
+        }
+    }
+
+    std::vector<glm::uint64> reference(count);
+    std::vector<unsigned> order(count);
+    for (size_t i = 0; i < count; i++) {
+        reference[i] = benchKey(points[i], lo, hi, bits);
+        order[i] = (unsigned)i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+            [&](unsigned a, unsigned b) { return reference[a] < reference[b]; });
+    bool same = order == sorter.order();
+
+    // The serial sort must give the same order
+    MortonSort serial(bits);
+    serial.sort(&points[0].x, 3, count, NULL);
+    same = same && serial.order() == order;
+
+    printf("%d bit keys: %zu key mismatches, order %s\n", bits, mismatches,
+            same ? "matches std::stable_sort" : "DIFFERS from std::stable_sort");
+    return !mismatches && same;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t queries = argc > 2 ? strtoul(argv[2], NULL, 10) : 200000;
+
+    std::vector<glm::vec3> points(count), centers(queries);
+    glm::batch_rng rng(5);
+    glm::linearRandBatch(rng, &points[0].x, count * 3, -BENCH_BOX, BENCH_BOX);
+    glm::linearRandBatch(rng, &centers[0].x, queries * 3, -BENCH_BOX, BENCH_BOX);
+    ThreadPool &pool = ThreadPool::shared();
+
+    bool ok = benchCheck(points, 30, pool) && benchCheck(points, 63, pool);
+
+    for (int bits = 30; bits <= 63; bits += 33) {
+        MortonSort sorter(bits);
+        double best[2] = { 1e30, 1e30 };
+        for (int threaded = 0; threaded < 2; threaded++)
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                sorter.sort(&points[0].x, 3, count, threaded ? &pool : NULL);
+                best[threaded] = std::min(best[threaded], benchSeconds(start));
+            }
+
+        std::vector<glm::uint64> keys(count);
+        std::vector<glm::uint32> keys32(count);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (bits == 30)
+            MortonSort::keys30(&points[0].x, 3, count, sorter.lower(), sorter.upper(), &keys32[0]);
+        else
+            MortonSort::keys63(&points[0].x, 3, count, sorter.lower(), sorter.upper(), &keys[0]);
+        double keyTime = benchSeconds(start);
+        if (bits == 30)
+            keys.assign(keys32.begin(), keys32.end());
+        start = std::chrono::steady_clock::now();
+        std::sort(keys.begin(), keys.end());
+        double stdSort = benchSeconds(start);
+
+        printf("%d bit, %zu points: keys %.2f ms, sort %.2f ms, %2u thread(s) %.2f ms, "
+                "std::sort of the keys %.2f ms\n", bits, count, keyTime * 1e3,
+                best[0] * 1e3, pool.size(), best[1] * 1e3, stdSort * 1e3);
+    }
+
+    // Sphere queries over a grid, centres in random then Morton order
+    SpatialGrid grid(BENCH_BOX * 2.0f * glm::pow(2.0f / (float)count, 1.0f / 3.0f));
+    grid.build(&points[0], count, &pool);
+    MortonSort sorter;
+    std::vector<unsigned> found;
+    for (int sorted = 0; sorted < 2; sorted++) {
+        if (sorted) {
+            sorter.sort(&centers[0].x, 3, queries, &pool);
+            sorter.apply(&centers[0], &pool);
+        }
+        size_t total = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries; q++) {
+            found.clear();
+            grid.querySphere(centers[q], grid.cellSize(), found);
+            total += found.size();
+        }
+        printf("sphere queries in %s order: %.0f per second, %zu found\n",
+                sorted ? "Morton" : "random", queries / benchSeconds(start), total);
+    }
+
+    // A fountain sorted spatially: same particles, packed in fewer chunks
+    ParticleSystem particles(count, 3);
+    ParticleEmitter emitter;
+    emitter.radius = 1.0f;
+    emitter.velocity = glm::vec3(0.0f, 6.0f, 0.0f);
+    emitter.speedSpread = 3.0f;
+    for (int f = 0; f < 60; f++) {
+        particles.update(1.0f / 60.0f, ParticleForces(), &pool);
+        particles.emit(emitter, count / 60, &pool);
+    }
+    size_t before = particles.size();
+    glm::vec3 sum(0.0f);
+    for (size_t c = 0; c * ParticleSystem::PARTICLE_CHUNK < particles.capacity(); c++)
+        for (unsigned i = 0; i < particles.liveCount(c); i++)
+            sum.x += particles.stream(ParticleSystem::POSITION_X, c)[i];
+    MortonSort particleSorter;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    particles.sortSpatially(particleSorter, &pool);
+    double sortTime = benchSeconds(start);
+    size_t after = 0;
+    for (size_t c = 0; c * ParticleSystem::PARTICLE_CHUNK < particles.capacity(); c++) {
+        after += particles.liveCount(c);
+        for (unsigned i = 0; i < particles.liveCount(c); i++)
+            sum.y += particles.stream(ParticleSystem::POSITION_X, c)[i];
+    }
+    bool kept = before == after && glm::abs(sum.x - sum.y) <= 1e-3f * glm::abs(sum.x) + 1.0f;
+    printf("sortSpatially of %zu particles: %.2f ms, %s\n", before, sortTime * 1e3,
+            kept ? "same particles" : "PARTICLES CHANGED");
+
+    return ok && kept ? 0 : 1;
+}
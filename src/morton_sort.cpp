@@ -0,0 +1,254 @@
+#include "morton_sort.h"
+
+#include "glm/gtc/bitfield.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include "glm/simd/lanes.h"
+
+#if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+typedef glm::detail::simd_lanes<16> MortonLanes;
+#elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+typedef glm::detail::simd_lanes<8> MortonLanes;
+#else
+typedef glm::detail::simd_lanes<4> MortonLanes;
+#endif
+#endif
+
+const size_t MortonSort::MORTON_GRAIN;
+
+// Quantisation steps per axis of 30 and 63 bit keys
+static const float MORTON_STEPS_30 = 1024.0f;
+static const float MORTON_STEPS_63 = 2097152.0f;
+
+static void mortonRun(ThreadPool *pool, size_t count, size_t grain,
+        const ThreadPool::Task &task) {
+    if (pool)
+        pool->parallelFor(count, grain, task);
+    else
+        task(0, count);
+}
+
+/* steps per unit along each axis, 0 for a flat axis */
+static glm::vec3 mortonScale(glm::vec3 lo, glm::vec3 hi, float steps) {
+    glm::vec3 scale;
+    for (int a = 0; a < 3; a++)
+        scale[a] = hi[a] > lo[a] ? steps / (hi[a] - lo[a]) : 0.0f;
+    return scale;
+}
+
+/* The comparisons are ordered like the SIMD max and min so that NaN
+ * gives 0 on both paths */
+static glm::uint32 mortonQuantise(float p, float lo, float scale, float top) {
+    float q = (p - lo) * scale;
+    q = q > 0.0f ? q : 0.0f;
+    q = q < top ? q : top;
+    return (glm::uint32)q;
+}
+
+static glm::uint64 mortonInterleave63(glm::uint32 x, glm::uint32 y, glm::uint32 z) {
+#if defined(__BMI2__)
+    return _pdep_u64(x, 0x1249249249249249ull) | _pdep_u64(y, 0x2492492492492492ull)
+        | _pdep_u64(z, 0x4924924924924924ull);
+#else
+    return glm::bitfieldInterleave(x, y, z);
+#endif
+}
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+/* Lanes quantised like mortonQuantise */
+static MortonLanes::ivec mortonQuantise(MortonLanes::vec p, MortonLanes::vec lo,
+        MortonLanes::vec scale, MortonLanes::vec top) {
+    typedef MortonLanes L;
+    L::vec q = L::max(L::mul(L::sub(p, lo), scale), L::set1(0.0f));
+    return L::trunc(L::min(q, top));
+}
+
+/* Bits 0 to 9 of each lane moved to bits 0, 3, 6 ... 27 */
+static MortonLanes::ivec mortonSpread(MortonLanes::ivec v) {
+    typedef MortonLanes L;
+    v = L::iand(L::ior(v, L::shl(v, 16)), L::iset1(0x030000FF));
+    v = L::iand(L::ior(v, L::shl(v, 8)), L::iset1(0x0300F00F));
+    v = L::iand(L::ior(v, L::shl(v, 4)), L::iset1(0x030C30C3));
+    return L::iand(L::ior(v, L::shl(v, 2)), L::iset1(0x09249249));
+}
+#endif
+
+void MortonSort::keys30(const float *positions, size_t stride, size_t count,
+        glm::vec3 lo, glm::vec3 hi, glm::uint32 *keys) {
+    glm::vec3 scale = mortonScale(lo, hi, MORTON_STEPS_30);
+    const float top = MORTON_STEPS_30 - 1.0f;
+    size_t i = 0;
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+    typedef MortonLanes L;
+    L::vec limit = L::set1(top);
+    L::vec lx = L::set1(lo.x), ly = L::set1(lo.y), lz = L::set1(lo.z);
+    L::vec sx = L::set1(scale.x), sy = L::set1(scale.y), sz = L::set1(scale.z);
+    for (; i + L::size <= count; i += L::size) {
+        L::vec p[3];
+        L::rows(positions + i * stride, (int)stride, 3, p);
+        L::ivec x = mortonSpread(mortonQuantise(p[0], lx, sx, limit));
+        L::ivec y = mortonSpread(mortonQuantise(p[1], ly, sy, limit));
+        L::ivec z = mortonSpread(mortonQuantise(p[2], lz, sz, limit));
+        L::istore(keys + i, L::ior(x, L::ior(L::shl(y, 1), L::shl(z, 2))));
+    }
+#endif
+    for (; i < count; i++) {
+        const float *p = positions + i * stride;
+        keys[i] = (glm::uint32)glm::bitfieldInterleave(
+                (glm::uint16)mortonQuantise(p[0], lo.x, scale.x, top),
+                (glm::uint16)mortonQuantise(p[1], lo.y, scale.y, top),
+                (glm::uint16)mortonQuantise(p[2], lo.z, scale.z, top));
+    }
+}
+
+void MortonSort::keys63(const float *positions, size_t stride, size_t count,
+        glm::vec3 lo, glm::vec3 hi, glm::uint64 *keys) {
+    glm::vec3 scale = mortonScale(lo, hi, MORTON_STEPS_63);
+    const float top = MORTON_STEPS_63 - 1.0f;
+    size_t i = 0;
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+    // Quantised in registers, interleaved one key at a time
+    typedef MortonLanes L;
+    L::vec limit = L::set1(top);
+    L::vec lx = L::set1(lo.x), ly = L::set1(lo.y), lz = L::set1(lo.z);
+    L::vec sx = L::set1(scale.x), sy = L::set1(scale.y), sz = L::set1(scale.z);
+    unsigned q[3][L::size];
+    for (; i + L::size <= count; i += L::size) {
+        L::vec p[3];
+        L::rows(positions + i * stride, (int)stride, 3, p);
+        L::istore(q[0], mortonQuantise(p[0], lx, sx, limit));
+        L::istore(q[1], mortonQuantise(p[1], ly, sy, limit));
+        L::istore(q[2], mortonQuantise(p[2], lz, sz, limit));
+        for (int j = 0; j < L::size; j++)
+            keys[i + j] = mortonInterleave63(q[0][j], q[1][j], q[2][j]);
+    }
+#endif
+    for (; i < count; i++) {
+        const float *p = positions + i * stride;
+        keys[i] = mortonInterleave63(mortonQuantise(p[0], lo.x, scale.x, top),
+                mortonQuantise(p[1], lo.y, scale.y, top),
+                mortonQuantise(p[2], lo.z, scale.z, top));
+    }
+}
+
+MortonSort::MortonSort(int keyBits)
+    : bits(keyBits == 63 ? 63 : 30), lo(0.0f), hi(0.0f) {
+}
+
+void MortonSort::sort(const float *positions, size_t stride, size_t count,
+        ThreadPool *pool) {
+    const size_t G = MORTON_GRAIN;
+    size_t chunks = (count + G - 1) / G;
+    sorted.resize(count);
+
+    // Bounds of every chunk, then of the set
+    std::vector<glm::vec3> chunkLo(chunks, glm::vec3(FLT_MAX));
+    std::vector<glm::vec3> chunkHi(chunks, glm::vec3(-FLT_MAX));
+    mortonRun(pool, chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            size_t last = std::min(count, (c + 1) * G);
+            for (size_t i = c * G; i < last; i++) {
+                const float *p = positions + i * stride;
+                glm::vec3 v(p[0], p[1], p[2]);
+                chunkLo[c] = glm::min(chunkLo[c], v);
+                chunkHi[c] = glm::max(chunkHi[c], v);
+            }
+        }
+    });
+    lo = glm::vec3(FLT_MAX);
+    hi = glm::vec3(-FLT_MAX);
+    for (size_t c = 0; c < chunks; c++) {
+        lo = glm::min(lo, chunkLo[c]);
+        hi = glm::max(hi, chunkHi[c]);
+    }
+    if (!count)
+        lo = hi = glm::vec3(0.0f);
+
+    if (bits == 30)
+        keys32.resize(count);
+    else
+        keys64.resize(count);
+    mortonRun(pool, chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            size_t first = c * G;
+            size_t n = std::min(count, first + G) - first;
+            if (bits == 30)
+                keys30(positions + first * stride, stride, n, lo, hi, &keys32[first]);
+            else
+                keys63(positions + first * stride, stride, n, lo, hi, &keys64[first]);
+            for (size_t i = first; i < first + n; i++)
+                sorted[i] = (unsigned)i;
+        }
+    });
+
+    if (bits == 30)
+        radixSort(keys32, scratch32, count, 10, pool);
+    else
+        radixSort(keys64, scratch64, count, 11, pool);
+}
+
+template <typename K>
+void MortonSort::radixSort(std::vector<K> &keys, std::vector<K> &scratch,
+        size_t count, int digitBits, ThreadPool *pool) {
+    const size_t G = MORTON_GRAIN;
+    const size_t B = (size_t)1 << digitBits;
+    size_t chunks = (count + G - 1) / G;
+    if (!count)
+        return;
+    scratch.resize(count);
+    scratchIds.resize(count);
+    histograms.resize(chunks * B);
+
+    for (int shift = 0; shift < bits; shift += digitBits) {
+        // Digit histogram of every chunk
+        mortonRun(pool, chunks, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                unsigned *histogram = &histograms[c * B];
+                std::fill(histogram, histogram + B, 0u);
+                size_t last = std::min(count, (c + 1) * G);
+                for (size_t i = c * G; i < last; i++)
+                    histogram[(size_t)(keys[i] >> shift) & (B - 1)]++;
+            }
+        });
+
+        // Digit major prefix sum: each chunk gets its own run of every
+        // digit, after the runs of the chunks before it
+        unsigned next = 0;
+        bool uniform = false;
+        for (size_t d = 0; d < B; d++) {
+            unsigned start = next;
+            for (size_t c = 0; c < chunks; c++) {
+                unsigned n = histograms[c * B + d];
+                histograms[c * B + d] = next;
+                next += n;
+            }
+            if (next - start == count)
+                uniform = true;
+        }
+        if (uniform)
+            continue;
+
+        mortonRun(pool, chunks, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                unsigned *cursor = &histograms[c * B];
+                size_t last = std::min(count, (c + 1) * G);
+                for (size_t i = c * G; i < last; i++) {
+                    unsigned at = cursor[(size_t)(keys[i] >> shift) & (B - 1)]++;
+                    scratch[at] = keys[i];
+                    scratchIds[at] = sorted[i];
+                }
+            }
+        });
+        keys.swap(scratch);
+        sorted.swap(scratchIds);
+    }
+}
@@ -0,0 +1,142 @@
+#include "noise_field.h"
+
+#include "glm/gtc/noise.hpp"
+#include "glm/gtx/random_batch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* Generates fBm and ridged fields with both bases and reports the time per
+ * field on one thread and on the whole pool, after checking sampled points
+ * against an octave sum of the scalar glm::perlin / glm::simplex. Then
+ * checks and times the 3D batch functions, on scattered points and on fBm
+ * grids over a slanted plane.
+ *
+ * run_noise_bench.sh builds with -ffp-contract=off: a scalar reference
+ * contracted into FMAs hashes some 3D perlin cells to other gradients,
+ * while the batch code never fuses, so the errors would measure the
+ * compiler rather than the batch code. Exits with status 1 when any error
+ * exceeds BENCH_TOLERANCE.
+ *
+ *   noise_bench [size] [octaves] [frames]
+ */
+
+static const float BENCH_TOLERANCE = 1e-5f;
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+template <typename vec>
+static float benchReference(vec p, const NoiseFractal &fractal) {
+    float sum = 0.0f, amplitude = 1.0f, frequency = 1.0f;
+    for (int o = 0; o < fractal.octaves; o++) {
+        vec q = p * frequency;
+        float n = fractal.basis == glm::noise_simplex ? glm::simplex(q) : glm::perlin(q);
+        if (fractal.ridged) {
+            n = 1.0f - glm::abs(n);
+            n = n * n;
+        }
+        sum += amplitude * n;
+        amplitude *= fractal.gain;
+        frequency *= fractal.lacunarity;
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    size_t size = argc > 1 ? (size_t)atol(argv[1]) : 4096;
+    int octaves = argc > 2 ? atoi(argv[2]) : 6;
+    int frames = argc > 3 ? atoi(argv[3]) : 3;
+
+    std::vector<float> field(size * size);
+    glm::vec2 origin(-17.25f, 3.5f);
+    glm::vec2 step(1.0f / 256.0f);
+    ThreadPool &pool = ThreadPool::shared();
+    float worst = 0.0f;
+
+    for (int kind = 0; kind < 4; kind++) {
+        NoiseFractal fractal;
+        fractal.basis = kind & 1 ? glm::noise_simplex : glm::noise_perlin;
+        fractal.ridged = (kind & 2) != 0;
+        fractal.octaves = octaves;
+        const char *name = kind == 0 ? "perlin fbm" : kind == 1 ? "simplex fbm"
+                : kind == 2 ? "perlin ridged" : "simplex ridged";
+
+        noiseFieldGenerate(&field[0], size, size, origin, step, fractal, &pool);
+        float error = 0.0f;
+        for (size_t i = 0; i < size * size; i += 9973) {
+            glm::vec2 p = origin + glm::vec2(i % size, i / size) * step;
+            error = glm::max(error, glm::abs(field[i] - benchReference(p, fractal)));
+        }
+        worst = glm::max(worst, error);
+
+        for (int threaded = 0; threaded < 2; threaded++) {
+            ThreadPool *run = threaded ? &pool : NULL;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int f = 0; f < frames; f++)
+                noiseFieldGenerate(&field[0], size, size, origin, step, fractal, run);
+            double seconds = benchSeconds(start) / frames;
+            printf("%-15s %zux%zu, %d octaves, %2u thread(s): %8.1f ms, %6.1f M samples/s, max error %g\n",
+                    name, size, size, octaves, threaded ? pool.size() : 1,
+                    seconds * 1e3, size * size / seconds * 1e-6, error);
+        }
+    }
+
+    // 3D batches over a wide range of scattered points
+    size_t count = size * 256;
+    std::vector<glm::vec3> points(count);
+    std::vector<float> values(count);
+    glm::batch_rng rng(5);
+    glm::linearRandBatch(rng, &points[0].x, count * 3, -256.0f, 256.0f);
+    for (int simplex = 0; simplex < 2; simplex++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (simplex)
+            glm::simplexBatch(&points[0], &values[0], count);
+        else
+            glm::perlinBatch(&points[0], &values[0], count);
+        double batch = benchSeconds(start);
+
+        float error = 0.0f;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            float n = simplex ? glm::simplex(points[i]) : glm::perlin(points[i]);
+            error = glm::max(error, glm::abs(values[i] - n));
+        }
+        double scalar = benchSeconds(start);
+        worst = glm::max(worst, error);
+        printf("%-15s %zu points: batch %8.1f ms, scalar %8.1f ms, max error %g\n",
+                simplex ? "simplex 3d" : "perlin 3d", count, batch * 1e3, scalar * 1e3, error);
+    }
+
+    // 3D fBm over a plane slanted through all three axes
+    glm::vec3 origin3(-201.7f, 23.8f, -31.6f);
+    glm::vec3 stepX(1.0f / 256.0f, 1.0f / 512.0f, 0.0f);
+    glm::vec3 stepY(0.0f, 1.0f / 512.0f, 1.0f / 256.0f);
+    for (int simplex = 0; simplex < 2; simplex++) {
+        NoiseFractal fractal;
+        fractal.basis = simplex ? glm::noise_simplex : glm::noise_perlin;
+        fractal.octaves = octaves;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        glm::fbmGrid(&field[0], size, size, origin3, stepX, stepY, fractal.basis, octaves);
+        double seconds = benchSeconds(start);
+        float error = 0.0f;
+        for (size_t i = 0; i < size * size; i += 9973) {
+            glm::vec3 p = origin3 + stepX * (float)(i % size) + stepY * (float)(i / size);
+            error = glm::max(error, glm::abs(field[i] - benchReference(p, fractal)));
+        }
+        worst = glm::max(worst, error);
+        printf("%-15s %zux%zu, %d octaves, %2u thread(s): %8.1f ms, %6.1f M samples/s, max error %g\n",
+                simplex ? "simplex fbm 3d" : "perlin fbm 3d", size, size, octaves, 1,
+                seconds * 1e3, size * size / seconds * 1e-6, error);
+    }
+
+    if (worst > BENCH_TOLERANCE) {
+        printf("FAIL: max error %g against the scalar functions\n", worst);
+        return 1;
+    }
+    return 0;
+}
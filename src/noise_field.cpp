@@ -0,0 +1,32 @@
+#include "noise_field.h"
+
+// Rows per task handed to the thread pool
+static const size_t NOISE_FIELD_GRAIN = 16;
+
+static void noiseFieldRows(float *out, size_t width, size_t begin, size_t end,
+        glm::vec2 origin, glm::vec2 step, const NoiseFractal &fractal) {
+    for (size_t y = begin; y < end; y++) {
+        // A zero row step keeps y at exactly origin.y + y * step.y
+        glm::vec2 rowOrigin(origin.x, origin.y + (float)y * step.y);
+        glm::vec2 rowStep(step.x, 0.0f);
+        float *row = out + y * width;
+        if (fractal.ridged)
+            glm::ridgedGrid(row, width, 1, rowOrigin, rowStep, fractal.basis,
+                    fractal.octaves, fractal.lacunarity, fractal.gain);
+        else
+            glm::fbmGrid(row, width, 1, rowOrigin, rowStep, fractal.basis,
+                    fractal.octaves, fractal.lacunarity, fractal.gain);
+    }
+}
+
+void noiseFieldGenerate(float *out, size_t width, size_t height,
+        glm::vec2 origin, glm::vec2 step, const NoiseFractal &fractal,
+        ThreadPool *pool) {
+    if (!pool) {
+        noiseFieldRows(out, width, 0, height, origin, step, fractal);
+        return;
+    }
+    pool->parallelFor(height, NOISE_FIELD_GRAIN, [&](size_t begin, size_t end) {
+        noiseFieldRows(out, width, begin, end, origin, step, fractal);
+    });
+}
@@ -0,0 +1,817 @@
+#include "null_gl.h"
+#include <glad/glad.h>
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+struct NullGLEntry {
+    const char *name;
+    void *proc;
+};
+
+struct NullShader {
+    GLenum type;
+    std::string source;
+};
+
+struct NullProgram {
+    std::vector<GLuint> shaders;
+    std::string source;     // attached sources, captured at link time
+    bool linked;
+    std::map<std::string, GLint> uniforms;
+};
+
+static const int MAX_TEXTURE_UNITS = 32;
+static const int MAX_VERTEX_ATTRIBS = 16;
+static const int MAX_REPORTED_ERRORS = 20;
+
+static const char *const NULL_GL_EXTENSIONS[] = {
+    "GL_NULL_backend",
+    "GL_ARB_buffer_storage",
+};
+static const GLuint NULL_GL_EXTENSION_COUNT = 2;
+
+static NullGLStats counters;
+static GLenum pendingError = GL_NO_ERROR;
+
+static GLuint nextName = 1;
+static std::map<GLuint, GLsizeiptr> buffers;
+static std::set<GLuint> immutableBuffers;          // from glBufferStorage
+static std::map<GLuint, std::vector<char> > mappedBuffers;
+static std::set<GLsync> syncs;
+static GLuint nextSync = 1;
+static std::set<GLuint> textures;
+static std::set<GLuint> vertexArrays;
+static std::map<GLuint, NullShader> shaders;
+static std::map<GLuint, NullProgram> programs;
+
+static GLuint arrayBufferBinding = 0;
+static GLuint unpackBufferBinding = 0;
+static std::map<GLuint, GLuint> elementBufferBinding;  // per vertex array
+static GLuint vertexArrayBinding = 0;
+static GLuint currentProgram = 0;
+static GLuint activeTextureUnit = 0;
+static GLuint textureBinding[MAX_TEXTURE_UNITS];
+static GLint viewport[4];
+static GLint unpackAlignment = 4;
+
+static void nullGLCall() {
+    counters.calls++;
+}
+
+static void nullGLError(GLenum error, const char *func, const char *why) {
+    if (pendingError == GL_NO_ERROR)
+        pendingError = error;
+    if (counters.errors++ < MAX_REPORTED_ERRORS)
+        std::cout << "NullGL: error 0x" << std::hex << error << std::dec
+            << " in " << func << ": " << why << std::endl;
+}
+
+#include "null_gl_gen.inc"
+
+/* ---- state queries ---- */
+
+static const GLubyte *APIENTRY null_glGetString(GLenum name) {
+    nullGLCall();
+    switch (name) {
+    case GL_VENDOR: return (const GLubyte *)"opengl-demo";
+    case GL_RENDERER: return (const GLubyte *)"NullGL";
+    case GL_VERSION: return (const GLubyte *)"3.3.0 NullGL";
+    case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte *)"3.30";
+    }
+    nullGLError(GL_INVALID_ENUM, "glGetString", "unknown name");
+    return NULL;
+}
+
+static const GLubyte *APIENTRY null_glGetStringi(GLenum name, GLuint index) {
+    nullGLCall();
+    if (name != GL_EXTENSIONS || index >= NULL_GL_EXTENSION_COUNT) {
+        nullGLError(GL_INVALID_VALUE, "glGetStringi", "no such extension");
+        return NULL;
+    }
+    return (const GLubyte *)NULL_GL_EXTENSIONS[index];
+}
+
+static void APIENTRY null_glGetIntegerv(GLenum pname, GLint *data) {
+    nullGLCall();
+    switch (pname) {
+    case GL_NUM_EXTENSIONS: *data = NULL_GL_EXTENSION_COUNT; break;
+    case GL_MAJOR_VERSION: *data = 3; break;
+    case GL_MINOR_VERSION: *data = 3; break;
+    case GL_MAX_TEXTURE_SIZE: *data = 16384; break;
+    case GL_MAX_VERTEX_ATTRIBS: *data = MAX_VERTEX_ATTRIBS; break;
+    case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS: *data = MAX_TEXTURE_UNITS; break;
+    case GL_UNPACK_ALIGNMENT: *data = unpackAlignment; break;
+    case GL_ARRAY_BUFFER_BINDING: *data = arrayBufferBinding; break;
+    case GL_PIXEL_UNPACK_BUFFER_BINDING: *data = unpackBufferBinding; break;
+    case GL_VERTEX_ARRAY_BINDING: *data = vertexArrayBinding; break;
+    case GL_CURRENT_PROGRAM: *data = currentProgram; break;
+    case GL_ACTIVE_TEXTURE: *data = GL_TEXTURE0 + activeTextureUnit; break;
+    case GL_VIEWPORT: memcpy(data, viewport, sizeof(viewport)); break;
+    default: *data = 0; break;
+    }
+}
+
+static GLenum APIENTRY null_glGetError(void) {
+    nullGLCall();
+    GLenum error = pendingError;
+    pendingError = GL_NO_ERROR;
+    return error;
+}
+
+static void APIENTRY null_glEnable(GLenum) {
+    nullGLCall();
+    counters.stateChanges++;
+}
+
+static void APIENTRY null_glDisable(GLenum) {
+    nullGLCall();
+    counters.stateChanges++;
+}
+
+static void APIENTRY null_glViewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+    nullGLCall();
+    if (w < 0 || h < 0) {
+        nullGLError(GL_INVALID_VALUE, "glViewport", "negative size");
+        return;
+    }
+    viewport[0] = x; viewport[1] = y; viewport[2] = w; viewport[3] = h;
+}
+
+static void APIENTRY null_glPixelStorei(GLenum pname, GLint param) {
+    nullGLCall();
+    if (pname == GL_UNPACK_ALIGNMENT)
+        unpackAlignment = param;
+}
+
+/* ---- object names ---- */
+
+static bool nullGLGenNames(const char *func, GLsizei n, GLuint *names) {
+    if (n < 0) {
+        nullGLError(GL_INVALID_VALUE, func, "n is negative");
+        return false;
+    }
+    for (GLsizei i = 0; i < n; i++)
+        names[i] = nextName++;
+    return true;
+}
+
+static void APIENTRY null_glGenBuffers(GLsizei n, GLuint *names) {
+    nullGLCall();
+    if (nullGLGenNames("glGenBuffers", n, names))
+        for (GLsizei i = 0; i < n; i++)
+            buffers[names[i]] = 0;
+}
+
+static void APIENTRY null_glDeleteBuffers(GLsizei n, const GLuint *names) {
+    nullGLCall();
+    for (GLsizei i = 0; i < n; i++) {
+        buffers.erase(names[i]);
+        immutableBuffers.erase(names[i]);
+        mappedBuffers.erase(names[i]);
+        if (arrayBufferBinding == names[i])
+            arrayBufferBinding = 0;
+        if (unpackBufferBinding == names[i])
+            unpackBufferBinding = 0;
+    }
+}
+
+static GLboolean APIENTRY null_glIsBuffer(GLuint name) {
+    nullGLCall();
+    return buffers.count(name) ? GL_TRUE : GL_FALSE;
+}
+
+static void APIENTRY null_glBindBuffer(GLenum target, GLuint name) {
+    nullGLCall();
+    if (name && !buffers.count(name)) {
+        nullGLError(GL_INVALID_OPERATION, "glBindBuffer", "unknown buffer");
+        return;
+    }
+    counters.stateChanges++;
+    if (target == GL_ARRAY_BUFFER)
+        arrayBufferBinding = name;
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+        elementBufferBinding[vertexArrayBinding] = name;
+    else if (target == GL_PIXEL_UNPACK_BUFFER)
+        unpackBufferBinding = name;
+}
+
+static GLuint nullGLBoundBuffer(GLenum target) {
+    if (target == GL_ARRAY_BUFFER)
+        return arrayBufferBinding;
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+        return elementBufferBinding[vertexArrayBinding];
+    if (target == GL_PIXEL_UNPACK_BUFFER)
+        return unpackBufferBinding;
+    return 0;
+}
+
+static void APIENTRY null_glBufferData(GLenum target, GLsizeiptr size,
+        const void *, GLenum) {
+    nullGLCall();
+    GLuint name = nullGLBoundBuffer(target);
+    if (!name) {
+        nullGLError(GL_INVALID_OPERATION, "glBufferData", "no buffer bound");
+        return;
+    }
+    if (size < 0) {
+        nullGLError(GL_INVALID_VALUE, "glBufferData", "negative size");
+        return;
+    }
+    if (immutableBuffers.count(name)) {
+        nullGLError(GL_INVALID_OPERATION, "glBufferData", "immutable buffer");
+        return;
+    }
+    buffers[name] = size;
+    mappedBuffers.erase(name);
+    counters.bufferBytes += size;
+}
+
+/* GL 4.4 / ARB_buffer_storage, which glad 3.3 doesn't load: applications
+ * fetch it through getProcAddress themselves */
+static void APIENTRY null_glBufferStorage(GLenum target, GLsizeiptr size,
+        const void *, GLbitfield) {
+    nullGLCall();
+    GLuint name = nullGLBoundBuffer(target);
+    if (!name) {
+        nullGLError(GL_INVALID_OPERATION, "glBufferStorage", "no buffer bound");
+        return;
+    }
+    if (size <= 0) {
+        nullGLError(GL_INVALID_VALUE, "glBufferStorage", "size not positive");
+        return;
+    }
+    if (immutableBuffers.count(name)) {
+        nullGLError(GL_INVALID_OPERATION, "glBufferStorage", "immutable buffer");
+        return;
+    }
+    buffers[name] = size;
+    immutableBuffers.insert(name);
+    counters.bufferBytes += size;
+}
+
+/* Mappings point into host memory sized to the whole buffer. Bytes written
+ * through them aren't counted: the application writes them directly. */
+static void *APIENTRY null_glMapBufferRange(GLenum target, GLintptr offset,
+        GLsizeiptr length, GLbitfield access) {
+    nullGLCall();
+    GLuint name = nullGLBoundBuffer(target);
+    if (!name) {
+        nullGLError(GL_INVALID_OPERATION, "glMapBufferRange", "no buffer bound");
+        return NULL;
+    }
+    if (offset < 0 || length <= 0 || offset + length > buffers[name]
+            || !(access & (GL_MAP_READ_BIT | GL_MAP_WRITE_BIT))) {
+        nullGLError(GL_INVALID_VALUE, "glMapBufferRange", "bad range or access");
+        return NULL;
+    }
+    if (mappedBuffers.count(name)) {
+        nullGLError(GL_INVALID_OPERATION, "glMapBufferRange", "already mapped");
+        return NULL;
+    }
+    std::vector<char> &storage = mappedBuffers[name];
+    storage.resize(buffers[name]);
+    return &storage[offset];
+}
+
+static GLboolean APIENTRY null_glUnmapBuffer(GLenum target) {
+    nullGLCall();
+    GLuint name = nullGLBoundBuffer(target);
+    if (!name || !mappedBuffers.count(name)) {
+        nullGLError(GL_INVALID_OPERATION, "glUnmapBuffer", "buffer not mapped");
+        return GL_FALSE;
+    }
+    mappedBuffers.erase(name);
+    return GL_TRUE;
+}
+
+static void APIENTRY null_glBufferSubData(GLenum target, GLintptr offset,
+        GLsizeiptr size, const void *) {
+    nullGLCall();
+    GLuint name = nullGLBoundBuffer(target);
+    if (!name) {
+        nullGLError(GL_INVALID_OPERATION, "glBufferSubData", "no buffer bound");
+        return;
+    }
+    if (offset < 0 || size < 0 || offset + size > buffers[name]) {
+        nullGLError(GL_INVALID_VALUE, "glBufferSubData", "range out of bounds");
+        return;
+    }
+    counters.bufferBytes += size;
+}
+
+static void APIENTRY null_glGenVertexArrays(GLsizei n, GLuint *names) {
+    nullGLCall();
+    if (nullGLGenNames("glGenVertexArrays", n, names))
+        for (GLsizei i = 0; i < n; i++)
+            vertexArrays.insert(names[i]);
+}
+
+static void APIENTRY null_glDeleteVertexArrays(GLsizei n, const GLuint *names) {
+    nullGLCall();
+    for (GLsizei i = 0; i < n; i++) {
+        vertexArrays.erase(names[i]);
+        if (vertexArrayBinding == names[i])
+            vertexArrayBinding = 0;
+    }
+}
+
+static void APIENTRY null_glBindVertexArray(GLuint name) {
+    nullGLCall();
+    if (name && !vertexArrays.count(name)) {
+        nullGLError(GL_INVALID_OPERATION, "glBindVertexArray",
+                "unknown vertex array");
+        return;
+    }
+    counters.stateChanges++;
+    vertexArrayBinding = name;
+}
+
+static void APIENTRY null_glVertexAttribPointer(GLuint index, GLint size,
+        GLenum, GLboolean, GLsizei stride, const void *) {
+    nullGLCall();
+    if (!vertexArrayBinding || !arrayBufferBinding) {
+        nullGLError(GL_INVALID_OPERATION, "glVertexAttribPointer",
+                "no vertex array or array buffer bound");
+        return;
+    }
+    if (index >= (GLuint)MAX_VERTEX_ATTRIBS || size < 1 || size > 4
+            || stride < 0)
+        nullGLError(GL_INVALID_VALUE, "glVertexAttribPointer", "bad argument");
+}
+
+static void APIENTRY null_glEnableVertexAttribArray(GLuint index) {
+    nullGLCall();
+    if (!vertexArrayBinding)
+        nullGLError(GL_INVALID_OPERATION, "glEnableVertexAttribArray",
+                "no vertex array bound");
+    else if (index >= (GLuint)MAX_VERTEX_ATTRIBS)
+        nullGLError(GL_INVALID_VALUE, "glEnableVertexAttribArray",
+                "index out of range");
+}
+
+static void APIENTRY null_glVertexAttribDivisor(GLuint index, GLuint) {
+    nullGLCall();
+    if (!vertexArrayBinding)
+        nullGLError(GL_INVALID_OPERATION, "glVertexAttribDivisor",
+                "no vertex array bound");
+    else if (index >= (GLuint)MAX_VERTEX_ATTRIBS)
+        nullGLError(GL_INVALID_VALUE, "glVertexAttribDivisor",
+                "index out of range");
+}
+
+/* ---- sync objects ---- */
+
+/* Nothing runs asynchronously, every fence is signaled once created */
+static GLsync APIENTRY null_glFenceSync(GLenum condition, GLbitfield flags) {
+    nullGLCall();
+    if (condition != GL_SYNC_GPU_COMMANDS_COMPLETE || flags) {
+        nullGLError(GL_INVALID_ENUM, "glFenceSync", "bad condition or flags");
+        return 0;
+    }
+    GLsync sync = (GLsync)(size_t)nextSync++;
+    syncs.insert(sync);
+    return sync;
+}
+
+static GLenum APIENTRY null_glClientWaitSync(GLsync sync, GLbitfield,
+        GLuint64) {
+    nullGLCall();
+    if (!syncs.count(sync)) {
+        nullGLError(GL_INVALID_VALUE, "glClientWaitSync", "unknown sync");
+        return GL_WAIT_FAILED;
+    }
+    return GL_ALREADY_SIGNALED;
+}
+
+static void APIENTRY null_glDeleteSync(GLsync sync) {
+    nullGLCall();
+    if (sync && !syncs.erase(sync))
+        nullGLError(GL_INVALID_VALUE, "glDeleteSync", "unknown sync");
+}
+
+/* ---- textures ---- */
+
+static void APIENTRY null_glGenTextures(GLsizei n, GLuint *names) {
+    nullGLCall();
+    if (nullGLGenNames("glGenTextures", n, names))
+        for (GLsizei i = 0; i < n; i++)
+            textures.insert(names[i]);
+}
+
+static void APIENTRY null_glDeleteTextures(GLsizei n, const GLuint *names) {
+    nullGLCall();
+    for (GLsizei i = 0; i < n; i++)
+        textures.erase(names[i]);
+}
+
+static void APIENTRY null_glActiveTexture(GLenum texture) {
+    nullGLCall();
+    if (texture < GL_TEXTURE0 || texture >= GL_TEXTURE0 + MAX_TEXTURE_UNITS) {
+        nullGLError(GL_INVALID_ENUM, "glActiveTexture", "unit out of range");
+        return;
+    }
+    counters.stateChanges++;
+    activeTextureUnit = texture - GL_TEXTURE0;
+}
+
+static void APIENTRY null_glBindTexture(GLenum, GLuint name) {
+    nullGLCall();
+    if (name && !textures.count(name)) {
+        nullGLError(GL_INVALID_OPERATION, "glBindTexture", "unknown texture");
+        return;
+    }
+    counters.stateChanges++;
+    textureBinding[activeTextureUnit] = name;
+}
+
+static void APIENTRY null_glTexImage2D(GLenum, GLint level, GLint,
+        GLsizei width, GLsizei height, GLint border, GLenum format,
+        GLenum type, const void *) {
+    nullGLCall();
+    if (level < 0 || width < 0 || height < 0 || border != 0) {
+        nullGLError(GL_INVALID_VALUE, "glTexImage2D", "bad size or level");
+        return;
+    }
+    size_t components = format == GL_RGBA || format == GL_BGRA ? 4 :
+        format == GL_RGB || format == GL_BGR ? 3 : format == GL_RG ? 2 : 1;
+    size_t bytes = type == GL_FLOAT || type == GL_INT
+        || type == GL_UNSIGNED_INT ? 4 : 1;
+    size_t rowBytes = (width * components * bytes + unpackAlignment - 1)
+        / unpackAlignment * unpackAlignment;
+    counters.textureBytes += rowBytes * height;
+}
+
+static void APIENTRY null_glGenerateMipmap(GLenum) {
+    nullGLCall();
+    if (!textureBinding[activeTextureUnit])
+        nullGLError(GL_INVALID_OPERATION, "glGenerateMipmap",
+                "no texture bound");
+}
+
+/* ---- shaders and programs ---- */
+
+static GLuint APIENTRY null_glCreateShader(GLenum type) {
+    nullGLCall();
+    if (type != GL_VERTEX_SHADER && type != GL_FRAGMENT_SHADER
+            && type != GL_GEOMETRY_SHADER) {
+        nullGLError(GL_INVALID_ENUM, "glCreateShader", "bad shader type");
+        return 0;
+    }
+    GLuint name = nextName++;
+    shaders[name].type = type;
+    return name;
+}
+
+static void APIENTRY null_glShaderSource(GLuint shader, GLsizei count,
+        const GLchar *const *strings, const GLint *lengths) {
+    nullGLCall();
+    if (!shaders.count(shader)) {
+        nullGLError(GL_INVALID_VALUE, "glShaderSource", "unknown shader");
+        return;
+    }
+    std::string &source = shaders[shader].source;
+    source.clear();
+    for (GLsizei i = 0; i < count; i++) {
+        if (lengths && lengths[i] >= 0)
+            source.append(strings[i], lengths[i]);
+        else
+            source.append(strings[i]);
+    }
+}
+
+static void APIENTRY null_glCompileShader(GLuint shader) {
+    nullGLCall();
+    if (!shaders.count(shader))
+        nullGLError(GL_INVALID_VALUE, "glCompileShader", "unknown shader");
+}
+
+static void APIENTRY null_glGetShaderiv(GLuint shader, GLenum pname,
+        GLint *params) {
+    nullGLCall();
+    if (!shaders.count(shader)) {
+        nullGLError(GL_INVALID_VALUE, "glGetShaderiv", "unknown shader");
+        return;
+    }
+    switch (pname) {
+    case GL_SHADER_TYPE: *params = shaders[shader].type; break;
+    case GL_COMPILE_STATUS: *params = GL_TRUE; break;
+    case GL_SHADER_SOURCE_LENGTH:
+        *params = shaders[shader].source.size() + 1; break;
+    default: *params = 0; break;
+    }
+}
+
+static void APIENTRY null_glGetInfoLog(GLuint, GLsizei bufSize,
+        GLsizei *length, GLchar *infoLog) {
+    nullGLCall();
+    if (length)
+        *length = 0;
+    if (infoLog && bufSize > 0)
+        infoLog[0] = '\0';
+}
+
+static void APIENTRY null_glDeleteShader(GLuint shader) {
+    nullGLCall();
+    shaders.erase(shader);
+}
+
+static GLuint APIENTRY null_glCreateProgram(void) {
+    nullGLCall();
+    GLuint name = nextName++;
+    programs[name].linked = false;
+    return name;
+}
+
+static void APIENTRY null_glAttachShader(GLuint program, GLuint shader) {
+    nullGLCall();
+    if (!programs.count(program) || !shaders.count(shader)) {
+        nullGLError(GL_INVALID_VALUE, "glAttachShader",
+                "unknown program or shader");
+        return;
+    }
+    programs[program].shaders.push_back(shader);
+}
+
+static void APIENTRY null_glLinkProgram(GLuint program) {
+    nullGLCall();
+    if (!programs.count(program)) {
+        nullGLError(GL_INVALID_VALUE, "glLinkProgram", "unknown program");
+        return;
+    }
+    NullProgram &prog = programs[program];
+    prog.source.clear();
+    for (size_t i = 0; i < prog.shaders.size(); i++)
+        if (shaders.count(prog.shaders[i]))
+            prog.source += shaders[prog.shaders[i]].source;
+    prog.uniforms.clear();
+    prog.linked = true;
+}
+
+static void APIENTRY null_glGetProgramiv(GLuint program, GLenum pname,
+        GLint *params) {
+    nullGLCall();
+    if (!programs.count(program)) {
+        nullGLError(GL_INVALID_VALUE, "glGetProgramiv", "unknown program");
+        return;
+    }
+    switch (pname) {
+    case GL_LINK_STATUS: *params = programs[program].linked; break;
+    case GL_ATTACHED_SHADERS: *params = programs[program].shaders.size(); break;
+    default: *params = 0; break;
+    }
+}
+
+static void APIENTRY null_glUseProgram(GLuint program) {
+    nullGLCall();
+    if (program && (!programs.count(program) || !programs[program].linked)) {
+        nullGLError(GL_INVALID_OPERATION, "glUseProgram",
+                "program is not linked");
+        return;
+    }
+    counters.stateChanges++;
+    currentProgram = program;
+}
+
+static void APIENTRY null_glDeleteProgram(GLuint program) {
+    nullGLCall();
+    programs.erase(program);
+    if (currentProgram == program)
+        currentProgram = 0;
+}
+
+/* Locations are handed out per program on first query. A name whose base
+ * identifier never appears in the sources gets -1, like an unknown (or
+ * optimised out) uniform would on a real driver. */
+static GLint APIENTRY null_glGetUniformLocation(GLuint program,
+        const GLchar *name) {
+    nullGLCall();
+    if (!programs.count(program) || !programs[program].linked) {
+        nullGLError(GL_INVALID_OPERATION, "glGetUniformLocation",
+                "program is not linked");
+        return -1;
+    }
+    NullProgram &prog = programs[program];
+    std::map<std::string, GLint>::const_iterator it = prog.uniforms.find(name);
+    if (it != prog.uniforms.end())
+        return it->second;
+
+    std::string base(name, strcspn(name, ".["));
+    if (prog.source.find(base) == std::string::npos)
+        return -1;
+    GLint location = prog.uniforms.size();
+    prog.uniforms[name] = location;
+    return location;
+}
+
+static bool nullGLCheckUniform(const char *func, GLint location) {
+    counters.uniformUpdates++;
+    if (!currentProgram) {
+        nullGLError(GL_INVALID_OPERATION, func, "no program in use");
+        return false;
+    }
+    if (location < -1
+            || location >= (GLint)programs[currentProgram].uniforms.size()) {
+        nullGLError(GL_INVALID_OPERATION, func, "bad uniform location");
+        return false;
+    }
+    return true;
+}
+
+static void APIENTRY null_glUniform1i(GLint location, GLint) {
+    nullGLCall();
+    nullGLCheckUniform("glUniform1i", location);
+}
+
+static void APIENTRY null_glUniform1f(GLint location, GLfloat) {
+    nullGLCall();
+    nullGLCheckUniform("glUniform1f", location);
+}
+
+static void APIENTRY null_glUniform3f(GLint location, GLfloat, GLfloat,
+        GLfloat) {
+    nullGLCall();
+    nullGLCheckUniform("glUniform3f", location);
+}
+
+static void APIENTRY null_glUniform4f(GLint location, GLfloat, GLfloat,
+        GLfloat, GLfloat) {
+    nullGLCall();
+    nullGLCheckUniform("glUniform4f", location);
+}
+
+static void APIENTRY null_glUniformfv(GLint location, GLsizei count,
+        const GLfloat *) {
+    nullGLCall();
+    if (nullGLCheckUniform("glUniform*fv", location) && count < 0)
+        nullGLError(GL_INVALID_VALUE, "glUniform*fv", "negative count");
+}
+
+static void APIENTRY null_glUniformMatrixfv(GLint location, GLsizei count,
+        GLboolean, const GLfloat *) {
+    nullGLCall();
+    if (nullGLCheckUniform("glUniformMatrix*fv", location) && count < 0)
+        nullGLError(GL_INVALID_VALUE, "glUniformMatrix*fv", "negative count");
+}
+
+/* ---- draws ---- */
+
+static bool nullGLCheckDraw(const char *func, GLenum mode, GLsizei count) {
+    if (mode > GL_TRIANGLE_FAN) {
+        nullGLError(GL_INVALID_ENUM, func, "bad primitive mode");
+        return false;
+    }
+    if (count < 0) {
+        nullGLError(GL_INVALID_VALUE, func, "negative count");
+        return false;
+    }
+    if (!vertexArrayBinding) {
+        nullGLError(GL_INVALID_OPERATION, func, "no vertex array bound");
+        return false;
+    }
+    if (!currentProgram) {
+        nullGLError(GL_INVALID_OPERATION, func, "no program in use");
+        return false;
+    }
+    return true;
+}
+
+static void APIENTRY null_glDrawArrays(GLenum mode, GLint first,
+        GLsizei count) {
+    nullGLCall();
+    if (first < 0) {
+        nullGLError(GL_INVALID_VALUE, "glDrawArrays", "negative first");
+        return;
+    }
+    if (nullGLCheckDraw("glDrawArrays", mode, count)) {
+        counters.drawCalls++;
+        counters.vertices += count;
+    }
+}
+
+static void APIENTRY null_glDrawArraysInstanced(GLenum mode, GLint first,
+        GLsizei count, GLsizei instances) {
+    nullGLCall();
+    if (first < 0 || instances < 0) {
+        nullGLError(GL_INVALID_VALUE, "glDrawArraysInstanced", "bad argument");
+        return;
+    }
+    if (nullGLCheckDraw("glDrawArraysInstanced", mode, count)) {
+        counters.drawCalls++;
+        counters.vertices += (unsigned long long)count * instances;
+    }
+}
+
+static void APIENTRY null_glDrawElements(GLenum mode, GLsizei count,
+        GLenum, const void *) {
+    nullGLCall();
+    if (!nullGLCheckDraw("glDrawElements", mode, count))
+        return;
+    if (!elementBufferBinding[vertexArrayBinding]) {
+        nullGLError(GL_INVALID_OPERATION, "glDrawElements",
+                "no element buffer bound");
+        return;
+    }
+    counters.drawCalls++;
+    counters.vertices += count;
+}
+
+static void APIENTRY null_glDrawElementsInstanced(GLenum mode, GLsizei count,
+        GLenum, const void *, GLsizei instances) {
+    nullGLCall();
+    if (!nullGLCheckDraw("glDrawElementsInstanced", mode, count))
+        return;
+    if (!elementBufferBinding[vertexArrayBinding] || instances < 0) {
+        nullGLError(GL_INVALID_OPERATION, "glDrawElementsInstanced",
+                "no element buffer bound");
+        return;
+    }
+    counters.drawCalls++;
+    counters.vertices += (unsigned long long)count * instances;
+}
+
+static const NullGLEntry nullGLImpls[] = {
+    { "glGetString", (void *)null_glGetString },
+    { "glGetStringi", (void *)null_glGetStringi },
+    { "glGetIntegerv", (void *)null_glGetIntegerv },
+    { "glGetError", (void *)null_glGetError },
+    { "glEnable", (void *)null_glEnable },
+    { "glDisable", (void *)null_glDisable },
+    { "glViewport", (void *)null_glViewport },
+    { "glPixelStorei", (void *)null_glPixelStorei },
+    { "glGenBuffers", (void *)null_glGenBuffers },
+    { "glDeleteBuffers", (void *)null_glDeleteBuffers },
+    { "glIsBuffer", (void *)null_glIsBuffer },
+    { "glBindBuffer", (void *)null_glBindBuffer },
+    { "glBufferData", (void *)null_glBufferData },
+    { "glBufferSubData", (void *)null_glBufferSubData },
+    { "glBufferStorage", (void *)null_glBufferStorage },
+    { "glMapBufferRange", (void *)null_glMapBufferRange },
+    { "glUnmapBuffer", (void *)null_glUnmapBuffer },
+    { "glGenVertexArrays", (void *)null_glGenVertexArrays },
+    { "glDeleteVertexArrays", (void *)null_glDeleteVertexArrays },
+    { "glBindVertexArray", (void *)null_glBindVertexArray },
+    { "glVertexAttribPointer", (void *)null_glVertexAttribPointer },
+    { "glEnableVertexAttribArray", (void *)null_glEnableVertexAttribArray },
+    { "glVertexAttribDivisor", (void *)null_glVertexAttribDivisor },
+    { "glFenceSync", (void *)null_glFenceSync },
+    { "glClientWaitSync", (void *)null_glClientWaitSync },
+    { "glDeleteSync", (void *)null_glDeleteSync },
+    { "glGenTextures", (void *)null_glGenTextures },
+    { "glDeleteTextures", (void *)null_glDeleteTextures },
+    { "glActiveTexture", (void *)null_glActiveTexture },
+    { "glBindTexture", (void *)null_glBindTexture },
+    { "glTexImage2D", (void *)null_glTexImage2D },
+    { "glGenerateMipmap", (void *)null_glGenerateMipmap },
+    { "glCreateShader", (void *)null_glCreateShader },
+    { "glShaderSource", (void *)null_glShaderSource },
+    { "glCompileShader", (void *)null_glCompileShader },
+    { "glGetShaderiv", (void *)null_glGetShaderiv },
+    { "glGetShaderInfoLog", (void *)null_glGetInfoLog },
+    { "glDeleteShader", (void *)null_glDeleteShader },
+    { "glCreateProgram", (void *)null_glCreateProgram },
+    { "glAttachShader", (void *)null_glAttachShader },
+    { "glLinkProgram", (void *)null_glLinkProgram },
+    { "glGetProgramiv", (void *)null_glGetProgramiv },
+    { "glGetProgramInfoLog", (void *)null_glGetInfoLog },
+    { "glUseProgram", (void *)null_glUseProgram },
+    { "glDeleteProgram", (void *)null_glDeleteProgram },
+    { "glGetUniformLocation", (void *)null_glGetUniformLocation },
+    { "glUniform1i", (void *)null_glUniform1i },
+    { "glUniform1f", (void *)null_glUniform1f },
+    { "glUniform3f", (void *)null_glUniform3f },
+    { "glUniform4f", (void *)null_glUniform4f },
+    { "glUniform1fv", (void *)null_glUniformfv },
+    { "glUniform2fv", (void *)null_glUniformfv },
+    { "glUniform3fv", (void *)null_glUniformfv },
+    { "glUniform4fv", (void *)null_glUniformfv },
+    { "glUniformMatrix3fv", (void *)null_glUniformMatrixfv },
+    { "glUniformMatrix4fv", (void *)null_glUniformMatrixfv },
+    { "glDrawArrays", (void *)null_glDrawArrays },
+    { "glDrawArraysInstanced", (void *)null_glDrawArraysInstanced },
+    { "glDrawElements", (void *)null_glDrawElements },
+    { "glDrawElementsInstanced", (void *)null_glDrawElementsInstanced },
+    { NULL, NULL }
+};
+
+void *NullGL::getProcAddress(const char *name) {
+    for (const NullGLEntry *entry = nullGLImpls; entry->name; entry++)
+        if (strcmp(entry->name, name) == 0)
+            return entry->proc;
+    for (const NullGLEntry *entry = nullGLStubs; entry->name; entry++)
+        if (strcmp(entry->name, name) == 0)
+            return entry->proc;
+    return NULL;
+}
+
+const NullGLStats &NullGL::stats() {
+    return counters;
+}
+
+void NullGL::resetStats() {
+    memset(&counters, 0, sizeof(counters));
+}
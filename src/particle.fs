@@ -0,0 +1,11 @@
+#version 330 core
+
+in vec2 corner;
+in vec4 color;
+
+out vec4 FragColor;
+
+void main() {
+    float falloff = max(1.0 - dot(corner, corner), 0.0);
+    FragColor = vec4(color.rgb, color.a * falloff);
+}
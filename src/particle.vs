@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec4 aPosSize;
+layout (location = 1) in vec4 aColor;
+
+uniform mat4 view;
+uniform mat4 proj;
+
+out vec2 corner;
+out vec4 color;
+
+void main() {
+    // triangle strip over the corners (-1,-1) (1,-1) (-1,1) (1,1)
+    corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec4 center = view * vec4(aPosSize.xyz, 1.0);
+    gl_Position = proj * (center + vec4(corner * aPosSize.w * 0.5, 0.0, 0.0));
+    color = aColor;
+}
@@ -0,0 +1,89 @@
+#include "particles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* Runs a fountain kept at about count live particles at 60 Hz and reports
+ * the time of emit, update and writeInstances per frame on one thread and
+ * on the whole pool. Both runs must write the same instances, since
+ * emission doesn't depend on the thread count.
+ *
+ *   particle_bench [count] [frames]
+ */
+
+static const float BENCH_DT = 1.0f / 60.0f;
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    int frames = argc > 2 ? atoi(argv[2]) : 300;
+
+    ParticleEmitter emitter;
+    emitter.position = glm::vec3(0.0f, 1.0f, 0.0f);
+    emitter.radius = 0.1f;
+    emitter.velocity = glm::vec3(0.0f, 6.0f, 0.0f);
+    emitter.speedSpread = 2.0f;
+    emitter.lifetime = 2.0f;
+    emitter.lifetimeSpread = 0.5f;
+    emitter.color = glm::vec4(1.0f, 0.5f, 0.25f, 1.0f);
+    ParticleForces forces;
+    forces.drag = 0.2f;
+
+    // Births per frame that keep the population near count
+    size_t births = (size_t)(count * BENCH_DT / emitter.lifetime);
+    ThreadPool &pool = ThreadPool::shared();
+
+    std::vector<glm::vec4> positions[2];
+    std::vector<glm::uint32> colors[2];
+    size_t written[2];
+
+    for (int threaded = 0; threaded < 2; threaded++) {
+        ThreadPool *run = threaded ? &pool : NULL;
+        ParticleSystem system(count, 1);
+        positions[threaded].resize(system.capacity());
+        colors[threaded].resize(system.capacity());
+        ParticleInstances out = { &positions[threaded][0], &colors[threaded][0],
+            system.capacity() };
+
+        double emitTime = 0.0, updateTime = 0.0, writeTime = 0.0;
+        for (int f = 0; f < frames; f++) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            system.update(BENCH_DT, forces, run);
+            updateTime += benchSeconds(start);
+
+            start = std::chrono::steady_clock::now();
+            system.emit(emitter, births, run);
+            emitTime += benchSeconds(start);
+
+            start = std::chrono::steady_clock::now();
+            written[threaded] = system.writeInstances(out, run);
+            writeTime += benchSeconds(start);
+        }
+
+        if (written[threaded] != system.size()) {
+            printf("FAIL: wrote %zu of %zu particles\n", written[threaded], system.size());
+            return 1;
+        }
+        double total = emitTime + updateTime + writeTime;
+        printf("%zu particles, %2u thread(s): emit %6.2f ms, update %6.2f ms, write %6.2f ms, "
+                "frame %6.2f ms (%s 16.7 ms)\n",
+                system.size(), threaded ? pool.size() : 1,
+                emitTime * 1e3 / frames, updateTime * 1e3 / frames,
+                writeTime * 1e3 / frames, total * 1e3 / frames,
+                total / frames < BENCH_DT ? "within" : "over");
+    }
+
+    if (written[0] != written[1]
+            || memcmp(&positions[0][0], &positions[1][0], written[0] * sizeof(glm::vec4))
+            || memcmp(&colors[0][0], &colors[1][0], written[0] * sizeof(glm::uint32))) {
+        printf("FAIL: threaded run differs from the serial one\n");
+        return 1;
+    }
+    return 0;
+}
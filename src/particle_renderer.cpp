@@ -0,0 +1,164 @@
+#include "particle_renderer.h"
+
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRYP PFNPARTICLEBUFFERSTORAGEPROC)(GLenum target,
+        GLsizeiptr size, const void *data, GLbitfield flags);
+
+// Regions start on a boundary every driver accepts for attribute offsets
+static const GLsizeiptr PARTICLE_REGION_ALIGNMENT = 256;
+
+// Nanoseconds per wait on a fence before checking it again
+static const GLuint64 PARTICLE_FENCE_TIMEOUT = 1000000;
+
+static GLsizeiptr particleAlign(GLsizeiptr bytes) {
+    return (bytes + PARTICLE_REGION_ALIGNMENT - 1)
+        / PARTICLE_REGION_ALIGNMENT * PARTICLE_REGION_ALIGNMENT;
+}
+
+/* glBufferStorage if the context has it, NULL otherwise */
+static PFNPARTICLEBUFFERSTORAGEPROC particleBufferStorage(GLADloadproc loader) {
+    GLint major = 0, minor = 0, extensions = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+
+    bool supported = major > 4 || (major == 4 && minor >= 4);
+    for (GLint i = 0; i < extensions && !supported; i++) {
+        const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
+        supported = name && strcmp(name, "GL_ARB_buffer_storage") == 0;
+    }
+    if (!supported)
+        return NULL;
+    return (PFNPARTICLEBUFFERSTORAGEPROC)loader("glBufferStorage");
+}
+
+ParticleRenderer::ParticleRenderer(size_t capacity, GLADloadproc loader)
+    : capacity(capacity), vao(0), vbo(0), persistent(NULL), mapped(false),
+      frame(0) {
+    colorOffset = particleAlign(capacity * sizeof(glm::vec4));
+    regionBytes = particleAlign(colorOffset + capacity * sizeof(glm::uint32));
+    GLsizeiptr bytes = regionBytes * PARTICLE_FRAMES;
+    for (int i = 0; i < PARTICLE_FRAMES; i++)
+        fences[i] = 0;
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    PFNPARTICLEBUFFERSTORAGEPROC bufferStorage = particleBufferStorage(loader);
+    if (bufferStorage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+            | GL_MAP_COHERENT_BIT;
+        bufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+        persistent = (char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+        if (!persistent) {
+            // Storage is immutable, start over with a mutable buffer
+            glDeleteBuffers(1, &vbo);
+            glGenBuffers(1, &vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        }
+    }
+    if (!persistent)
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+
+    /* per instance xyz + size and RGBA8 colour, pointers set each frame */
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(0, 1);
+    glVertexAttribDivisor(1, 1);
+
+    glBindVertexArray(0);
+}
+
+ParticleRenderer::~ParticleRenderer() {
+    for (int i = 0; i < PARTICLE_FRAMES; i++)
+        if (fences[i])
+            glDeleteSync(fences[i]);
+    if (persistent || mapped) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+}
+
+ParticleInstances ParticleRenderer::beginFrame() {
+    ParticleInstances out = { NULL, NULL, 0 };
+
+    // The GPU may still read this region from PARTICLE_FRAMES frames ago
+    if (fences[frame]) {
+        GLenum status;
+        do
+            status = glClientWaitSync(fences[frame], GL_SYNC_FLUSH_COMMANDS_BIT,
+                    PARTICLE_FENCE_TIMEOUT);
+        while (status == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fences[frame]);
+        fences[frame] = 0;
+    }
+
+    GLintptr offset = frame * regionBytes;
+    char *region;
+    if (persistent) {
+        region = persistent + offset;
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        if (mapped)
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        // The fence already covers the region, no need for the driver to
+        // synchronise as well
+        region = (char *)glMapBufferRange(GL_ARRAY_BUFFER, offset, regionBytes,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT
+                | GL_MAP_UNSYNCHRONIZED_BIT);
+        mapped = region != NULL;
+        if (!region)
+            return out;
+    }
+
+    out.positionSize = (glm::vec4 *)region;
+    out.colors = (glm::uint32 *)(region + colorOffset);
+    out.capacity = capacity;
+    return out;
+}
+
+void ParticleRenderer::draw(size_t count, Shader &shader,
+        const glm::mat4 &view, const glm::mat4 &proj) {
+    GLintptr offset = frame * regionBytes;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (mapped) {
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mapped = false;
+    }
+    if (count > capacity)
+        count = capacity;
+
+    shader.use();
+    shader.setMat4("view", view);
+    shader.setMat4("proj", proj);
+
+    glBindVertexArray(vao);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4),
+            (void *)offset);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(glm::uint32),
+            (void *)(offset + colorOffset));
+
+    /* additive blending needs no sorting, depth is tested but not written */
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glDepthMask(GL_FALSE);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glBindVertexArray(0);
+
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame = (frame + 1) % PARTICLE_FRAMES;
+}
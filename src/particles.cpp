@@ -0,0 +1,309 @@
+#include "particles.h"
+#include "morton_sort.h"
+
+#include "glm/gtc/packing.hpp"
+#include "glm/gtx/random_batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include "glm/simd/lanes.h"
+
+#if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+typedef glm::detail::simd_lanes<16> ParticleLanes;
+#elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+typedef glm::detail::simd_lanes<8> ParticleLanes;
+#else
+typedef glm::detail::simd_lanes<4> ParticleLanes;
+#endif
+#endif
+
+const size_t ParticleSystem::PARTICLE_CHUNK;
+
+// Chunks per task handed to the thread pool
+static const size_t PARTICLE_GRAIN = 4;
+
+// Particles generated per batch of random numbers while spawning
+static const size_t PARTICLE_SPAWN_BLOCK = 256;
+
+static const size_t PARTICLE_ALIGNMENT = 64;
+
+ParticleSystem::ParticleSystem(size_t capacity, glm::uint64 seed)
+    : colors(NULL), total(0), seed(seed), emitCalls(0) {
+    size_t chunks = std::max<size_t>(1, (capacity + PARTICLE_CHUNK - 1) / PARTICLE_CHUNK);
+    live.assign(chunks, 0);
+
+    // One zeroed block, every stream starting on a cache line. Lanes past
+    // the live count of a chunk are integrated too and must hold numbers.
+    size_t streamBytes = chunks * PARTICLE_CHUNK * sizeof(float);
+    storage.assign(streamBytes * (FLOAT_STREAMS + 1) + PARTICLE_ALIGNMENT, 0);
+    size_t misalignment = (size_t)&storage[0] % PARTICLE_ALIGNMENT;
+    char *base = &storage[0] + (misalignment ? PARTICLE_ALIGNMENT - misalignment : 0);
+    for (int s = 0; s < FLOAT_STREAMS; s++)
+        streams[s] = (float *)(base + s * streamBytes);
+    colors = (glm::uint32 *)(base + FLOAT_STREAMS * streamBytes);
+}
+
+void ParticleSystem::spawn(const ParticleEmitter &emitter, size_t chunk,
+        size_t begin, size_t count, glm::uint64 stream) {
+    glm::batch_rng rng(seed, stream);
+    glm::vec3 offsets[PARTICLE_SPAWN_BLOCK];
+    float values[PARTICLE_SPAWN_BLOCK];
+    glm::uint32 color = glm::packUnorm4x8(emitter.color);
+
+    size_t first = chunk * PARTICLE_CHUNK + begin;
+    for (size_t b = 0; b < count; b += PARTICLE_SPAWN_BLOCK) {
+        size_t n = std::min(PARTICLE_SPAWN_BLOCK, count - b);
+        size_t at = first + b;
+
+        glm::sphericalRandBatch(rng, offsets, n, emitter.radius);
+        for (size_t i = 0; i < n; i++) {
+            streams[POSITION_X][at + i] = emitter.position.x + offsets[i].x;
+            streams[POSITION_Y][at + i] = emitter.position.y + offsets[i].y;
+            streams[POSITION_Z][at + i] = emitter.position.z + offsets[i].z;
+        }
+        glm::sphericalRandBatch(rng, offsets, n, emitter.speedSpread);
+        for (size_t i = 0; i < n; i++) {
+            streams[VELOCITY_X][at + i] = emitter.velocity.x + offsets[i].x;
+            streams[VELOCITY_Y][at + i] = emitter.velocity.y + offsets[i].y;
+            streams[VELOCITY_Z][at + i] = emitter.velocity.z + offsets[i].z;
+        }
+        glm::linearRandBatch(rng, &streams[LIFETIME][at], n,
+                emitter.lifetime - emitter.lifetimeSpread,
+                emitter.lifetime + emitter.lifetimeSpread);
+        glm::linearRandBatch(rng, values, n,
+                emitter.size - emitter.sizeSpread,
+                emitter.size + emitter.sizeSpread);
+        memcpy(&streams[SIZE][at], values, n * sizeof(float));
+        memset(&streams[AGE][at], 0, n * sizeof(float));
+        std::fill(colors + at, colors + at + n, color);
+    }
+}
+
+size_t ParticleSystem::emit(const ParticleEmitter &emitter, size_t count,
+        ThreadPool *pool) {
+    // Fill chunks in order, each range its own random stream
+    struct SpawnRange {
+        size_t chunk, begin, count;
+    };
+    std::vector<SpawnRange> ranges;
+    size_t spawned = 0;
+    for (size_t c = 0; c < live.size() && spawned < count; c++) {
+        size_t room = std::min(PARTICLE_CHUNK - live[c], count - spawned);
+        if (!room)
+            continue;
+        SpawnRange range = { c, live[c], room };
+        ranges.push_back(range);
+        live[c] += (unsigned)room;
+        spawned += room;
+    }
+
+    glm::uint64 stream = emitCalls++ << 32;
+    auto task = [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r++)
+            spawn(emitter, ranges[r].chunk, ranges[r].begin, ranges[r].count,
+                    stream + ranges[r].chunk);
+    };
+    if (pool)
+        pool->parallelFor(ranges.size(), PARTICLE_GRAIN, task);
+    else
+        task(0, ranges.size());
+
+    total += spawned;
+    return spawned;
+}
+
+void ParticleSystem::updateChunk(size_t chunk, float dt,
+        const ParticleForces &forces) {
+    unsigned count = live[chunk];
+    if (!count)
+        return;
+
+    float *px = stream(POSITION_X, chunk);
+    float *py = stream(POSITION_Y, chunk);
+    float *pz = stream(POSITION_Z, chunk);
+    float *vx = stream(VELOCITY_X, chunk);
+    float *vy = stream(VELOCITY_Y, chunk);
+    float *vz = stream(VELOCITY_Z, chunk);
+    float *age = stream(AGE, chunk);
+    float *lifetime = stream(LIFETIME, chunk);
+
+    // v' = v * (1 - drag dt) + g dt, then x' = x + v' dt
+    float damping = std::max(0.0f, 1.0f - forces.drag * dt);
+    glm::vec3 impulse = forces.gravity * dt;
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+    typedef ParticleLanes L;
+    L::vec d = L::set1(damping);
+    L::vec t = L::set1(dt);
+    L::vec gx = L::set1(impulse.x), gy = L::set1(impulse.y), gz = L::set1(impulse.z);
+    // Chunks are a whole number of registers, lanes past count hold stale values
+    for (unsigned i = 0; i < count; i += L::size) {
+        L::vec x = L::madd(L::load(vx + i), d, gx);
+        L::vec y = L::madd(L::load(vy + i), d, gy);
+        L::vec z = L::madd(L::load(vz + i), d, gz);
+        L::store(vx + i, x);
+        L::store(vy + i, y);
+        L::store(vz + i, z);
+        L::store(px + i, L::madd(x, t, L::load(px + i)));
+        L::store(py + i, L::madd(y, t, L::load(py + i)));
+        L::store(pz + i, L::madd(z, t, L::load(pz + i)));
+        L::store(age + i, L::add(L::load(age + i), t));
+    }
+#else
+    for (unsigned i = 0; i < count; i++) {
+        vx[i] = vx[i] * damping + impulse.x;
+        vy[i] = vy[i] * damping + impulse.y;
+        vz[i] = vz[i] * damping + impulse.z;
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        pz[i] += vz[i] * dt;
+        age[i] += dt;
+    }
+#endif
+
+    // Indices of the survivors without a branch per particle, then each
+    // stream gathered down in place (keep[k] >= k so reads stay ahead)
+    unsigned keep[PARTICLE_CHUNK];
+    unsigned kept = 0;
+    for (unsigned i = 0; i < count; i++) {
+        keep[kept] = i;
+        kept += age[i] < lifetime[i];
+    }
+    if (kept != count) {
+        for (int s = 0; s < FLOAT_STREAMS; s++) {
+            float *values = stream((Stream)s, chunk);
+            for (unsigned k = 0; k < kept; k++)
+                values[k] = values[keep[k]];
+        }
+        glm::uint32 *color = colorStream(chunk);
+        for (unsigned k = 0; k < kept; k++)
+            color[k] = color[keep[k]];
+    }
+    live[chunk] = kept;
+}
+
+void ParticleSystem::update(float dt, const ParticleForces &forces,
+        ThreadPool *pool) {
+    auto task = [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++)
+            updateChunk(c, dt, forces);
+    };
+    if (pool)
+        pool->parallelFor(live.size(), PARTICLE_GRAIN, task);
+    else
+        task(0, live.size());
+
+    total = 0;
+    for (size_t c = 0; c < live.size(); c++)
+        total += live[c];
+}
+
+void ParticleSystem::writeChunk(size_t chunk, size_t first, size_t count,
+        const ParticleInstances &out) const {
+    size_t base = chunk * PARTICLE_CHUNK;
+    const float *px = streams[POSITION_X] + base;
+    const float *py = streams[POSITION_Y] + base;
+    const float *pz = streams[POSITION_Z] + base;
+    const float *size = streams[SIZE] + base;
+    const float *age = streams[AGE] + base;
+    const float *lifetime = streams[LIFETIME] + base;
+    const glm::uint32 *color = colors + base;
+    glm::vec4 *positionSize = out.positionSize + first;
+    glm::uint32 *packed = out.colors + first;
+
+    // Sequential 16 byte stores, which suits write-combined mappings
+    size_t i = 0;
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+    const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_load_ps(px + i);
+        __m128 y = _mm_load_ps(py + i);
+        __m128 z = _mm_load_ps(pz + i);
+        __m128 w = _mm_load_ps(size + i);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&positionSize[i].x, x);
+        _mm_storeu_ps(&positionSize[i + 1].x, y);
+        _mm_storeu_ps(&positionSize[i + 2].x, z);
+        _mm_storeu_ps(&positionSize[i + 3].x, w);
+
+        __m128 fade = _mm_sub_ps(_mm_set1_ps(1.0f),
+                _mm_div_ps(_mm_load_ps(age + i), _mm_load_ps(lifetime + i)));
+        __m128i c = _mm_load_si128((const __m128i *)(color + i));
+        __m128 alpha = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(c, 24)), fade);
+        // Rounded half up like the scalar tail, not to even by cvtps
+        c = _mm_or_si128(_mm_and_si128(c, rgb),
+                _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(alpha, _mm_set1_ps(0.5f))), 24));
+        _mm_storeu_si128((__m128i *)(packed + i), c);
+    }
+#endif
+    for (; i < count; i++) {
+        positionSize[i] = glm::vec4(px[i], py[i], pz[i], size[i]);
+        float alpha = (float)(color[i] >> 24) * (1.0f - age[i] / lifetime[i]);
+        packed[i] = (color[i] & 0x00FFFFFF) | ((glm::uint32)(alpha + 0.5f) << 24);
+    }
+}
+
+size_t ParticleSystem::writeInstances(const ParticleInstances &out,
+        ThreadPool *pool) const {
+    // Destination of each chunk, the last ones clipped to the capacity
+    std::vector<size_t> first(live.size() + 1, 0);
+    for (size_t c = 0; c < live.size(); c++)
+        first[c + 1] = std::min(out.capacity, first[c] + live[c]);
+
+    auto task = [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++)
+            writeChunk(c, first[c], first[c + 1] - first[c], out);
+    };
+    if (pool)
+        pool->parallelFor(live.size(), PARTICLE_GRAIN, task);
+    else
+        task(0, live.size());
+    return first[live.size()];
+}
+
+void ParticleSystem::sortSpatially(MortonSort &sorter, ThreadPool *pool) {
+    if (!total)
+        return;
+
+    // Live particles gathered densely, with the slot each came from
+    std::vector<glm::vec3> positions(total);
+    std::vector<unsigned> slots(total);
+    size_t k = 0;
+    for (size_t c = 0; c < live.size(); c++) {
+        size_t base = c * PARTICLE_CHUNK;
+        for (unsigned i = 0; i < live[c]; i++, k++) {
+            positions[k] = glm::vec3(streams[POSITION_X][base + i],
+                    streams[POSITION_Y][base + i], streams[POSITION_Z][base + i]);
+            slots[k] = (unsigned)(base + i);
+        }
+    }
+    sorter.sort(&positions[0].x, 3, total, pool);
+    sorter.apply(&slots[0], pool);
+
+    // Particle k along the curve moves to slot k: full chunks, then one
+    // partial chunk. Slots past the new live counts keep stale numbers.
+    std::vector<float> moved(total);
+    for (int s = 0; s < FLOAT_STREAMS; s++) {
+        const float *from = streams[s];
+        auto task = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                moved[i] = from[slots[i]];
+        };
+        if (pool)
+            pool->parallelFor(total, PARTICLE_CHUNK, task);
+        else
+            task(0, total);
+        memcpy(streams[s], &moved[0], total * sizeof(float));
+    }
+    std::vector<glm::uint32> movedColors(total);
+    for (size_t i = 0; i < total; i++)
+        movedColors[i] = colors[slots[i]];
+    memcpy(colors, &movedColors[0], total * sizeof(glm::uint32));
+
+    for (size_t c = 0; c < live.size(); c++) {
+        size_t first = std::min(total, c * PARTICLE_CHUNK);
+        live[c] = (unsigned)std::min(PARTICLE_CHUNK, total - first);
+    }
+}
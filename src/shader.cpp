@@ -3,37 +3,28 @@
 #include <glad/glad.h>
 
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath) {
+    compile(vertexPath, fragmentPath, ShaderDefines());
+}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath,
+        const ShaderDefines &defines) {
+    compile(vertexPath, fragmentPath, defines);
+}
+
+void Shader::compile(const char* vertexPath, const char* fragmentPath,
+        const ShaderDefines &defines) {
 
     programID = 0;
 
     std::string vertexCode;
     std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-    try {
-        std::stringstream vShaderStream;
-        std::stringstream fShaderStream;
-
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        vShaderFile.close();
-        fShaderFile.close();
+    ShaderPreprocessor preprocessor(defines);
 
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-
-    } catch(std::ifstream::failure e) {
+    if (!preprocessor.process(vertexPath, vertexCode)
+            || !preprocessor.process(fragmentPath, fragmentCode)) {
         std::cout << "ERROR::SHADER::FILE_READ_FAILED" << std::endl;
         return;
     }
@@ -112,6 +103,26 @@ void Shader::setVec3(const char* name, glm::vec3 value) const {
     glUniform3fv(location, 1, glm::value_ptr(value));
 }
 
+Shader &ShaderVariantCache::get(const char* vertexPath,
+        const char* fragmentPath, const ShaderDefines &defines) {
+    std::string key =
+        ShaderPreprocessor::variantKey(vertexPath, fragmentPath, defines);
+
+    std::map<std::string, Shader>::iterator it = variants.find(key);
+    if (it == variants.end()) { // compile only what is actually requested
+        it = variants.insert(std::make_pair(key,
+                    Shader(vertexPath, fragmentPath, defines))).first;
+    }
+    return it->second;
+}
+
+void ShaderVariantCache::clear() {
+    std::map<std::string, Shader>::iterator it;
+    for (it = variants.begin(); it != variants.end(); ++it)
+        glDeleteProgram(it->second.programID);
+    variants.clear();
+}
+
 /* for test ...
 int main() {
     Shader shader("src/vertex_shader.vs", "src/fragment_shader.fs");
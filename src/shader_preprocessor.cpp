@@ -0,0 +1,103 @@
+#include "shader_preprocessor.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+static const int MAX_INCLUDE_DEPTH = 16;
+
+ShaderPreprocessor::ShaderPreprocessor(const ShaderDefines &defines)
+    : defines(defines) {
+}
+
+bool ShaderPreprocessor::process(const char* path, std::string &output) {
+    output.clear();
+    includeStack.clear();
+    return expand(path, 0, output);
+}
+
+static std::string directoryOf(const std::string &path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+static bool startsWith(const std::string &line, size_t pos, const char* word) {
+    return line.compare(pos, std::char_traits<char>::length(word), word) == 0;
+}
+
+bool ShaderPreprocessor::expand(const std::string &path, int depth,
+        std::string &output) {
+    if (depth > MAX_INCLUDE_DEPTH || includeStack.count(path)) {
+        std::cout << "ERROR::SHADER::RECURSIVE_INCLUDE: " << path << std::endl;
+        return false;
+    }
+
+    std::ifstream file(path.c_str());
+    if (!file.is_open()) {
+        std::cout << "ERROR::SHADER::FILE_READ_FAILED: " << path << std::endl;
+        return false;
+    }
+
+    includeStack.insert(path);
+
+    bool definesInjected = (depth > 0);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t pos = line.find_first_not_of(" \t");
+
+        if (pos != std::string::npos && line[pos] == '#') {
+            pos = line.find_first_not_of(" \t", pos + 1);
+
+            if (pos != std::string::npos && startsWith(line, pos, "include")) {
+                size_t first = line.find('"', pos);
+                size_t last = line.rfind('"');
+                if (first == std::string::npos || last <= first) {
+                    std::cout << "ERROR::SHADER::BAD_INCLUDE: " << path
+                        << ": " << line << std::endl;
+                    includeStack.erase(path);
+                    return false;
+                }
+                std::string name = line.substr(first + 1, last - first - 1);
+                if (!expand(directoryOf(path) + name, depth + 1, output)) {
+                    includeStack.erase(path);
+                    return false;
+                }
+                continue;
+            }
+
+            if (!definesInjected && pos != std::string::npos
+                    && startsWith(line, pos, "version")) {
+                output += line + "\n";
+                for (ShaderDefines::const_iterator it = defines.begin();
+                        it != defines.end(); ++it)
+                    output += "#define " + it->first + " " + it->second + "\n";
+                definesInjected = true;
+                continue;
+            }
+        }
+
+        output += line + "\n";
+    }
+
+    if (!definesInjected) { // no #version line, put defines on top
+        std::string header;
+        for (ShaderDefines::const_iterator it = defines.begin();
+                it != defines.end(); ++it)
+            header += "#define " + it->first + " " + it->second + "\n";
+        output.insert(0, header);
+    }
+
+    includeStack.erase(path);
+    return true;
+}
+
+std::string ShaderPreprocessor::variantKey(const char* vertexPath,
+        const char* fragmentPath, const ShaderDefines &defines) {
+    std::string text;
+    text += vertexPath; text += '\0';
+    text += fragmentPath; text += '\0';
+    for (ShaderDefines::const_iterator it = defines.begin();
+            it != defines.end(); ++it)
+        text += it->first + "=" + it->second + "\n";
+    return text;
+}
@@ -0,0 +1,312 @@
+#include "skinning.h"
+
+#include "glm/gtc/quaternion.hpp"
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include "glm/simd/geometric.h"
+#endif
+
+// Vertices per task handed to the thread pool
+static const size_t SKIN_GRAIN = 4096;
+
+void skinWorldTransforms(const Skeleton &skeleton, const LocalPose &pose,
+        std::vector<glm::affine> &world) {
+    size_t joints = skeleton.parents.size();
+    world.resize(joints);
+    for (size_t j = 0; j < joints; j++) {
+        glm::mat3 linear = glm::mat3_cast(pose.rotations[j]);
+        linear[0] *= pose.scales[j].x;
+        linear[1] *= pose.scales[j].y;
+        linear[2] *= pose.scales[j].z;
+        glm::affine local(linear, pose.translations[j]);
+
+        int parent = skeleton.parents[j];
+        world[j] = parent < 0 ? local : world[parent] * local;
+    }
+}
+
+void skinLinearPalette(const Skeleton &skeleton,
+        const std::vector<glm::affine> &world,
+        std::vector<glm::affine> &palette) {
+    palette.resize(world.size());
+    for (size_t j = 0; j < world.size(); j++)
+        palette[j] = world[j] * skeleton.inverseBind[j];
+}
+
+void skinDualQuatPalette(const Skeleton &skeleton,
+        const std::vector<glm::affine> &world,
+        std::vector<glm::dualquat> &palette) {
+    palette.resize(world.size());
+    for (size_t j = 0; j < world.size(); j++) {
+        glm::affine m = world[j] * skeleton.inverseBind[j];
+        glm::mat3 linear(
+            glm::vec3(m.row[0].x, m.row[1].x, m.row[2].x),
+            glm::vec3(m.row[0].y, m.row[1].y, m.row[2].y),
+            glm::vec3(m.row[0].z, m.row[1].z, m.row[2].z));
+        linear[0] = glm::normalize(linear[0]);
+        linear[1] = glm::normalize(linear[1]);
+        linear[2] = glm::normalize(linear[2]);
+        glm::quat rotation = glm::normalize(glm::quat_cast(linear));
+        palette[j] = glm::dualquat(rotation,
+                glm::vec3(m.row[0].w, m.row[1].w, m.row[2].w));
+    }
+}
+
+static inline float *skinPosition(const SkinTarget &target, size_t i) {
+    return (float *)((char *)target.data + i * target.stride);
+}
+
+static inline float *skinNormal(const SkinTarget &target, size_t i) {
+    return (float *)((char *)target.data + i * target.stride + target.normalOffset);
+}
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+static inline __m128 skinMadd(__m128 a, __m128 b, __m128 c) {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+/* x, y and z of v, without touching the fourth float */
+static inline void skinStore3(float *dst, __m128 v) {
+    _mm_storel_pi((__m64 *)dst, v);
+    _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+}
+
+static inline __m128 skinNormalize3(__m128 v) {
+    __m128 sq = _mm_mul_ps(v, v);
+    __m128 sum = _mm_add_ss(_mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1))),
+            _mm_movehl_ps(sq, sq));
+    __m128 len = _mm_sqrt_ss(sum);
+    return _mm_div_ps(v, _mm_shuffle_ps(len, len, _MM_SHUFFLE(0, 0, 0, 0)));
+}
+
+static void skinLinearRange(const SkinSource &source,
+        const glm::affine *palette, const SkinTarget &target,
+        size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        const glm::u16vec4 &joints = source.joints[i];
+        const glm::vec4 &weights = source.weights[i];
+        const float *m0 = &palette[joints.x].row[0].x;
+        const float *m1 = &palette[joints.y].row[0].x;
+        const float *m2 = &palette[joints.z].row[0].x;
+        const float *m3 = &palette[joints.w].row[0].x;
+
+        // Weighted sum of the four 3 x 4 matrices
+        __m128 r0, r1, r2;
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+        __m256 w0 = _mm256_set1_ps(weights.x);
+        __m256 w1 = _mm256_set1_ps(weights.y);
+        __m256 w2 = _mm256_set1_ps(weights.z);
+        __m256 w3 = _mm256_set1_ps(weights.w);
+#if defined(__FMA__)
+        __m256 r01 = _mm256_mul_ps(w0, _mm256_loadu_ps(m0));
+        r01 = _mm256_fmadd_ps(w1, _mm256_loadu_ps(m1), r01);
+        r01 = _mm256_fmadd_ps(w2, _mm256_loadu_ps(m2), r01);
+        r01 = _mm256_fmadd_ps(w3, _mm256_loadu_ps(m3), r01);
+#else
+        __m256 r01 = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(w0, _mm256_loadu_ps(m0)), _mm256_mul_ps(w1, _mm256_loadu_ps(m1))),
+                _mm256_add_ps(_mm256_mul_ps(w2, _mm256_loadu_ps(m2)), _mm256_mul_ps(w3, _mm256_loadu_ps(m3))));
+#endif
+        r0 = _mm256_castps256_ps128(r01);
+        r1 = _mm256_extractf128_ps(r01, 1);
+        r2 = _mm_mul_ps(_mm256_castps256_ps128(w0), _mm_loadu_ps(m0 + 8));
+        r2 = skinMadd(_mm256_castps256_ps128(w1), _mm_loadu_ps(m1 + 8), r2);
+        r2 = skinMadd(_mm256_castps256_ps128(w2), _mm_loadu_ps(m2 + 8), r2);
+        r2 = skinMadd(_mm256_castps256_ps128(w3), _mm_loadu_ps(m3 + 8), r2);
+#else
+        __m128 w0 = _mm_set1_ps(weights.x);
+        __m128 w1 = _mm_set1_ps(weights.y);
+        __m128 w2 = _mm_set1_ps(weights.z);
+        __m128 w3 = _mm_set1_ps(weights.w);
+        r0 = _mm_mul_ps(w0, _mm_loadu_ps(m0));
+        r1 = _mm_mul_ps(w0, _mm_loadu_ps(m0 + 4));
+        r2 = _mm_mul_ps(w0, _mm_loadu_ps(m0 + 8));
+        r0 = skinMadd(w1, _mm_loadu_ps(m1), r0);
+        r1 = skinMadd(w1, _mm_loadu_ps(m1 + 4), r1);
+        r2 = skinMadd(w1, _mm_loadu_ps(m1 + 8), r2);
+        r0 = skinMadd(w2, _mm_loadu_ps(m2), r0);
+        r1 = skinMadd(w2, _mm_loadu_ps(m2 + 4), r1);
+        r2 = skinMadd(w2, _mm_loadu_ps(m2 + 8), r2);
+        r0 = skinMadd(w3, _mm_loadu_ps(m3), r0);
+        r1 = skinMadd(w3, _mm_loadu_ps(m3 + 4), r1);
+        r2 = skinMadd(w3, _mm_loadu_ps(m3 + 8), r2);
+#endif
+
+        // Rows to columns, shared by the position and the normal
+        __m128 c3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(r0, r1, r2, c3);
+
+        const glm::vec3 &p = source.positions[i];
+        __m128 position = skinMadd(r0, _mm_set1_ps(p.x),
+                skinMadd(r1, _mm_set1_ps(p.y), skinMadd(r2, _mm_set1_ps(p.z), c3)));
+        skinStore3(skinPosition(target, i), position);
+
+        if (source.normals) {
+            const glm::vec3 &n = source.normals[i];
+            __m128 normal = skinMadd(r0, _mm_set1_ps(n.x),
+                    skinMadd(r1, _mm_set1_ps(n.y), _mm_mul_ps(r2, _mm_set1_ps(n.z))));
+            skinStore3(skinNormal(target, i), skinNormalize3(normal));
+        }
+    }
+}
+
+static void skinDualQuatRange(const SkinSource &source,
+        const glm::dualquat *palette, const SkinTarget &target,
+        size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        const glm::u16vec4 &joints = source.joints[i];
+        const glm::dualquat &q0 = palette[joints.x];
+        const glm::dualquat &q1 = palette[joints.y];
+        const glm::dualquat &q2 = palette[joints.z];
+        const glm::dualquat &q3 = palette[joints.w];
+        __m128 real0 = _mm_loadu_ps(&q0.real.x);
+        __m128 real1 = _mm_loadu_ps(&q1.real.x);
+        __m128 real2 = _mm_loadu_ps(&q2.real.x);
+        __m128 real3 = _mm_loadu_ps(&q3.real.x);
+
+        // Blend in the hemisphere of the first influence: the four dot
+        // products with its real part give the sign of each weight
+        __m128 d0 = _mm_mul_ps(real0, real0);
+        __m128 d1 = _mm_mul_ps(real0, real1);
+        __m128 d2 = _mm_mul_ps(real0, real2);
+        __m128 d3 = _mm_mul_ps(real0, real3);
+        _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+        __m128 dots = _mm_add_ps(_mm_add_ps(d0, d1), _mm_add_ps(d2, d3));
+        __m128 w = _mm_xor_ps(_mm_loadu_ps(&source.weights[i].x),
+                _mm_and_ps(dots, _mm_set1_ps(-0.0f)));
+        __m128 w0 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 w1 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 w2 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 2, 2));
+        __m128 w3 = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m128 real = _mm_mul_ps(w0, real0);
+        __m128 dual = _mm_mul_ps(w0, _mm_loadu_ps(&q0.dual.x));
+        real = skinMadd(w1, real1, real);
+        dual = skinMadd(w1, _mm_loadu_ps(&q1.dual.x), dual);
+        real = skinMadd(w2, real2, real);
+        dual = skinMadd(w2, _mm_loadu_ps(&q2.dual.x), dual);
+        real = skinMadd(w3, real3, real);
+        dual = skinMadd(w3, _mm_loadu_ps(&q3.dual.x), dual);
+
+        // Normalize by the length of the real part
+        __m128 rsq = _mm_mul_ps(real, real);
+        rsq = _mm_add_ps(rsq, _mm_shuffle_ps(rsq, rsq, _MM_SHUFFLE(2, 3, 0, 1)));
+        rsq = _mm_add_ps(rsq, _mm_shuffle_ps(rsq, rsq, _MM_SHUFFLE(1, 0, 3, 2)));
+        __m128 scale = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(rsq));
+        real = _mm_mul_ps(real, scale);
+        dual = _mm_mul_ps(dual, scale);
+
+        // Translation 2 * (rw * dv - dw * rv + rv x dv)
+        __m128 rw = _mm_shuffle_ps(real, real, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128 dw = _mm_shuffle_ps(dual, dual, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128 two = _mm_set1_ps(2.0f);
+        __m128 translation = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dual), _mm_mul_ps(dw, real)),
+                glm_vec4_cross(real, dual));
+        translation = _mm_mul_ps(two, translation);
+
+        // Rotation v + 2 * rv x (rv x v + rw * v)
+        const glm::vec3 &p = source.positions[i];
+        __m128 pv = _mm_setr_ps(p.x, p.y, p.z, 0.0f);
+        __m128 pt = skinMadd(rw, pv, glm_vec4_cross(real, pv));
+        __m128 position = _mm_add_ps(skinMadd(two, glm_vec4_cross(real, pt), pv), translation);
+        skinStore3(skinPosition(target, i), position);
+
+        if (source.normals) {
+            const glm::vec3 &n = source.normals[i];
+            __m128 nv = _mm_setr_ps(n.x, n.y, n.z, 0.0f);
+            __m128 nt = skinMadd(rw, nv, glm_vec4_cross(real, nv));
+            __m128 normal = skinMadd(two, glm_vec4_cross(real, nt), nv);
+            skinStore3(skinNormal(target, i), skinNormalize3(normal));
+        }
+    }
+}
+
+#else
+
+static inline void skinStore3(float *dst, const glm::vec3 &v) {
+    dst[0] = v.x;
+    dst[1] = v.y;
+    dst[2] = v.z;
+}
+
+static void skinLinearRange(const SkinSource &source,
+        const glm::affine *palette, const SkinTarget &target,
+        size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        const glm::u16vec4 &joints = source.joints[i];
+        const glm::vec4 &weights = source.weights[i];
+        glm::affine m(glm::uninitialize);
+        for (int r = 0; r < 3; r++)
+            m.row[r] = palette[joints.x].row[r] * weights.x
+                + palette[joints.y].row[r] * weights.y
+                + palette[joints.z].row[r] * weights.z
+                + palette[joints.w].row[r] * weights.w;
+
+        skinStore3(skinPosition(target, i), glm::transformPoint(m, source.positions[i]));
+        if (source.normals)
+            skinStore3(skinNormal(target, i),
+                    glm::normalize(glm::transformVector(m, source.normals[i])));
+    }
+}
+
+static void skinDualQuatRange(const SkinSource &source,
+        const glm::dualquat *palette, const SkinTarget &target,
+        size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        const glm::u16vec4 &joints = source.joints[i];
+        const glm::vec4 &weights = source.weights[i];
+        const glm::quat &pivot = palette[joints.x].real;
+
+        glm::dualquat b(glm::quat(0.0f, 0.0f, 0.0f, 0.0f), glm::quat(0.0f, 0.0f, 0.0f, 0.0f));
+        for (int k = 0; k < 4; k++) {
+            const glm::dualquat &q = palette[joints[k]];
+            float w = glm::dot(pivot, q.real) < 0.0f ? -weights[k] : weights[k];
+            b.real = b.real + q.real * w;
+            b.dual = b.dual + q.dual * w;
+        }
+        b = glm::normalize(b);
+
+        glm::vec3 rv(b.real.x, b.real.y, b.real.z);
+        glm::vec3 dv(b.dual.x, b.dual.y, b.dual.z);
+        glm::vec3 translation = 2.0f * (b.real.w * dv - b.dual.w * rv + glm::cross(rv, dv));
+
+        const glm::vec3 &p = source.positions[i];
+        glm::vec3 position = p + 2.0f * glm::cross(rv, glm::cross(rv, p) + b.real.w * p) + translation;
+        skinStore3(skinPosition(target, i), position);
+
+        if (source.normals) {
+            const glm::vec3 &n = source.normals[i];
+            glm::vec3 normal = n + 2.0f * glm::cross(rv, glm::cross(rv, n) + b.real.w * n);
+            skinStore3(skinNormal(target, i), glm::normalize(normal));
+        }
+    }
+}
+
+#endif
+
+void skinLinear(const SkinSource &source, const glm::affine *palette,
+        const SkinTarget &target, ThreadPool *pool) {
+    if (!pool) {
+        skinLinearRange(source, palette, target, 0, source.count);
+        return;
+    }
+    pool->parallelFor(source.count, SKIN_GRAIN, [&](size_t begin, size_t end) {
+        skinLinearRange(source, palette, target, begin, end);
+    });
+}
+
+void skinDualQuat(const SkinSource &source, const glm::dualquat *palette,
+        const SkinTarget &target, ThreadPool *pool) {
+    if (!pool) {
+        skinDualQuatRange(source, palette, target, 0, source.count);
+        return;
+    }
+    pool->parallelFor(source.count, SKIN_GRAIN, [&](size_t begin, size_t end) {
+        skinDualQuatRange(source, palette, target, begin, end);
+    });
+}
@@ -0,0 +1,188 @@
+#include "skinning.h"
+#include "animation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* Skins a synthetic mesh with both methods and reports vertices per second
+ * on one thread and on the whole pool, after checking the results against
+ * a plain mat4 / dual quaternion reference to within BENCH_MAX_ERROR.
+ * Then times AnimationClip::sample on one thread for a crowd of
+ * BENCH_INSTANCES clips of BENCH_CLIP_JOINTS joints, with nlerp and slerp.
+ *
+ *   skinning_bench [vertices] [joints] [frames]
+ */
+
+static const float BENCH_MAX_ERROR = 1e-5f;
+static const unsigned BENCH_INSTANCES = 1000;
+static const unsigned BENCH_CLIP_JOINTS = 100;
+static const unsigned BENCH_CLIP_KEYS = 31;
+
+static float benchRandom() {
+    return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+struct BenchVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t vertices = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    unsigned joints = argc > 2 ? (unsigned)atoi(argv[2]) : 64;
+    int frames = argc > 3 ? atoi(argv[3]) : 20;
+
+    // A chain of joints with a random rest pose and one clip
+    srand(7);
+    Skeleton skeleton;
+    LocalPose bind(joints);
+    AnimationClip clip(joints, 1.0f);
+    for (unsigned j = 0; j < joints; j++) {
+        skeleton.parents.push_back((int)j - 1);
+        bind.translations[j] = glm::vec3(0.0f, 0.1f, 0.0f);
+        float times[2] = { 0.0f, 1.0f };
+        glm::quat keys[2] = {
+            glm::normalize(glm::quat(1.0f, 0.1f * benchRandom(), 0.1f * benchRandom(), 0.1f * benchRandom())),
+            glm::normalize(glm::quat(1.0f, 0.3f * benchRandom(), 0.3f * benchRandom(), 0.3f * benchRandom()))
+        };
+        clip.rotation.setKeys(j, times, keys, 2);
+    }
+    std::vector<glm::affine> world;
+    skinWorldTransforms(skeleton, bind, world);
+    for (unsigned j = 0; j < joints; j++)
+        skeleton.inverseBind.push_back(glm::inverse(world[j]));
+
+    std::vector<glm::vec3> positions(vertices);
+    std::vector<glm::vec3> normals(vertices);
+    std::vector<glm::u16vec4> influences(vertices);
+    std::vector<glm::vec4> weights(vertices);
+    for (size_t i = 0; i < vertices; i++) {
+        positions[i] = glm::vec3(benchRandom(), benchRandom() * joints * 0.1f, benchRandom());
+        normals[i] = glm::normalize(glm::vec3(benchRandom(), benchRandom(), benchRandom()));
+        unsigned base = (unsigned)rand() % joints;
+        influences[i] = glm::u16vec4(base, (base + 1) % joints, (base + 2) % joints, (base + 3) % joints);
+        glm::vec4 w(rand() % 100 + 1, rand() % 100, rand() % 50, rand() % 10);
+        weights[i] = w / (w.x + w.y + w.z + w.w);
+    }
+
+    SkinSource source;
+    source.positions = &positions[0];
+    source.normals = &normals[0];
+    source.joints = &influences[0];
+    source.weights = &weights[0];
+    source.count = vertices;
+
+    std::vector<BenchVertex> output(vertices);
+    SkinTarget target;
+    target.data = &output[0];
+    target.stride = sizeof(BenchVertex);
+    target.normalOffset = offsetof(BenchVertex, normal);
+
+    LocalPose pose = bind;
+    AnimationCursor cursor;
+    clip.initCursor(cursor);
+    clip.sample(0.5f, cursor, pose);
+    std::vector<glm::affine> linearPalette;
+    std::vector<glm::dualquat> dualPalette;
+    skinWorldTransforms(skeleton, pose, world);
+    skinLinearPalette(skeleton, world, linearPalette);
+    skinDualQuatPalette(skeleton, world, dualPalette);
+
+    // Validation against straightforward glm code
+    skinLinear(source, &linearPalette[0], target, NULL);
+    float linearError = 0.0f;
+    for (size_t i = 0; i < vertices; i += 97) {
+        glm::mat4 m(0.0f);
+        for (int k = 0; k < 4; k++)
+            m += glm::mat4_cast(linearPalette[influences[i][k]]) * weights[i][k];
+        glm::vec3 p(m * glm::vec4(positions[i], 1.0f));
+        glm::vec3 n = glm::normalize(glm::vec3(m * glm::vec4(normals[i], 0.0f)));
+        linearError = glm::max(linearError, glm::length(p - output[i].position));
+        linearError = glm::max(linearError, glm::length(n - output[i].normal));
+    }
+
+    skinDualQuat(source, &dualPalette[0], target, NULL);
+    float dualError = 0.0f;
+    for (size_t i = 0; i < vertices; i += 97) {
+        glm::dualquat b(glm::quat(0.0f, 0.0f, 0.0f, 0.0f), glm::quat(0.0f, 0.0f, 0.0f, 0.0f));
+        for (int k = 0; k < 4; k++) {
+            glm::dualquat q = dualPalette[influences[i][k]];
+            float w = glm::dot(dualPalette[influences[i][0]].real, q.real) < 0.0f ? -weights[i][k] : weights[i][k];
+            b = b + q * w;
+        }
+        b = glm::normalize(b);
+        glm::vec3 p = b * positions[i];
+        glm::vec3 n = glm::normalize(b.real * normals[i]);
+        dualError = glm::max(dualError, glm::length(p - output[i].position));
+        dualError = glm::max(dualError, glm::length(n - output[i].normal));
+    }
+
+    printf("%zu vertices, %u joints, max error linear %g dual quaternion %g\n",
+            vertices, joints, linearError, dualError);
+    if (!(linearError <= BENCH_MAX_ERROR && dualError <= BENCH_MAX_ERROR)) {
+        printf("FAIL: error above %g\n", BENCH_MAX_ERROR);
+        return 1;
+    }
+
+    ThreadPool &pool = ThreadPool::shared();
+    for (int method = 0; method < 2; method++) {
+        for (int threaded = 0; threaded < 2; threaded++) {
+            ThreadPool *run = threaded ? &pool : NULL;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int f = 0; f < frames; f++) {
+                if (method == 0)
+                    skinLinear(source, &linearPalette[0], target, run);
+                else
+                    skinDualQuat(source, &dualPalette[0], target, run);
+            }
+            double rate = vertices * (double)frames / benchSeconds(start);
+            unsigned threads = threaded ? pool.size() : 1;
+            printf("%-16s %2u thread(s): %8.1f M vertices/s, %7.1f M per core\n",
+                    method == 0 ? "linear blend" : "dual quaternion",
+                    threads, rate * 1e-6, rate * 1e-6 / threads);
+        }
+    }
+
+    // A crowd playing one clip at different times, every channel keyed
+    AnimationClip crowdClip(BENCH_CLIP_JOINTS, 1.0f);
+    for (unsigned j = 0; j < BENCH_CLIP_JOINTS; j++) {
+        float times[BENCH_CLIP_KEYS];
+        glm::vec3 translations[BENCH_CLIP_KEYS], scales[BENCH_CLIP_KEYS];
+        glm::quat rotations[BENCH_CLIP_KEYS];
+        for (unsigned k = 0; k < BENCH_CLIP_KEYS; k++) {
+            times[k] = k / (float)(BENCH_CLIP_KEYS - 1);
+            translations[k] = glm::vec3(benchRandom(), benchRandom(), benchRandom()) * 0.1f;
+            scales[k] = glm::vec3(1.0f + 0.1f * benchRandom());
+            rotations[k] = glm::normalize(glm::quat(1.0f, 0.5f * benchRandom(),
+                    0.5f * benchRandom(), 0.5f * benchRandom()));
+        }
+        crowdClip.translation.setKeys(j, times, translations, BENCH_CLIP_KEYS);
+        crowdClip.rotation.setKeys(j, times, rotations, BENCH_CLIP_KEYS);
+        crowdClip.scale.setKeys(j, times, scales, BENCH_CLIP_KEYS);
+    }
+    std::vector<AnimationCursor> cursors(BENCH_INSTANCES);
+    std::vector<LocalPose> poses(BENCH_INSTANCES, LocalPose(BENCH_CLIP_JOINTS));
+    for (unsigned i = 0; i < BENCH_INSTANCES; i++)
+        crowdClip.initCursor(cursors[i]);
+
+    double sampleTime[2];
+    for (int mode = 0; mode < 2; mode++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++)
+            for (unsigned i = 0; i < BENCH_INSTANCES; i++)
+                crowdClip.sample(crowdClip.wrap(f / 60.0f + i * 0.37f), cursors[i], poses[i],
+                        mode ? ANIMATION_SLERP : ANIMATION_NLERP);
+        sampleTime[mode] = benchSeconds(start) / frames;
+    }
+    printf("%u instances of %u joints, %u keys per track: sample nlerp %.2f ms, slerp %.2f ms "
+            "per frame on 1 thread\n", BENCH_INSTANCES, BENCH_CLIP_JOINTS, BENCH_CLIP_KEYS,
+            sampleTime[0] * 1e3, sampleTime[1] * 1e3);
+    return 0;
+}
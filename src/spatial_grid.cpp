@@ -0,0 +1,389 @@
+#include "spatial_grid.h"
+
+#include "glm/gtx/hash.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include "glm/simd/lanes.h"
+
+#if (GLM_ARCH & GLM_ARCH_AVX512_BIT) && (GLM_ARCH & GLM_ARCH_X86_BIT)
+typedef glm::detail::simd_lanes<16> GridLanes;
+#elif GLM_ARCH & GLM_ARCH_AVX2_BIT
+typedef glm::detail::simd_lanes<8> GridLanes;
+#else
+typedef glm::detail::simd_lanes<4> GridLanes;
+#endif
+static const int SPATIAL_GRID_LANES = GridLanes::size;
+#else
+static const int SPATIAL_GRID_LANES = 1;
+#endif
+
+static const glm::uint64 SPATIAL_GRID_EMPTY = ~0ull;
+
+// Buckets are picked by the top bits of the cell hash
+static const int SPATIAL_GRID_BUCKET_BITS = 8;
+static const size_t SPATIAL_GRID_BUCKETS = (size_t)1 << SPATIAL_GRID_BUCKET_BITS;
+
+// Cell coordinates are packed 21 bits each
+static const int SPATIAL_GRID_WRAP = 1 << 21;
+
+// Points per task of the parallel passes of build(), buckets per task of
+// the fill pass
+static const size_t SPATIAL_GRID_GRAIN = 16384;
+static const size_t SPATIAL_GRID_BUCKET_GRAIN = 4;
+
+static void spatialGridRun(ThreadPool *pool, size_t count, size_t grain,
+        const ThreadPool::Task &task) {
+    if (pool)
+        pool->parallelFor(count, grain, task);
+    else
+        task(0, count);
+}
+
+static glm::ivec3 spatialGridCell(glm::vec3 p, float inverseSize) {
+    return glm::ivec3(glm::floor(p * inverseSize));
+}
+
+/* Cells a multiple of 2^21 apart share key and hash, so they share a slot */
+static glm::ivec3 spatialGridWrap(glm::ivec3 cell) {
+    return cell & glm::ivec3(SPATIAL_GRID_WRAP - 1);
+}
+
+static glm::uint64 spatialGridKey(glm::ivec3 wrapped) {
+    return (glm::uint64)wrapped.x << 42 | (glm::uint64)wrapped.y << 21
+        | (glm::uint64)wrapped.z;
+}
+
+static glm::uint64 spatialGridHash(glm::ivec3 wrapped) {
+    // std::hash of gtx_hash combines the coordinates without a final mix,
+    // the table needs every bit to depend on all of them
+    glm::uint64 h = std::hash<glm::ivec3>()(wrapped);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    return h ^ (h >> 33);
+}
+
+/* First slot to probe within a bucket of n slots */
+static size_t spatialGridHome(unsigned hash, size_t n) {
+    return (size_t)((glm::uint64)hash * n >> 32);
+}
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : size(cellSize), inverseSize(1.0f / cellSize), total(0), cells(0),
+      cellLo(0), cellHi(-1) {}
+
+const SpatialGrid::Slot *SpatialGrid::find(glm::ivec3 cell) const {
+    if (table.empty())
+        return NULL;
+    glm::ivec3 wrapped = spatialGridWrap(cell);
+    glm::uint64 key = spatialGridKey(wrapped);
+    glm::uint64 hash = spatialGridHash(wrapped);
+    size_t bucket = (size_t)(hash >> (64 - SPATIAL_GRID_BUCKET_BITS));
+    const Slot *slots = &table[slotStart[bucket]];
+    size_t n = slotStart[bucket + 1] - slotStart[bucket];
+    for (size_t s = spatialGridHome((unsigned)hash, n); slots[s].key != SPATIAL_GRID_EMPTY;
+            s = s + 1 == n ? 0 : s + 1)
+        if (slots[s].key == key)
+            return &slots[s];
+    return NULL;
+}
+
+/* Inserts the cells of one bucket, then lays its points out cell by cell
+ * in the range the bucket owns. Returns the number of cells. */
+size_t SpatialGrid::fillBucket(size_t bucket) {
+    Slot *slots = &table[slotStart[bucket]];
+    size_t n = slotStart[bucket + 1] - slotStart[bucket];
+    for (size_t s = 0; s < n; s++) {
+        slots[s].key = SPATIAL_GRID_EMPTY;
+        slots[s].count = 0;
+    }
+
+    // The hash is not needed once the point has a slot, it keeps the slot
+    size_t used = 0;
+    for (unsigned j = bucketStart[bucket]; j < bucketStart[bucket + 1]; j++) {
+        Staged &point = staged[j];
+        glm::uint64 key = spatialGridKey(spatialGridWrap(spatialGridCell(point.position, inverseSize)));
+        size_t s = spatialGridHome(point.hash, n);
+        while (slots[s].key != SPATIAL_GRID_EMPTY && slots[s].key != key)
+            s = s + 1 == n ? 0 : s + 1;
+        if (slots[s].key == SPATIAL_GRID_EMPTY) {
+            slots[s].key = key;
+            used++;
+        }
+        slots[s].count++;
+        point.hash = (unsigned)s;
+    }
+
+    unsigned next = bucketStart[bucket];
+    for (size_t s = 0; s < n; s++) {
+        slots[s].begin = next;
+        next += slots[s].count;
+        slots[s].count = 0;
+    }
+
+    for (unsigned j = bucketStart[bucket]; j < bucketStart[bucket + 1]; j++) {
+        const Staged &point = staged[j];
+        Slot &slot = slots[point.hash];
+        unsigned at = slot.begin + slot.count++;
+        xs[at] = point.position.x;
+        ys[at] = point.position.y;
+        zs[at] = point.position.z;
+        ids[at] = point.id;
+    }
+    return used;
+}
+
+void SpatialGrid::build(const glm::vec3 *points, size_t count,
+        ThreadPool *pool) {
+    const size_t B = SPATIAL_GRID_BUCKETS;
+    size_t chunks = (count + SPATIAL_GRID_GRAIN - 1) / SPATIAL_GRID_GRAIN;
+    total = count;
+    staged.resize(count);
+    histograms.assign(chunks * B, 0);
+    chunkCells.assign(chunks * B, 0);
+    std::vector<glm::ivec3> chunkLo(chunks, glm::ivec3(INT_MAX));
+    std::vector<glm::ivec3> chunkHi(chunks, glm::ivec3(INT_MIN));
+
+    // Bucket histogram of every chunk, and the distinct cells the chunk
+    // brings to each bucket, found with a set of the chunk's cell keys
+    spatialGridRun(pool, chunks, 1, [&](size_t begin, size_t end) {
+        const size_t S = 2 * SPATIAL_GRID_GRAIN;
+        std::vector<glm::uint64> seen(S);
+        for (size_t c = begin; c < end; c++) {
+            std::fill(seen.begin(), seen.end(), SPATIAL_GRID_EMPTY);
+            unsigned *histogram = &histograms[c * B];
+            unsigned *cellCount = &chunkCells[c * B];
+            size_t last = std::min(count, (c + 1) * SPATIAL_GRID_GRAIN);
+            for (size_t i = c * SPATIAL_GRID_GRAIN; i < last; i++) {
+                glm::ivec3 cell = spatialGridCell(points[i], inverseSize);
+                glm::ivec3 wrapped = spatialGridWrap(cell);
+                glm::uint64 hash = spatialGridHash(wrapped);
+                glm::uint64 key = spatialGridKey(wrapped);
+                size_t b = (size_t)(hash >> (64 - SPATIAL_GRID_BUCKET_BITS));
+                histogram[b]++;
+                size_t s = (size_t)hash & (S - 1);
+                while (seen[s] != SPATIAL_GRID_EMPTY && seen[s] != key)
+                    s = (s + 1) & (S - 1);
+                if (seen[s] == SPATIAL_GRID_EMPTY) {
+                    seen[s] = key;
+                    cellCount[b]++;
+                }
+                chunkLo[c] = glm::min(chunkLo[c], cell);
+                chunkHi[c] = glm::max(chunkHi[c], cell);
+            }
+        }
+    });
+
+    // Bucket major prefix sum: each chunk gets its own run in every bucket.
+    // The cells of a bucket are at most the sum of the chunks' distinct
+    // cells, which keeps the load factor of every bucket under 0.8.
+    bucketStart.resize(B + 1);
+    slotStart.resize(B + 1);
+    unsigned next = 0;
+    size_t slots = 0;
+    for (size_t b = 0; b < B; b++) {
+        bucketStart[b] = next;
+        slotStart[b] = slots;
+        size_t bound = 0;
+        for (size_t c = 0; c < chunks; c++) {
+            unsigned n = histograms[c * B + b];
+            histograms[c * B + b] = next;
+            next += n;
+            bound += chunkCells[c * B + b];
+        }
+        slots += bound + bound / 4 + 16;
+    }
+    bucketStart[B] = next;
+    slotStart[B] = slots;
+    cellLo = glm::ivec3(INT_MAX);
+    cellHi = glm::ivec3(INT_MIN);
+    for (size_t c = 0; c < chunks; c++) {
+        cellLo = glm::min(cellLo, chunkLo[c]);
+        cellHi = glm::max(cellHi, chunkHi[c]);
+    }
+
+    spatialGridRun(pool, chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            unsigned *cursor = &histograms[c * B];
+            size_t last = std::min(count, (c + 1) * SPATIAL_GRID_GRAIN);
+            for (size_t i = c * SPATIAL_GRID_GRAIN; i < last; i++) {
+                // Hashing again is cheaper than a pass over stored hashes
+                glm::uint64 hash = spatialGridHash(spatialGridWrap(spatialGridCell(points[i], inverseSize)));
+                Staged &point = staged[cursor[hash >> (64 - SPATIAL_GRID_BUCKET_BITS)]++];
+                point.position = points[i];
+                point.hash = (unsigned)hash;
+                point.id = (unsigned)i;
+            }
+        }
+    });
+
+    table.resize(slots);
+    xs.resize(count + SPATIAL_GRID_LANES);
+    ys.resize(count + SPATIAL_GRID_LANES);
+    zs.resize(count + SPATIAL_GRID_LANES);
+    ids.resize(count);
+
+    std::vector<size_t> used(B);
+    spatialGridRun(pool, B, SPATIAL_GRID_BUCKET_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++)
+            used[b] = fillBucket(b);
+    });
+    cells = 0;
+    for (size_t b = 0; b < B; b++)
+        cells += used[b];
+}
+
+template <typename Visit>
+void SpatialGrid::visitCells(glm::vec3 lo, glm::vec3 hi, Visit visit) const {
+    if (!total)
+        return;
+    // Only the cells the points span, and each wrapped cell once
+    glm::ivec3 first = glm::max(spatialGridCell(lo, inverseSize), cellLo);
+    glm::ivec3 last = glm::min(glm::min(spatialGridCell(hi, inverseSize), cellHi),
+            first + (SPATIAL_GRID_WRAP - 1));
+    for (int z = first.z; z <= last.z; z++)
+        for (int y = first.y; y <= last.y; y++)
+            for (int x = first.x; x <= last.x; x++) {
+                const Slot *slot = find(glm::ivec3(x, y, z));
+                if (slot)
+                    visit(slot->begin, slot->count);
+            }
+}
+
+/* Bits of the lanes of [begin, begin + n) that pass, i in
+ * [0, SPATIAL_GRID_LANES) of each group */
+#define SPATIAL_GRID_EMIT(mask, begin, i, n, out) \
+    for (int lane = 0; lane < SPATIAL_GRID_LANES && (mask); lane++) \
+        if (((mask) >> lane & 1) && (i) + lane < (n)) \
+            (out).push_back(ids[(begin) + (i) + lane])
+
+void SpatialGrid::querySphere(glm::vec3 center, float radius,
+        std::vector<unsigned> &out) const {
+    float r2 = radius * radius;
+    visitCells(center - radius, center + radius, [&](unsigned begin, unsigned n) {
+        for (unsigned i = 0; i < n; i += SPATIAL_GRID_LANES) {
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+            typedef GridLanes L;
+            L::vec dx = L::sub(L::load(&xs[begin + i]), L::set1(center.x));
+            L::vec dy = L::sub(L::load(&ys[begin + i]), L::set1(center.y));
+            L::vec dz = L::sub(L::load(&zs[begin + i]), L::set1(center.z));
+            L::vec d2 = L::add(L::add(L::mul(dx, dx), L::mul(dy, dy)), L::mul(dz, dz));
+            int mask = L::bits(L::le(d2, L::set1(r2)));
+#else
+            glm::vec3 d = glm::vec3(xs[begin + i], ys[begin + i], zs[begin + i]) - center;
+            int mask = glm::dot(d, d) <= r2;
+#endif
+            SPATIAL_GRID_EMIT(mask, begin, i, n, out);
+        }
+    });
+}
+
+void SpatialGrid::queryBox(glm::vec3 lo, glm::vec3 hi,
+        std::vector<unsigned> &out) const {
+    visitCells(lo, hi, [&](unsigned begin, unsigned n) {
+        for (unsigned i = 0; i < n; i += SPATIAL_GRID_LANES) {
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+            typedef GridLanes L;
+            L::vec x = L::load(&xs[begin + i]);
+            L::vec y = L::load(&ys[begin + i]);
+            L::vec z = L::load(&zs[begin + i]);
+            L::mask inside = L::mand(L::le(L::set1(lo.x), x), L::le(x, L::set1(hi.x)));
+            inside = L::mand(inside, L::mand(L::le(L::set1(lo.y), y), L::le(y, L::set1(hi.y))));
+            inside = L::mand(inside, L::mand(L::le(L::set1(lo.z), z), L::le(z, L::set1(hi.z))));
+            int mask = L::bits(inside);
+#else
+            glm::vec3 p(xs[begin + i], ys[begin + i], zs[begin + i]);
+            int mask = glm::all(glm::lessThanEqual(lo, p)) && glm::all(glm::lessThanEqual(p, hi));
+#endif
+            SPATIAL_GRID_EMIT(mask, begin, i, n, out);
+        }
+    });
+}
+
+#undef SPATIAL_GRID_EMIT
+
+size_t SpatialGrid::nearest(glm::vec3 p, size_t k, float maxDistance,
+        unsigned *indices, float *distances) const {
+    if (!k || !total)
+        return 0;
+
+    // Max-heap on the squared distance, the worst of the best k on top
+    std::vector<std::pair<float, unsigned> > best;
+    best.reserve(k);
+    float limit = maxDistance * maxDistance;
+    float threshold = limit;
+
+    glm::ivec3 center = spatialGridCell(p, inverseSize);
+    for (int r = 0; ; r++) {
+        // Points outside the r - 1 ring are at least gap away
+        if (r > 0) {
+            glm::vec3 lo = glm::vec3(center - (r - 1)) * size;
+            glm::vec3 hi = glm::vec3(center + r) * size;
+            glm::vec3 gap = glm::min(p - lo, hi - p);
+            float g = glm::max(0.0f, glm::min(glm::min(gap.x, gap.y), gap.z));
+            if (g * g > threshold)
+                break;
+            if (glm::all(glm::lessThanEqual(center - (r - 1), cellLo))
+                    && glm::all(glm::greaterThanEqual(center + (r - 1), cellHi)))
+                break;
+            // Further rings would reach wrapped cells already visited
+            if (2 * r - 1 >= SPATIAL_GRID_WRAP)
+                break;
+        }
+
+        // Cells of ring r: the whole rows on two faces, the ends elsewhere
+        for (int dz = -r; dz <= r; dz++)
+            for (int dy = -r; dy <= r; dy++) {
+                bool face = dz == -r || dz == r || dy == -r || dy == r;
+                for (int dx = -r; dx <= r; dx += face || r == 0 ? 1 : 2 * r) {
+                    const Slot *slot = find(center + glm::ivec3(dx, dy, dz));
+                    if (!slot)
+                        continue;
+                    for (unsigned i = 0; i < slot->count; i += SPATIAL_GRID_LANES) {
+                        unsigned at = slot->begin + i;
+                        float d2[SPATIAL_GRID_LANES];
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+                        typedef GridLanes L;
+                        L::vec x = L::sub(L::load(&xs[at]), L::set1(p.x));
+                        L::vec y = L::sub(L::load(&ys[at]), L::set1(p.y));
+                        L::vec z = L::sub(L::load(&zs[at]), L::set1(p.z));
+                        L::vec d = L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z));
+                        int mask = L::bits(L::le(d, L::set1(threshold)));
+                        if (!mask)
+                            continue;
+                        L::store(d2, d);
+#else
+                        glm::vec3 d = glm::vec3(xs[at], ys[at], zs[at]) - p;
+                        d2[0] = glm::dot(d, d);
+                        int mask = d2[0] <= threshold;
+#endif
+                        for (int lane = 0; lane < SPATIAL_GRID_LANES && i + lane < slot->count; lane++) {
+                            if (!(mask >> lane & 1) || d2[lane] > threshold)
+                                continue;
+                            if (best.size() == k) {
+                                std::pop_heap(best.begin(), best.end());
+                                best.pop_back();
+                            }
+                            best.push_back(std::make_pair(d2[lane], ids[at + lane]));
+                            std::push_heap(best.begin(), best.end());
+                            if (best.size() == k)
+                                threshold = std::min(limit, best.front().first);
+                        }
+                    }
+                }
+            }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    for (size_t i = 0; i < best.size(); i++) {
+        indices[i] = best[i].second;
+        if (distances)
+            distances[i] = glm::sqrt(best[i].first);
+    }
+    return best.size();
+}
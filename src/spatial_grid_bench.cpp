@@ -0,0 +1,172 @@
+#include "spatial_grid.h"
+
+#include "glm/gtx/random_batch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/* Moves points with random velocities inside a box, bouncing off its
+ * walls, and rebuilds a SpatialGrid every frame. Reports the rebuild time
+ * on one thread and on the pool, then sphere, box and nearest neighbour
+ * query rates, after checking a sample of queries against a loop over
+ * every point. Then builds clustered sets, all points in one cell and in 64
+ * cells, whose table must stay proportional to the occupied cells.
+ *
+ *   spatial_grid_bench [points] [frames] [queries]
+ */
+
+static const size_t BENCH_REFERENCE_QUERIES = 64;
+static const size_t BENCH_NEIGHBOURS = 8;
+static const float BENCH_BOX = 100.0f;
+static const size_t BENCH_CLUSTERS[] = { 1, 64 };
+
+static double benchSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void benchMove(std::vector<glm::vec3> &points, std::vector<glm::vec3> &velocities,
+        float dt) {
+    for (size_t i = 0; i < points.size(); i++) {
+        glm::vec3 p = points[i] + velocities[i] * dt;
+        for (int a = 0; a < 3; a++)
+            if (p[a] < -BENCH_BOX || p[a] > BENCH_BOX) {
+                velocities[i][a] = -velocities[i][a];
+                p[a] = glm::clamp(p[a], -BENCH_BOX, BENCH_BOX);
+            }
+        points[i] = p;
+    }
+}
+
+/* Sampled queries whose results differ from a loop over every point */
+static size_t benchCheck(const SpatialGrid &grid, const std::vector<glm::vec3> &points,
+        const std::vector<glm::vec3> &centers, float radius) {
+    size_t count = points.size(), queries = centers.size();
+    std::vector<unsigned> found;
+    unsigned neighbours[BENCH_NEIGHBOURS];
+    float distances[BENCH_NEIGHBOURS];
+    size_t mismatches = 0;
+    size_t stride = std::max<size_t>(1, queries / BENCH_REFERENCE_QUERIES);
+    for (size_t q = 0; q < queries; q += stride) {
+        glm::vec3 c = centers[q];
+        std::vector<unsigned> sphere, box;
+        std::vector<std::pair<float, unsigned> > all;
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 d = points[i] - c;
+            float d2 = glm::dot(d, d);
+            if (d2 <= radius * radius)
+                sphere.push_back((unsigned)i);
+            if (glm::all(glm::lessThanEqual(c - radius, points[i]))
+                    && glm::all(glm::lessThanEqual(points[i], c + radius)))
+                box.push_back((unsigned)i);
+            all.push_back(std::make_pair(d2, (unsigned)i));
+        }
+        size_t k = std::min(BENCH_NEIGHBOURS, count);
+        std::partial_sort(all.begin(), all.begin() + k, all.end());
+
+        found.clear();
+        grid.querySphere(c, radius, found);
+        std::sort(found.begin(), found.end());
+        mismatches += found != sphere;
+        found.clear();
+        grid.queryBox(c - radius, c + radius, found);
+        std::sort(found.begin(), found.end());
+        mismatches += found != box;
+
+        // Compare distances: equidistant points may come in either order
+        size_t n = grid.nearest(c, BENCH_NEIGHBOURS, 1e30f, neighbours, distances);
+        mismatches += n != k;
+        for (size_t i = 0; i < n && i < k; i++)
+            mismatches += glm::abs(distances[i] - glm::sqrt(all[i].first)) > 1e-4f;
+    }
+    return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    int frames = argc > 2 ? atoi(argv[2]) : 20;
+    size_t queries = argc > 3 ? strtoul(argv[3], NULL, 10) : 100000;
+
+    std::vector<glm::vec3> points(count), velocities(count), centers(queries);
+    glm::batch_rng rng(11);
+    glm::linearRandBatch(rng, &points[0].x, count * 3, -BENCH_BOX, BENCH_BOX);
+    glm::sphericalRandBatch(rng, &velocities[0], count, 10.0f);
+    glm::linearRandBatch(rng, &centers[0].x, queries * 3, -BENCH_BOX, BENCH_BOX);
+
+    // About two points per cell
+    float cellSize = BENCH_BOX * 2.0f * glm::pow(2.0f / (float)count, 1.0f / 3.0f);
+    float radius = cellSize;
+    SpatialGrid grid(cellSize);
+    ThreadPool &pool = ThreadPool::shared();
+
+    double buildSeconds[2] = { 0.0, 0.0 };
+    for (int f = 0; f < frames; f++) {
+        benchMove(points, velocities, 1.0f / 60.0f);
+        for (int threaded = 0; threaded < 2; threaded++) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            grid.build(&points[0], count, threaded ? &pool : NULL);
+            buildSeconds[threaded] += benchSeconds(start);
+        }
+    }
+    printf("%zu points, %zu cells of %.3f, build %.2f ms, %2u thread(s) %.2f ms\n",
+            count, grid.cellCount(), cellSize, buildSeconds[0] / frames * 1e3,
+            pool.size(), buildSeconds[1] / frames * 1e3);
+
+    std::vector<unsigned> found;
+    size_t total = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries; q++) {
+        found.clear();
+        grid.querySphere(centers[q], radius, found);
+        total += found.size();
+    }
+    double sphereRate = queries / benchSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries; q++) {
+        found.clear();
+        grid.queryBox(centers[q] - radius, centers[q] + radius, found);
+        total += found.size();
+    }
+    double boxRate = queries / benchSeconds(start);
+
+    unsigned neighbours[BENCH_NEIGHBOURS];
+    start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries; q++)
+        total += grid.nearest(centers[q], BENCH_NEIGHBOURS, 1e30f, neighbours);
+    double nearestRate = queries / benchSeconds(start);
+
+    printf("queries/s: sphere %.2f M, box %.2f M, %zu nearest %.2f M (%zu results)\n",
+            sphereRate * 1e-6, boxRate * 1e-6, BENCH_NEIGHBOURS, nearestRate * 1e-6, total);
+
+    size_t mismatches = benchCheck(grid, points, centers, radius);
+
+    // Clustered: the same points packed into a few cells of a 4^3 block
+    for (size_t k = 0; k < sizeof(BENCH_CLUSTERS) / sizeof(BENCH_CLUSTERS[0]); k++) {
+        size_t clusters = BENCH_CLUSTERS[k];
+        std::vector<glm::vec3> clustered(count);
+        for (size_t i = 0; i < count; i++) {
+            size_t c = i % clusters;
+            glm::vec3 cell((float)(c & 3), (float)(c >> 2 & 3), (float)(c >> 4));
+            clustered[i] = (cell + glm::fract(points[i] * 0.37f)) * cellSize;
+        }
+        std::vector<glm::vec3> probes(BENCH_REFERENCE_QUERIES);
+        for (size_t q = 0; q < probes.size(); q++)
+            probes[q] = clustered[q * 7919 % count];
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        grid.build(&clustered[0], count, &pool);
+        double seconds = benchSeconds(start);
+        printf("%zu points in %zu cell(s): build %.2f ms, %zu table slots (%.2f MB)\n",
+                count, grid.cellCount(), seconds * 1e3, grid.tableSlots(),
+                grid.tableSlots() * 16.0 / (1 << 20));
+        mismatches += benchCheck(grid, clustered, probes, radius);
+    }
+    if (mismatches) {
+        printf("FAIL: %zu sampled queries disagree\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+// Set while a thread runs a task, nested loops then run inline
+static thread_local bool threadPoolInsideTask = false;
+
+ThreadPool::ThreadPool(unsigned threads)
+    : task(NULL), count(0), grain(1), next(0), active(0), generation(0),
+      stopping(false) {
+    if (!threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < threads; i++)
+        workers.push_back(std::thread(&ThreadPool::workerMain, this));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::runChunks() {
+    for (;;) {
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (next >= count)
+                return;
+            begin = next;
+            end = std::min(count, begin + grain);
+            next = end;
+        }
+        threadPoolInsideTask = true;
+        (*task)(begin, end);
+        threadPoolInsideTask = false;
+    }
+}
+
+void ThreadPool::workerMain() {
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (--active == 0)
+            done.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const Task &task) {
+    if (!count)
+        return;
+    grain = std::max<size_t>(grain, 1);
+    if (workers.empty() || count <= grain || threadPoolInsideTask) {
+        task(0, count);
+        return;
+    }
+
+    // Loops started from several threads take turns
+    std::lock_guard<std::mutex> turn(loop);
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        this->task = &task;
+        this->count = count;
+        this->grain = grain;
+        this->next = 0;
+        this->active = (unsigned)workers.size();
+        this->generation++;
+    }
+    wake.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [&] { return active == 0; });
+    this->task = NULL;
+}
@@ -0,0 +1,12 @@
+#ifndef TRANSFORM_GLSL
+#define TRANSFORM_GLSL
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 proj;
+
+vec4 toClipSpace(vec3 pos) {
+    return proj * view * model * vec4(pos, 1.0);
+}
+
+#endif
@@ -0,0 +1,331 @@
+#!/usr/bin/env python3
+#
+# Generates the capture wrappers (src/gl_capture_gen.inc) and the replay
+# dispatcher (src/gl_replay_gen.inc) from include/glad/glad.h. Every entry
+# point is classified into how its arguments are serialised; calls whose
+# pointer arguments cannot be sized are forwarded with a warning instead.
+#
+#   python3 tools/gen_gl_capture.py
+#
+
+import os
+import re
+
+from gen_gl_trace import ROOT, parse_glad
+
+CAPTURE_OUT = os.path.join(ROOT, "src", "gl_capture_gen.inc")
+REPLAY_OUT = os.path.join(ROOT, "src", "gl_replay_gen.inc")
+
+# scalar GLuint parameters holding object names, and the namespace they map in
+NAME_PARAMS = {
+    "buffer": "NAME_BUFFER",
+    "texture": "NAME_TEXTURE",
+    "array": "NAME_ARRAY",
+    "framebuffer": "NAME_FRAMEBUFFER",
+    "renderbuffer": "NAME_RENDERBUFFER",
+    "sampler": "NAME_SAMPLER",
+    "id": "NAME_QUERY",
+    "program": "NAME_PROGRAM",
+    "shader": "NAME_PROGRAM",
+}
+
+# glGen*/glDelete* array parameters
+NAME_ARRAYS = {
+    "buffers": "NAME_BUFFER",
+    "textures": "NAME_TEXTURE",
+    "arrays": "NAME_ARRAY",
+    "framebuffers": "NAME_FRAMEBUFFER",
+    "renderbuffers": "NAME_RENDERBUFFER",
+    "samplers": "NAME_SAMPLER",
+    "ids": "NAME_QUERY",
+}
+
+WIDE_INTEGERS = ("GLintptr", "GLsizeiptr")
+
+OUT_SCRATCH = "65536"
+
+
+class Unsupported(Exception):
+    pass
+
+
+def base_type(ctype):
+    return ctype.replace("const", "").replace("*", "").strip()
+
+
+def array_count(name, params, pname):
+    names = [n for _, n in params]
+    m = re.match(r"^glUniformMatrix(\d)(?:x(\d))?fv$", name)
+    if m:
+        cols = int(m.group(1))
+        rows = int(m.group(2) or m.group(1))
+        return "count * %d" % (cols * rows)
+    m = re.match(r"^glUniform(\d)u?[fi]v$", name)
+    if m:
+        return "count * %s" % m.group(1)
+    m = re.match(r"^glVertexAttribI?(\d)N?(ub|us|ui|b|s|i|f|d)v$", name)
+    if m:
+        return m.group(1)
+    if re.match(r"^gl(VertexAttribP|VertexP|TexCoordP|MultiTexCoordP|"
+                r"NormalP|ColorP|SecondaryColorP)\duiv$", name):
+        return "1"
+    if re.match(r"^gl(Tex|Sampler)Parameter", name):
+        return ("(pname == GL_TEXTURE_BORDER_COLOR || "
+                "pname == GL_TEXTURE_SWIZZLE_RGBA) ? 4 : 1")
+    if name.startswith("glPointParameter"):
+        return "1"
+    if name.startswith("glClearBuffer"):
+        return "buffer == GL_COLOR ? 4 : 1"
+    if name == "glMultiDrawArrays":
+        return "drawcount"
+    if name == "glGetActiveUniformsiv" and pname == "uniformIndices":
+        return "uniformCount"
+    if name.startswith("glDelete") or name == "glDrawBuffers":
+        return "n" if "n" in names else "count"
+    raise Unsupported()
+
+
+def classify(name, ret, params):
+    """Returns the list of argument ops, raises Unsupported if the call
+    cannot be serialised."""
+    if ret == "GLsync" or (ret.endswith("*") and not name.startswith("glGetString")):
+        raise Unsupported()
+
+    names = [n for _, n in params]
+    ops = []
+    skip = set()
+    for i, (ctype, pname) in enumerate(params):
+        if pname in skip:
+            ops.append(("null", ctype, pname))
+            continue
+        if ctype == "GLsync" or "const*" in ctype and "GLchar" not in ctype:
+            raise Unsupported()
+
+        if "*" not in ctype:
+            if ctype == "GLuint" and pname in NAME_PARAMS:
+                ops.append(("name", ctype, pname, NAME_PARAMS[pname]))
+            elif ctype == "GLint" and pname == "location":
+                ops.append(("location", ctype, pname))
+            elif ctype in WIDE_INTEGERS:
+                ops.append(("wide", ctype, pname))
+            else:
+                ops.append(("scalar", ctype, pname))
+            continue
+
+        if ctype == "const GLchar *":
+            ops.append(("string", ctype, pname))
+        elif ctype == "const GLchar *const*":
+            count = "count" if "count" in names else "uniformCount"
+            if i + 1 < len(params) and params[i + 1] == ("const GLint *", "length"):
+                skip.add("length")
+            ops.append(("strings", ctype, pname, count))
+        elif ctype == "const void *":
+            if pname == "pixels":
+                dims = re.search(r"(\d)D$", name).group(1)
+                ops.append(("image", ctype, pname, dims))
+            elif pname == "data" and "imageSize" in names:
+                ops.append(("blob", ctype, pname, "imageSize"))
+            elif pname == "data" and "size" in names:
+                ops.append(("blob", ctype, pname, "size"))
+            elif pname in ("pointer", "indices"):
+                ops.append(("offset", ctype, pname))
+            else:
+                raise Unsupported()
+        elif ctype == "void *":
+            if name == "glReadPixels":
+                ops.append(("readpixels", ctype, pname))
+            elif name == "glGetBufferSubData":
+                ops.append(("out", ctype, pname, "size"))
+            else:
+                raise Unsupported()
+        elif ctype == "void **":
+            ops.append(("out", ctype, pname, OUT_SCRATCH))
+        elif ctype.startswith("const "):
+            cls = NAME_ARRAYS.get(pname) if name.startswith("glDelete") else None
+            ops.append(("array", base_type(ctype), pname,
+                        array_count(name, params, pname), cls))
+        elif name.startswith("glGen") and pname in NAME_ARRAYS:
+            count = "n" if "n" in names else "count"
+            ops.append(("gen", ctype, pname, NAME_ARRAYS[pname], count))
+        else:
+            size = OUT_SCRATCH
+            if "bufSize" in names:
+                size = "(size_t)bufSize + " + OUT_SCRATCH
+            ops.append(("out", ctype, pname, size))
+    return ops
+
+
+def capture_wrapper(index, name, proc, ret, params, ops):
+    decl = ", ".join("%s %s" % (t, n) for t, n in params) or "void"
+    call = ", ".join(n for _, n in params)
+    body = []
+    w = body.append
+    w("    GLCaptureWriter &out = glCaptureWriter();")
+    w("    out.begin(%d);" % index)
+    post = []
+    for op in ops:
+        kind, ctype, pname = op[0], op[1], op[2]
+        if kind in ("scalar", "name", "location"):
+            w("    out.put(%s);" % pname)
+        elif kind == "wide":
+            w("    out.put((long long)%s);" % pname)
+        elif kind == "string":
+            w("    out.putString(%s);" % pname)
+        elif kind == "strings":
+            length = "length" if "length" in [n for _, n in params] else "NULL"
+            w("    out.putStrings(%s, %s, %s);" % (op[3], pname, length))
+        elif kind == "image":
+            dims = op[3]
+            height = "height" if dims in ("2", "3") else "1"
+            depth = "depth" if dims == "3" else "1"
+            w("    out.putImage(%s, glCaptureImageSize(width, %s, %s, format, type));"
+              % (pname, height, depth))
+        elif kind == "blob":
+            w("    out.putPointer(%s, (size_t)(%s));" % (pname, op[3]))
+        elif kind == "offset":
+            w("    out.putOffset(%s);" % pname)
+        elif kind == "readpixels":
+            w("    out.putPackOffset(%s);" % pname)
+        elif kind == "array":
+            w("    out.putPointer(%s, (size_t)(%s) * sizeof(%s));"
+              % (pname, op[3], op[1]))
+        elif kind == "gen":
+            post.append("    out.putPointer(%s, (size_t)%s * sizeof(GLuint));"
+                        % (pname, op[4]))
+    if ret == "void":
+        w("    capreal_%s(%s);" % (name, call))
+    else:
+        w("    %s ret = capreal_%s(%s);" % (ret, name, call))
+        if not ret.endswith("*"):
+            post.append("    out.put(ret);")
+    body.extend(post)
+    if ret != "void":
+        w("    return ret;")
+    lines = ["static %s capreal_%s;" % (proc, name),
+             "static %s APIENTRY capture_%s(%s) {" % (ret, name, decl)]
+    lines.extend(body)
+    lines.append("}")
+    return lines
+
+
+def unsupported_wrapper(index, name, proc, ret, params):
+    decl = ", ".join("%s %s" % (t, n) for t, n in params) or "void"
+    call = ", ".join(n for _, n in params)
+    lines = ["static %s capreal_%s;" % (proc, name),
+             "static %s APIENTRY capture_%s(%s) {" % (ret, name, decl),
+             "    glCaptureUnsupported(%d);" % index]
+    if ret == "void":
+        lines.append("    capreal_%s(%s);" % (name, call))
+    else:
+        lines.append("    return capreal_%s(%s);" % (name, call))
+    lines.append("}")
+    return lines
+
+
+def replay_case(index, name, ret, params, ops):
+    lines = ["    case %d: { // %s" % (index, name)]
+    w = lines.append
+    has_program = "program" in [n for _, n in params]
+    post = []
+    for slot, op in enumerate(ops):
+        kind, ctype, pname = op[0], op[1], op[2]
+        if kind == "scalar":
+            w("        %s %s = in.get<%s>();" % (ctype, pname, ctype))
+        elif kind == "name":
+            w("        GLuint c_%s = in.get<GLuint>();" % pname)
+            w("        GLuint %s = state.map(%s, c_%s);" % (pname, op[3], pname))
+        elif kind == "location":
+            prog = "c_program" if has_program else "state.currentProgram"
+            w("        GLint %s = state.location(%s, in.get<GLint>());" % (pname, prog))
+        elif kind == "wide":
+            w("        %s %s = (%s)in.get<long long>();" % (ctype, pname, ctype))
+        elif kind == "string":
+            w("        const GLchar *%s = in.string();" % pname)
+        elif kind == "strings":
+            w("        const GLchar *const *%s = in.strings();" % pname)
+        elif kind == "null":
+            w("        %s%s = NULL;" % (ctype, pname))
+        elif kind in ("image", "blob", "offset", "readpixels"):
+            w("        %s%s = (%s)in.pointer();" % (ctype, pname, ctype))
+            if kind == "readpixels":
+                w("        if (!%s) %s = state.scratch(%d, (size_t)width * height * 16);"
+                  % (pname, pname, slot))
+        elif kind == "array":
+            if op[4]:
+                w("        const GLuint *%s = state.mapArray(%s, in);" % (pname, op[4]))
+            else:
+                w("        const %s *%s = (const %s *)in.pointer();"
+                  % (ctype, pname, ctype))
+        elif kind == "gen":
+            w("        GLuint *%s = (GLuint *)state.scratch(%d, (size_t)%s * sizeof(GLuint));"
+              % (pname, slot, op[4]))
+            post.append("        state.registerNames(%s, %s, %s, in);" % (op[3], op[4], pname))
+        elif kind == "out":
+            w("        %s%s = (%s)state.scratch(%d, %s);"
+              % (ctype, pname, ctype, slot, op[3]))
+    call = ", ".join(n for _, n in params)
+    if ret == "void" or ret.endswith("*"):
+        w("        glad_%s(%s);" % (name, call))
+    else:
+        w("        %s ret = glad_%s(%s);" % (ret, name, call))
+        w("        %s c_ret = in.get<%s>();" % (ret, ret))
+        if name in ("glCreateShader", "glCreateProgram"):
+            w("        state.registerName(NAME_PROGRAM, c_ret, ret);")
+        elif name == "glGetUniformLocation":
+            w("        state.registerLocation(c_program, c_ret, ret);")
+        else:
+            w("        (void)c_ret; (void)ret;")
+    lines.extend(post)
+    if name == "glUseProgram":
+        w("        state.currentProgram = c_program;")
+    w("        break;")
+    w("    }")
+    return lines
+
+
+def emit(entries):
+    cap = ["/* Generated by tools/gen_gl_capture.py from include/glad/glad.h.",
+           " * Do not edit by hand. */", "",
+           "#define GL_CAPTURE_ENTRY_COUNT %d" % len(entries), "",
+           "static const char *const glCaptureNames[GL_CAPTURE_ENTRY_COUNT] = {"]
+    cap += ['    "%s",' % e[0] for e in entries]
+    cap += ["};", ""]
+
+    rep = ["/* Generated by tools/gen_gl_capture.py from include/glad/glad.h.",
+           " * Do not edit by hand. */", "",
+           "#define GL_REPLAY_ENTRY_COUNT %d" % len(entries), "",
+           "static bool glReplayDispatch(int index, GLReplayReader &in,",
+           "        GLReplayState &state) {",
+           "    switch (index) {"]
+
+    for index, (name, proc, ret, params) in enumerate(entries):
+        try:
+            ops = classify(name, ret, params)
+        except Unsupported:
+            cap += unsupported_wrapper(index, name, proc, ret, params)
+            cap.append("")
+            continue
+        cap += capture_wrapper(index, name, proc, ret, params, ops)
+        cap.append("")
+        rep += replay_case(index, name, ret, params, ops)
+
+    rep += ["    default:", "        return false;", "    }",
+            "    return true;", "}"]
+
+    cap.append("static void glCaptureSwapIn() {")
+    for name, _, _, _ in entries:
+        cap.append("    capreal_%s = glad_%s;" % (name, name))
+        cap.append("    if (capreal_%s) glad_%s = capture_%s;" % (name, name, name))
+    cap += ["}", "", "static void glCaptureSwapOut() {"]
+    for name, _, _, _ in entries:
+        cap.append("    if (capreal_%s) glad_%s = capreal_%s;" % (name, name, name))
+    cap.append("}")
+    return "\n".join(cap) + "\n", "\n".join(rep) + "\n"
+
+
+if __name__ == "__main__":
+    capture, replay = emit(parse_glad())
+    with open(CAPTURE_OUT, "w") as f:
+        f.write(capture)
+    with open(REPLAY_OUT, "w") as f:
+        f.write(replay)
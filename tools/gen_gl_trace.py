@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+#
+# Generates src/gl_trace_gen.inc from include/glad/glad.h: one wrapper per
+# glad entry point, plus the tables used to swap them in and out.
+#
+#   python3 tools/gen_gl_trace.py
+#
+
+import os
+import re
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+GLAD_H = os.path.join(ROOT, "include", "glad", "glad.h")
+OUTPUT = os.path.join(ROOT, "src", "gl_trace_gen.inc")
+
+TYPEDEF_RE = re.compile(
+    r"^typedef (.+?) \(APIENTRYP (PFNGL\w+PROC)\)\((.*)\);$")
+GLAPI_RE = re.compile(r"^GLAPI (PFNGL\w+PROC) glad_(gl\w+);$")
+
+# printf format and cast used when logging an argument of this type
+ARG_FORMATS = {
+    "GLenum": ("0x%04X", "(unsigned int)"),
+    "GLbitfield": ("0x%X", "(unsigned int)"),
+    "GLboolean": ("%u", "(unsigned int)"),
+    "GLubyte": ("%u", "(unsigned int)"),
+    "GLuint": ("%u", "(unsigned int)"),
+    "GLshort": ("%d", "(int)"),
+    "GLint": ("%d", "(int)"),
+    "GLsizei": ("%d", "(int)"),
+    "GLfloat": ("%g", "(double)"),
+    "GLdouble": ("%g", "(double)"),
+    "GLintptr": ("%lld", "(long long)"),
+    "GLsizeiptr": ("%lld", "(long long)"),
+    "GLuint64": ("%llu", "(unsigned long long)"),
+}
+
+
+def parse_params(text):
+    """'GLenum target, const void *data' -> [('GLenum', 'target'), ...]"""
+    text = text.strip()
+    if text in ("", "void"):
+        return []
+    params = []
+    for part in text.split(","):
+        part = part.strip()
+        m = re.match(r"^(.*?)(\w+)$", part)
+        params.append((m.group(1).strip(), m.group(2)))
+    return params
+
+
+def arg_format(ctype):
+    if "*" in ctype or ctype == "GLsync":
+        return ("%p", "(const void *)")
+    return ARG_FORMATS[ctype]
+
+
+def parse_glad():
+    typedefs = {}
+    entries = []
+    with open(GLAD_H) as f:
+        for line in f:
+            line = line.strip()
+            m = TYPEDEF_RE.match(line)
+            if m:
+                typedefs[m.group(2)] = (m.group(1), parse_params(m.group(3)))
+                continue
+            m = GLAPI_RE.match(line)
+            if m:
+                ret, params = typedefs[m.group(1)]
+                entries.append((m.group(2), m.group(1), ret, params))
+    return entries
+
+
+def emit(entries):
+    out = []
+    w = out.append
+    w("/* Generated by tools/gen_gl_trace.py from include/glad/glad.h.")
+    w(" * Do not edit by hand. */")
+    w("")
+    w("#define GL_TRACE_ENTRY_COUNT %d" % len(entries))
+    w("")
+    w("static const char *const glTraceNames[GL_TRACE_ENTRY_COUNT] = {")
+    for name, _, _, _ in entries:
+        w('    "%s",' % name)
+    w("};")
+    w("")
+
+    for index, (name, proc, ret, params) in enumerate(entries):
+        decl = ", ".join("%s %s" % (t, n) for t, n in params) or "void"
+        call = ", ".join(n for _, n in params)
+        w("static %s real_%s;" % (proc, name))
+        w("static %s APIENTRY trace_%s(%s) {" % (ret, name, decl))
+        w("    GLTraceScope scope(%d);" % index)
+        if params:
+            fmts = ", ".join(arg_format(t)[0] for t, _ in params)
+            args = ", ".join(arg_format(t)[1] + n for t, n in params)
+            w("    if (scope.logging)")
+            w('        glTraceLogArgs(%d, "(%s)", %s);' % (index, fmts, args))
+        else:
+            w("    if (scope.logging)")
+            w('        glTraceLogArgs(%d, "()");' % index)
+        if ret == "void":
+            w("    real_%s(%s);" % (name, call))
+        else:
+            w("    return real_%s(%s);" % (name, call))
+        w("}")
+        w("")
+
+    w("static void glTraceSwapIn() {")
+    for name, _, _, _ in entries:
+        w("    real_%s = glad_%s;" % (name, name))
+        w("    if (real_%s) glad_%s = trace_%s;" % (name, name, name))
+    w("}")
+    w("")
+    w("static void glTraceSwapOut() {")
+    for name, _, _, _ in entries:
+        w("    if (real_%s) glad_%s = real_%s;" % (name, name, name))
+    w("}")
+    return "\n".join(out) + "\n"
+
+
+if __name__ == "__main__":
+    with open(OUTPUT, "w") as f:
+        f.write(emit(parse_glad()))
@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+#
+# Generates src/null_gl_gen.inc from include/glad/glad.h: a counting no-op
+# stub for every entry point, so NullGL can hand gladLoadGLLoader() a
+# correctly typed function for calls it does not implement itself.
+#
+#   python3 tools/gen_null_gl.py
+#
+
+import os
+
+from gen_gl_trace import ROOT, parse_glad
+
+OUTPUT = os.path.join(ROOT, "src", "null_gl_gen.inc")
+
+
+def emit(entries):
+    out = ["/* Generated by tools/gen_null_gl.py from include/glad/glad.h.",
+           " * Do not edit by hand. */", ""]
+    for name, _, ret, params in entries:
+        decl = ", ".join(t for t, _ in params) or "void"
+        out.append("static %s APIENTRY nullstub_%s(%s) {" % (ret, name, decl))
+        out.append("    nullGLCall();")
+        if ret != "void":
+            out.append("    return (%s)0;" % ret)
+        out.append("}")
+        out.append("")
+
+    out.append("static const NullGLEntry nullGLStubs[] = {")
+    for name, _, _, _ in entries:
+        out.append('    { "%s", (void *)nullstub_%s },' % (name, name))
+    out.append("    { NULL, NULL }")
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+if __name__ == "__main__":
+    with open(OUTPUT, "w") as f:
+        f.write(emit(parse_glad()))